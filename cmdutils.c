@@ -120,6 +120,7 @@ void exit_program(int ret)
     if (program_exit)
         program_exit(ret);
 
+    av_log_flush();
     exit(ret);
 }
 
@@ -833,14 +834,19 @@ int opt_loglevel(void *optctx, const char *opt, const char *arg)
         { "debug"  , AV_LOG_DEBUG   },
     };
     char *tail;
-    int level;
+    int level, flags;
     int i;
 
     tail = strstr(arg, "repeat");
-    av_log_set_flags(tail ? 0 : AV_LOG_SKIP_REPEATED);
+    flags = tail ? 0 : AV_LOG_SKIP_REPEATED;
     if (tail == arg)
         arg += 6 + (arg[6]=='+');
-    if(tail && !*arg)
+    if (av_strstart(arg, "buffered", (const char **)&tail)) {
+        flags |= AV_LOG_BUFFERED;
+        arg = tail + (*tail == '+');
+    }
+    av_log_set_flags(flags);
+    if(flags != AV_LOG_SKIP_REPEATED && !*arg)
         return 0;
 
     for (i = 0; i < FF_ARRAY_ELEMS(log_levels); i++) {
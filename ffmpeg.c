@@ -424,6 +424,24 @@ static int decode_interrupt_cb(void *ctx)
 
 const AVIOInterruptCB int_cb = { decode_interrupt_cb, NULL };
 
+static void write_trace(const char *filename)
+{
+    AVBPrint bp;
+    FILE *f;
+
+    av_bprint_init(&bp, 0, AV_BPRINT_SIZE_UNLIMITED);
+    if (av_trace_dump(trace_ctx, &bp) < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Out of memory dumping the trace\n");
+    } else if (!(f = fopen(filename, "w"))) {
+        av_log(NULL, AV_LOG_ERROR, "Cannot open trace file %s: %s\n",
+               filename, strerror(errno));
+    } else {
+        fwrite(bp.str, 1, bp.len, f);
+        fclose(f);
+    }
+    av_bprint_finalize(&bp, NULL);
+}
+
 static void ffmpeg_cleanup(int ret)
 {
     int i, j;
@@ -501,6 +519,14 @@ static void ffmpeg_cleanup(int ret)
         fclose(vstats_file);
     av_free(vstats_filename);
 
+    if (trace_ctx) {
+        av_trace_stop(trace_ctx);
+        if (trace_filename)
+            write_trace(trace_filename);
+        av_trace_free(&trace_ctx);
+    }
+    av_free(trace_filename);
+
     av_freep(&input_streams);
     av_freep(&input_files);
     av_freep(&output_streams);
@@ -3118,6 +3144,11 @@ static int process_input(int file_index)
     ist = input_streams[ifile->ist_index + pkt.stream_index];
     if (ist->discard)
         goto discard_packet;
+    /* not all demuxers skip the packets themselves */
+    if (ist->user_set_discard == AVDISCARD_ALL ||
+        (ist->user_set_discard >= AVDISCARD_NONKEY &&
+         !(pkt.flags & AV_PKT_FLAG_KEY)))
+        goto discard_packet;
 
     if (debug_ts) {
         av_log(NULL, AV_LOG_INFO, "demuxer -> ist_index:%d type:%s "
@@ -3571,6 +3602,12 @@ int main(int argc, char **argv)
 //         exit_program(1);
 //     }
 
+    if (trace_filename) {
+        if (!trace_ctx && !(trace_ctx = av_trace_alloc()))
+            exit_program(1);
+        av_trace_start(trace_ctx);
+    }
+
     current_time = ti = getutime();
     if (transcode() < 0)
         exit_program(1);
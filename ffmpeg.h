@@ -44,6 +44,7 @@
 #include "libavutil/fifo.h"
 #include "libavutil/pixfmt.h"
 #include "libavutil/rational.h"
+#include "libavutil/trace.h"
 
 #include "libswresample/swresample.h"
 
@@ -117,6 +118,10 @@ typedef struct OptionsContext {
     int        nb_hwaccels;
     SpecifierOpt *hwaccel_devices;
     int        nb_hwaccel_devices;
+    SpecifierOpt *lowres_sizes;
+    int        nb_lowres_sizes;
+    SpecifierOpt *discard;
+    int        nb_discard;
 
     /* output options */
     StreamMap *stream_maps;
@@ -235,6 +240,7 @@ typedef struct InputStream {
     int file_index;
     AVStream *st;
     int discard;             /* true if stream data should be discarded */
+    int user_set_discard;    /* AVDISCARD_* set with -discard, applied by the demuxer */
     int decoding_needed;     /* true if the packets must be decoded in 'raw_fifo' */
     AVCodec *dec;
     AVFrame *decoded_frame;
@@ -439,6 +445,8 @@ extern FilterGraph **filtergraphs;
 extern int        nb_filtergraphs;
 
 extern char *vstats_filename;
+extern char *trace_filename;
+extern AVTraceContext *trace_ctx;
 
 extern float audio_drift_threshold;
 extern float dts_delta_threshold;
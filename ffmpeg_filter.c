@@ -271,7 +271,7 @@ static void init_input_filter(FilterGraph *fg, AVFilterInOut *in)
 
     ist->discard         = 0;
     ist->decoding_needed++;
-    ist->st->discard = AVDISCARD_NONE;
+    ist->st->discard = ist->user_set_discard;
 
     GROW_ARRAY(fg->inputs, fg->nb_inputs);
     if (!(fg->inputs[fg->nb_inputs - 1] = av_mallocz(sizeof(*fg->inputs[0]))))
@@ -872,6 +872,10 @@ int configure_filtergraph(FilterGraph *fg)
         e = av_dict_get(ost->opts, "threads", NULL, 0);
         if (e)
             av_opt_set(fg->graph, "threads", e->value, 0);
+
+        e = av_dict_get(ost->opts, "shared_threads", NULL, 0);
+        if (e)
+            av_opt_set(fg->graph, "shared_threads", e->value, 0);
     }
 
     if ((ret = avfilter_graph_parse2(fg->graph, graph_desc, &inputs, &outputs)) < 0)
@@ -71,6 +71,8 @@ const HWAccel hwaccels[] = {
 };
 
 char *vstats_filename;
+char *trace_filename;
+AVTraceContext *trace_ctx;
 
 float audio_drift_threshold = 0.1;
 float dts_delta_threshold   = 10;
@@ -566,6 +568,7 @@ static void add_input_streams(OptionsContext *o, AVFormatContext *ic)
         AVCodecContext *dec = st->codec;
         InputStream *ist = av_mallocz(sizeof(*ist));
         char *framerate = NULL, *hwaccel = NULL, *hwaccel_device = NULL;
+        char *lowres_size = NULL, *discard_str = NULL;
 
         if (!ist)
             exit_program(1);
@@ -581,6 +584,19 @@ static void add_input_streams(OptionsContext *o, AVFormatContext *ic)
         ist->ts_scale = 1.0;
         MATCH_PER_STREAM_OPT(ts_scale, dbl, ist->ts_scale, ic, st);
 
+        ist->user_set_discard = AVDISCARD_NONE;
+        MATCH_PER_STREAM_OPT(discard, str, discard_str, ic, st);
+        if (discard_str) {
+            const AVOption *discard_opt = av_opt_find(dec, "skip_frame", NULL, 0, 0);
+
+            if (av_opt_eval_int(dec, discard_opt, discard_str,
+                                &ist->user_set_discard) < 0) {
+                av_log(NULL, AV_LOG_FATAL, "Invalid discard value: %s.\n",
+                       discard_str);
+                exit_program(1);
+            }
+        }
+
         MATCH_PER_STREAM_OPT(codec_tags, str, codec_tag, ic, st);
         if (codec_tag) {
             uint32_t tag = strtol(codec_tag, &next, 0);
@@ -601,6 +617,28 @@ static void add_input_streams(OptionsContext *o, AVFormatContext *ic)
         case AVMEDIA_TYPE_VIDEO:
             if(!ist->dec)
                 ist->dec = avcodec_find_decoder(dec->codec_id);
+
+            /* pick the lowest resolution still at least as large as requested */
+            MATCH_PER_STREAM_OPT(lowres_sizes, str, lowres_size, ic, st);
+            if (lowres_size && ist->dec && !av_codec_get_lowres(dec) &&
+                !av_dict_get(ist->opts, "lowres", NULL, 0)) {
+                int w, h, lowres = 0;
+
+                if (av_parse_video_size(&w, &h, lowres_size) < 0) {
+                    av_log(NULL, AV_LOG_FATAL, "Invalid lowres size: %s.\n",
+                           lowres_size);
+                    exit_program(1);
+                }
+                while (lowres < av_codec_get_max_lowres(ist->dec) &&
+                       FF_CEIL_RSHIFT(dec->width,  lowres + 1) >= w &&
+                       FF_CEIL_RSHIFT(dec->height, lowres + 1) >= h)
+                    lowres++;
+                av_codec_set_lowres(dec, lowres);
+                if (lowres)
+                    av_log(NULL, AV_LOG_VERBOSE, "Decoding input stream #%d:%d "
+                           "at 1/%d resolution\n", nb_input_files, st->index,
+                           1 << lowres);
+            }
             if (av_codec_get_lowres(dec)) {
                 dec->flags |= CODEC_FLAG_EMU_EDGE;
             }
@@ -1143,7 +1181,7 @@ static OutputStream *new_output_stream(OptionsContext *o, AVFormatContext *oc, e
     if (source_index >= 0) {
         ost->sync_ist = input_streams[source_index];
         input_streams[source_index]->discard = 0;
-        input_streams[source_index]->st->discard = AVDISCARD_NONE;
+        input_streams[source_index]->st->discard = input_streams[source_index]->user_set_discard;
     }
     ost->last_mux_dts = AV_NOPTS_VALUE;
 
@@ -1758,7 +1796,7 @@ static int open_output_file(OptionsContext *o, const char *filename)
                     if(ost->st->codec->codec_type == AVMEDIA_TYPE_AUDIO) ost->avfilter = av_strdup("anull");
                     if(ost->st->codec->codec_type == AVMEDIA_TYPE_VIDEO) ost->avfilter = av_strdup("null");
                     ist->discard = 0;
-                    ist->st->discard = AVDISCARD_NONE;
+                    ist->st->discard = ist->user_set_discard;
                     break;
                 }
             }
@@ -2231,6 +2269,26 @@ static int opt_vstats_file(void *optctx, const char *opt, const char *arg)
     return 0;
 }
 
+static int opt_trace(void *optctx, const char *opt, const char *arg)
+{
+    av_free(trace_filename);
+    trace_filename = av_strdup(arg);
+    return 0;
+}
+
+static int opt_trace_opts(void *optctx, const char *opt, const char *arg)
+{
+    int ret;
+
+    if (!trace_ctx && !(trace_ctx = av_trace_alloc()))
+        return AVERROR(ENOMEM);
+    if ((ret = av_set_options_string(trace_ctx, arg, "=", ":")) < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Invalid trace options '%s'\n", arg);
+        return ret;
+    }
+    return 0;
+}
+
 static int opt_vstats(void *optctx, const char *opt, const char *arg)
 {
     char filename[40];
@@ -2724,6 +2782,10 @@ const OptionDef options[] = {
         "add timings for benchmarking" },
     { "benchmark_all",  OPT_BOOL | OPT_EXPERT,                       { &do_benchmark_all },
       "add timings for each task" },
+    { "trace",          HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_trace },
+      "trace the decoders, encoders, filters, demuxers and muxers to file", "file" },
+    { "trace_opts",     HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_trace_opts },
+      "set the options of the trace", "options" },
     { "progress",       HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_progress },
       "write program-readable progress information", "url" },
     { "stdin",          OPT_BOOL | OPT_EXPERT,                       { &stdin_interaction },
@@ -2882,6 +2944,11 @@ const OptionDef options[] = {
         "force key frames at specified timestamps", "timestamps" },
     { "b",            OPT_VIDEO | HAS_ARG | OPT_PERFILE | OPT_OUTPUT,            { .func_arg = opt_bitrate },
         "video bitrate (please use -b:v)", "bitrate" },
+    { "lowres_size",      OPT_VIDEO | OPT_STRING | HAS_ARG | OPT_EXPERT |
+                          OPT_SPEC | OPT_INPUT,                                  { .off = OFFSET(lowres_sizes) },
+        "decode at the lowest resolution not smaller than size, if the decoder supports it", "size" },
+    { "discard",          OPT_STRING | HAS_ARG | OPT_SPEC | OPT_INPUT,          { .off = OFFSET(discard) },
+        "discard packets of the stream before decoding", "none|default|noref|bidir|nokey|all" },
     { "hwaccel",          OPT_VIDEO | OPT_STRING | HAS_ARG | OPT_EXPERT |
                           OPT_SPEC | OPT_INPUT,                                  { .off = OFFSET(hwaccels) },
         "use HW accelerated decoding", "hwaccel name" },
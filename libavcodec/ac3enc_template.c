@@ -155,8 +155,12 @@ static void apply_channel_coupling(AC3EncodeContext *s)
             CoefType *ch_coef = &block->mdct_coef[ch][cpl_start];
             if (!block->channel_in_cpl[ch])
                 continue;
+#if CONFIG_AC3ENC_FLOAT
+            s->fdsp.vector_fadd(cpl_coef, cpl_coef, ch_coef, num_cpl_coefs);
+#else
             for (i = 0; i < num_cpl_coefs; i++)
                 cpl_coef[i] += ch_coef[i];
+#endif
         }
 
         /* coefficients must be clipped in order to be encoded */
@@ -39,6 +39,7 @@
 #include "libavutil/log.h"
 #include "libavutil/pixfmt.h"
 #include "libavutil/rational.h"
+#include "libavutil/threadpool.h"
 
 #include "version.h"
 
@@ -2984,6 +2985,26 @@ typedef struct AVCodecContext {
 #define FF_DEBUG_VIS_MV_B_FOR  0x00000002 //visualize forward predicted MVs of B frames
 #define FF_DEBUG_VIS_MV_B_BACK 0x00000004 //visualize backward predicted MVs of B frames
 #endif
+
+    /**
+     * Thread pool running the jobs of slice threading, instead of threads
+     * created for this context. thread_count still bounds the number of
+     * jobs running at the same time.
+     * - encoding: Set by user before avcodec_open2().
+     * - decoding: Set by user before avcodec_open2().
+     * Code outside libavcodec should access this field using:
+     * av_codec_{get,set}_thread_pool(avctx)
+     */
+    AVThreadPool *thread_pool;
+
+    /**
+     * Run the jobs of slice threading on the default thread pool of
+     * libavutil when thread_pool is not set.
+     * Code outside libavcodec should access this field using AVOptions
+     * - encoding: Set by user.
+     * - decoding: Set by user.
+     */
+    int shared_threads;
 } AVCodecContext;
 
 AVRational av_codec_get_pkt_timebase         (const AVCodecContext *avctx);
@@ -2998,6 +3019,9 @@ void av_codec_set_lowres(AVCodecContext *avctx, int val);
 int  av_codec_get_seek_preroll(const AVCodecContext *avctx);
 void av_codec_set_seek_preroll(AVCodecContext *avctx, int val);
 
+AVThreadPool *av_codec_get_thread_pool(const AVCodecContext *avctx);
+void          av_codec_set_thread_pool(AVCodecContext *avctx, AVThreadPool *val);
+
 /**
  * AVProfile.
  */
@@ -3700,6 +3724,74 @@ void av_packet_move_ref(AVPacket *dst, AVPacket *src);
  */
 int av_packet_copy_props(AVPacket *dst, const AVPacket *src);
 
+/**
+ * A pool of AVPacket structures, the counterpart of AVFramePool for
+ * packets allocated on the heap.
+ *
+ * Packets are taken with av_packet_pool_get() and given back with
+ * av_packet_pool_release(), which unreferences them with av_packet_unref()
+ * and keeps them for later av_packet_pool_get() calls. The pool may be used
+ * from several threads at the same time.
+ */
+typedef struct AVPacketPool AVPacketPool;
+
+/**
+ * Counters of an AVPacketPool, filled by av_packet_pool_get_stats().
+ */
+typedef struct AVPacketPoolStats {
+    int     nb_in_use;      ///< packets taken and not released yet
+    int     max_in_use;     ///< largest nb_in_use so far
+    int     nb_idle;        ///< packets kept for reuse
+    int64_t nb_allocs;      ///< packets allocated by av_packet_pool_get()
+    int64_t nb_reuses;      ///< av_packet_pool_get() calls served by an idle packet
+    int64_t nb_refused;     ///< av_packet_pool_get() calls failing on max_packets
+    int64_t nb_frees;       ///< released packets freed instead of being kept
+} AVPacketPoolStats;
+
+/**
+ * Allocate a packet pool.
+ *
+ * Both limits are numbers of packets, not of bytes, as for
+ * av_frame_pool_alloc(): the data of a packet is held by an AVBufferRef
+ * which is not accounted to the pool.
+ *
+ * @param max_packets maximum number of packets of the pool in use at the
+ *                    same time, 0 for no limit
+ * @param max_idle    maximum number of released packets kept for reuse,
+ *                    0 for no limit; the others are freed
+ * @return the pool or NULL on failure
+ */
+AVPacketPool *av_packet_pool_alloc(int max_packets, int max_idle);
+
+/**
+ * Free the idle packets of the pool and set *pool to NULL. The packets
+ * still in use may be released afterwards; the pool is freed with the last
+ * one.
+ */
+void av_packet_pool_free(AVPacketPool **pool);
+
+/**
+ * Get a packet from the pool, initialized with av_init_packet() and with
+ * data and size set to 0.
+ *
+ * @return the packet or NULL if max_packets packets are in use or on
+ *         allocation failure
+ */
+AVPacket *av_packet_pool_get(AVPacketPool *pool);
+
+/**
+ * Unreference a packet obtained from av_packet_pool_get() and give it back
+ * to the pool. Nothing is done if *pkt is NULL.
+ *
+ * @param pkt the packet, set to NULL
+ */
+void av_packet_pool_release(AVPacketPool *pool, AVPacket **pkt);
+
+/**
+ * Get the counters of the pool.
+ */
+void av_packet_pool_get_stats(AVPacketPool *pool, AVPacketPoolStats *stats);
+
 /**
  * @}
  */
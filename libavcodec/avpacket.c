@@ -25,6 +25,7 @@
 #include "libavutil/common.h"
 #include "libavutil/internal.h"
 #include "libavutil/mem.h"
+#include "libavutil/objpool.h"
 #include "avcodec.h"
 #include "bytestream.h"
 #include "internal.h"
@@ -563,3 +564,140 @@ void av_packet_move_ref(AVPacket *dst, AVPacket *src)
     *dst = *src;
     av_init_packet(src);
 }
+
+struct AVPacketPool {
+    FFObjectPool pool;
+};
+
+static void *packet_pool_alloc(void)
+{
+    AVPacket *pkt = av_mallocz(sizeof(*pkt));
+
+    if (pkt)
+        av_init_packet(pkt);
+    return pkt;
+}
+
+static void packet_pool_reset(void *obj)
+{
+    av_packet_unref(obj);
+}
+
+static void packet_pool_free(void *obj)
+{
+    av_free(obj);
+}
+
+AVPacketPool *av_packet_pool_alloc(int max_packets, int max_idle)
+{
+    AVPacketPool *pool = av_mallocz(sizeof(*pool));
+
+    if (!pool)
+        return NULL;
+    if (avpriv_object_pool_init(&pool->pool, max_packets, max_idle,
+                                packet_pool_alloc, packet_pool_reset,
+                                packet_pool_free) < 0) {
+        av_free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void av_packet_pool_free(AVPacketPool **ppool)
+{
+    AVPacketPool *pool = *ppool;
+
+    if (!pool)
+        return;
+    *ppool = NULL;
+
+    if (avpriv_object_pool_close(&pool->pool)) {
+        avpriv_object_pool_uninit(&pool->pool);
+        av_free(pool);
+    }
+}
+
+AVPacket *av_packet_pool_get(AVPacketPool *pool)
+{
+    return avpriv_object_pool_get(&pool->pool);
+}
+
+void av_packet_pool_release(AVPacketPool *pool, AVPacket **ppkt)
+{
+    AVPacket *pkt = *ppkt;
+
+    if (!pkt)
+        return;
+    *ppkt = NULL;
+
+    if (avpriv_object_pool_release(&pool->pool, pkt)) {
+        avpriv_object_pool_uninit(&pool->pool);
+        av_free(pool);
+    }
+}
+
+void av_packet_pool_get_stats(AVPacketPool *pool, AVPacketPoolStats *stats)
+{
+    FFObjectPoolStats s;
+
+    avpriv_object_pool_get_stats(&pool->pool, &s);
+    stats->nb_in_use  = s.nb_in_use;
+    stats->max_in_use = s.max_in_use;
+    stats->nb_idle    = s.nb_idle;
+    stats->nb_allocs  = s.nb_allocs;
+    stats->nb_reuses  = s.nb_reuses;
+    stats->nb_refused = s.nb_refused;
+    stats->nb_frees   = s.nb_frees;
+}
+
+#ifdef TEST
+// LCOV_EXCL_START
+#include <stdio.h>
+
+int main(void)
+{
+    AVPacketPool *pool = av_packet_pool_alloc(4, 2), *tmp;
+    AVPacketPoolStats stats;
+    AVPacket *pkts[5];
+    int i, j;
+
+    if (!pool)
+        return 1;
+
+    for (j = 0; j < 3; j++) {
+        for (i = 0; i < 5; i++) {
+            pkts[i] = av_packet_pool_get(pool);
+            if (!pkts[i] != (i == 4))
+                printf("round %d: get %d returned %p\n", j, i, pkts[i]);
+        }
+        if (pkts[0]->data || pkts[0]->size || pkts[0]->buf ||
+            pkts[0]->side_data_elems || pkts[0]->pts != AV_NOPTS_VALUE)
+            printf("round %d: packet not reset\n", j);
+        if (av_new_packet(pkts[0], 64) < 0 ||
+            !av_packet_new_side_data(pkts[0], AV_PKT_DATA_NEW_EXTRADATA, 16))
+            return 1;
+        pkts[0]->pts = 42;
+        for (i = 0; i < 5; i++)
+            av_packet_pool_release(pool, &pkts[i]);
+        if (pkts[0])
+            printf("round %d: packet pointer not cleared\n", j);
+    }
+
+    av_packet_pool_get_stats(pool, &stats);
+    if (stats.nb_in_use != 0 || stats.max_in_use != 4 || stats.nb_idle != 2 ||
+        stats.nb_allocs != 8 || stats.nb_reuses != 4 ||
+        stats.nb_refused != 3 || stats.nb_frees != 6)
+        printf("stats: %d %d %d %"PRId64" %"PRId64" %"PRId64" %"PRId64"\n",
+               stats.nb_in_use, stats.max_in_use, stats.nb_idle,
+               stats.nb_allocs, stats.nb_reuses, stats.nb_refused,
+               stats.nb_frees);
+
+    /* a packet released after the pool is freed */
+    pkts[0] = av_packet_pool_get(pool);
+    tmp     = pool;
+    av_packet_pool_free(&pool);
+    av_packet_pool_release(tmp, &pkts[0]);
+    return 0;
+}
+// LCOV_EXCL_STOP
+#endif
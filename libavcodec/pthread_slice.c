@@ -40,6 +40,7 @@
 #include "libavutil/common.h"
 #include "libavutil/cpu.h"
 #include "libavutil/mem.h"
+#include "libavutil/threadpool.h"
 
 typedef int (action_func)(AVCodecContext *c, void *arg);
 typedef int (action_func2)(AVCodecContext *c, void *arg, int jobnr, int threadnr);
@@ -66,6 +67,8 @@ typedef struct SliceThreadContext {
     int thread_count;
     pthread_cond_t *progress_cond;
     pthread_mutex_t *progress_mutex;
+
+    AVThreadPool *pool;   ///< pool running the jobs instead of workers
 } SliceThreadContext;
 
 static void* attribute_align_arg worker(void *v)
@@ -109,6 +112,11 @@ void ff_slice_thread_free(AVCodecContext *avctx)
     SliceThreadContext *c = avctx->internal->thread_ctx;
     int i;
 
+    if (c->pool) {
+        av_freep(&avctx->internal->thread_ctx);
+        return;
+    }
+
     pthread_mutex_lock(&c->current_job_lock);
     c->done = 1;
     pthread_cond_broadcast(&c->current_job_cond);
@@ -171,6 +179,39 @@ static int thread_execute2(AVCodecContext *avctx, action_func2* func2, void *arg
     return thread_execute(avctx, NULL, arg, ret, job_count, 0);
 }
 
+static int pool_job(void *ctx, void *arg, int jobnr, int threadnr)
+{
+    AVCodecContext *avctx = ctx;
+    SliceThreadContext *c = avctx->internal->thread_ctx;
+
+    return c->func ? c->func(avctx, (char*)c->args + jobnr*c->job_size):
+                     c->func2(avctx, c->args, jobnr, threadnr);
+}
+
+static int pool_execute(AVCodecContext *avctx, action_func* func, void *arg, int *ret, int job_count, int job_size)
+{
+    SliceThreadContext *c = avctx->internal->thread_ctx;
+
+    if (!(avctx->active_thread_type&FF_THREAD_SLICE) || avctx->thread_count <= 1)
+        return avcodec_default_execute(avctx, func, arg, ret, job_count, job_size);
+
+    if (job_count <= 0)
+        return 0;
+
+    c->job_size = job_size;
+    c->args = arg;
+    c->func = func;
+    return av_thread_pool_execute(c->pool, pool_job, avctx, NULL, ret,
+                                  job_count, avctx->thread_count);
+}
+
+static int pool_execute2(AVCodecContext *avctx, action_func2* func2, void *arg, int *ret, int job_count)
+{
+    SliceThreadContext *c = avctx->internal->thread_ctx;
+    c->func2 = func2;
+    return pool_execute(avctx, NULL, arg, ret, job_count, 0);
+}
+
 int ff_slice_thread_init(AVCodecContext *avctx)
 {
     int i;
@@ -201,6 +242,16 @@ int ff_slice_thread_init(AVCodecContext *avctx)
     if (!c)
         return -1;
 
+    c->pool = avctx->thread_pool;
+    if (!c->pool && avctx->shared_threads)
+        c->pool = av_thread_pool_get_default();
+    if (c->pool) {
+        avctx->internal->thread_ctx = c;
+        avctx->execute = pool_execute;
+        avctx->execute2 = pool_execute2;
+        return 0;
+    }
+
     c->workers = av_mallocz(sizeof(pthread_t)*thread_count);
     if (!c->workers) {
         av_free(c);
@@ -40,6 +40,7 @@
 #include "libavutil/imgutils.h"
 #include "libavutil/samplefmt.h"
 #include "libavutil/dict.h"
+#include "libavutil/trace.h"
 #include "avcodec.h"
 #include "dsputil.h"
 #include "libavutil/opt.h"
@@ -1106,6 +1107,7 @@ MAKE_ACCESSORS(AVCodecContext, codec, AVRational, pkt_timebase)
 MAKE_ACCESSORS(AVCodecContext, codec, const AVCodecDescriptor *, codec_descriptor)
 MAKE_ACCESSORS(AVCodecContext, codec, int, lowres)
 MAKE_ACCESSORS(AVCodecContext, codec, int, seek_preroll)
+MAKE_ACCESSORS(AVCodecContext, codec, AVThreadPool *, thread_pool)
 
 int av_codec_get_max_lowres(const AVCodec *codec)
 {
@@ -1613,6 +1615,7 @@ int attribute_align_arg avcodec_encode_audio2(AVCodecContext *avctx,
     int ret;
     AVPacket user_pkt = *avpkt;
     int needs_realloc = !user_pkt.data;
+    int64_t trace_start;
 
     *got_packet_ptr = 0;
 
@@ -1664,9 +1667,12 @@ int attribute_align_arg avcodec_encode_audio2(AVCodecContext *avctx,
         }
     }
 
+    trace_start = av_trace_begin(AV_TRACE_CODEC);
     ret = avctx->codec->encode2(avctx, avpkt, frame, got_packet_ptr);
+    av_trace_end(AV_TRACE_CODEC, avctx->codec->name, trace_start);
     if (!ret) {
         if (*got_packet_ptr) {
+            av_trace_counter(AV_TRACE_CODEC, avctx->codec->name, avpkt->size);
             if (!(avctx->codec->capabilities & CODEC_CAP_DELAY)) {
                 if (avpkt->pts == AV_NOPTS_VALUE)
                     avpkt->pts = frame->pts;
@@ -1854,6 +1860,7 @@ int attribute_align_arg avcodec_encode_video2(AVCodecContext *avctx,
     int ret;
     AVPacket user_pkt = *avpkt;
     int needs_realloc = !user_pkt.data;
+    int64_t trace_start;
 
     *got_packet_ptr = 0;
 
@@ -1876,8 +1883,12 @@ int attribute_align_arg avcodec_encode_video2(AVCodecContext *avctx,
 
     av_assert0(avctx->codec->encode2);
 
+    trace_start = av_trace_begin(AV_TRACE_CODEC);
     ret = avctx->codec->encode2(avctx, avpkt, frame, got_packet_ptr);
+    av_trace_end(AV_TRACE_CODEC, avctx->codec->name, trace_start);
     av_assert0(ret <= 0);
+    if (!ret && *got_packet_ptr)
+        av_trace_counter(AV_TRACE_CODEC, avctx->codec->name, avpkt->size);
 
     if (avpkt->data && avpkt->data == avctx->internal->byte_buffer) {
         needs_realloc = 0;
@@ -2090,6 +2101,7 @@ int attribute_align_arg avcodec_decode_video2(AVCodecContext *avctx, AVFrame *pi
 {
     AVCodecInternal *avci = avctx->internal;
     int ret;
+    int64_t trace_start = 0;
     // copy to ensure we do not change avpkt
     AVPacket tmp = *avpkt;
 
@@ -2116,6 +2128,7 @@ int attribute_align_arg avcodec_decode_video2(AVCodecContext *avctx, AVFrame *pi
         }
 
         avctx->internal->pkt = &tmp;
+        trace_start = av_trace_begin(AV_TRACE_CODEC);
         if (HAVE_THREADS && avctx->active_thread_type & FF_THREAD_FRAME)
             ret = ff_thread_decode_frame(avctx, picture, got_picture_ptr,
                                          &tmp);
@@ -2140,6 +2153,7 @@ int attribute_align_arg avcodec_decode_video2(AVCodecContext *avctx, AVFrame *pi
 
 fail:
         emms_c(); //needed to avoid an emms_c() call before every return;
+        av_trace_end(AV_TRACE_CODEC, avctx->codec->name, trace_start);
 
         avctx->internal->pkt = NULL;
         if (did_split) {
@@ -2252,6 +2266,7 @@ int attribute_align_arg avcodec_decode_audio4(AVCodecContext *avctx,
         uint8_t *side;
         int side_size;
         uint32_t discard_padding = 0;
+        int64_t trace_start;
         // copy to ensure we do not change avpkt
         AVPacket tmp = *avpkt;
         int did_split = av_packet_split_side_data(&tmp);
@@ -2263,12 +2278,14 @@ int attribute_align_arg avcodec_decode_audio4(AVCodecContext *avctx,
         }
 
         avctx->internal->pkt = &tmp;
+        trace_start = av_trace_begin(AV_TRACE_CODEC);
         if (HAVE_THREADS && avctx->active_thread_type & FF_THREAD_FRAME)
             ret = ff_thread_decode_frame(avctx, frame, got_frame_ptr, &tmp);
         else {
             ret = avctx->codec->decode(avctx, frame, got_frame_ptr, &tmp);
             frame->pkt_dts = avpkt->dts;
         }
+        av_trace_end(AV_TRACE_CODEC, avctx->codec->name, trace_start);
         if (ret >= 0 && *got_frame_ptr) {
             add_metadata_from_side_data(avctx, frame);
             avctx->frame_number++;
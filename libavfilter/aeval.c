@@ -71,6 +71,10 @@ typedef struct {
     double var_values[VAR_VARS_NB];
     double *channel_values;
     int64_t out_channel_layout;
+    int uses_val;               ///< some expressions read the input samples with val()
+    double *n_values, *t_values;
+    int nb_var_values;          ///< number of allocated n_values and t_values
+    const double *var_arrays[VAR_VARS_NB];
 } EvalContext;
 
 static double val(void *priv, double ch)
@@ -164,6 +168,17 @@ static int parse_channel_expressions(AVFilterContext *ctx,
         goto end;
     }
 
+    /* val() returns the current input sample, so the expressions using it
+     * are evaluated one sample at a time */
+    eval->uses_val = 0;
+    if (func1) {
+        unsigned counter[FF_ARRAY_ELEMS(aeval_func1_names) - 1] = { 0 };
+
+        for (i = 0; i < eval->nb_channels; i++)
+            av_expr_count_func(eval->expr[i], counter, FF_ARRAY_ELEMS(counter), 1);
+        eval->uses_val = counter[0] > 0;
+    }
+
 end:
     av_free(args1);
     return ret;
@@ -217,6 +232,25 @@ static av_cold void uninit(AVFilterContext *ctx)
         eval->expr[i] = NULL;
     }
     av_freep(&eval->expr);
+    av_freep(&eval->n_values);
+    av_freep(&eval->t_values);
+}
+
+/* Make room for the values of n and t of nb_samples samples */
+static int alloc_var_values(EvalContext *eval, int nb_samples)
+{
+    if (nb_samples > eval->nb_var_values) {
+        eval->n_values = av_realloc_f(eval->n_values, nb_samples, sizeof(*eval->n_values));
+        eval->t_values = av_realloc_f(eval->t_values, nb_samples, sizeof(*eval->t_values));
+        if (!eval->n_values || !eval->t_values) {
+            eval->nb_var_values = 0;
+            return AVERROR(ENOMEM);
+        }
+        eval->nb_var_values = nb_samples;
+    }
+    eval->var_arrays[VAR_N] = eval->n_values;
+    eval->var_arrays[VAR_T] = eval->t_values;
+    return 0;
 }
 
 static int config_props(AVFilterLink *outlink)
@@ -258,26 +292,28 @@ static int request_frame(AVFilterLink *outlink)
 {
     EvalContext *eval = outlink->src->priv;
     AVFrame *samplesref;
-    int i, j;
+    int i, j, ret;
     int64_t t = av_rescale(eval->n, AV_TIME_BASE, eval->sample_rate);
 
     if (eval->duration >= 0 && t >= eval->duration)
         return AVERROR_EOF;
 
+    if ((ret = alloc_var_values(eval, eval->nb_samples)) < 0)
+        return ret;
     samplesref = ff_get_audio_buffer(outlink, eval->nb_samples);
     if (!samplesref)
         return AVERROR(ENOMEM);
 
-    /* evaluate expression for each single sample and for each channel */
-    for (i = 0; i < eval->nb_samples; i++, eval->n++) {
-        eval->var_values[VAR_N] = eval->n;
-        eval->var_values[VAR_T] = eval->var_values[VAR_N] * (double)1/eval->sample_rate;
-
-        for (j = 0; j < eval->nb_channels; j++) {
-            *((double *) samplesref->extended_data[j] + i) =
-                av_expr_eval(eval->expr[j], eval->var_values, NULL);
-        }
+    /* evaluate expression for all the samples of each channel */
+    for (i = 0; i < eval->nb_samples; i++) {
+        eval->n_values[i] = eval->n + i;
+        eval->t_values[i] = eval->n_values[i] * (double)1/eval->sample_rate;
     }
+    for (j = 0; j < eval->nb_channels; j++)
+        av_expr_eval_batch(eval->expr[j], (double *)samplesref->extended_data[j],
+                           eval->nb_samples, eval->var_values,
+                           eval->var_arrays, NULL);
+    eval->n += eval->nb_samples;
 
     samplesref->pts = eval->pts;
     samplesref->sample_rate = eval->sample_rate;
@@ -402,7 +438,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     int nb_samples        = in->nb_samples;
     AVFrame *out;
     double t0;
-    int i, j;
+    int i, j, ret;
 
     /* do volume scaling in-place if input buffer is writable */
     out = ff_get_audio_buffer(outlink, nb_samples);
@@ -412,6 +448,30 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 
     t0 = TS2T(in->pts, inlink->time_base);
 
+    if (!eval->uses_val) {
+        if ((ret = alloc_var_values(eval, nb_samples)) < 0) {
+            av_frame_free(&in);
+            av_frame_free(&out);
+            return ret;
+        }
+
+        /* evaluate expression for all the samples of each channel */
+        for (i = 0; i < nb_samples; i++) {
+            eval->n_values[i] = eval->n + i;
+            eval->t_values[i] = t0 + i * (double)1/inlink->sample_rate;
+        }
+        for (j = 0; j < outlink->channels; j++) {
+            eval->var_values[VAR_CH] = j;
+            av_expr_eval_batch(eval->expr[j], (double *)out->extended_data[j],
+                               nb_samples, eval->var_values,
+                               eval->var_arrays, eval);
+        }
+        eval->n += nb_samples;
+
+        av_frame_free(&in);
+        return ff_filter_frame(outlink, out);
+    }
+
     /* evaluate expression for each single sample and for each channel */
     for (i = 0; i < nb_samples; i++, eval->n++) {
         eval->var_values[VAR_N] = eval->n;
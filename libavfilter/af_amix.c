@@ -43,6 +43,7 @@
 #include "avfilter.h"
 #include "formats.h"
 #include "internal.h"
+#include "mixdsp.h"
 
 #define INPUT_OFF      0    /**< input has reached EOF */
 #define INPUT_ON       1    /**< input is active */
@@ -156,6 +157,7 @@ static int frame_list_add_frame(FrameList *frame_list, int nb_samples, int64_t p
 typedef struct MixContext {
     const AVClass *class;       /**< class for AVOptions */
     AVFloatDSPContext fdsp;
+    MixDSPContext mdsp;
 
     int nb_inputs;              /**< number of inputs */
     int active_inputs;          /**< number of input currently active */
@@ -165,6 +167,10 @@ typedef struct MixContext {
     int nb_channels;            /**< number of channels */
     int sample_rate;            /**< sample rate */
     int planar;
+    int dbl;                    /**< whether the samples are doubles */
+    int s16;                    /**< whether the samples are 16-bit integers */
+    int32_t *acc;               /**< s16 mixing accumulator */
+    unsigned int acc_size;
     AVAudioFifo **fifos;        /**< audio fifo for each input */
     uint8_t *input_state;       /**< current state of each input */
     float *input_scale;         /**< mixing scale factor for each input */
@@ -224,6 +230,8 @@ static int config_output(AVFilterLink *outlink)
     char buf[64];
 
     s->planar          = av_sample_fmt_is_planar(outlink->format);
+    s->dbl             = av_get_packed_sample_fmt(outlink->format) == AV_SAMPLE_FMT_DBL;
+    s->s16             = av_get_packed_sample_fmt(outlink->format) == AV_SAMPLE_FMT_S16;
     s->sample_rate     = outlink->sample_rate;
     outlink->time_base = (AVRational){ 1, outlink->sample_rate };
     s->next_pts        = AV_NOPTS_VALUE;
@@ -271,8 +279,8 @@ static int output_frame(AVFilterLink *outlink, int nb_samples)
 {
     AVFilterContext *ctx = outlink->src;
     MixContext      *s = ctx->priv;
-    AVFrame *out_buf, *in_buf;
-    int i;
+    AVFrame *out_buf, *in_buf = NULL;
+    int i, planes, plane_size, first = 1;
 
     calculate_scales(s, nb_samples);
 
@@ -280,30 +288,69 @@ static int output_frame(AVFilterLink *outlink, int nb_samples)
     if (!out_buf)
         return AVERROR(ENOMEM);
 
-    in_buf = ff_get_audio_buffer(outlink, nb_samples);
-    if (!in_buf) {
-        av_frame_free(&out_buf);
-        return AVERROR(ENOMEM);
+    planes     = s->planar ? s->nb_channels : 1;
+    plane_size = nb_samples * (s->planar ? 1 : s->nb_channels);
+
+    /* s16 inputs are accumulated in 32 bits with 15 fractional bits */
+    if (s->s16) {
+        av_fast_malloc(&s->acc, &s->acc_size,
+                       planes * plane_size * sizeof(*s->acc));
+        if (!s->acc) {
+            av_frame_free(&out_buf);
+            return AVERROR(ENOMEM);
+        }
+        memset(s->acc, 0, planes * plane_size * sizeof(*s->acc));
     }
 
     for (i = 0; i < s->nb_inputs; i++) {
         if (s->input_state[i] == INPUT_ON) {
-            int planes, plane_size, p;
+            int p;
+
+            /* the first active input is read straight into the output and
+             * scaled in place, the other ones are accumulated on top of it */
+            if (!first && !in_buf) {
+                in_buf = ff_get_audio_buffer(outlink, nb_samples);
+                if (!in_buf) {
+                    av_frame_free(&out_buf);
+                    return AVERROR(ENOMEM);
+                }
+            }
 
-            av_audio_fifo_read(s->fifos[i], (void **)in_buf->extended_data,
+            av_audio_fifo_read(s->fifos[i],
+                               (void **)(first ? out_buf : in_buf)->extended_data,
                                nb_samples);
 
-            planes     = s->planar ? s->nb_channels : 1;
-            plane_size = nb_samples * (s->planar ? 1 : s->nb_channels);
-            plane_size = FFALIGN(plane_size, 16);
-
             for (p = 0; p < planes; p++) {
-                s->fdsp.vector_fmac_scalar((float *)out_buf->extended_data[p],
-                                           (float *) in_buf->extended_data[p],
-                                           s->input_scale[i], plane_size);
+                /* the float DSP works on whole aligned blocks */
+                int size = FFALIGN(plane_size, s->dbl ? 8 : 16);
+
+                if (s->s16)
+                    s->mdsp.mix_s16(s->acc + p * plane_size,
+                                    (int16_t *)(first ? out_buf : in_buf)->extended_data[p],
+                                    lrintf(s->input_scale[i] * 32768), plane_size);
+                else if (s->dbl && first)
+                    s->fdsp.vector_dmul_scalar((double *)out_buf->extended_data[p],
+                                               (double *)out_buf->extended_data[p],
+                                               s->input_scale[i], size);
+                else if (s->dbl)
+                    s->fdsp.vector_dmac_scalar((double *)out_buf->extended_data[p],
+                                               (double *) in_buf->extended_data[p],
+                                               s->input_scale[i], size);
+                else if (first)
+                    s->fdsp.vector_fmul_scalar((float *)out_buf->extended_data[p],
+                                               (float *)out_buf->extended_data[p],
+                                               s->input_scale[i], size);
+                else
+                    s->fdsp.vector_fmac_scalar((float *)out_buf->extended_data[p],
+                                               (float *) in_buf->extended_data[p],
+                                               s->input_scale[i], size);
             }
+            first = 0;
         }
     }
+    for (i = 0; s->s16 && i < planes; i++)
+        s->mdsp.pack_s16((int16_t *)out_buf->extended_data[i],
+                         s->acc + i * plane_size, 15, plane_size);
     av_frame_free(&in_buf);
 
     out_buf->pts = s->next_pts;
@@ -502,6 +549,7 @@ static av_cold int init(AVFilterContext *ctx)
     }
 
     avpriv_float_dsp_init(&s->fdsp, 0);
+    ff_mixdsp_init(&s->mdsp);
 
     return 0;
 }
@@ -520,6 +568,7 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&s->frame_list);
     av_freep(&s->input_state);
     av_freep(&s->input_scale);
+    av_freep(&s->acc);
 
     for (i = 0; i < ctx->nb_inputs; i++)
         av_freep(&ctx->input_pads[i].name);
@@ -530,6 +579,10 @@ static int query_formats(AVFilterContext *ctx)
     AVFilterFormats *formats = NULL;
     ff_add_format(&formats, AV_SAMPLE_FMT_FLT);
     ff_add_format(&formats, AV_SAMPLE_FMT_FLTP);
+    ff_add_format(&formats, AV_SAMPLE_FMT_DBL);
+    ff_add_format(&formats, AV_SAMPLE_FMT_DBLP);
+    ff_add_format(&formats, AV_SAMPLE_FMT_S16);
+    ff_add_format(&formats, AV_SAMPLE_FMT_S16P);
     ff_set_common_formats(ctx, formats);
     ff_set_common_channel_layouts(ctx, ff_all_channel_layouts());
     ff_set_common_samplerates(ctx, ff_all_samplerates());
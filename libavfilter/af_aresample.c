@@ -144,6 +144,9 @@ static int config_output(AVFilterLink *outlink)
         av_opt_set_int(aresample->swr, "ich", inlink->channels, 0);
     if (!outlink->channel_layout)
         av_opt_set_int(aresample->swr, "och", outlink->channels, 0);
+    swr_set_thread_pool(aresample->swr, ctx->graph->thread_pool);
+    if (ctx->graph->shared_threads)
+        av_opt_set_int(aresample->swr, "shared_threads", 1, 0);
 
     ret = swr_init(aresample->swr);
     if (ret < 0)
@@ -30,12 +30,14 @@
 #include <stdio.h>
 #include "libavutil/avstring.h"
 #include "libavutil/channel_layout.h"
+#include "libavutil/float_dsp.h"
 #include "libavutil/opt.h"
 #include "libswresample/swresample.h"
 #include "audio.h"
 #include "avfilter.h"
 #include "formats.h"
 #include "internal.h"
+#include "mixdsp.h"
 
 #define MAX_CHANNELS 63
 
@@ -52,6 +54,19 @@ typedef struct PanContext {
     /* channel mapping specific */
     int channel_map[SWR_CH_MAX];
     struct SwrContext *swr;
+
+    /* native mixing of float and s16 samples, only the non-zero gains of
+     * each output channel are kept */
+    int native;
+    int64_t used_inputs;
+    int nb_mix[SWR_CH_MAX];
+    int mix_ch[SWR_CH_MAX][SWR_CH_MAX];
+    float mix_gain[SWR_CH_MAX][SWR_CH_MAX];
+    int mix_gain_s16[SWR_CH_MAX][SWR_CH_MAX];
+    AVFloatDSPContext fdsp;
+    MixDSPContext dsp;
+    uint8_t *buf;
+    unsigned int buf_size;
 } PanContext;
 
 static void skip_spaces(char **arg)
@@ -192,6 +207,9 @@ static av_cold int init(AVFilterContext *ctx)
     }
     pan->need_renumber = !!nb_in_channels[1];
 
+    avpriv_float_dsp_init(&pan->fdsp, 0);
+    ff_mixdsp_init(&pan->dsp);
+
     ret = 0;
 fail:
     av_free(args);
@@ -250,6 +268,51 @@ static int query_formats(AVFilterContext *ctx)
     return 0;
 }
 
+static void init_native_mixing(PanContext *pan, AVFilterLink *link)
+{
+    int s16 = 0, i, j, k;
+
+    pan->native      = 0;
+    pan->used_inputs = 0;
+
+    switch (link->format) {
+    case AV_SAMPLE_FMT_S16:
+    case AV_SAMPLE_FMT_S16P:
+        s16 = 1;
+        /* fall through */
+    case AV_SAMPLE_FMT_FLT:
+    case AV_SAMPLE_FMT_FLTP:
+        break;
+    default:
+        return;
+    }
+
+    for (i = 0; i < pan->nb_output_channels; i++) {
+        double sum = 0;
+
+        for (j = k = 0; j < link->channels; j++) {
+            double gain = pan->gain[i][j];
+
+            if (!gain)
+                continue;
+            pan->mix_ch[i][k]   = j;
+            pan->mix_gain[i][k] = gain;
+            pan->used_inputs   |= (int64_t)1 << j;
+            sum += fabs(gain);
+            k++;
+        }
+        pan->nb_mix[i] = k;
+
+        /* s16 uses the coefficients of the swr s16 rematrix, with 15
+         * fractional bits; the products and their sum must fit in 32 bits */
+        if (s16 && sum * 32768 + k >= 65535)
+            return;
+        for (j = 0; j < k && s16; j++)
+            pan->mix_gain_s16[i][j] = lrintf(pan->mix_gain[i][j] * 32768);
+    }
+    pan->native = 1;
+}
+
 static int config_props(AVFilterLink *link)
 {
     AVFilterContext *ctx = link->dst;
@@ -293,6 +356,7 @@ static int config_props(AVFilterLink *link)
 
     // gains are pure, init the channel mapping
     if (pan->pure_gains) {
+        pan->native = 0;
 
         // get channel map from the pure gains
         for (i = 0; i < pan->nb_output_channels; i++) {
@@ -330,6 +394,7 @@ static int config_props(AVFilterLink *link)
         av_opt_set_int(pan->swr, "icl", link->channel_layout, 0);
         av_opt_set_int(pan->swr, "ocl", pan->out_channel_layout, 0);
         swr_set_matrix(pan->swr, pan->gain[0], pan->gain[1] - pan->gain[0]);
+        init_native_mixing(pan, link);
     }
 
     r = swr_init(pan->swr);
@@ -360,6 +425,122 @@ static int config_props(AVFilterLink *link)
     return 0;
 }
 
+static void mix_channel_flt(PanContext *pan, float *dst, const float **src,
+                            int out_ch, int n)
+{
+    const int nb     = pan->nb_mix[out_ch];
+    const int *ch    = pan->mix_ch[out_ch];
+    const float *gain = pan->mix_gain[out_ch];
+    int len = n & ~15;
+    int i, k;
+
+    if (!nb) {
+        memset(dst, 0, n * sizeof(*dst));
+        return;
+    }
+
+    /* the float DSP needs aligned vectors, misaligned ones use the C loop */
+    if ((intptr_t)dst & 31)
+        len = 0;
+    for (k = 0; k < nb; k++)
+        if ((intptr_t)src[ch[k]] & 31)
+            len = 0;
+
+    if (len) {
+        pan->fdsp.vector_fmul_scalar(dst, src[ch[0]], gain[0], len);
+        for (k = 1; k < nb; k++)
+            pan->fdsp.vector_fmac_scalar(dst, src[ch[k]], gain[k], len);
+    }
+    for (i = len; i < n; i++) {
+        float v = src[ch[0]][i] * gain[0];
+        for (k = 1; k < nb; k++)
+            v += src[ch[k]][i] * gain[k];
+        dst[i] = v;
+    }
+}
+
+static void mix_channel_s16(PanContext *pan, int16_t *dst, int32_t *acc,
+                            const int16_t **src, int out_ch, int n)
+{
+    const int nb   = pan->nb_mix[out_ch];
+    const int *ch  = pan->mix_ch[out_ch];
+    const int *gain = pan->mix_gain_s16[out_ch];
+    int k;
+
+    if (!nb) {
+        memset(dst, 0, n * sizeof(*dst));
+        return;
+    }
+
+    memset(acc, 0, n * sizeof(*acc));
+    for (k = 0; k < nb; k++)
+        pan->dsp.mix_s16(acc, src[ch[k]], gain[k], n);
+    pan->dsp.pack_s16(dst, acc, 15, n);
+}
+
+/**
+ * Copy the samples of one channel between a packed and a planar buffer,
+ * strides are in samples.
+ */
+static void copy_channel(uint8_t *dst, int dst_stride,
+                         const uint8_t *src, int src_stride, int bps, int n)
+{
+    int i;
+
+    if (bps == 2) {
+        for (i = 0; i < n; i++)
+            ((int16_t *)dst)[i * dst_stride] = ((const int16_t *)src)[i * src_stride];
+    } else {
+        for (i = 0; i < n; i++)
+            ((uint32_t *)dst)[i * dst_stride] = ((const uint32_t *)src)[i * src_stride];
+    }
+}
+
+static int mix_samples(AVFilterLink *inlink, AVFrame *out, const AVFrame *in, int n)
+{
+    PanContext *pan  = inlink->dst->priv;
+    const int planar = av_sample_fmt_is_planar(inlink->format);
+    const int s16    = av_get_packed_sample_fmt(inlink->format) == AV_SAMPLE_FMT_S16;
+    const int bps    = s16 ? 2 : 4;
+    const int in_ch  = inlink->channels;
+    const int out_ch = pan->nb_output_channels;
+    /* room for n int32 or float samples, keeps every plane aligned */
+    const int plane_size = FFALIGN(n, 16) * 4;
+    uint8_t *src[SWR_CH_MAX], *acc, *tmp;
+    int i;
+
+    /* packed samples are split into planes around the mixing */
+    av_fast_malloc(&pan->buf, &pan->buf_size,
+                   (2 + (planar ? 0 : in_ch)) * plane_size);
+    if (!pan->buf)
+        return AVERROR(ENOMEM);
+    acc = pan->buf;
+    tmp = pan->buf + plane_size;
+
+    for (i = 0; i < in_ch; i++) {
+        if (planar) {
+            src[i] = in->extended_data[i];
+        } else {
+            src[i] = tmp + (i + 1) * plane_size;
+            if ((pan->used_inputs >> i) & 1)
+                copy_channel(src[i], 1, in->data[0] + i * bps, in_ch, bps, n);
+        }
+    }
+
+    for (i = 0; i < out_ch; i++) {
+        uint8_t *dst = planar ? out->extended_data[i] : tmp;
+
+        if (s16)
+            mix_channel_s16(pan, (int16_t *)dst, (int32_t *)acc,
+                            (const int16_t **)src, i, n);
+        else
+            mix_channel_flt(pan, (float *)dst, (const float **)src, i, n);
+        if (!planar)
+            copy_channel(out->data[0] + i * bps, out_ch, tmp, 1, bps, n);
+    }
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
 {
     int ret;
@@ -370,7 +551,16 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
 
     if (!outsamples)
         return AVERROR(ENOMEM);
-    swr_convert(pan->swr, outsamples->data, n, (void *)insamples->data, n);
+    if (pan->native) {
+        ret = mix_samples(inlink, outsamples, insamples, n);
+        if (ret < 0) {
+            av_frame_free(&outsamples);
+            av_frame_free(&insamples);
+            return ret;
+        }
+    } else {
+        swr_convert(pan->swr, outsamples->data, n, (void *)insamples->data, n);
+    }
     av_frame_copy_props(outsamples, insamples);
     outsamples->channel_layout = outlink->channel_layout;
     av_frame_set_channels(outsamples, outlink->channels);
@@ -384,6 +574,7 @@ static av_cold void uninit(AVFilterContext *ctx)
 {
     PanContext *pan = ctx->priv;
     swr_free(&pan->swr);
+    av_freep(&pan->buf);
 }
 
 #define OFFSET(x) offsetof(PanContext, x)
@@ -31,6 +31,7 @@
 #include "libavutil/pixdesc.h"
 #include "libavutil/rational.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/trace.h"
 
 #include "audio.h"
 #include "avfilter.h"
@@ -1001,6 +1002,7 @@ static int ff_filter_frame_framed(AVFilterLink *link, AVFrame *frame)
     AVFilterPad *dst = link->dstpad;
     AVFrame *out;
     int ret;
+    int64_t trace_start;
     AVFilterCommand *cmd= link->dst->command_queue;
     int64_t pts;
 
@@ -1078,7 +1080,9 @@ static int ff_filter_frame_framed(AVFilterLink *link, AVFrame *frame)
             (dstctx->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC))
             filter_frame = default_filter_frame;
     }
+    trace_start = av_trace_begin(AV_TRACE_FILTER);
     ret = filter_frame(link, out);
+    av_trace_end(AV_TRACE_FILTER, dstctx->filter->name, trace_start);
     link->frame_count++;
     link->frame_requested = 0;
     ff_update_link_current_pts(link, pts);
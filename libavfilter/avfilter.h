@@ -43,6 +43,7 @@
 #include "libavutil/samplefmt.h"
 #include "libavutil/pixfmt.h"
 #include "libavutil/rational.h"
+#include "libavutil/threadpool.h"
 
 #include "libavfilter/version.h"
 
@@ -1230,6 +1231,16 @@ typedef struct AVFilterGraph {
 
     char *aresample_swr_opts; ///< swr options to use for the auto-inserted aresample filters, Access ONLY through AVOptions
 
+    /**
+     * Thread pool running the jobs of the filters with slice threading,
+     * instead of threads created for this graph. May be set by the caller
+     * before adding any filters to the filtergraph; nb_threads still bounds
+     * the number of jobs running at the same time.
+     */
+    AVThreadPool *thread_pool;
+
+    int shared_threads; ///< run the jobs on the default thread pool of libavutil if thread_pool is not set, Access ONLY through AVOptions
+
     /**
      * Private fields
      *
@@ -0,0 +1,130 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "blurdsp.h"
+
+void ff_blur_sum_pairs_c(uint32_t *dst, const uint32_t *src, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++)
+        dst[i] = src[i] + src[i + 1];
+}
+
+void ff_blur_sum_stages_c(uint32_t *line, uint32_t *state0, uint32_t *state1, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++) {
+        uint32_t tmp1 = line[i], tmp2;
+
+        tmp2 = state0[i] + tmp1; state0[i] = tmp1;
+        tmp1 = state1[i] + tmp2; state1[i] = tmp2;
+        line[i] = tmp1;
+    }
+}
+
+void ff_blur_unsharp_line_c(uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                            int len, int amount, int scalebits)
+{
+    const int32_t halfscale = 1 << (scalebits - 1);
+    int i;
+
+    for (i = 0; i < len; i++) {
+        int32_t res = (int32_t)src[i] + ((((int32_t)src[i] - (int32_t)((blur[i] + halfscale) >> scalebits)) * amount) >> 16);
+        dst[i] = av_clip_uint8(res);
+    }
+}
+
+void ff_blur_box_slide_c(uint16_t *sum, const uint8_t *add, const uint8_t *sub, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++)
+        sum[i] += add[i] - sub[i];
+}
+
+void ff_blur_box_scale_c(uint8_t *dst, const uint16_t *sum, int inv, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++)
+        dst[i] = (sum[i] * inv + (1 << 15)) >> 16;
+}
+
+void ff_blur_threshold_line_c(uint8_t *dst, const uint8_t *src, int threshold, int len)
+{
+    int i;
+
+    if (threshold > 0) {
+        for (i = 0; i < len; i++) {
+            const int orig = src[i];
+            const int diff = orig - dst[i];
+
+            if (diff > 0) {
+                if (diff > 2 * threshold)
+                    dst[i] = orig;
+                else if (diff > threshold)
+                    /* add 'diff' and substract 'threshold' from 'filtered' */
+                    dst[i] = orig - threshold;
+            } else {
+                if (-diff > 2 * threshold)
+                    dst[i] = orig;
+                else if (-diff > threshold)
+                    /* add 'diff' and 'threshold' to 'filtered' */
+                    dst[i] = orig + threshold;
+            }
+        }
+    } else {
+        for (i = 0; i < len; i++) {
+            const int orig     = src[i];
+            const int filtered = dst[i];
+            const int diff     = orig - filtered;
+
+            if (diff > 0) {
+                if (diff <= -threshold)
+                    dst[i] = orig;
+                else if (diff <= -2 * threshold)
+                    /* substract 'diff' and 'threshold' from 'orig' */
+                    dst[i] = filtered - threshold;
+            } else {
+                if (diff >= threshold)
+                    dst[i] = orig;
+                else if (diff >= 2 * threshold)
+                    /* add 'threshold' and substract 'diff' from 'orig' */
+                    dst[i] = filtered + threshold;
+            }
+        }
+    }
+}
+
+av_cold void ff_blurdsp_init(BlurDSPContext *dsp)
+{
+    dsp->sum_pairs      = ff_blur_sum_pairs_c;
+    dsp->sum_stages     = ff_blur_sum_stages_c;
+    dsp->unsharp_line   = ff_blur_unsharp_line_c;
+    dsp->box_slide      = ff_blur_box_slide_c;
+    dsp->box_scale      = ff_blur_box_scale_c;
+    dsp->threshold_line = ff_blur_threshold_line_c;
+
+    if (ARCH_X86)
+        ff_blurdsp_init_x86(dsp);
+}
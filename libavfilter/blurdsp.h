@@ -0,0 +1,78 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * separable blur DSP shared by the unsharp, boxblur and smartblur filters
+ */
+
+#ifndef AVFILTER_BLURDSP_H
+#define AVFILTER_BLURDSP_H
+
+#include <stdint.h>
+
+typedef struct BlurDSPContext {
+    /**
+     * One [1 1] pass of a binomial filter: dst[i] = src[i] + src[i + 1].
+     * src must hold len + 1 elements, dst may be equal to src.
+     */
+    void (*sum_pairs)(uint32_t *dst, const uint32_t *src, int len);
+
+    /**
+     * Push one line through two cascaded vertical [1 1] stages.
+     * state0/state1 hold the previous input of each stage and are updated,
+     * line is replaced by the output of the second stage.
+     */
+    void (*sum_stages)(uint32_t *line, uint32_t *state0, uint32_t *state1, int len);
+
+    /**
+     * Unsharp mask output:
+     * dst[i] = clip(src[i] + ((src[i] - ((blur[i] + (1 << (scalebits - 1))) >> scalebits)) * amount >> 16))
+     */
+    void (*unsharp_line)(uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                         int len, int amount, int scalebits);
+
+    /**
+     * Slide a vertical box window down one line: sum[i] += add[i] - sub[i].
+     */
+    void (*box_slide)(uint16_t *sum, const uint8_t *add, const uint8_t *sub, int len);
+
+    /**
+     * Normalize box sums: dst[i] = (sum[i] * inv + (1 << 15)) >> 16.
+     */
+    void (*box_scale)(uint8_t *dst, const uint16_t *sum, int inv, int len);
+
+    /**
+     * Smartblur edge preservation: dst holds the blurred line on input and
+     * is blended back towards src according to threshold, which is non-zero.
+     */
+    void (*threshold_line)(uint8_t *dst, const uint8_t *src, int threshold, int len);
+} BlurDSPContext;
+
+void ff_blurdsp_init(BlurDSPContext *dsp);
+void ff_blurdsp_init_x86(BlurDSPContext *dsp);
+
+void ff_blur_sum_pairs_c(uint32_t *dst, const uint32_t *src, int len);
+void ff_blur_sum_stages_c(uint32_t *line, uint32_t *state0, uint32_t *state1, int len);
+void ff_blur_unsharp_line_c(uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                            int len, int amount, int scalebits);
+void ff_blur_box_slide_c(uint16_t *sum, const uint8_t *add, const uint8_t *sub, int len);
+void ff_blur_box_scale_c(uint8_t *dst, const uint16_t *sum, int inv, int len);
+void ff_blur_threshold_line_c(uint8_t *dst, const uint8_t *src, int threshold, int len);
+
+#endif /* AVFILTER_BLURDSP_H */
@@ -21,6 +21,7 @@
 
 #include <string.h>
 
+#include "config.h"
 #include "libavutil/avutil.h"
 #include "libavutil/colorspace.h"
 #include "libavutil/mem.h"
@@ -146,6 +147,17 @@ void ff_copy_rectangle(uint8_t *dst[4], int dst_linesize[4],
     }
 }
 
+void ff_draw_blend_row_c(uint8_t *dst, const uint8_t *mask,
+                         unsigned src, unsigned alpha, int w)
+{
+    int x;
+
+    for (x = 0; x < w; x++) {
+        unsigned a = mask[x] * alpha;
+        dst[x] = ((0x1010101 - a) * dst[x] + a * src) >> 24;
+    }
+}
+
 int ff_draw_init(FFDrawContext *draw, enum AVPixelFormat format, unsigned flags)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
@@ -185,6 +197,9 @@ int ff_draw_init(FFDrawContext *draw, enum AVPixelFormat format, unsigned flags)
     for (i = 0; i < ((desc->nb_components - 1) | 1); i++)
         draw->comp_mask[desc->comp[i].plane] |=
             1 << (desc->comp[i].offset_plus1 - 1);
+    draw->blend_row = ff_draw_blend_row_c;
+    if (ARCH_X86)
+        ff_draw_init_x86(draw);
     return 0;
 }
 
@@ -418,7 +433,41 @@ static void blend_pixel(uint8_t *dst, unsigned src, unsigned alpha,
     *dst = ((0x1010101 - alpha) * *dst + alpha * src) >> 24;
 }
 
-static void blend_line_hv(uint8_t *dst, int dst_delta,
+/**
+ * Blend w full pixels of an 8-bit mask with draw->blend_row, reducing the
+ * mask to the subsampled coverage first if needed.
+ */
+static void blend_line_8(FFDrawContext *draw, uint8_t *dst,
+                         unsigned src, unsigned alpha,
+                         const uint8_t *mask, int mask_linesize, int w,
+                         unsigned hsub, unsigned vsub, int hband)
+{
+    uint8_t cov[256];
+    int x0, x, y, n;
+
+    if (!hsub && !vsub) {
+        draw->blend_row(dst, mask, src, alpha, w);
+        return;
+    }
+    for (x0 = 0; x0 < w; x0 += n) {
+        n = FFMIN(w - x0, (int)sizeof(cov));
+        for (x = 0; x < n; x++) {
+            const uint8_t *m = mask + ((x0 + x) << hsub);
+            unsigned t = 0;
+
+            for (y = 0; y < hband; y++) {
+                t += m[0];
+                if (hsub)
+                    t += m[1];
+                m += mask_linesize;
+            }
+            cov[x] = t >> (hsub + vsub);
+        }
+        draw->blend_row(dst + x0, cov, src, alpha, n);
+    }
+}
+
+static void blend_line_hv(FFDrawContext *draw, uint8_t *dst, int dst_delta,
                           unsigned src, unsigned alpha,
                           uint8_t *mask, int mask_linesize, int l2depth, int w,
                           unsigned hsub, unsigned vsub,
@@ -432,11 +481,18 @@ static void blend_line_hv(uint8_t *dst, int dst_delta,
         dst += dst_delta;
         xm += left;
     }
-    for (x = 0; x < w; x++) {
-        blend_pixel(dst, src, alpha, mask, mask_linesize, l2depth,
-                    1 << hsub, hband, hsub + vsub, xm);
-        dst += dst_delta;
-        xm += 1 << hsub;
+    if (l2depth == 3 && dst_delta == 1 && hsub <= 1) {
+        blend_line_8(draw, dst, src, alpha, mask + xm, mask_linesize, w,
+                     hsub, vsub, hband);
+        dst += w;
+        xm  += w << hsub;
+    } else {
+        for (x = 0; x < w; x++) {
+            blend_pixel(dst, src, alpha, mask, mask_linesize, l2depth,
+                        1 << hsub, hband, hsub + vsub, xm);
+            dst += dst_delta;
+            xm += 1 << hsub;
+        }
     }
     if (right)
         blend_pixel(dst, src, alpha, mask, mask_linesize, l2depth,
@@ -476,7 +532,7 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
             p = p0 + comp;
             m = mask;
             if (top) {
-                blend_line_hv(p, draw->pixelstep[plane],
+                blend_line_hv(draw, p, draw->pixelstep[plane],
                               color->comp[plane].u8[comp], alpha,
                               m, mask_linesize, l2depth, w_sub,
                               draw->hsub[plane], draw->vsub[plane],
@@ -485,7 +541,7 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                 m += top * mask_linesize;
             }
             for (y = 0; y < h_sub; y++) {
-                blend_line_hv(p, draw->pixelstep[plane],
+                blend_line_hv(draw, p, draw->pixelstep[plane],
                               color->comp[plane].u8[comp], alpha,
                               m, mask_linesize, l2depth, w_sub,
                               draw->hsub[plane], draw->vsub[plane],
@@ -494,7 +550,7 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                 m += mask_linesize << draw->vsub[plane];
             }
             if (bottom)
-                blend_line_hv(p, draw->pixelstep[plane],
+                blend_line_hv(draw, p, draw->pixelstep[plane],
                               color->comp[plane].u8[comp], alpha,
                               m, mask_linesize, l2depth, w_sub,
                               draw->hsub[plane], draw->vsub[plane],
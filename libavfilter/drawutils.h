@@ -55,6 +55,14 @@ typedef struct FFDrawContext {
     uint8_t vsub[MAX_PLANES];  /*< vertical subsampling */
     uint8_t hsub_max;
     uint8_t vsub_max;
+
+    /**
+     * Blend a line of an 8-bit coverage mask with a uniform value:
+     * a = mask[x] * alpha, dst[x] = ((0x1010101 - a) * dst[x] + a * src) >> 24
+     * alpha is in the [ 0 ; 0x10203 ] range.
+     */
+    void (*blend_row)(uint8_t *dst, const uint8_t *mask,
+                      unsigned src, unsigned alpha, int w);
 } FFDrawContext;
 
 typedef struct FFDrawColor {
@@ -76,6 +84,10 @@ typedef struct FFDrawColor {
  */
 int ff_draw_init(FFDrawContext *draw, enum AVPixelFormat format, unsigned flags);
 
+void ff_draw_init_x86(FFDrawContext *draw);
+void ff_draw_blend_row_c(uint8_t *dst, const uint8_t *mask,
+                         unsigned src, unsigned alpha, int w);
+
 /**
  * Prepare a color.
  */
@@ -39,6 +39,7 @@
 #include "libavutil/timestamp.h"
 #include "audio.h"
 #include "avfilter.h"
+#include "f_ebur128.h"
 #include "formats.h"
 #include "internal.h"
 
@@ -77,10 +78,6 @@ struct hist_entry {
 };
 
 struct integrator {
-    double *cache[MAX_CHANNELS];    ///< window of filtered samples (N ms)
-    int cache_pos;                  ///< focus on the last added bin in the cache array
-    double sum[MAX_CHANNELS];       ///< sum of the last N ms filtered samples (cache content)
-    int filled;                     ///< 1 if the cache is completely filled, 0 otherwise
     double rel_threshold;           ///< relative threshold
     double sum_kept_powers;         ///< sum of the powers (weighted sums) above absolute threshold
     int nb_kept_powers;             ///< number of sum above absolute threshold
@@ -109,14 +106,26 @@ typedef struct {
     double *ch_weighting;           ///< channel weighting mapping
     int sample_count;               ///< sample count used for refresh frequency, reset at refresh
 
-    /* Filter caches.
-     * The mult by 3 in the following is for X[i], X[i-1] and X[i-2] */
-    double x[MAX_CHANNELS * 3];     ///< 3 input samples cache for each channel
-    double y[MAX_CHANNELS * 3];     ///< 3 pre-filter samples cache for each channel
-    double z[MAX_CHANNELS * 3];     ///< 3 RLB-filter samples cache for each channel
-
+    /* Filter caches: X[i-1], X[i-2], Y[i-1], Y[i-2], Z[i-1] and Z[i-2] for
+     * each channel, see EBUR128_STATE_STRIDE */
+    double state[6 * EBUR128_STATE_STRIDE];
+    EBUR128DSPContext dsp;
+    int nb_threads;
+
+    /* The loudness is only computed at the end of each 100ms block, so the
+     * integration windows are sums of whole blocks: the energy of each
+     * channel is accumulated over the current block, then the weighted sum
+     * of the channels is kept in a ring of the last 3s of blocks. */
+#define BLOCK_SAMPLES 4800
 #define I400_BINS  (48000 * 4 / 10)
 #define I3000_BINS (48000 * 3)
+#define I400_BLOCKS  (I400_BINS  / BLOCK_SAMPLES)
+#define I3000_BLOCKS (I3000_BINS / BLOCK_SAMPLES)
+    double block_energy[MAX_CHANNELS]; ///< energy of the current block for each channel
+    double block_power[I3000_BLOCKS];   ///< weighted energies of the last blocks
+    int block_pos;                  ///< position of the next block in block_power
+    int nb_blocks;                  ///< number of completed blocks, up to I3000_BLOCKS
+
     struct integrator i400;         ///< 400ms integrator, used for Momentary loudness  (M), and Integrated loudness (I)
     struct integrator i3000;        ///<    3s integrator, used for Short term loudness (S), and Loudness Range      (LRA)
 
@@ -128,6 +137,7 @@ typedef struct {
     /* misc */
     int loglevel;                   ///< log level for frame logging
     int metadata;                   ///< whether or not to inject loudness results in frames
+    int analysis;                   ///< only compute the final summary
 } EBUR128Context;
 
 #define OFFSET(x) offsetof(EBUR128Context, x)
@@ -142,6 +152,7 @@ static const AVOption ebur128_options[] = {
         { "info",    "information logging level", 0, AV_OPT_TYPE_CONST, {.i64 = AV_LOG_INFO},    INT_MIN, INT_MAX, A|V|F, "level" },
         { "verbose", "verbose logging level",     0, AV_OPT_TYPE_CONST, {.i64 = AV_LOG_VERBOSE}, INT_MIN, INT_MAX, A|V|F, "level" },
     { "metadata", "inject metadata in the filtergraph", OFFSET(metadata), AV_OPT_TYPE_INT, {.i64 = 0}, 0, 1, A|V|F },
+    { "analysis", "only compute the summary, without per-block output", OFFSET(analysis), AV_OPT_TYPE_INT, {.i64 = 0}, 0, 1, A|F },
     { NULL }
 };
 
@@ -370,17 +381,10 @@ static int config_audio_output(AVFilterLink *outlink)
         }
 
         idx_bitposn++;
-
-        if (!ebur128->ch_weighting[i])
-            continue;
-
-        /* bins buffer for the two integration window (400ms and 3s) */
-        ebur128->i400.cache[i]  = av_calloc(I400_BINS,  sizeof(*ebur128->i400.cache[0]));
-        ebur128->i3000.cache[i] = av_calloc(I3000_BINS, sizeof(*ebur128->i3000.cache[0]));
-        if (!ebur128->i400.cache[i] || !ebur128->i3000.cache[i])
-            return AVERROR(ENOMEM);
     }
 
+    ebur128->nb_threads = ctx->graph->nb_threads;
+
     outlink->flags |= FF_LINK_FLAG_REQUEST_LOOP;
 
     return 0;
@@ -403,6 +407,39 @@ static struct hist_entry *get_histogram(void)
     return h;
 }
 
+static void filter_channels_c(double *energy, double *state, const double *samples,
+                              int stride, int nb_channels, int nb_samples)
+{
+    double *x1 = state,    *x2 = x1 + EBUR128_STATE_STRIDE;
+    double *y1 = x2 + EBUR128_STATE_STRIDE, *y2 = y1 + EBUR128_STATE_STRIDE;
+    double *z1 = y2 + EBUR128_STATE_STRIDE, *z2 = z1 + EBUR128_STATE_STRIDE;
+    int i, ch;
+
+    for (i = 0; i < nb_samples; i++) {
+        for (ch = 0; ch < nb_channels; ch++) {
+            /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
+            const double x = samples[ch];
+            const double y = x     * PRE_B0 + x1[ch] * PRE_B1 + x2[ch] * PRE_B2
+                                            - y1[ch] * PRE_A1 - y2[ch] * PRE_A2;
+            const double z = y     * RLB_B0 + y1[ch] * RLB_B1 + y2[ch] * RLB_B2
+                                            - z1[ch] * RLB_A1 - z2[ch] * RLB_A2;
+
+            x2[ch] = x1[ch]; x1[ch] = x;
+            y2[ch] = y1[ch]; y1[ch] = y;
+            z2[ch] = z1[ch]; z1[ch] = z;
+            energy[ch] += z * z;
+        }
+        samples += stride;
+    }
+}
+
+av_cold void ff_ebur128_dsp_init(EBUR128DSPContext *dsp)
+{
+    dsp->filter_channels = filter_channels_c;
+    if (ARCH_X86)
+        ff_ebur128_dsp_init_x86(dsp);
+}
+
 static av_cold int init(AVFilterContext *ctx)
 {
     EBUR128Context *ebur128 = ctx->priv;
@@ -428,6 +465,14 @@ static av_cold int init(AVFilterContext *ctx)
     ebur128->integrated_loudness = ABS_THRES;
     ebur128->loudness_range = 0;
 
+    if (ebur128->analysis && (ebur128->do_video || ebur128->metadata)) {
+        av_log(ctx, AV_LOG_ERROR,
+               "The analysis mode cannot be used with video or metadata output\n");
+        return AVERROR(EINVAL);
+    }
+
+    ff_ebur128_dsp_init(&ebur128->dsp);
+
     /* insert output pads */
     if (ebur128->do_video) {
         pad = (AVFilterPad){
@@ -458,12 +503,11 @@ static av_cold int init(AVFilterContext *ctx)
 
 /* loudness and power should be set such as loudness = -0.691 +
  * 10*log10(power), we just avoid doing that calculus two times */
-static int gate_update(struct integrator *integ, double power,
-                       double loudness, int gate_thres)
+static void gate_update(struct integrator *integ, double power,
+                        double loudness, int gate_thres)
 {
     int ipower;
     double relative_threshold;
-    int gate_hist_pos;
 
     /* update powers histograms by incrementing current power count */
     ipower = av_clip(HIST_POS(loudness), 0, HIST_SIZE - 1);
@@ -476,14 +520,88 @@ static int gate_update(struct integrator *integ, double power,
     if (!relative_threshold)
         relative_threshold = 1e-12;
     integ->rel_threshold = LOUDNESS(relative_threshold) + gate_thres;
-    gate_hist_pos = av_clip(HIST_POS(integ->rel_threshold), 0, HIST_SIZE - 1);
+}
 
-    return gate_hist_pos;
+/* compute integrated loudness by summing the histogram values above the
+ * relative threshold */
+static void compute_integrated_loudness(EBUR128Context *ebur128)
+{
+    const int gate_hist_pos = av_clip(HIST_POS(ebur128->i400.rel_threshold), 0, HIST_SIZE - 1);
+    double integrated_sum = 0;
+    int i, nb_integrated = 0;
+
+    for (i = gate_hist_pos; i < HIST_SIZE; i++) {
+        const int nb_v = ebur128->i400.histogram[i].count;
+        nb_integrated  += nb_v;
+        integrated_sum += nb_v * ebur128->i400.histogram[i].energy;
+    }
+    if (nb_integrated)
+        ebur128->integrated_loudness = LOUDNESS(integrated_sum / nb_integrated);
+}
+
+#define LRA_LOWER_PRC   10
+#define LRA_HIGHER_PRC  95
+
+static void compute_loudness_range(EBUR128Context *ebur128)
+{
+    const int gate_hist_pos = av_clip(HIST_POS(ebur128->i3000.rel_threshold), 0, HIST_SIZE - 1);
+    int i, nb_powers = 0;
+
+    for (i = gate_hist_pos; i < HIST_SIZE; i++)
+        nb_powers += ebur128->i3000.histogram[i].count;
+    if (nb_powers) {
+        int n, nb_pow;
+
+        /* get lower loudness to consider */
+        n = 0;
+        nb_pow = LRA_LOWER_PRC  * nb_powers / 100. + 0.5;
+        for (i = gate_hist_pos; i < HIST_SIZE; i++) {
+            n += ebur128->i3000.histogram[i].count;
+            if (n >= nb_pow) {
+                ebur128->lra_low = ebur128->i3000.histogram[i].loudness;
+                break;
+            }
+        }
+
+        /* get higher loudness to consider */
+        n = nb_powers;
+        nb_pow = LRA_HIGHER_PRC * nb_powers / 100. + 0.5;
+        for (i = HIST_SIZE - 1; i >= 0; i--) {
+            n -= ebur128->i3000.histogram[i].count;
+            if (n < nb_pow) {
+                ebur128->lra_high = ebur128->i3000.histogram[i].loudness;
+                break;
+            }
+        }
+
+        // XXX: show low & high on the graph?
+        ebur128->loudness_range = ebur128->lra_high - ebur128->lra_low;
+    }
+}
+
+typedef struct ThreadData {
+    const double *samples;
+    int nb_samples;
+} ThreadData;
+
+static int filter_channels(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    EBUR128Context *ebur128 = ctx->priv;
+    ThreadData *td = arg;
+    /* keep the channel ranges even, so that they can be processed by pairs */
+    const int nb_pairs = (ebur128->nb_channels + 1) >> 1;
+    const int start    =  (nb_pairs *  jobnr   ) / nb_jobs * 2;
+    const int end      = FFMIN((nb_pairs * (jobnr+1)) / nb_jobs * 2, ebur128->nb_channels);
+
+    ebur128->dsp.filter_channels(ebur128->block_energy + start,
+                                 ebur128->state + start, td->samples + start,
+                                 ebur128->nb_channels, end - start, td->nb_samples);
+    return 0;
 }
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
 {
-    int i, ch, idx_insample;
+    int ch, idx_insample = 0;
     AVFilterContext *ctx = inlink->dst;
     EBUR128Context *ebur128 = ctx->priv;
     const int nb_channels = ebur128->nb_channels;
@@ -491,75 +609,48 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
     const double *samples = (double *)insamples->data[0];
     AVFrame *pic = ebur128->outpicref;
 
-    for (idx_insample = 0; idx_insample < nb_samples; idx_insample++) {
-        const int bin_id_400  = ebur128->i400.cache_pos;
-        const int bin_id_3000 = ebur128->i3000.cache_pos;
-
-#define MOVE_TO_NEXT_CACHED_ENTRY(time) do {                \
-    ebur128->i##time.cache_pos++;                           \
-    if (ebur128->i##time.cache_pos == I##time##_BINS) {     \
-        ebur128->i##time.filled    = 1;                     \
-        ebur128->i##time.cache_pos = 0;                     \
-    }                                                       \
-} while (0)
-
-        MOVE_TO_NEXT_CACHED_ENTRY(400);
-        MOVE_TO_NEXT_CACHED_ENTRY(3000);
-
-        for (ch = 0; ch < nb_channels; ch++) {
-            double bin;
-
-            ebur128->x[ch * 3] = *samples++; // set X[i]
-
-            if (!ebur128->ch_weighting[ch])
-                continue;
-
-            /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
-#define FILTER(Y, X, name) do {                                                 \
-            double *dst = ebur128->Y + ch*3;                                    \
-            double *src = ebur128->X + ch*3;                                    \
-            dst[2] = dst[1];                                                    \
-            dst[1] = dst[0];                                                    \
-            dst[0] = src[0]*name##_B0 + src[1]*name##_B1 + src[2]*name##_B2     \
-                                      - dst[1]*name##_A1 - dst[2]*name##_A2;    \
-} while (0)
-
-            // TODO: merge both filters in one?
-            FILTER(y, x, PRE);  // apply pre-filter
-            ebur128->x[ch * 3 + 2] = ebur128->x[ch * 3 + 1];
-            ebur128->x[ch * 3 + 1] = ebur128->x[ch * 3    ];
-            FILTER(z, y, RLB);  // apply RLB-filter
+    while (idx_insample < nb_samples) {
+        ThreadData td;
 
-            bin = ebur128->z[ch * 3] * ebur128->z[ch * 3];
-
-            /* add the new value, and limit the sum to the cache size (400ms or 3s)
-             * by removing the oldest one */
-            ebur128->i400.sum [ch] = ebur128->i400.sum [ch] + bin - ebur128->i400.cache [ch][bin_id_400];
-            ebur128->i3000.sum[ch] = ebur128->i3000.sum[ch] + bin - ebur128->i3000.cache[ch][bin_id_3000];
-
-            /* override old cache entry with the new value */
-            ebur128->i400.cache [ch][bin_id_400 ] = bin;
-            ebur128->i3000.cache[ch][bin_id_3000] = bin;
-        }
+        /* filter up to the end of the current 100ms block */
+        td.samples    = samples + idx_insample * nb_channels;
+        td.nb_samples = FFMIN(nb_samples - idx_insample,
+                              BLOCK_SAMPLES - ebur128->sample_count);
+        ctx->internal->execute(ctx, filter_channels, &td, NULL,
+                               FFMIN((nb_channels + 1) >> 1, ebur128->nb_threads));
+        idx_insample          += td.nb_samples;
+        ebur128->sample_count += td.nb_samples;
 
         /* For integrated loudness, gating blocks are 400ms long with 75%
          * overlap (see BS.1770-2 p5), so a re-computation is needed each 100ms
          * (4800 samples at 48kHz). */
-        if (++ebur128->sample_count == 4800) {
+        if (ebur128->sample_count == BLOCK_SAMPLES) {
             double loudness_400, loudness_3000;
-            double power_400 = 1e-12, power_3000 = 1e-12;
+            double power_400 = 1e-12, power_3000 = 1e-12, block_power = 0;
             AVFilterLink *outlink = ctx->outputs[0];
             const int64_t pts = insamples->pts +
-                av_rescale_q(idx_insample, (AVRational){ 1, inlink->sample_rate },
+                av_rescale_q(idx_insample - 1, (AVRational){ 1, inlink->sample_rate },
                              outlink->time_base);
 
             ebur128->sample_count = 0;
 
+            /* weighting sum of the channels over the block */
+            for (ch = 0; ch < nb_channels; ch++) {
+                if (ebur128->ch_weighting[ch])
+                    block_power += ebur128->ch_weighting[ch] * ebur128->block_energy[ch];
+                ebur128->block_energy[ch] = 0;
+            }
+            ebur128->block_power[ebur128->block_pos] = block_power;
+            ebur128->block_pos = (ebur128->block_pos + 1) % I3000_BLOCKS;
+            ebur128->nb_blocks = FFMIN(ebur128->nb_blocks + 1, I3000_BLOCKS);
+
 #define COMPUTE_LOUDNESS(m, time) do {                                              \
-    if (ebur128->i##time.filled) {                                                  \
-        /* weighting sum of the last <time> ms */                                   \
-        for (ch = 0; ch < nb_channels; ch++)                                        \
-            power_##time += ebur128->ch_weighting[ch] * ebur128->i##time.sum[ch];   \
+    if (ebur128->nb_blocks >= I##time##_BLOCKS) {                                   \
+        int i;                                                                      \
+        /* sum of the last <time> ms */                                             \
+        for (i = 1; i <= I##time##_BLOCKS; i++)                                     \
+            power_##time += ebur128->block_power[(ebur128->block_pos - i +          \
+                                                  I3000_BLOCKS) % I3000_BLOCKS];    \
         power_##time /= I##time##_BINS;                                             \
     }                                                                               \
     loudness_##time = LOUDNESS(power_##time);                                       \
@@ -572,66 +663,26 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
 #define I_GATE_THRES -10  // initially defined to -8 LU in the first EBU standard
 
             if (loudness_400 >= ABS_THRES) {
-                double integrated_sum = 0;
-                int nb_integrated = 0;
-                int gate_hist_pos = gate_update(&ebur128->i400, power_400,
-                                                loudness_400, I_GATE_THRES);
-
-                /* compute integrated loudness by summing the histogram values
-                 * above the relative threshold */
-                for (i = gate_hist_pos; i < HIST_SIZE; i++) {
-                    const int nb_v = ebur128->i400.histogram[i].count;
-                    nb_integrated  += nb_v;
-                    integrated_sum += nb_v * ebur128->i400.histogram[i].energy;
-                }
-                if (nb_integrated)
-                    ebur128->integrated_loudness = LOUDNESS(integrated_sum / nb_integrated);
+                gate_update(&ebur128->i400, power_400, loudness_400, I_GATE_THRES);
+                /* in analysis mode, only the final value is computed */
+                if (!ebur128->analysis)
+                    compute_integrated_loudness(ebur128);
             }
 
             /* LRA */
 #define LRA_GATE_THRES -20
-#define LRA_LOWER_PRC   10
-#define LRA_HIGHER_PRC  95
 
             /* XXX: example code in EBU 3342 is ">=" but formula in BS.1770
              * specs is ">" */
             if (loudness_3000 >= ABS_THRES) {
-                int nb_powers = 0;
-                int gate_hist_pos = gate_update(&ebur128->i3000, power_3000,
-                                                loudness_3000, LRA_GATE_THRES);
-
-                for (i = gate_hist_pos; i < HIST_SIZE; i++)
-                    nb_powers += ebur128->i3000.histogram[i].count;
-                if (nb_powers) {
-                    int n, nb_pow;
-
-                    /* get lower loudness to consider */
-                    n = 0;
-                    nb_pow = LRA_LOWER_PRC  * nb_powers / 100. + 0.5;
-                    for (i = gate_hist_pos; i < HIST_SIZE; i++) {
-                        n += ebur128->i3000.histogram[i].count;
-                        if (n >= nb_pow) {
-                            ebur128->lra_low = ebur128->i3000.histogram[i].loudness;
-                            break;
-                        }
-                    }
-
-                    /* get higher loudness to consider */
-                    n = nb_powers;
-                    nb_pow = LRA_HIGHER_PRC * nb_powers / 100. + 0.5;
-                    for (i = HIST_SIZE - 1; i >= 0; i--) {
-                        n -= ebur128->i3000.histogram[i].count;
-                        if (n < nb_pow) {
-                            ebur128->lra_high = ebur128->i3000.histogram[i].loudness;
-                            break;
-                        }
-                    }
-
-                    // XXX: show low & high on the graph?
-                    ebur128->loudness_range = ebur128->lra_high - ebur128->lra_low;
-                }
+                gate_update(&ebur128->i3000, power_3000, loudness_3000, LRA_GATE_THRES);
+                if (!ebur128->analysis)
+                    compute_loudness_range(ebur128);
             }
 
+            if (ebur128->analysis)
+                continue;
+
 #define LOG_FMT "M:%6.1f S:%6.1f     I:%6.1f LUFS     LRA:%6.1f LU"
 
             /* push one video frame */
@@ -749,6 +800,13 @@ static av_cold void uninit(AVFilterContext *ctx)
     int i;
     EBUR128Context *ebur128 = ctx->priv;
 
+    if (ebur128->analysis) {
+        if (ebur128->i400.nb_kept_powers)
+            compute_integrated_loudness(ebur128);
+        if (ebur128->i3000.nb_kept_powers)
+            compute_loudness_range(ebur128);
+    }
+
     av_log(ctx, AV_LOG_INFO, "Summary:\n\n"
            "  Integrated loudness:\n"
            "    I:         %5.1f LUFS\n"
@@ -766,10 +824,6 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&ebur128->ch_weighting);
     av_freep(&ebur128->i400.histogram);
     av_freep(&ebur128->i3000.histogram);
-    for (i = 0; i < ebur128->nb_channels; i++) {
-        av_freep(&ebur128->i400.cache[i]);
-        av_freep(&ebur128->i3000.cache[i]);
-    }
     for (i = 0; i < ctx->nb_outputs; i++)
         av_freep(&ctx->output_pads[i].name);
     av_frame_free(&ebur128->outpicref);
@@ -795,5 +849,5 @@ AVFilter ff_af_ebur128 = {
     .inputs        = ebur128_inputs,
     .outputs       = NULL,
     .priv_class    = &ebur128_class,
-    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS,
+    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -0,0 +1,44 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef AVFILTER_F_EBUR128_H
+#define AVFILTER_F_EBUR128_H
+
+/**
+ * Distance in elements between the filter state arrays: the state holds
+ * X[i-1], X[i-2], Y[i-1], Y[i-2], Z[i-1] and Z[i-2] in that order, each of
+ * them as an array indexed by channel.
+ */
+#define EBUR128_STATE_STRIDE 64
+
+typedef struct EBUR128DSPContext {
+    /**
+     * Apply the K-weighting (pre-filter then RLB-filter) to nb_samples
+     * interleaved samples of nb_channels channels and add the energy of the
+     * filtered signal of each channel to energy[ch].
+     *
+     * @param stride distance in elements between two samples of a channel
+     */
+    void (*filter_channels)(double *energy, double *state, const double *samples,
+                            int stride, int nb_channels, int nb_samples);
+} EBUR128DSPContext;
+
+void ff_ebur128_dsp_init(EBUR128DSPContext *dsp);
+void ff_ebur128_dsp_init_x86(EBUR128DSPContext *dsp);
+
+#endif /* AVFILTER_F_EBUR128_H */
@@ -0,0 +1,48 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "mixdsp.h"
+
+void ff_mix_s16_c(int32_t *acc, const int16_t *src, int gain, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++)
+        acc[i] += src[i] * gain;
+}
+
+void ff_mix_pack_s16_c(int16_t *dst, const int32_t *acc, int shift, int len)
+{
+    const int round = (1 << shift) >> 1;
+    int i;
+
+    for (i = 0; i < len; i++)
+        dst[i] = av_clip_int16((acc[i] + round) >> shift);
+}
+
+av_cold void ff_mixdsp_init(MixDSPContext *dsp)
+{
+    dsp->mix_s16  = ff_mix_s16_c;
+    dsp->pack_s16 = ff_mix_pack_s16_c;
+
+    if (ARCH_X86)
+        ff_mixdsp_init_x86(dsp);
+}
@@ -0,0 +1,50 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * fixed point audio mixing DSP shared by the pan and amix filters
+ */
+
+#ifndef AVFILTER_MIXDSP_H
+#define AVFILTER_MIXDSP_H
+
+#include <stdint.h>
+
+typedef struct MixDSPContext {
+    /**
+     * Accumulate one input channel: acc[i] += src[i] * gain.
+     * gain is a fixed point coefficient with 15 fractional bits,
+     * -65535 < gain < 65535.
+     */
+    void (*mix_s16)(int32_t *acc, const int16_t *src, int gain, int len);
+
+    /**
+     * Round and saturate the accumulated samples:
+     * dst[i] = av_clip_int16((acc[i] + ((1 << shift) >> 1)) >> shift).
+     */
+    void (*pack_s16)(int16_t *dst, const int32_t *acc, int shift, int len);
+} MixDSPContext;
+
+void ff_mixdsp_init(MixDSPContext *dsp);
+void ff_mixdsp_init_x86(MixDSPContext *dsp);
+
+void ff_mix_s16_c(int32_t *acc, const int16_t *src, int gain, int len);
+void ff_mix_pack_s16_c(int16_t *dst, const int32_t *acc, int shift, int len);
+
+#endif /* AVFILTER_MIXDSP_H */
@@ -27,6 +27,7 @@
 #include "libavutil/common.h"
 #include "libavutil/cpu.h"
 #include "libavutil/mem.h"
+#include "libavutil/threadpool.h"
 
 #include "avfilter.h"
 #include "internal.h"
@@ -60,6 +61,8 @@ typedef struct ThreadContext {
     int current_job;
     unsigned int current_execute;
     int done;
+
+    AVThreadPool *pool;     ///< pool running the jobs instead of workers
 } ThreadContext;
 
 static void* attribute_align_arg worker(void *v)
@@ -153,6 +156,27 @@ static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
     return 0;
 }
 
+static int pool_job(void *ctx, void *arg, int jobnr, int threadnr)
+{
+    ThreadContext *c = arg;
+    return c->func(ctx, c->arg, jobnr, c->nb_jobs);
+}
+
+static int pool_execute(AVFilterContext *ctx, avfilter_action_func *func,
+                        void *arg, int *ret, int nb_jobs)
+{
+    ThreadContext *c = ctx->graph->internal->thread;
+
+    if (nb_jobs <= 0)
+        return 0;
+
+    c->func    = func;
+    c->arg     = arg;
+    c->nb_jobs = nb_jobs;
+    return av_thread_pool_execute(c->pool, pool_job, ctx, c, ret, nb_jobs,
+                                  c->nb_threads);
+}
+
 static int thread_init_internal(ThreadContext *c, int nb_threads)
 {
     int i, ret;
@@ -169,6 +193,11 @@ static int thread_init_internal(ThreadContext *c, int nb_threads)
     if (nb_threads <= 1)
         return 1;
 
+    if (c->pool) {
+        c->nb_threads = nb_threads;
+        return nb_threads;
+    }
+
     c->nb_threads = nb_threads;
     c->workers = av_mallocz(sizeof(*c->workers) * nb_threads);
     if (!c->workers)
@@ -200,6 +229,7 @@ static int thread_init_internal(ThreadContext *c, int nb_threads)
 
 int ff_graph_thread_init(AVFilterGraph *graph)
 {
+    ThreadContext *c;
     int ret;
 
 #if HAVE_W32THREADS
@@ -215,7 +245,12 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     if (!graph->internal->thread)
         return AVERROR(ENOMEM);
 
-    ret = thread_init_internal(graph->internal->thread, graph->nb_threads);
+    c = graph->internal->thread;
+    c->pool = graph->thread_pool;
+    if (!c->pool && graph->shared_threads)
+        c->pool = av_thread_pool_get_default();
+
+    ret = thread_init_internal(c, graph->nb_threads);
     if (ret <= 1) {
         av_freep(&graph->internal->thread);
         graph->thread_type = 0;
@@ -224,14 +259,16 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     }
     graph->nb_threads = ret;
 
-    graph->internal->thread_execute = thread_execute;
+    graph->internal->thread_execute = c->pool ? pool_execute : thread_execute;
 
     return 0;
 }
 
 void ff_graph_thread_free(AVFilterGraph *graph)
 {
-    if (graph->internal->thread)
-        slice_thread_uninit(graph->internal->thread);
+    ThreadContext *c = graph->internal->thread;
+
+    if (c && !c->pool)
+        slice_thread_uninit(c);
     av_freep(&graph->internal->thread);
 }
@@ -24,6 +24,7 @@
 
 #include "config.h"
 #include "avfilter.h"
+#include "blurdsp.h"
 #if CONFIG_OPENCL
 #include "libavutil/opencl.h"
 #endif
@@ -61,7 +62,8 @@ typedef struct UnsharpFilterParam {
     int steps_y;                             ///< vertical step count
     int scalebits;                           ///< bits to shift pixel
     int32_t halfscale;                       ///< amount to add to pixel
-    uint32_t *sc[MAX_MATRIX_SIZE - 1];       ///< finite state machine storage
+    int stride;                              ///< length of a line of storage
+    uint32_t **buf;                          ///< per-thread finite state machine storage
 } UnsharpFilterParam;
 
 typedef struct {
@@ -71,6 +73,8 @@ typedef struct {
     UnsharpFilterParam luma;   ///< luma parameters (width, height, amount)
     UnsharpFilterParam chroma; ///< chroma parameters (width, height, amount)
     int hsub, vsub;
+    int nb_threads;
+    BlurDSPContext dsp;
     int opencl;
 #if CONFIG_OPENCL
     UnsharpOpenclContext opencl_ctx;
@@ -28,9 +28,11 @@
 #include "libavutil/avstring.h"
 #include "libavutil/common.h"
 #include "libavutil/eval.h"
+#include "libavutil/imgutils.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "avfilter.h"
+#include "blurdsp.h"
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
@@ -70,9 +72,26 @@ typedef struct {
     int hsub, vsub;
     int radius[4];
     int power[4];
-    uint8_t *temp[2]; ///< temporary buffer used in blur_power()
+    int nb_threads;
+    uint8_t **temp;     ///< per-thread temporary buffers used in blur_power()
+    uint16_t **sum;     ///< per-thread running column sums used in vblur_lines()
+    uint8_t *plane[2];  ///< temporary planes used by the vertical passes
+    int plane_linesize;
+    BlurDSPContext dsp;
 } BoxBlurContext;
 
+typedef struct ThreadData {
+    uint8_t *dst;
+    int dst_linesize;
+    const uint8_t *src;
+    int src_linesize;
+    int w, h;
+    int radius, power;
+} ThreadData;
+
+/* the column sums of vblur_lines() must fit in 16 bits */
+#define MAX_LINE_RADIUS 127
+
 #define Y 0
 #define U 1
 #define V 2
@@ -107,12 +126,27 @@ static av_cold int init(AVFilterContext *ctx)
     return 0;
 }
 
+static void free_buffers(BoxBlurContext *s)
+{
+    int i;
+
+    for (i = 0; i < s->nb_threads; i++) {
+        if (s->temp)
+            av_freep(&s->temp[i]);
+        if (s->sum)
+            av_freep(&s->sum[i]);
+    }
+    av_freep(&s->temp);
+    av_freep(&s->sum);
+    av_freep(&s->plane[0]);
+    av_freep(&s->plane[1]);
+}
+
 static av_cold void uninit(AVFilterContext *ctx)
 {
     BoxBlurContext *s = ctx->priv;
 
-    av_freep(&s->temp[0]);
-    av_freep(&s->temp[1]);
+    free_buffers(s);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -139,11 +173,22 @@ static int config_input(AVFilterLink *inlink)
     int cw, ch;
     double var_values[VARS_NB], res;
     char *expr;
-    int ret;
-
-    if (!(s->temp[0] = av_malloc(FFMAX(w, h))) ||
-        !(s->temp[1] = av_malloc(FFMAX(w, h))))
+    int i, ret;
+
+    free_buffers(s);
+    s->nb_threads = ctx->graph->nb_threads;
+    s->plane_linesize = FFALIGN(w, 32);
+    if (!(s->temp = av_mallocz_array(s->nb_threads, sizeof(*s->temp))) ||
+        !(s->sum  = av_mallocz_array(s->nb_threads, sizeof(*s->sum)))  ||
+        !(s->plane[0] = av_malloc_array(h, s->plane_linesize)) ||
+        !(s->plane[1] = av_malloc_array(h, s->plane_linesize)))
         return AVERROR(ENOMEM);
+    for (i = 0; i < s->nb_threads; i++)
+        if (!(s->temp[i] = av_malloc_array(2, FFMAX(w, h))) ||
+            !(s->sum[i]  = av_malloc_array(w, sizeof(*s->sum[i]))))
+            return AVERROR(ENOMEM);
+
+    ff_blurdsp_init(&s->dsp);
 
     s->hsub = desc->log2_chroma_w;
     s->vsub = desc->log2_chroma_h;
@@ -202,6 +247,11 @@ static int config_input(AVFilterLink *inlink)
     return 0;
 }
 
+static inline int mirror(int y, int h)
+{
+    return y < 0 ? -y - 1 : y >= h ? 2*h - y - 1 : y;
+}
+
 static inline void blur(uint8_t *dst, int dst_step, const uint8_t *src, int src_step,
                         int len, int radius)
 {
@@ -228,7 +278,7 @@ static inline void blur(uint8_t *dst, int dst_step, const uint8_t *src, int src_
     sum += src[radius*src_step];
 
     for (x = 0; x <= radius; x++) {
-        sum += src[(radius+x)*src_step] - src[(radius-x)*src_step];
+        sum += src[mirror(radius+x, len)*src_step] - src[(radius-x)*src_step];
         dst[x*dst_step] = (sum*inv + (1<<15))>>16;
     }
 
@@ -238,15 +288,15 @@ static inline void blur(uint8_t *dst, int dst_step, const uint8_t *src, int src_
     }
 
     for (; x < len; x++) {
-        sum += src[(2*len-radius-x-1)*src_step] - src[(x-radius-1)*src_step];
+        sum += src[mirror(radius+x, len)*src_step] - src[(x-radius-1)*src_step];
         dst[x*dst_step] = (sum*inv + (1<<15))>>16;
     }
 }
 
 static inline void blur_power(uint8_t *dst, int dst_step, const uint8_t *src, int src_step,
-                              int len, int radius, int power, uint8_t *temp[2])
+                              int len, int radius, int power, uint8_t *temp)
 {
-    uint8_t *a = temp[0], *b = temp[1];
+    uint8_t *a = temp, *b = temp + len;
 
     if (radius && power) {
         blur(a, 1, src, src_step, len, radius);
@@ -269,30 +319,89 @@ static inline void blur_power(uint8_t *dst, int dst_step, const uint8_t *src, in
     }
 }
 
-static void hblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2])
+static int hblur(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
+    BoxBlurContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    const int slice_start = (td->h *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->h * (jobnr+1)) / nb_jobs;
     int y;
 
-    if (radius == 0 && dst == src)
-        return;
+    if (td->radius == 0 && td->dst == td->src)
+        return 0;
+
+    for (y = slice_start; y < slice_end; y++)
+        blur_power(td->dst + y*td->dst_linesize, 1, td->src + y*td->src_linesize, 1,
+                   td->w, td->radius, td->power, s->temp[jobnr]);
+    return 0;
+}
+
+/**
+ * Vertical counterpart of blur() which slides the window down a whole
+ * line of columns at once, keeping one running sum per column.
+ */
+static void vblur_lines(const BlurDSPContext *dsp, uint8_t *dst, int dst_linesize,
+                        const uint8_t *src, int src_linesize,
+                        int w, int h, int radius, uint16_t *sum)
+{
+    const int length = radius*2 + 1;
+    const int inv = ((1<<16) + length/2)/length;
+    int x, y;
 
-    for (y = 0; y < h; y++)
-        blur_power(dst + y*dst_linesize, 1, src + y*src_linesize, 1,
-                   w, radius, power, temp);
+    for (x = 0; x < w; x++)
+        sum[x] = src[radius*src_linesize + x];
+    for (y = 0; y < radius; y++)
+        for (x = 0; x < w; x++)
+            sum[x] += src[y*src_linesize + x] << 1;
+
+    for (y = 0; y < h; y++) {
+        dsp->box_slide(sum, src + mirror(y + radius,     h) * src_linesize,
+                            src + mirror(y - radius - 1, h) * src_linesize, w);
+        dsp->box_scale(dst + y*dst_linesize, sum, inv, w);
+    }
 }
 
-static void vblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2])
+static int vblur(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
+    BoxBlurContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    const int slice_start = (td->w *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->w * (jobnr+1)) / nb_jobs;
+    const int w = slice_end - slice_start;
     int x;
 
-    if (radius == 0 && dst == src)
-        return;
-
-    for (x = 0; x < w; x++)
-        blur_power(dst + x, dst_linesize, src + x, src_linesize,
-                   h, radius, power, temp);
+    if (td->radius == 0 && td->dst == td->src)
+        return 0;
+
+    if (td->radius && td->power && td->radius <= MAX_LINE_RADIUS) {
+        const uint8_t *src = td->src + slice_start;
+        int src_linesize   = td->src_linesize;
+        int power;
+
+        /* the window reads lines on both sides of the one being written, so
+         * only a pass reading from a temporary plane may write to dst */
+        for (power = 0; power < td->power; power++) {
+            uint8_t *dst     = s->plane[power & 1] + slice_start;
+            int dst_linesize = s->plane_linesize;
+
+            if (power && power == td->power - 1) {
+                dst          = td->dst + slice_start;
+                dst_linesize = td->dst_linesize;
+            }
+            vblur_lines(&s->dsp, dst, dst_linesize, src, src_linesize,
+                        w, td->h, td->radius, s->sum[jobnr]);
+            src          = dst;
+            src_linesize = dst_linesize;
+        }
+        if (td->power == 1)
+            av_image_copy_plane(td->dst + slice_start, td->dst_linesize,
+                                src, src_linesize, w, td->h);
+    } else {
+        for (x = slice_start; x < slice_end; x++)
+            blur_power(td->dst + x, td->dst_linesize, td->src + x, td->src_linesize,
+                       td->h, td->radius, td->power, s->temp[jobnr]);
+    }
+    return 0;
 }
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
@@ -313,17 +422,20 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     }
     av_frame_copy_props(out, in);
 
-    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++)
-        hblur(out->data[plane], out->linesize[plane],
-              in ->data[plane], in ->linesize[plane],
-              w[plane], h[plane], s->radius[plane], s->power[plane],
-              s->temp);
+    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++) {
+        ThreadData td = {
+            .dst = out->data[plane], .dst_linesize = out->linesize[plane],
+            .src = in ->data[plane], .src_linesize = in ->linesize[plane],
+            .w = w[plane], .h = h[plane],
+            .radius = s->radius[plane], .power = s->power[plane],
+        };
 
-    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++)
-        vblur(out->data[plane], out->linesize[plane],
-              out->data[plane], out->linesize[plane],
-              w[plane], h[plane], s->radius[plane], s->power[plane],
-              s->temp);
+        ctx->internal->execute(ctx, hblur, &td, NULL, FFMIN(td.h, s->nb_threads));
+
+        td.src          = td.dst;
+        td.src_linesize = td.dst_linesize;
+        ctx->internal->execute(ctx, vblur, &td, NULL, FFMIN(td.w, s->nb_threads));
+    }
 
     av_frame_free(&in);
 
@@ -382,5 +494,5 @@ AVFilter ff_vf_boxblur = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_boxblur_inputs,
     .outputs       = avfilter_vf_boxblur_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -23,12 +23,30 @@
 
 #include "libavutil/imgutils.h"
 #include "libavutil/internal.h"
+#include "libavutil/opt.h"
 #include "avfilter.h"
 #include "internal.h"
 #include "video.h"
 
+typedef struct CopyContext {
+    const AVClass *class;
+    int flags;
+} CopyContext;
+
+#define OFFSET(x) offsetof(CopyContext, x)
+#define FLAGS AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM
+static const AVOption copy_options[] = {
+    { "flags", "set the copy flags", OFFSET(flags), AV_OPT_TYPE_FLAGS, { .i64 = 0 }, 0, INT_MAX, FLAGS, "flags" },
+        { "nt_store", "write the output with non-temporal stores", 0, AV_OPT_TYPE_CONST, { .i64 = AV_IMAGE_COPY_FLAG_NT_STORE }, 0, 0, FLAGS, "flags" },
+        { "uc_src",   "the input is in uncacheable memory",        0, AV_OPT_TYPE_CONST, { .i64 = AV_IMAGE_COPY_FLAG_UC_SRC },   0, 0, FLAGS, "flags" },
+    { NULL }
+};
+
+AVFILTER_DEFINE_CLASS(copy);
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
+    CopyContext *s = inlink->dst->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
     AVFrame *out = ff_get_video_buffer(outlink, in->width, in->height);
 
@@ -37,8 +55,8 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         return AVERROR(ENOMEM);
     }
     av_frame_copy_props(out, in);
-    av_image_copy(out->data, out->linesize, (const uint8_t**) in->data, in->linesize,
-                  in->format, in->width, in->height);
+    av_image_copy2(out->data, out->linesize, (const uint8_t**) in->data, in->linesize,
+                   in->format, in->width, in->height, s->flags);
 
     av_frame_free(&in);
     return ff_filter_frame(outlink, out);
@@ -64,6 +82,8 @@ static const AVFilterPad avfilter_vf_copy_outputs[] = {
 AVFilter ff_vf_copy = {
     .name        = "copy",
     .description = NULL_IF_CONFIG_SMALL("Copy the input video unchanged to the output."),
+    .priv_size   = sizeof(CopyContext),
+    .priv_class  = &copy_class,
     .inputs      = avfilter_vf_copy_inputs,
     .outputs     = avfilter_vf_copy_outputs,
 };
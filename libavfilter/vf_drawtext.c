@@ -128,6 +128,15 @@ typedef struct {
     int ft_load_flags;              ///< flags used for loading fonts, see FT_LOAD_*
     FT_Vector *positions;           ///< positions for each element in the text
     size_t nb_positions;            ///< number of elements of positions array
+    char *layout_text;              ///< expanded text the layout was computed for
+    unsigned int layout_text_size;  ///< allocated size of layout_text
+    uint8_t *text_mask;             ///< 8-bit coverage of all the glyphs of the text
+    unsigned int text_mask_size;    ///< allocated size of text_mask
+    int text_mask_x, text_mask_y;   ///< position of text_mask relative to the text origin
+    int text_mask_w, text_mask_h;   ///< dimensions of text_mask
+    int text_mask_overlap;          ///< glyph boxes touch, blend the glyphs one by one
+    int (*glyph_boxes)[4];          ///< bitmap boxes of the glyphs, as x0, y0, x1, y1
+    unsigned int glyph_boxes_size;  ///< allocated size of glyph_boxes
     char *textfile;                 ///< file with text to be drawn
     int x;                          ///< x position to start drawing text
     int y;                          ///< y position to start drawing text
@@ -533,6 +542,12 @@ static av_cold void uninit(AVFilterContext *ctx)
 #endif
     av_freep(&s->positions);
     s->nb_positions = 0;
+    av_freep(&s->layout_text);
+    s->layout_text_size = 0;
+    av_freep(&s->text_mask);
+    s->text_mask_size = 0;
+    av_freep(&s->glyph_boxes);
+    s->glyph_boxes_size = 0;
 
 
     av_tree_enumerate(s->glyphs, NULL, NULL, glyph_enu_free);
@@ -805,17 +820,66 @@ static int expand_text(AVFilterContext *ctx)
     return 0;
 }
 
-static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
-                       int width, int height, const uint8_t rgbcolor[4], FFDrawColor *color, int x, int y)
+static int glyph_box_cmp(const void *a, const void *b)
+{
+    int xa = ((const int *)a)[0], xb = ((const int *)b)[0];
+    return (xa > xb) - (xa < xb);
+}
+
+/**
+ * Check whether some glyph boxes overlap or share a chroma sample once
+ * widened by the subsampling of the output. Blending such glyphs through a
+ * combined mask would not give the same pixels as blending them one after
+ * the other.
+ * The boxes are sorted by their left edge, so that each one is only compared
+ * with the following ones that start before its right edge, in practice its
+ * neighbours on the same and the adjacent lines.
+ */
+static int glyph_boxes_touch(const FFDrawContext *dc, int (*boxes)[4], int nb_boxes)
+{
+    const int mx = (1 << dc->hsub_max) - 1;
+    const int my = (1 << dc->vsub_max) - 1;
+    int i, j;
+
+    qsort(boxes, nb_boxes, sizeof(*boxes), glyph_box_cmp);
+    for (i = 0; i < nb_boxes; i++) {
+        const int *a = boxes[i];
+        for (j = i + 1; j < nb_boxes && boxes[j][0] < a[2] + mx; j++) {
+            const int *b = boxes[j];
+            if (a[1] < b[3] + my && b[1] < a[3] + my)
+                return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Render the glyphs of the laid out text into a single 8-bit coverage mask,
+ * so that the text and its shadow are each blended with one call per frame.
+ * If some glyph boxes touch, text_mask_overlap is set and the glyphs are
+ * blended separately by draw_glyphs() instead.
+ */
+static int render_text_mask(DrawTextContext *s)
 {
     char *text = s->expanded_text.str;
     uint32_t code = 0;
-    int i, x1, y1;
+    int i, x, y, x0 = INT_MAX, y0 = INT_MAX, x1 = INT_MIN, y1 = INT_MIN;
+    int nb_boxes = 0;
     uint8_t *p;
     Glyph *glyph = NULL;
 
+    s->text_mask_w = s->text_mask_h = 0;
+    s->text_mask_overlap = 0;
+
+    av_fast_malloc(&s->glyph_boxes, &s->glyph_boxes_size,
+                   s->expanded_text.len * sizeof(*s->glyph_boxes));
+    if (!s->glyph_boxes)
+        return AVERROR(ENOMEM);
+
+    /* compute the bounding box of the bitmaps */
     for (i = 0, p = text; *p; i++) {
         Glyph dummy = { 0 };
+        int *box;
         GET_UTF8(code, *p++, continue;);
 
         /* skip new line chars, just go to new line */
@@ -828,32 +892,75 @@ static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
         if (glyph->bitmap.pixel_mode != FT_PIXEL_MODE_MONO &&
             glyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
             return AVERROR(EINVAL);
+        if (!glyph->bitmap.width || !glyph->bitmap.rows)
+            continue;
+
+        box = s->glyph_boxes[nb_boxes];
+        box[0] = s->positions[i].x;
+        box[1] = s->positions[i].y;
+        box[2] = s->positions[i].x + glyph->bitmap.width;
+        box[3] = s->positions[i].y + glyph->bitmap.rows;
+        nb_boxes++;
+
+        x0 = FFMIN(x0, box[0]);
+        y0 = FFMIN(y0, box[1]);
+        x1 = FFMAX(x1, box[2]);
+        y1 = FFMAX(y1, box[3]);
+    }
+    if (x0 >= x1 || y0 >= y1)
+        return 0;
+    if ((s->text_mask_overlap = glyph_boxes_touch(&s->dc, s->glyph_boxes, nb_boxes)))
+        return 0;
 
-        x1 = s->positions[i].x+s->x+x;
-        y1 = s->positions[i].y+s->y+y;
+    av_fast_malloc(&s->text_mask, &s->text_mask_size, (size_t)(x1 - x0) * (y1 - y0));
+    if (!s->text_mask)
+        return AVERROR(ENOMEM);
+    memset(s->text_mask, 0, (size_t)(x1 - x0) * (y1 - y0));
+    s->text_mask_x = x0;
+    s->text_mask_y = y0;
+    s->text_mask_w = x1 - x0;
+    s->text_mask_h = y1 - y0;
 
-        ff_blend_mask(&s->dc, color,
-                      frame->data, frame->linesize, width, height,
-                      glyph->bitmap.buffer, glyph->bitmap.pitch,
-                      glyph->bitmap.width, glyph->bitmap.rows,
-                      glyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO ? 0 : 3,
-                      0, x1, y1);
+    /* the glyph boxes are disjoint, so every mask pixel comes from one glyph */
+    for (i = 0, p = text; *p; i++) {
+        Glyph dummy = { 0 };
+        const uint8_t *src;
+        uint8_t *dst;
+        GET_UTF8(code, *p++, continue;);
+
+        if (code == '\n' || code == '\r' || code == '\t')
+            continue;
+
+        dummy.code = code;
+        glyph = av_tree_find(s->glyphs, &dummy, (void *)glyph_cmp, NULL);
+
+        src = glyph->bitmap.buffer;
+        dst = s->text_mask + (s->positions[i].y - y0) * s->text_mask_w +
+                             (s->positions[i].x - x0);
+        for (y = 0; y < glyph->bitmap.rows; y++) {
+            for (x = 0; x < glyph->bitmap.width; x++)
+                dst[x] = glyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO ?
+                         (src[x >> 3] >> (~x & 7) & 1) * 255 : src[x];
+            src += glyph->bitmap.pitch;
+            dst += s->text_mask_w;
+        }
     }
 
     return 0;
 }
 
-static int draw_text(AVFilterContext *ctx, AVFrame *frame,
-                     int width, int height)
+/**
+ * Load the glyphs of the expanded text, compute their positions and the
+ * text metrics, and render the text mask.
+ */
+static int layout_text(AVFilterContext *ctx)
 {
     DrawTextContext *s = ctx->priv;
-    AVFilterLink *inlink = ctx->inputs[0];
 
     uint32_t code = 0, prev_code = 0;
-    int x = 0, y = 0, i = 0, ret;
+    int x = 0, y = 0, i = 0;
     int max_text_line_w = 0, len;
-    int box_w, box_h;
-    char *text;
+    char *text = s->expanded_text.str;
     uint8_t *p;
     int y_min = 32000, y_max = -32000;
     int x_min = 32000, x_max = -32000;
@@ -861,39 +968,6 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
     Glyph *glyph = NULL, *prev_glyph = NULL;
     Glyph dummy = { 0 };
 
-    time_t now = time(0);
-    struct tm ltime;
-    AVBPrint *bp = &s->expanded_text;
-
-    av_bprint_clear(bp);
-
-    if(s->basetime != AV_NOPTS_VALUE)
-        now= frame->pts*av_q2d(ctx->inputs[0]->time_base) + s->basetime/1000000;
-
-    switch (s->exp_mode) {
-    case EXP_NONE:
-        av_bprintf(bp, "%s", s->text);
-        break;
-    case EXP_NORMAL:
-        if ((ret = expand_text(ctx)) < 0)
-            return ret;
-        break;
-    case EXP_STRFTIME:
-        localtime_r(&now, &ltime);
-        av_bprint_strftime(bp, s->text, &ltime);
-        break;
-    }
-
-    if (s->tc_opt_string) {
-        char tcbuf[AV_TIMECODE_STR_SIZE];
-        av_timecode_make_string(&s->tc, tcbuf, inlink->frame_count);
-        av_bprint_clear(bp);
-        av_bprintf(bp, "%s%s", s->text, tcbuf);
-    }
-
-    if (!av_bprint_is_complete(bp))
-        return AVERROR(ENOMEM);
-    text = s->expanded_text.str;
     if ((len = s->expanded_text.len) > s->nb_positions) {
         if (!(s->positions =
               av_realloc(s->positions, len*sizeof(*s->positions))))
@@ -901,9 +975,6 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
         s->nb_positions = len;
     }
 
-    x = 0;
-    y = 0;
-
     /* load and cache glyphs */
     for (i = 0, p = text; *p; i++) {
         GET_UTF8(code, *p++, continue;);
@@ -934,6 +1005,9 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
 
         prev_code = code;
         if (is_newline(code)) {
+            /* the glyphs of \f and \v are still drawn, give them a position */
+            s->positions[i].x = x;
+            s->positions[i].y = y;
 
             max_text_line_w = FFMAX(max_text_line_w, x);
             y += s->max_glyph_h;
@@ -972,6 +1046,107 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
 
     s->var_values[VAR_LINE_H] = s->var_values[VAR_LH] = s->max_glyph_h;
 
+    return render_text_mask(s);
+}
+
+static void draw_glyphs(DrawTextContext *s, AVFrame *frame,
+                        int width, int height, FFDrawColor *color, int x, int y)
+{
+    char *text = s->expanded_text.str;
+    uint32_t code = 0;
+    int i;
+    uint8_t *p;
+    Glyph *glyph = NULL;
+
+    for (i = 0, p = text; *p; i++) {
+        Glyph dummy = { 0 };
+        GET_UTF8(code, *p++, continue;);
+
+        /* skip new line chars, just go to new line */
+        if (code == '\n' || code == '\r' || code == '\t')
+            continue;
+
+        dummy.code = code;
+        glyph = av_tree_find(s->glyphs, &dummy, (void *)glyph_cmp, NULL);
+
+        ff_blend_mask(&s->dc, color,
+                      frame->data, frame->linesize, width, height,
+                      glyph->bitmap.buffer, glyph->bitmap.pitch,
+                      glyph->bitmap.width, glyph->bitmap.rows,
+                      glyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO ? 0 : 3,
+                      0, s->positions[i].x + s->x + x, s->positions[i].y + s->y + y);
+    }
+}
+
+static void draw_text_mask(DrawTextContext *s, AVFrame *frame,
+                           int width, int height, FFDrawColor *color, int x, int y)
+{
+    if (s->text_mask_overlap) {
+        draw_glyphs(s, frame, width, height, color, x, y);
+        return;
+    }
+    ff_blend_mask(&s->dc, color,
+                  frame->data, frame->linesize, width, height,
+                  s->text_mask, s->text_mask_w,
+                  s->text_mask_w, s->text_mask_h, 3, 0,
+                  s->x + x + s->text_mask_x, s->y + y + s->text_mask_y);
+}
+
+static int draw_text(AVFilterContext *ctx, AVFrame *frame,
+                     int width, int height)
+{
+    DrawTextContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+
+    int ret;
+    int box_w, box_h;
+
+    time_t now = time(0);
+    struct tm ltime;
+    AVBPrint *bp = &s->expanded_text;
+
+    av_bprint_clear(bp);
+
+    if(s->basetime != AV_NOPTS_VALUE)
+        now= frame->pts*av_q2d(ctx->inputs[0]->time_base) + s->basetime/1000000;
+
+    switch (s->exp_mode) {
+    case EXP_NONE:
+        av_bprintf(bp, "%s", s->text);
+        break;
+    case EXP_NORMAL:
+        if ((ret = expand_text(ctx)) < 0)
+            return ret;
+        break;
+    case EXP_STRFTIME:
+        localtime_r(&now, &ltime);
+        av_bprint_strftime(bp, s->text, &ltime);
+        break;
+    }
+
+    if (s->tc_opt_string) {
+        char tcbuf[AV_TIMECODE_STR_SIZE];
+        av_timecode_make_string(&s->tc, tcbuf, inlink->frame_count);
+        av_bprint_clear(bp);
+        av_bprintf(bp, "%s%s", s->text, tcbuf);
+    }
+
+    if (!av_bprint_is_complete(bp))
+        return AVERROR(ENOMEM);
+
+    /* the layout and the text mask only depend on the expanded text */
+    if (!s->layout_text || strcmp(s->layout_text, bp->str)) {
+        if ((ret = layout_text(ctx)) < 0) {
+            av_freep(&s->layout_text);
+            s->layout_text_size = 0;
+            return ret;
+        }
+        av_fast_malloc(&s->layout_text, &s->layout_text_size, bp->len + 1);
+        if (!s->layout_text)
+            return AVERROR(ENOMEM);
+        memcpy(s->layout_text, bp->str, bp->len + 1);
+    }
+
     s->x = s->var_values[VAR_X] = av_expr_eval(s->x_pexpr, s->var_values, &s->prng);
     s->y = s->var_values[VAR_Y] = av_expr_eval(s->y_pexpr, s->var_values, &s->prng);
     s->x = s->var_values[VAR_X] = av_expr_eval(s->x_pexpr, s->var_values, &s->prng);
@@ -986,8 +1161,8 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
         return 0;
 #endif
 
-    box_w = FFMIN(width - 1 , max_text_line_w);
-    box_h = FFMIN(height - 1, y + s->max_glyph_h);
+    box_w = FFMIN(width - 1 , (int)s->var_values[VAR_TEXT_W]);
+    box_h = FFMIN(height - 1, (int)s->var_values[VAR_TEXT_H]);
 
     /* draw box */
     if (s->draw_box)
@@ -995,15 +1170,11 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
                            frame->data, frame->linesize, width, height,
                            s->x, s->y, box_w, box_h);
 
-    if (s->shadowx || s->shadowy) {
-        if ((ret = draw_glyphs(s, frame, width, height, s->shadowcolor.rgba,
-                               &s->shadowcolor, s->shadowx, s->shadowy)) < 0)
-            return ret;
-    }
+    if (s->shadowx || s->shadowy)
+        draw_text_mask(s, frame, width, height, &s->shadowcolor,
+                       s->shadowx, s->shadowy);
 
-    if ((ret = draw_glyphs(s, frame, width, height, s->fontcolor.rgba,
-                           &s->fontcolor, 0, 0)) < 0)
-        return ret;
+    draw_text_mask(s, frame, width, height, &s->fontcolor, 0, 0);
 
     return 0;
 }
@@ -40,6 +40,8 @@ typedef struct {
     int hsub, vsub;             ///< chroma subsampling
     int planes;                 ///< number of planes
     int is_rgb;
+    double *x;                  ///< the values of X for a whole line
+    double *res;                ///< the results of a whole line
 } GEQContext;
 
 enum { Y = 0, U, V, A, G, B, R };
@@ -187,10 +189,20 @@ static int geq_config_props(AVFilterLink *inlink)
 {
     GEQContext *geq = inlink->dst->priv;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+    int x;
 
     geq->hsub = desc->log2_chroma_w;
     geq->vsub = desc->log2_chroma_h;
     geq->planes = desc->nb_components;
+
+    av_freep(&geq->x);
+    av_freep(&geq->res);
+    geq->x   = av_malloc_array(inlink->w, sizeof(*geq->x));
+    geq->res = av_malloc_array(inlink->w, sizeof(*geq->res));
+    if (!geq->x || !geq->res)
+        return AVERROR(ENOMEM);
+    for (x = 0; x < inlink->w; x++)
+        geq->x[x] = x;
     return 0;
 }
 
@@ -204,6 +216,7 @@ static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
         [VAR_N] = inlink->frame_count,
         [VAR_T] = in->pts == AV_NOPTS_VALUE ? NAN : in->pts * av_q2d(inlink->time_base),
     };
+    const double *arrays[VAR_VARS_NB] = { [VAR_X] = geq->x };
 
     geq->picref = in;
     out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
@@ -225,12 +238,12 @@ static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
         values[VAR_SW] = w / (double)inlink->w;
         values[VAR_SH] = h / (double)inlink->h;
 
+        /* evaluate a whole line at a time */
         for (y = 0; y < h; y++) {
             values[VAR_Y] = y;
-            for (x = 0; x < w; x++) {
-                values[VAR_X] = x;
-                dst[x] = av_expr_eval(geq->e[plane], values, geq);
-            }
+            av_expr_eval_batch(geq->e[plane], geq->res, w, values, arrays, geq);
+            for (x = 0; x < w; x++)
+                dst[x] = geq->res[x];
             dst += linesize;
         }
     }
@@ -246,6 +259,8 @@ static av_cold void geq_uninit(AVFilterContext *ctx)
 
     for (i = 0; i < FF_ARRAY_ELEMS(geq->e); i++)
         av_expr_free(geq->e[i]);
+    av_freep(&geq->x);
+    av_freep(&geq->res);
 }
 
 static const AVFilterPad geq_inputs[] = {
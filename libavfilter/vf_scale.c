@@ -108,6 +108,8 @@ typedef struct {
     int in_v_chr_pos;
 
     int force_original_aspect_ratio;
+
+    int snap;                   ///< size difference up to which frames are not scaled
 } ScaleContext;
 
 static av_cold int init_dict(AVFilterContext *ctx, AVDictionary **opts)
@@ -224,6 +226,67 @@ static const int *parse_yuv_type(const char *s, enum AVColorSpace colorspace)
     return sws_getCoefficients(colorspace);
 }
 
+/**
+ * Whether frames differing from the output by at most snap pixels are cropped
+ * or have their right and bottom edges repeated instead of being scaled, e.g.
+ * frames decoded at a lowres size rounded away from the requested one.
+ */
+static int can_snap(ScaleContext *scale, AVFilterLink *inlink, AVFilterLink *outlink)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+
+    return inlink->format == outlink->format &&
+           FFABS(inlink->w - outlink->w) <= scale->snap &&
+           FFABS(inlink->h - outlink->h) <= scale->snap &&
+           !(desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_PSEUDOPAL |
+                            AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_HWACCEL)) &&
+           (desc->flags & AV_PIX_FMT_FLAG_PLANAR || !desc->log2_chroma_w);
+}
+
+static AVFrame *snap_frame(AVFilterLink *outlink, AVFrame *in)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(in->format);
+    int max_step[4], p, x, y;
+    AVFrame *out;
+
+    /* cropping the right and bottom edges needs no copy */
+    if (outlink->w <= in->width && outlink->h <= in->height) {
+        in->width  = outlink->w;
+        in->height = outlink->h;
+        return in;
+    }
+
+    out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+    if (!out) {
+        av_frame_free(&in);
+        return NULL;
+    }
+    av_frame_copy_props(out, in);
+
+    av_image_fill_max_pixsteps(max_step, NULL, desc);
+    for (p = 0; p < 4 && out->data[p]; p++) {
+        int hsub = p == 1 || p == 2 ? desc->log2_chroma_w : 0;
+        int vsub = p == 1 || p == 2 ? desc->log2_chroma_h : 0;
+        int step = max_step[p];
+        int w  = FF_CEIL_RSHIFT(FFMIN(in->width,  outlink->w), hsub);
+        int h  = FF_CEIL_RSHIFT(FFMIN(in->height, outlink->h), vsub);
+        int ow = FF_CEIL_RSHIFT(outlink->w, hsub);
+        int oh = FF_CEIL_RSHIFT(outlink->h, vsub);
+
+        for (y = 0; y < oh; y++) {
+            const uint8_t *src = in->data[p] + FFMIN(y, h - 1) * in->linesize[p];
+            uint8_t *dst = out->data[p] + y * out->linesize[p];
+
+            memcpy(dst, src, w * step);
+            for (x = w; x < ow; x++)
+                memcpy(dst + x * step, src + (w - 1) * step, step);
+        }
+    }
+
+    av_frame_free(&in);
+    return out;
+}
+
 static int config_props(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
@@ -326,7 +389,13 @@ static int config_props(AVFilterLink *outlink)
     if (inlink->w == outlink->w && inlink->h == outlink->h &&
         inlink->format == outlink->format)
         ;
-    else {
+    else if (can_snap(scale, inlink, outlink)) {
+        /* the edges are cropped or repeated, the pixels keep their shape */
+        outlink->sample_aspect_ratio = inlink->sample_aspect_ratio;
+        av_log(ctx, AV_LOG_VERBOSE, "w:%d h:%d -> w:%d h:%d without scaling\n",
+               inlink->w, inlink->h, outlink->w, outlink->h);
+        return 0;
+    } else {
         struct SwsContext **swscs[3] = {&scale->sws, &scale->isws[0], &scale->isws[1]};
         int i;
 
@@ -436,8 +505,14 @@ static int filter_frame(AVFilterLink *link, AVFrame *in)
             return ret;
     }
 
-    if (!scale->sws)
+    if (!scale->sws) {
+        if (in->width != outlink->w || in->height != outlink->h) {
+            in = snap_frame(outlink, in);
+            if (!in)
+                return AVERROR(ENOMEM);
+        }
         return ff_filter_frame(outlink, in);
+    }
 
     scale->hsub = desc->log2_chroma_w;
     scale->vsub = desc->log2_chroma_h;
@@ -545,6 +620,7 @@ static const AVOption scale_options[] = {
     { "disable",  NULL, 0, AV_OPT_TYPE_CONST, {.i64 = 0 }, 0, 0, FLAGS, "force_oar" },
     { "decrease", NULL, 0, AV_OPT_TYPE_CONST, {.i64 = 1 }, 0, 0, FLAGS, "force_oar" },
     { "increase", NULL, 0, AV_OPT_TYPE_CONST, {.i64 = 2 }, 0, 0, FLAGS, "force_oar" },
+    { "snap", "crop or pad instead of scaling when the size differs by at most this many pixels", OFFSET(snap), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 16, FLAGS },
     { NULL }
 };
 
@@ -30,6 +30,7 @@
 #include "libswscale/swscale.h"
 
 #include "avfilter.h"
+#include "blurdsp.h"
 #include "formats.h"
 #include "internal.h"
 
@@ -57,6 +58,7 @@ typedef struct {
     int          hsub;
     int          vsub;
     unsigned int sws_flags;
+    BlurDSPContext dsp;
 } SmartblurContext;
 
 #define OFFSET(x) offsetof(SmartblurContext, x)
@@ -97,6 +99,8 @@ static av_cold int init(AVFilterContext *ctx)
     sblur->luma.quality = sblur->chroma.quality = 3.0;
     sblur->sws_flags = SWS_BICUBIC;
 
+    ff_blurdsp_init(&sblur->dsp);
+
     av_log(ctx, AV_LOG_VERBOSE,
            "luma_radius:%f luma_strength:%f luma_threshold:%d "
            "chroma_radius:%f chroma_strength:%f chroma_threshold:%d\n",
@@ -176,11 +180,10 @@ static int config_props(AVFilterLink *inlink)
 static void blur(uint8_t       *dst, const int dst_linesize,
                  const uint8_t *src, const int src_linesize,
                  const int w, const int h, const int threshold,
-                 struct SwsContext *filter_context)
+                 struct SwsContext *filter_context,
+                 const BlurDSPContext *dsp)
 {
-    int x, y;
-    int orig, filtered;
-    int diff;
+    int y;
     /* Declare arrays of 4 to get aligned data */
     const uint8_t* const src_array[4] = {src};
     uint8_t *dst_array[4]             = {dst};
@@ -190,51 +193,10 @@ static void blur(uint8_t       *dst, const int dst_linesize,
     sws_scale(filter_context, src_array, src_linesize_array,
               0, h, dst_array, dst_linesize_array);
 
-    if (threshold > 0) {
-        for (y = 0; y < h; ++y) {
-            for (x = 0; x < w; ++x) {
-                orig     = src[x + y * src_linesize];
-                filtered = dst[x + y * dst_linesize];
-                diff     = orig - filtered;
-
-                if (diff > 0) {
-                    if (diff > 2 * threshold)
-                        dst[x + y * dst_linesize] = orig;
-                    else if (diff > threshold)
-                        /* add 'diff' and substract 'threshold' from 'filtered' */
-                        dst[x + y * dst_linesize] = orig - threshold;
-                } else {
-                    if (-diff > 2 * threshold)
-                        dst[x + y * dst_linesize] = orig;
-                    else if (-diff > threshold)
-                        /* add 'diff' and 'threshold' to 'filtered' */
-                        dst[x + y * dst_linesize] = orig + threshold;
-                }
-            }
-        }
-    } else if (threshold < 0) {
-        for (y = 0; y < h; ++y) {
-            for (x = 0; x < w; ++x) {
-                orig     = src[x + y * src_linesize];
-                filtered = dst[x + y * dst_linesize];
-                diff     = orig - filtered;
-
-                if (diff > 0) {
-                    if (diff <= -threshold)
-                        dst[x + y * dst_linesize] = orig;
-                    else if (diff <= -2 * threshold)
-                        /* substract 'diff' and 'threshold' from 'orig' */
-                        dst[x + y * dst_linesize] = filtered - threshold;
-                } else {
-                    if (diff >= threshold)
-                        dst[x + y * dst_linesize] = orig;
-                    else if (diff >= 2 * threshold)
-                        /* add 'threshold' and substract 'diff' from 'orig' */
-                        dst[x + y * dst_linesize] = filtered + threshold;
-                }
-            }
-        }
-    }
+    if (threshold)
+        for (y = 0; y < h; ++y)
+            dsp->threshold_line(dst + y * dst_linesize, src + y * src_linesize,
+                                threshold, w);
 }
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *inpic)
@@ -255,17 +217,17 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *inpic)
     blur(outpic->data[0], outpic->linesize[0],
          inpic->data[0],  inpic->linesize[0],
          inlink->w, inlink->h, sblur->luma.threshold,
-         sblur->luma.filter_context);
+         sblur->luma.filter_context, &sblur->dsp);
 
     if (inpic->data[2]) {
         blur(outpic->data[1], outpic->linesize[1],
              inpic->data[1],  inpic->linesize[1],
              cw, ch, sblur->chroma.threshold,
-             sblur->chroma.filter_context);
+             sblur->chroma.filter_context, &sblur->dsp);
         blur(outpic->data[2], outpic->linesize[2],
              inpic->data[2],  inpic->linesize[2],
              cw, ch, sblur->chroma.threshold,
-             sblur->chroma.filter_context);
+             sblur->chroma.filter_context, &sblur->dsp);
     }
 
     av_frame_free(&inpic);
@@ -0,0 +1,51 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_SSIM_H
+#define AVFILTER_SSIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct SSIMDSPContext {
+    /**
+     * Compute the statistics of a line of w 4x4 blocks:
+     * sums[x] = { sum(main), sum(ref), sum(main^2 + ref^2), sum(main * ref) }.
+     */
+    void (*ssim_4x4_line)(const uint8_t *main, ptrdiff_t main_stride,
+                          const uint8_t *ref, ptrdiff_t ref_stride,
+                          int (*sums)[4], int w);
+
+    /**
+     * Sum the SSIM of w overlapping 8x8 blocks, each of them made of the
+     * 4x4 blocks x and x + 1 of two consecutive lines of statistics.
+     * The results are accumulated in 4 interleaved partial sums which are
+     * added pairwise at the end, so that all versions are bit-exact.
+     */
+    float (*ssim_end_line)(const int (*sum0)[4], const int (*sum1)[4], int w);
+} SSIMDSPContext;
+
+void ff_ssim_init(SSIMDSPContext *dsp);
+void ff_ssim_init_x86(SSIMDSPContext *dsp);
+
+void ff_ssim_4x4_line_c(const uint8_t *main, ptrdiff_t main_stride,
+                        const uint8_t *ref, ptrdiff_t ref_stride,
+                        int (*sums)[4], int w);
+float ff_ssim_end_line_c(const int (*sum0)[4], const int (*sum1)[4], int w);
+
+#endif /* AVFILTER_SSIM_H */
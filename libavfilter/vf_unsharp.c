@@ -48,78 +48,102 @@
 #include "unsharp.h"
 #include "unsharp_opencl.h"
 
-static void apply_unsharp(      uint8_t *dst, int dst_stride,
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int width[3], height[3];
+} ThreadData;
+
+/**
+ * Filter rows [slice_start, slice_end) of one plane.
+ *
+ * The finite state machines of the original algorithm are cascaded [1 1]
+ * filters, i.e. a separable binomial blur with replicated edges. Each
+ * horizontal stage is run as a pass over the whole line and the vertical
+ * stages are run a line at a time, so that both vectorize. The vertical
+ * state is primed with the 2 * steps_y lines above the slice, which makes
+ * the slices independent and the result identical to a single pass.
+ */
+static void apply_unsharp(UnsharpContext *unsharp, uint32_t *buf,
+                                uint8_t *dst, int dst_stride,
                           const uint8_t *src, int src_stride,
-                          int width, int height, UnsharpFilterParam *fp)
+                          int width, int height, int slice_start, int slice_end,
+                          UnsharpFilterParam *fp)
 {
-    uint32_t **sc = fp->sc;
-    uint32_t sr[MAX_MATRIX_SIZE - 1], tmp1, tmp2;
-
-    int32_t res;
-    int x, y, z;
-    const uint8_t *src2 = NULL;  //silence a warning
-    const int amount = fp->amount;
+    const BlurDSPContext *dsp = &unsharp->dsp;
     const int steps_x = fp->steps_x;
     const int steps_y = fp->steps_y;
-    const int scalebits = fp->scalebits;
-    const int32_t halfscale = fp->halfscale;
+    const int stride  = fp->stride;
+    uint32_t *line = buf + 2 * steps_y * stride;
+    int x, y, z;
 
-    if (!amount) {
-        av_image_copy_plane(dst, dst_stride, src, src_stride, width, height);
+    if (!fp->amount) {
+        av_image_copy_plane(dst + slice_start * dst_stride, dst_stride,
+                            src + slice_start * src_stride, src_stride,
+                            width, slice_end - slice_start);
         return;
     }
 
-    for (y = 0; y < 2 * steps_y; y++)
-        memset(sc[y], 0, sizeof(sc[y][0]) * (width + 2 * steps_x));
-
-    for (y = -steps_y; y < height + steps_y; y++) {
-        if (y < height)
-            src2 = src;
-
-        memset(sr, 0, sizeof(sr[0]) * (2 * steps_x - 1));
-        for (x = -steps_x; x < width + steps_x; x++) {
-            tmp1 = x <= 0 ? src2[0] : x >= width ? src2[width-1] : src2[x];
-            for (z = 0; z < steps_x * 2; z += 2) {
-                tmp2 = sr[z + 0] + tmp1; sr[z + 0] = tmp1;
-                tmp1 = sr[z + 1] + tmp2; sr[z + 1] = tmp2;
-            }
-            for (z = 0; z < steps_y * 2; z += 2) {
-                tmp2 = sc[z + 0][x + steps_x] + tmp1; sc[z + 0][x + steps_x] = tmp1;
-                tmp1 = sc[z + 1][x + steps_x] + tmp2; sc[z + 1][x + steps_x] = tmp2;
-            }
-            if (x >= steps_x && y >= steps_y) {
-                const uint8_t *srx = src - steps_y * src_stride + x - steps_x;
-                uint8_t *dsx       = dst - steps_y * dst_stride + x - steps_x;
-
-                res = (int32_t)*srx + ((((int32_t) * srx - (int32_t)((tmp1 + halfscale) >> scalebits)) * amount) >> 16);
-                *dsx = av_clip_uint8(res);
-            }
-        }
-        if (y >= 0) {
-            dst += dst_stride;
-            src += src_stride;
-        }
+    memset(buf, 0, sizeof(*buf) * 2 * steps_y * stride);
+
+    for (y = slice_start - steps_y; y < slice_end + steps_y; y++) {
+        const uint8_t *src2 = src + av_clip(y, 0, height - 1) * src_stride;
+
+        for (x = 0; x < steps_x; x++)
+            line[x] = src2[0];
+        for (x = 0; x < width; x++)
+            line[x + steps_x] = src2[x];
+        for (x = 0; x < steps_x; x++)
+            line[x + steps_x + width] = src2[width - 1];
+
+        for (z = 0; z < 2 * steps_x; z++)
+            dsp->sum_pairs(line, line, width + 2 * steps_x - 1 - z);
+        for (z = 0; z < 2 * steps_y; z += 2)
+            dsp->sum_stages(line, buf + z * stride, buf + (z + 1) * stride, width);
+
+        if (y - steps_y >= slice_start)
+            dsp->unsharp_line(dst + (y - steps_y) * dst_stride,
+                              src + (y - steps_y) * src_stride,
+                              line, width, fp->amount, fp->scalebits);
     }
 }
 
-static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+static int unsharp_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    AVFilterLink *inlink = ctx->inputs[0];
     UnsharpContext *unsharp = ctx->priv;
-    int i, plane_w[3], plane_h[3];
-    UnsharpFilterParam *fp[3];
-    plane_w[0] = inlink->w;
-    plane_w[1] = plane_w[2] = FF_CEIL_RSHIFT(inlink->w, unsharp->hsub);
-    plane_h[0] = inlink->h;
-    plane_h[1] = plane_h[2] = FF_CEIL_RSHIFT(inlink->h, unsharp->vsub);
-    fp[0] = &unsharp->luma;
-    fp[1] = fp[2] = &unsharp->chroma;
+    ThreadData *td = arg;
+    UnsharpFilterParam *fp[3] = { &unsharp->luma, &unsharp->chroma, &unsharp->chroma };
+    int i;
+
     for (i = 0; i < 3; i++) {
-        apply_unsharp(out->data[i], out->linesize[i], in->data[i], in->linesize[i], plane_w[i], plane_h[i], fp[i]);
+        const int slice_start = (td->height[i] *  jobnr   ) / nb_jobs;
+        const int slice_end   = (td->height[i] * (jobnr+1)) / nb_jobs;
+
+        apply_unsharp(unsharp, fp[i]->buf[jobnr],
+                      td->out->data[i], td->out->linesize[i],
+                      td->in->data[i],  td->in->linesize[i],
+                      td->width[i], td->height[i], slice_start, slice_end, fp[i]);
     }
     return 0;
 }
 
+static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+{
+    AVFilterLink *inlink = ctx->inputs[0];
+    UnsharpContext *unsharp = ctx->priv;
+    ThreadData td;
+
+    td.in  = in;
+    td.out = out;
+    td.width[0]  = inlink->w;
+    td.width[1]  = td.width[2]  = FF_CEIL_RSHIFT(inlink->w, unsharp->hsub);
+    td.height[0] = inlink->h;
+    td.height[1] = td.height[2] = FF_CEIL_RSHIFT(inlink->h, unsharp->vsub);
+
+    ctx->internal->execute(ctx, unsharp_slice, &td, NULL,
+                           FFMIN(td.height[2], unsharp->nb_threads));
+    return 0;
+}
+
 static void set_filter_param(UnsharpFilterParam *fp, int msize_x, int msize_y, float amount)
 {
     fp->msize_x = msize_x;
@@ -141,6 +165,7 @@ static av_cold int init(AVFilterContext *ctx)
     set_filter_param(&unsharp->luma,   unsharp->lmsize_x, unsharp->lmsize_y, unsharp->lamount);
     set_filter_param(&unsharp->chroma, unsharp->cmsize_x, unsharp->cmsize_y, unsharp->camount);
 
+    ff_blurdsp_init(&unsharp->dsp);
     unsharp->apply_unsharp = apply_unsharp_c;
     if (!CONFIG_OPENCL && unsharp->opencl) {
         av_log(ctx, AV_LOG_ERROR, "OpenCL support was not enabled in this build, cannot be selected\n");
@@ -168,9 +193,20 @@ static int query_formats(AVFilterContext *ctx)
     return 0;
 }
 
-static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const char *effect_type, int width)
+static void free_filter_param(UnsharpFilterParam *fp, int nb_threads)
 {
-    int z;
+    int i;
+
+    if (fp->buf)
+        for (i = 0; i < nb_threads; i++)
+            av_free(fp->buf[i]);
+    av_freep(&fp->buf);
+}
+
+static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const char *effect_type,
+                             int width, int nb_threads)
+{
+    int i;
     const char *effect = fp->amount == 0 ? "none" : fp->amount < 0 ? "blur" : "sharpen";
 
     if  (!(fp->msize_x & fp->msize_y & 1)) {
@@ -183,8 +219,12 @@ static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const
     av_log(ctx, AV_LOG_VERBOSE, "effect:%s type:%s msize_x:%d msize_y:%d amount:%0.2f\n",
            effect, effect_type, fp->msize_x, fp->msize_y, fp->amount / 65535.0);
 
-    for (z = 0; z < 2 * fp->steps_y; z++)
-        if (!(fp->sc[z] = av_malloc(sizeof(*(fp->sc[z])) * (width + 2 * fp->steps_x))))
+    /* 2 * steps_y lines of vertical state followed by the working line */
+    fp->stride = FFALIGN(width + 2 * fp->steps_x, 8);
+    if (!(fp->buf = av_mallocz_array(nb_threads, sizeof(*fp->buf))))
+        return AVERROR(ENOMEM);
+    for (i = 0; i < nb_threads; i++)
+        if (!(fp->buf[i] = av_malloc_array((2 * fp->steps_y + 1) * fp->stride, sizeof(*fp->buf[i]))))
             return AVERROR(ENOMEM);
 
     return 0;
@@ -199,24 +239,21 @@ static int config_props(AVFilterLink *link)
     unsharp->hsub = desc->log2_chroma_w;
     unsharp->vsub = desc->log2_chroma_h;
 
-    ret = init_filter_param(link->dst, &unsharp->luma,   "luma",   link->w);
+    free_filter_param(&unsharp->luma,   unsharp->nb_threads);
+    free_filter_param(&unsharp->chroma, unsharp->nb_threads);
+    unsharp->nb_threads = link->dst->graph->nb_threads;
+
+    ret = init_filter_param(link->dst, &unsharp->luma,   "luma",   link->w, unsharp->nb_threads);
     if (ret < 0)
         return ret;
-    ret = init_filter_param(link->dst, &unsharp->chroma, "chroma", FF_CEIL_RSHIFT(link->w, unsharp->hsub));
+    ret = init_filter_param(link->dst, &unsharp->chroma, "chroma", FF_CEIL_RSHIFT(link->w, unsharp->hsub),
+                            unsharp->nb_threads);
     if (ret < 0)
         return ret;
 
     return 0;
 }
 
-static void free_filter_param(UnsharpFilterParam *fp)
-{
-    int z;
-
-    for (z = 0; z < 2 * fp->steps_y; z++)
-        av_free(fp->sc[z]);
-}
-
 static av_cold void uninit(AVFilterContext *ctx)
 {
     UnsharpContext *unsharp = ctx->priv;
@@ -225,8 +262,8 @@ static av_cold void uninit(AVFilterContext *ctx)
         ff_opencl_unsharp_uninit(ctx);
     }
 
-    free_filter_param(&unsharp->luma);
-    free_filter_param(&unsharp->chroma);
+    free_filter_param(&unsharp->luma,   unsharp->nb_threads);
+    free_filter_param(&unsharp->chroma, unsharp->nb_threads);
 }
 
 static int filter_frame(AVFilterLink *link, AVFrame *in)
@@ -308,5 +345,5 @@ AVFilter ff_vf_unsharp = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_unsharp_inputs,
     .outputs       = avfilter_vf_unsharp_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -0,0 +1,290 @@
+;*****************************************************************************
+;* x86-optimized functions for the unsharp, boxblur and smartblur filters
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+; All functions process len elements, len being a multiple of the number of
+; elements handled per loop iteration. Tails are left to the C versions.
+
+;------------------------------------------------------------------------------
+; void ff_blur_sum_pairs(uint32_t *dst, const uint32_t *src, int len)
+;------------------------------------------------------------------------------
+
+%macro SUM_PAIRS 0
+cglobal blur_sum_pairs, 3,3,2, dst, src, len
+    movsxdifnidn lenq, lend
+    shl        lenq, 2
+    add        dstq, lenq
+    add        srcq, lenq
+    neg        lenq
+.loop:
+    movu         m0, [srcq+lenq]
+    movu         m1, [srcq+lenq+4]
+    paddd        m0, m1
+    movu [dstq+lenq], m0
+    add        lenq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; void ff_blur_sum_stages(uint32_t *line, uint32_t *state0, uint32_t *state1,
+;                         int len)
+;------------------------------------------------------------------------------
+
+%macro SUM_STAGES 0
+cglobal blur_sum_stages, 4,4,3, line, state0, state1, len
+    movsxdifnidn lenq, lend
+    shl        lenq, 2
+    add       lineq, lenq
+    add     state0q, lenq
+    add     state1q, lenq
+    neg        lenq
+.loop:
+    movu         m0, [lineq+lenq]
+    movu         m1, [state0q+lenq]
+    movu         m2, [state1q+lenq]
+    movu [state0q+lenq], m0
+    paddd        m1, m0
+    movu [state1q+lenq], m1
+    paddd        m2, m1
+    movu [lineq+lenq], m2
+    add        lenq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; void ff_blur_box_slide(uint16_t *sum, const uint8_t *add, const uint8_t *sub,
+;                        int len)
+;------------------------------------------------------------------------------
+
+%macro BOX_SLIDE 0
+cglobal blur_box_slide, 4,4,4, sum, add, sub, len
+    movsxdifnidn lenq, lend
+    add        addq, lenq
+    add        subq, lenq
+    lea        sumq, [sumq+lenq*2]
+    neg        lenq
+%if notcpuflag(avx2)
+    pxor         m3, m3
+%endif
+.loop:
+%if cpuflag(avx2)
+    pmovzxbw     m0, [addq+lenq]
+    pmovzxbw     m1, [subq+lenq]
+%else
+    movh         m0, [addq+lenq]
+    movh         m1, [subq+lenq]
+    punpcklbw    m0, m3
+    punpcklbw    m1, m3
+%endif
+    movu         m2, [sumq+lenq*2]
+    psubw        m0, m1
+    paddw        m0, m2
+    movu [sumq+lenq*2], m0
+    add        lenq, mmsize/2
+    jl .loop
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; void ff_blur_box_scale(uint8_t *dst, const uint16_t *sum, int inv, int len)
+;------------------------------------------------------------------------------
+
+%macro BOX_SCALE 0
+cglobal blur_box_scale, 4,4,5, dst, sum, inv, len
+    movd        xm4, invd
+%if cpuflag(avx2)
+    vpbroadcastw m4, xm4
+%else
+    SPLATW       m4, m4
+%endif
+    movsxdifnidn lenq, lend
+    add        dstq, lenq
+    lea        sumq, [sumq+lenq*2]
+    neg        lenq
+.loop:
+    ; (sum * inv + (1 << 15)) >> 16 == hi16(sum * inv) + (lo16(sum * inv) >> 15)
+    movu         m0, [sumq+lenq*2]
+    movu         m1, [sumq+lenq*2+mmsize]
+    pmullw       m2, m0, m4
+    pmullw       m3, m1, m4
+    pmulhuw      m0, m4
+    pmulhuw      m1, m4
+    psrlw        m2, 15
+    psrlw        m3, 15
+    paddw        m0, m2
+    paddw        m1, m3
+    packuswb     m0, m1
+%if cpuflag(avx2)
+    vpermq       m0, m0, 0xD8
+%endif
+    movu [dstq+lenq], m0
+    add        lenq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+SUM_PAIRS
+SUM_STAGES
+BOX_SLIDE
+BOX_SCALE
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+SUM_PAIRS
+SUM_STAGES
+BOX_SLIDE
+BOX_SCALE
+%endif
+
+;------------------------------------------------------------------------------
+; void ff_blur_unsharp_line(uint8_t *dst, const uint8_t *src,
+;                           const uint32_t *blur, int len, int amount,
+;                           int scalebits)
+;------------------------------------------------------------------------------
+
+INIT_XMM sse4
+cglobal blur_unsharp_line, 6,6,8, dst, src, blur, len, amount, scalebits
+    ; (src - blur) * amount is computed as (blur - src) * -amount
+    neg     amountd
+    movd         m5, amountd
+    pshufd       m5, m5, 0
+    movd         m6, scalebitsd
+    dec  scalebitsd
+    movd         m4, scalebitsd
+    pcmpeqd      m7, m7
+    psrld        m7, 31
+    pslld        m7, m4
+    pxor         m4, m4
+    movsxdifnidn lenq, lend
+    add        dstq, lenq
+    add        srcq, lenq
+    lea       blurq, [blurq+lenq*4]
+    neg        lenq
+.loop:
+    movh         m0, [srcq+lenq]
+    punpcklbw    m0, m4
+    punpckhwd    m1, m0, m4
+    punpcklwd    m0, m4
+    movu         m2, [blurq+lenq*4]
+    movu         m3, [blurq+lenq*4+16]
+    paddd        m2, m7
+    paddd        m3, m7
+    psrld        m2, m6
+    psrld        m3, m6
+    psubd        m2, m0
+    psubd        m3, m1
+    pmulld       m2, m5
+    pmulld       m3, m5
+    psrad        m2, 16
+    psrad        m3, 16
+    paddd        m0, m2
+    paddd        m1, m3
+    packssdw     m0, m1
+    packuswb     m0, m0
+    movh [dstq+lenq], m0
+    add        lenq, 8
+    jl .loop
+    RET
+
+;------------------------------------------------------------------------------
+; void ff_blur_threshold_line(uint8_t *dst, const uint8_t *src, int threshold,
+;                             int len)
+;------------------------------------------------------------------------------
+
+INIT_XMM sse2
+cglobal blur_threshold_line, 4,5,8, dst, src, thresh, len, tmp
+    mov        tmpd, threshd
+    sar        tmpd, 31
+    xor     threshd, tmpd
+    sub     threshd, tmpd           ; t = FFABS(threshold)
+    movd         m6, threshd
+    punpcklbw    m6, m6
+    SPLATW       m6, m6             ; t
+    paddb        m7, m6, m6         ; 2 * t
+    movsxdifnidn lenq, lend
+    add        dstq, lenq
+    add        srcq, lenq
+    neg        lenq
+    test       tmpd, tmpd
+    jnz .negative
+.positive:
+    ; |diff| > 2t: orig, |diff| > t: orig -/+ t, else filtered
+    movu         m0, [srcq+lenq]    ; orig
+    movu         m1, [dstq+lenq]    ; filtered
+    pxor         m5, m5
+    psubusb      m2, m0, m1         ; orig > filtered ? diff : 0
+    psubusb      m3, m1, m0         ; orig < filtered ? -diff : 0
+    pcmpeqb      m4, m2, m5
+    pcmpeqb      m5, m3
+    por          m2, m3             ; |diff|
+    pandn        m4, m6             ; t where orig > filtered
+    pandn        m5, m6             ; t where orig < filtered
+    psubusb      m3, m0, m4
+    paddusb      m3, m5             ; orig -/+ t
+    psubusb      m4, m2, m6
+    psubusb      m2, m7
+    pxor         m5, m5
+    pcmpeqb      m4, m5             ; |diff| <= t
+    pcmpeqb      m2, m5             ; |diff| <= 2t
+    pand         m1, m4
+    pandn        m4, m3
+    por          m1, m4             ; |diff| <= t ? filtered : orig -/+ t
+    pand         m1, m2
+    pandn        m2, m0
+    por          m1, m2             ; |diff| <= 2t ? previous : orig
+    movu [dstq+lenq], m1
+    add        lenq, mmsize
+    jl .positive
+    RET
+.negative:
+    ; |diff| <= t: orig, |diff| <= 2t: filtered +/- t, else filtered
+    movu         m0, [srcq+lenq]    ; orig
+    movu         m1, [dstq+lenq]    ; filtered
+    pxor         m5, m5
+    psubusb      m2, m0, m1
+    psubusb      m3, m1, m0
+    pcmpeqb      m4, m2, m5
+    pcmpeqb      m5, m3
+    por          m2, m3             ; |diff|
+    pandn        m4, m6             ; t where orig > filtered
+    pandn        m5, m6             ; t where orig < filtered
+    paddusb      m3, m1, m4
+    psubusb      m3, m5             ; filtered +/- t
+    psubusb      m4, m2, m6
+    psubusb      m2, m7
+    pxor         m5, m5
+    pcmpeqb      m4, m5             ; |diff| <= t
+    pcmpeqb      m2, m5             ; |diff| <= 2t
+    pand         m3, m2
+    pandn        m2, m1
+    por          m3, m2             ; |diff| <= 2t ? filtered +/- t : filtered
+    pand         m0, m4
+    pandn        m4, m3
+    por          m0, m4             ; |diff| <= t ? orig : previous
+    movu [dstq+lenq], m0
+    add        lenq, mmsize
+    jl .negative
+    RET
@@ -0,0 +1,110 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/blurdsp.h"
+
+void ff_blur_sum_pairs_sse2(uint32_t *dst, const uint32_t *src, int len);
+void ff_blur_sum_pairs_avx2(uint32_t *dst, const uint32_t *src, int len);
+void ff_blur_sum_stages_sse2(uint32_t *line, uint32_t *state0, uint32_t *state1, int len);
+void ff_blur_sum_stages_avx2(uint32_t *line, uint32_t *state0, uint32_t *state1, int len);
+void ff_blur_unsharp_line_sse4(uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                               int len, int amount, int scalebits);
+void ff_blur_box_slide_sse2(uint16_t *sum, const uint8_t *add, const uint8_t *sub, int len);
+void ff_blur_box_slide_avx2(uint16_t *sum, const uint8_t *add, const uint8_t *sub, int len);
+void ff_blur_box_scale_sse2(uint8_t *dst, const uint16_t *sum, int inv, int len);
+void ff_blur_box_scale_avx2(uint8_t *dst, const uint16_t *sum, int inv, int len);
+void ff_blur_threshold_line_sse2(uint8_t *dst, const uint8_t *src, int threshold, int len);
+
+#if HAVE_YASM
+#define BLUR_FUNC(name, opt, step, type0, type1, type2)                         \
+static void blur_ ## name ## _ ## opt(type0 *a, type1 *b, type2 *c, int len)   \
+{                                                                               \
+    FF_SIMD_WITH_C_TAIL(len, step, ff_blur_ ## name ## _ ## opt(a, b, c, x),    \
+                        ff_blur_ ## name ## _c(a + x, b + x, c + x, len - x));  \
+}
+
+BLUR_FUNC(sum_stages, sse2,  4, uint32_t, uint32_t,      uint32_t)
+BLUR_FUNC(sum_stages, avx2,  8, uint32_t, uint32_t,      uint32_t)
+BLUR_FUNC(box_slide,  sse2,  8, uint16_t, const uint8_t, const uint8_t)
+BLUR_FUNC(box_slide,  avx2, 16, uint16_t, const uint8_t, const uint8_t)
+
+#define SUM_PAIRS_FUNC(opt, step)                                               \
+static void blur_sum_pairs_ ## opt(uint32_t *dst, const uint32_t *src, int len) \
+{                                                                               \
+    FF_SIMD_WITH_C_TAIL(len, step, ff_blur_sum_pairs_ ## opt(dst, src, x),      \
+                        ff_blur_sum_pairs_c(dst + x, src + x, len - x));        \
+}
+
+SUM_PAIRS_FUNC(sse2, 4)
+SUM_PAIRS_FUNC(avx2, 8)
+
+#define BOX_SCALE_FUNC(opt, step)                                               \
+static void blur_box_scale_ ## opt(uint8_t *dst, const uint16_t *sum,           \
+                                   int inv, int len)                            \
+{                                                                               \
+    FF_SIMD_WITH_C_TAIL(len, step, ff_blur_box_scale_ ## opt(dst, sum, inv, x), \
+                        ff_blur_box_scale_c(dst + x, sum + x, inv, len - x));   \
+}
+
+BOX_SCALE_FUNC(sse2, 16)
+BOX_SCALE_FUNC(avx2, 32)
+
+static void blur_threshold_line_sse2(uint8_t *dst, const uint8_t *src,
+                                     int threshold, int len)
+{
+    FF_SIMD_WITH_C_TAIL(len, 16, ff_blur_threshold_line_sse2(dst, src, threshold, x),
+                        ff_blur_threshold_line_c(dst + x, src + x, threshold, len - x));
+}
+
+static void blur_unsharp_line_sse4(uint8_t *dst, const uint8_t *src,
+                                   const uint32_t *blur, int len,
+                                   int amount, int scalebits)
+{
+    FF_SIMD_WITH_C_TAIL(len, 8,
+                        ff_blur_unsharp_line_sse4(dst, src, blur, x, amount, scalebits),
+                        ff_blur_unsharp_line_c(dst + x, src + x, blur + x, len - x,
+                                               amount, scalebits));
+}
+#endif /* HAVE_YASM */
+
+av_cold void ff_blurdsp_init_x86(BlurDSPContext *dsp)
+{
+#if HAVE_YASM
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        dsp->sum_pairs      = blur_sum_pairs_sse2;
+        dsp->sum_stages     = blur_sum_stages_sse2;
+        dsp->box_slide      = blur_box_slide_sse2;
+        dsp->box_scale      = blur_box_scale_sse2;
+        dsp->threshold_line = blur_threshold_line_sse2;
+    }
+    if (EXTERNAL_SSE4(cpu_flags))
+        dsp->unsharp_line   = blur_unsharp_line_sse4;
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        dsp->sum_pairs      = blur_sum_pairs_avx2;
+        dsp->sum_stages     = blur_sum_stages_avx2;
+        dsp->box_slide      = blur_box_slide_avx2;
+        dsp->box_scale      = blur_box_scale_avx2;
+    }
+#endif /* HAVE_YASM */
+}
@@ -0,0 +1,102 @@
+;*****************************************************************************
+;* x86-optimized functions for the drawing utilities
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pd_0x1010101: times 8 dd 0x1010101
+
+SECTION .text
+
+;------------------------------------------------------------------------------
+; void ff_draw_blend_row(uint8_t *dst, const uint8_t *mask,
+;                        unsigned src, unsigned alpha, int w)
+;
+; w must be a multiple of 8.
+;------------------------------------------------------------------------------
+
+; ((0x1010101 - a) * d + a * s) >> 24 is computed as
+; (0x1010101 * d - a * (d - s)) >> 24, which is exact modulo 2^32.
+
+INIT_XMM sse4
+cglobal draw_blend_row, 5,5,8, dst, mask, src, alpha, w
+    movd         m4, srcd
+    pshufd       m4, m4, 0
+    movd         m5, alphad
+    pshufd       m5, m5, 0
+    movsxdifnidn wq, wd
+    add        dstq, wq
+    add       maskq, wq
+    neg          wq
+.loop:
+    movh         m0, [dstq+wq]
+    punpcklbw    m0, m0
+    punpckhwd    m1, m0, m0         ; 0x1010101 * d, pixels 4-7
+    punpcklwd    m0, m0             ; 0x1010101 * d, pixels 0-3
+    pmovzxbd     m2, [maskq+wq]
+    pmovzxbd     m3, [maskq+wq+4]
+    pmulld       m2, m5             ; a
+    pmulld       m3, m5
+    psrld        m6, m0, 24
+    psrld        m7, m1, 24
+    psubd        m6, m4             ; d - s
+    psubd        m7, m4
+    pmulld       m6, m2
+    pmulld       m7, m3
+    psubd        m0, m6
+    psubd        m1, m7
+    psrld        m0, 24
+    psrld        m1, 24
+    packusdw     m0, m1
+    packuswb     m0, m0
+    movh [dstq+wq], m0
+    add          wq, 8
+    jl .loop
+    RET
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+cglobal draw_blend_row, 5,5,6, dst, mask, src, alpha, w
+    movd        xm4, srcd
+    vpbroadcastd m4, xm4
+    movd        xm5, alphad
+    vpbroadcastd m5, xm5
+    movsxdifnidn wq, wd
+    add        dstq, wq
+    add       maskq, wq
+    neg          wq
+.loop:
+    pmovzxbd     m0, [dstq+wq]      ; d
+    pmovzxbd     m2, [maskq+wq]
+    pmulld       m2, m5             ; a
+    pmulld       m1, m0, [pd_0x1010101]
+    psubd        m0, m4             ; d - s
+    pmulld       m0, m2
+    psubd        m1, m0
+    psrld        m1, 24
+    vextracti128 xm0, m1, 1
+    packusdw    xm1, xm0
+    packuswb    xm1, xm1
+    movh [dstq+wq], xm1
+    add          wq, 8
+    jl .loop
+    RET
+%endif
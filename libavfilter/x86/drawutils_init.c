@@ -0,0 +1,53 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/drawutils.h"
+
+void ff_draw_blend_row_sse4(uint8_t *dst, const uint8_t *mask,
+                            unsigned src, unsigned alpha, int w);
+void ff_draw_blend_row_avx2(uint8_t *dst, const uint8_t *mask,
+                            unsigned src, unsigned alpha, int w);
+
+#if HAVE_YASM
+#define BLEND_ROW_FUNC(opt)                                                     \
+static void blend_row_ ## opt(uint8_t *dst, const uint8_t *mask,               \
+                              unsigned src, unsigned alpha, int w)              \
+{                                                                               \
+    FF_SIMD_WITH_C_TAIL(w, 8, ff_draw_blend_row_ ## opt(dst, mask, src, alpha, x), \
+                        ff_draw_blend_row_c(dst + x, mask + x, src, alpha, w - x)); \
+}
+
+BLEND_ROW_FUNC(sse4)
+BLEND_ROW_FUNC(avx2)
+#endif /* HAVE_YASM */
+
+av_cold void ff_draw_init_x86(FFDrawContext *draw)
+{
+#if HAVE_YASM
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE4(cpu_flags))
+        draw->blend_row = blend_row_sse4;
+    if (EXTERNAL_AVX2(cpu_flags))
+        draw->blend_row = blend_row_avx2;
+#endif /* HAVE_YASM */
+}
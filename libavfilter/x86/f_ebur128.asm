@@ -0,0 +1,117 @@
+;*****************************************************************************
+;* x86-optimized functions for the ebur128 filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or modify
+;* it under the terms of the GNU General Public License as published by
+;* the Free Software Foundation; either version 2 of the License, or
+;* (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;* GNU General Public License for more details.
+;*
+;* You should have received a copy of the GNU General Public License along
+;* with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+;* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pd_pre_b0: times 2 dq  1.53512485958697
+pd_pre_b1: times 2 dq -2.69169618940638
+pd_pre_b2: times 2 dq  1.19839281085285
+pd_pre_a1: times 2 dq -1.69065929318241
+pd_pre_a2: times 2 dq  0.73248077421585
+pd_rlb_a1: times 2 dq -1.99004745483398
+pd_rlb_a2: times 2 dq  0.99007225036621
+
+SECTION .text
+
+; must match EBUR128_STATE_STRIDE
+%define X1 0*64*8
+%define X2 1*64*8
+%define Y1 2*64*8
+%define Y2 3*64*8
+%define Z1 4*64*8
+%define Z2 5*64*8
+
+; The operations are done in the same order as in the C version, so that the
+; output is identical. The RLB-filter coefficients b0, b1 and b2 are 1, -2
+; and 1, the multiplications by them are exact.
+; %1 = instruction suffix (pd or sd), %2 = load/store instruction
+%macro KWEIGHT 2
+    %2           m0, [samplesq+chq]             ; x
+    %2           m1, [stateq+chq+X1]
+    %2           m2, [stateq+chq+X2]
+    %2 [stateq+chq+X2], m1
+    %2 [stateq+chq+X1], m0
+    mul%1        m3, m0, [pd_pre_b0]
+    mul%1        m1, [pd_pre_b1]
+    mul%1        m2, [pd_pre_b2]
+    add%1        m3, m1
+    add%1        m3, m2
+    %2           m4, [stateq+chq+Y1]
+    %2           m5, [stateq+chq+Y2]
+    %2 [stateq+chq+Y2], m4
+    mul%1        m6, m4, [pd_pre_a1]
+    sub%1        m3, m6
+    mul%1        m6, m5, [pd_pre_a2]
+    sub%1        m3, m6                         ; y
+    %2 [stateq+chq+Y1], m3
+    add%1        m4, m4
+    sub%1        m3, m4
+    add%1        m3, m5
+    %2           m4, [stateq+chq+Z1]
+    %2           m5, [stateq+chq+Z2]
+    %2 [stateq+chq+Z2], m4
+    mul%1        m4, [pd_rlb_a1]
+    mul%1        m5, [pd_rlb_a2]
+    sub%1        m3, m4
+    sub%1        m3, m5                         ; z
+    %2 [stateq+chq+Z1], m3
+    mul%1        m3, m3
+    %2           m4, [energyq+chq]
+    add%1        m4, m3
+    %2 [energyq+chq], m4
+%endmacro
+
+;------------------------------------------------------------------------------
+; void ff_ebur128_filter_channels(double *energy, double *state,
+;                                 const double *samples, int stride,
+;                                 int nb_channels, int nb_samples)
+;------------------------------------------------------------------------------
+
+INIT_XMM sse2
+cglobal ebur128_filter_channels, 6,7,7, energy, state, samples, stride, channels, len, ch
+    movsxdifnidn strideq, strided
+    movsxdifnidn channelsq, channelsd
+    shl     strideq, 3
+    shl   channelsq, 3
+    add     energyq, channelsq
+    add      stateq, channelsq
+    add    samplesq, channelsq
+    neg   channelsq
+    jz .end
+.sample:
+    mov         chq, channelsq
+    test        chq, 8
+    jz .pairs
+    ; odd number of channels: process the first one alone
+    KWEIGHT      sd, movsd
+    add         chq, 8
+    jz .next
+.pairs:
+    KWEIGHT      pd, movu
+    add         chq, 16
+    jl .pairs
+.next:
+    add    samplesq, strideq
+    dec        lend
+    jg .sample
+.end:
+    RET
@@ -0,0 +1,117 @@
+;*****************************************************************************
+;* x86-optimized audio mixing functions for the pan and amix filters
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+; Both functions process len samples, len being a multiple of mmsize / 2.
+; Tails are left to the C versions.
+
+;------------------------------------------------------------------------------
+; void ff_mix_s16(int32_t *acc, const int16_t *src, int gain, int len)
+;------------------------------------------------------------------------------
+
+%macro MIX_S16 0
+cglobal mix_s16, 4,5,5, acc, src, gain, len, tmp
+%if cpuflag(avx2)
+    movd        xm4, gaind
+    vpbroadcastd m4, xm4
+%else
+    ; gain = g0 + g1 with both halves fitting in 16 bits, so that pmaddwd
+    ; on duplicated samples gives src * g0 + src * g1
+    mov        tmpd, gaind
+    sar        tmpd, 1
+    sub       gaind, tmpd
+    shl       gaind, 16
+    movzx      tmpd, tmpw
+    or        gaind, tmpd
+    movd         m4, gaind
+    pshufd       m4, m4, 0
+%endif
+    movsxdifnidn lenq, lend
+    lea        srcq, [srcq+lenq*2]
+    lea        accq, [accq+lenq*4]
+    neg        lenq
+.loop:
+%if cpuflag(avx2)
+    pmovsxwd     m0, [srcq+lenq*2]
+    pmovsxwd     m1, [srcq+lenq*2+mmsize/2]
+    pmulld       m0, m4
+    pmulld       m1, m4
+%else
+    movu         m2, [srcq+lenq*2]
+    punpcklwd    m0, m2, m2
+    punpckhwd    m1, m2, m2
+    pmaddwd      m0, m4
+    pmaddwd      m1, m4
+%endif
+    movu         m2, [accq+lenq*4]
+    movu         m3, [accq+lenq*4+mmsize]
+    paddd        m0, m2
+    paddd        m1, m3
+    movu [accq+lenq*4], m0
+    movu [accq+lenq*4+mmsize], m1
+    add        lenq, mmsize/2
+    jl .loop
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; void ff_mix_pack_s16(int16_t *dst, const int32_t *acc, int shift, int len)
+;------------------------------------------------------------------------------
+
+%macro PACK_S16 0
+cglobal mix_pack_s16, 4,4,4, dst, acc, shift, len
+    movd        xm3, shiftd
+    pcmpeqd      m2, m2
+    psrld        m2, 31
+    pslld        m2, xm3
+    psrld        m2, 1              ; (1 << shift) >> 1
+    movsxdifnidn lenq, lend
+    lea        dstq, [dstq+lenq*2]
+    lea        accq, [accq+lenq*4]
+    neg        lenq
+.loop:
+    movu         m0, [accq+lenq*4]
+    movu         m1, [accq+lenq*4+mmsize]
+    paddd        m0, m2
+    paddd        m1, m2
+    psrad        m0, xm3
+    psrad        m1, xm3
+    packssdw     m0, m1
+%if cpuflag(avx2)
+    vpermq       m0, m0, 0xD8
+%endif
+    movu [dstq+lenq*2], m0
+    add        lenq, mmsize/2
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+MIX_S16
+PACK_S16
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+MIX_S16
+PACK_S16
+%endif
@@ -0,0 +1,58 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/mixdsp.h"
+
+void ff_mix_s16_sse2(int32_t *acc, const int16_t *src, int gain, int len);
+void ff_mix_s16_avx2(int32_t *acc, const int16_t *src, int gain, int len);
+void ff_mix_pack_s16_sse2(int16_t *dst, const int32_t *acc, int shift, int len);
+void ff_mix_pack_s16_avx2(int16_t *dst, const int32_t *acc, int shift, int len);
+
+#if HAVE_YASM
+#define MIX_FUNC(name, opt, step, type0, type1)                                 \
+static void name ## _ ## opt(type0 *dst, const type1 *src, int arg, int len)    \
+{                                                                               \
+    FF_SIMD_WITH_C_TAIL(len, step, ff_ ## name ## _ ## opt(dst, src, arg, x),   \
+                        ff_ ## name ## _c(dst + x, src + x, arg, len - x));     \
+}
+
+MIX_FUNC(mix_s16,      sse2,  8, int32_t, int16_t)
+MIX_FUNC(mix_s16,      avx2, 16, int32_t, int16_t)
+MIX_FUNC(mix_pack_s16, sse2,  8, int16_t, int32_t)
+MIX_FUNC(mix_pack_s16, avx2, 16, int16_t, int32_t)
+#endif /* HAVE_YASM */
+
+av_cold void ff_mixdsp_init_x86(MixDSPContext *dsp)
+{
+#if HAVE_YASM
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        dsp->mix_s16  = mix_s16_sse2;
+        dsp->pack_s16 = mix_pack_s16_sse2;
+    }
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        dsp->mix_s16  = mix_s16_avx2;
+        dsp->pack_s16 = mix_pack_s16_avx2;
+    }
+#endif /* HAVE_YASM */
+}
@@ -0,0 +1,191 @@
+;*****************************************************************************
+;* x86-optimized functions for the ssim filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+ssim_c1: times 4 dd 416    ; (int)(.01 * .01 * 255 * 255 * 64 + .5)
+ssim_c2: times 4 dd 235963 ; (int)(.03 * .03 * 255 * 255 * 64 * 63 + .5)
+
+SECTION .text
+
+; Both functions process w blocks, w being a multiple of the number of blocks
+; handled per loop iteration. Tails are left to the C versions.
+
+;------------------------------------------------------------------------------
+; void ff_ssim_4x4_line(const uint8_t *main, ptrdiff_t main_stride,
+;                       const uint8_t *ref, ptrdiff_t ref_stride,
+;                       int (*sums)[4], int w)
+;------------------------------------------------------------------------------
+
+%macro LOAD_ROW 4 ; dst_main, dst_ref, main offset, ref offset
+%if cpuflag(avx2)
+    pmovzxbw    m%1, [mainq+%3]
+    pmovzxbw    m%2, [refq+%4]
+%else
+    movh        m%1, [mainq+%3]
+    movh        m%2, [refq+%4]
+    punpcklbw   m%1, m7
+    punpcklbw   m%2, m7
+%endif
+%endmacro
+
+; m2/m3: sum of the main/ref words, m4: sum of squares, m5: sum of products
+%macro ACCUM_ROW 2 ; main offset, ref offset
+    LOAD_ROW         0, 1, %1, %2
+    paddw           m2, m0
+    paddw           m3, m1
+    pmaddwd         m6, m0, m0
+    paddd           m4, m6
+    pmaddwd         m6, m1, m1
+    paddd           m4, m6
+    pmaddwd         m0, m1
+    paddd           m5, m0
+%endmacro
+
+%macro SSIM_4X4_LINE 0
+cglobal ssim_4x4_line, 6,8,8, main, main_stride, ref, ref_stride, sums, w, main_stride3, ref_stride3
+    movsxdifnidn wq, wd
+    lea  main_stride3q, [main_strideq*3]
+    lea   ref_stride3q, [ref_strideq*3]
+    pxor            m7, m7
+.loop:
+    LOAD_ROW         2, 3, 0, 0
+    pmaddwd         m4, m2, m2
+    pmaddwd         m6, m3, m3
+    pmaddwd         m5, m2, m3
+    paddd           m4, m6
+    ACCUM_ROW       main_strideq,   ref_strideq
+    ACCUM_ROW       main_strideq*2, ref_strideq*2
+    ACCUM_ROW       main_stride3q,  ref_stride3q
+    ; reduce the word sums to dwords, each block is then the sum of two
+    ; consecutive dwords of each of m2, m3, m4 and m5
+    pcmpeqw         m6, m6
+    psrlw           m6, 15
+    pmaddwd         m2, m6
+    pmaddwd         m3, m6
+    punpckhdq       m0, m2, m3
+    punpckldq       m2, m3
+    punpckhdq       m1, m4, m5
+    punpckldq       m4, m5
+    punpckhqdq      m3, m2, m4
+    punpcklqdq      m2, m4
+    paddd           m2, m3          ; block 0 (and 2 in the high lane)
+    punpckhqdq      m3, m0, m1
+    punpcklqdq      m0, m1
+    paddd           m0, m3          ; block 1 (and 3 in the high lane)
+%if cpuflag(avx2)
+    vperm2i128      m1, m2, m0, 0x20
+    vperm2i128      m2, m2, m0, 0x31
+    movu   [sumsq],        m1
+    movu   [sumsq+mmsize], m2
+%else
+    movu   [sumsq],        m2
+    movu   [sumsq+mmsize], m0
+%endif
+    add          mainq, mmsize/2
+    add           refq, mmsize/2
+    add          sumsq, mmsize*2
+    sub             wq, mmsize/8
+    jg .loop
+    RET
+%endmacro
+
+%if ARCH_X86_64
+INIT_XMM sse2
+SSIM_4X4_LINE
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+SSIM_4X4_LINE
+%endif
+%endif
+
+;------------------------------------------------------------------------------
+; float ff_ssim_end_line(const int (*sum0)[4], const int (*sum1)[4], int w)
+;------------------------------------------------------------------------------
+
+INIT_XMM sse2
+cglobal ssim_end_line, 3,3,8, sum0, sum1, w
+    xorps           m7, m7
+.loop:
+    ; statistics of the 8x8 blocks 0-3, one block per register
+    movu            m0, [sum0q+ 0]
+    movu            m1, [sum0q+16]
+    movu            m2, [sum0q+32]
+    movu            m3, [sum0q+48]
+    movu            m4, [sum0q+64]
+    movu            m5, [sum1q+ 0]
+    paddd           m0, m5
+    movu            m5, [sum1q+16]
+    paddd           m1, m5
+    movu            m5, [sum1q+32]
+    paddd           m2, m5
+    movu            m5, [sum1q+48]
+    paddd           m3, m5
+    movu            m5, [sum1q+64]
+    paddd           m4, m5
+    paddd           m0, m1
+    paddd           m1, m2
+    paddd           m2, m3
+    paddd           m3, m4
+    TRANSPOSE4x4D    0, 1, 2, 3, 4  ; m0: s1, m1: s2, m2: ss, m3: s12
+
+    ; s1 and s2 are below 2^15, so pmaddwd gives the full 32 bits products
+    pmaddwd         m4, m0, m1      ; s1 * s2
+    pmaddwd         m0, m0          ; s1 * s1
+    pmaddwd         m1, m1          ; s2 * s2
+    paddd           m0, m1          ; s1 * s1 + s2 * s2
+    pslld           m2, 6
+    pslld           m3, 6
+    psubd           m2, m0          ; vars
+    psubd           m3, m4          ; covar
+    pslld           m4, 1
+    pslld           m3, 1
+    mova            m5, [ssim_c1]
+    mova            m6, [ssim_c2]
+    paddd           m4, m5          ; 2 * s1 * s2 + c1
+    paddd           m0, m5          ; s1 * s1 + s2 * s2 + c1
+    paddd           m3, m6          ; 2 * covar + c2
+    paddd           m2, m6          ; vars + c2
+    cvtdq2ps        m4, m4
+    cvtdq2ps        m3, m3
+    cvtdq2ps        m0, m0
+    cvtdq2ps        m2, m2
+    mulps           m4, m3
+    mulps           m0, m2
+    divps           m4, m0
+    addps           m7, m4
+
+    add          sum0q, 64
+    add          sum1q, 64
+    sub             wd, 4
+    jg .loop
+
+    ; (ssim[0] + ssim[2]) + (ssim[1] + ssim[3]), like the C version
+    movhlps         m0, m7
+    addps           m0, m7
+    pshufd          m1, m0, 1
+    addss           m0, m1
+%if ARCH_X86_64 == 0
+    movss         r0m, m0
+    fld     dword r0m
+%endif
+    RET
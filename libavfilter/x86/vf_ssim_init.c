@@ -0,0 +1,77 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vf_ssim.h"
+
+void ff_ssim_4x4_line_sse2(const uint8_t *main, ptrdiff_t main_stride,
+                           const uint8_t *ref, ptrdiff_t ref_stride,
+                           int (*sums)[4], int w);
+void ff_ssim_4x4_line_avx2(const uint8_t *main, ptrdiff_t main_stride,
+                           const uint8_t *ref, ptrdiff_t ref_stride,
+                           int (*sums)[4], int w);
+float ff_ssim_end_line_sse2(const int (*sum0)[4], const int (*sum1)[4], int w);
+
+#if HAVE_YASM
+#define SSIM_4X4_LINE_FUNC(opt, step)                                           \
+static void ssim_4x4_line_ ## opt(const uint8_t *main, ptrdiff_t main_stride,   \
+                                  const uint8_t *ref, ptrdiff_t ref_stride,     \
+                                  int (*sums)[4], int w)                        \
+{                                                                               \
+    FF_SIMD_WITH_C_TAIL(w, step,                                                \
+                        ff_ssim_4x4_line_ ## opt(main, main_stride, ref,        \
+                                                 ref_stride, sums, x),          \
+                        ff_ssim_4x4_line_c(main + 4 * x, main_stride,           \
+                                           ref + 4 * x, ref_stride,             \
+                                           sums + x, w - x));                   \
+}
+
+#if ARCH_X86_64
+SSIM_4X4_LINE_FUNC(sse2, 2)
+SSIM_4X4_LINE_FUNC(avx2, 4)
+#endif
+
+static float ssim_end_line_sse2(const int (*sum0)[4], const int (*sum1)[4], int w)
+{
+    float ssim = 0.0f;
+    FF_SIMD_WITH_C_TAIL(w, 4, ssim  = ff_ssim_end_line_sse2(sum0, sum1, x),
+                              ssim += ff_ssim_end_line_c(sum0 + x, sum1 + x, w - x));
+    return ssim;
+}
+#endif /* HAVE_YASM */
+
+av_cold void ff_ssim_init_x86(SSIMDSPContext *dsp)
+{
+#if HAVE_YASM
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+#if ARCH_X86_64
+        dsp->ssim_4x4_line = ssim_4x4_line_sse2;
+#endif
+        dsp->ssim_end_line = ssim_end_line_sse2;
+    }
+#if ARCH_X86_64
+    if (EXTERNAL_AVX2(cpu_flags))
+        dsp->ssim_4x4_line = ssim_4x4_line_avx2;
+#endif
+#endif /* HAVE_YASM */
+}
@@ -36,6 +36,7 @@
 #include "libavutil/mathematics.h"
 #include "libavutil/parseutils.h"
 #include "libavutil/time.h"
+#include "libavutil/trace.h"
 #include "riff.h"
 #include "audiointerleave.h"
 #include "url.h"
@@ -509,6 +510,7 @@ static int compute_pkt_fields2(AVFormatContext *s, AVStream *st, AVPacket *pkt)
 static int write_packet(AVFormatContext *s, AVPacket *pkt)
 {
     int ret, did_split;
+    int64_t trace_start;
 
     if (s->avoid_negative_ts > 0) {
         AVStream *st = s->streams[pkt->stream_index];
@@ -536,7 +538,9 @@ static int write_packet(AVFormatContext *s, AVPacket *pkt)
     }
 
     did_split = av_packet_split_side_data(pkt);
+    trace_start = av_trace_begin(AV_TRACE_FORMAT);
     ret = s->oformat->write_packet(s, pkt);
+    av_trace_end(AV_TRACE_FORMAT, s->oformat->name, trace_start);
 
     if (s->flush_packets && s->pb && ret >= 0 && s->flags & AVFMT_FLAG_FLUSH_PACKETS)
         avio_flush(s->pb);
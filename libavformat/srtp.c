@@ -41,14 +41,8 @@ void ff_srtp_free(struct SRTPContext *s)
 static void encrypt_counter(struct AVAES *aes, uint8_t *iv, uint8_t *outbuf,
                             int outlen)
 {
-    int i, j, outpos;
-    for (i = 0, outpos = 0; outpos < outlen; i++) {
-        uint8_t keystream[16];
-        AV_WB16(&iv[14], i);
-        av_aes_crypt(aes, keystream, iv, 1, NULL, 0);
-        for (j = 0; j < 16 && outpos < outlen; j++, outpos++)
-            outbuf[outpos] ^= keystream[j];
-    }
+    AV_WB16(&iv[14], 0);
+    av_aes_ctr_crypt(aes, outbuf, outbuf, outlen, iv);
 }
 
 static void derive_key(struct AVAES *aes, const uint8_t *salt, int label,
@@ -39,6 +39,7 @@
 #include "libavutil/parseutils.h"
 #include "libavutil/time.h"
 #include "libavutil/timestamp.h"
+#include "libavutil/trace.h"
 #include "riff.h"
 #include "audiointerleave.h"
 #include "url.h"
@@ -719,6 +720,7 @@ static int update_wrap_reference(AVFormatContext *s, AVStream *st, int stream_in
 int ff_read_packet(AVFormatContext *s, AVPacket *pkt)
 {
     int ret, i, err;
+    int64_t trace_start;
     AVStream *st;
 
     for(;;){
@@ -742,7 +744,9 @@ int ff_read_packet(AVFormatContext *s, AVPacket *pkt)
         pkt->data = NULL;
         pkt->size = 0;
         av_init_packet(pkt);
+        trace_start = av_trace_begin(AV_TRACE_FORMAT);
         ret= s->iformat->read_packet(s, pkt);
+        av_trace_end(AV_TRACE_FORMAT, s->iformat->name, trace_start);
         if (ret < 0) {
             if (!pktl || ret == AVERROR(EAGAIN))
                 return ret;
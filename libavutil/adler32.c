@@ -35,6 +35,10 @@
 #include "common.h"
 #include "intreadwrite.h"
 
+#if ARCH_X86
+#include "x86/adler32.h"
+#endif
+
 #define BASE 65521L /* largest prime smaller than 65536 */
 
 #define DO1(buf)  { s1 += *buf++; s2 += s1; }
@@ -44,9 +48,18 @@
 unsigned long av_adler32_update(unsigned long adler, const uint8_t * buf,
                                 unsigned int len)
 {
-    unsigned long s1 = adler & 0xffff;
-    unsigned long s2 = adler >> 16;
+    unsigned long s1, s2;
+
+#if ARCH_X86 && HAVE_SSSE3_EXTERNAL
+    if (len >= 64) {
+        unsigned done = ff_adler32_update_x86(&adler, buf, len);
+        buf += done;
+        len -= done;
+    }
+#endif
 
+    s1 = adler & 0xffff;
+    s2 = adler >> 16;
     while (len > 0) {
 #if HAVE_FAST_64BIT && HAVE_FAST_UNALIGNED && !CONFIG_SMALL
         unsigned len2 = FFMIN((len-1) & ~7, 23*8);
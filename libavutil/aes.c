@@ -20,25 +20,12 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "config.h"
 #include "common.h"
 #include "aes.h"
+#include "aes_internal.h"
 #include "intreadwrite.h"
 
-typedef union {
-    uint64_t u64[2];
-    uint32_t u32[4];
-    uint8_t u8x4[4][4];
-    uint8_t u8[16];
-} av_aes_block;
-
-typedef struct AVAES {
-    // Note: round_key[16] is accessed in the init code, but this only
-    // overwrites state, which does not matter (see also commit ba554c0).
-    av_aes_block round_key[15];
-    av_aes_block state[2];
-    int rounds;
-} AVAES;
-
 const int av_aes_size= sizeof(AVAES);
 
 struct AVAES *av_aes_alloc(void)
@@ -139,8 +126,8 @@ static inline void crypt(AVAES *a, int s, const uint8_t *sbox,
     subshift(&a->state[0], s, sbox);
 }
 
-void av_aes_crypt(AVAES *a, uint8_t *dst, const uint8_t *src,
-                  int count, uint8_t *iv, int decrypt)
+static void aes_crypt(AVAES *a, uint8_t *dst, const uint8_t *src,
+                      int count, uint8_t *iv, int decrypt)
 {
     while (count--) {
         addkey_s(&a->state[1], src, &a->round_key[a->rounds]);
@@ -164,6 +151,59 @@ void av_aes_crypt(AVAES *a, uint8_t *dst, const uint8_t *src,
     }
 }
 
+void av_aes_crypt(AVAES *a, uint8_t *dst, const uint8_t *src,
+                  int count, uint8_t *iv, int decrypt)
+{
+    a->crypt(a, dst, src, count, iv, decrypt);
+}
+
+static void increment_counter(uint8_t *counter)
+{
+    int i;
+
+    for (i = 15; i >= 0 && !++counter[i]; i--)
+        ;
+}
+
+#define CTR_BLOCKS 16
+
+static void aes_ctr(AVAES *a, uint8_t *dst, const uint8_t *src,
+                    int count, uint8_t *counter)
+{
+    uint8_t keystream[CTR_BLOCKS * 16];
+
+    while (count > 0) {
+        int i, blocks = FFMIN(count, CTR_BLOCKS);
+
+        for (i = 0; i < blocks; i++) {
+            memcpy(keystream + 16 * i, counter, 16);
+            increment_counter(counter);
+        }
+        a->crypt(a, keystream, keystream, blocks, NULL, 0);
+        for (i = 0; i < blocks * 16; i++)
+            dst[i] = src[i] ^ keystream[i];
+        src   += blocks * 16;
+        dst   += blocks * 16;
+        count -= blocks;
+    }
+}
+
+void av_aes_ctr_crypt(AVAES *a, uint8_t *dst, const uint8_t *src,
+                      int size, uint8_t *counter)
+{
+    if (size >= 16)
+        a->ctr(a, dst, src, size >> 4, counter);
+    if (size & 15) {
+        uint8_t keystream[16];
+        int i;
+
+        a->crypt(a, keystream, counter, 1, NULL, 0);
+        increment_counter(counter);
+        for (i = 0; i < (size & 15); i++)
+            dst[(size & ~15) + i] = src[(size & ~15) + i] ^ keystream[i];
+    }
+}
+
 static void init_multbl2(uint32_t tbl[][256], const int c[4],
                          const uint8_t *log8, const uint8_t *alog8,
                          const uint8_t *sbox)
@@ -225,6 +265,10 @@ int av_aes_init(AVAES *a, const uint8_t *key, int key_bits, int decrypt)
         return -1;
 
     a->rounds = rounds;
+    a->crypt  = aes_crypt;
+    a->ctr    = aes_ctr;
+    if (ARCH_X86)
+        ff_aes_init_x86(a, decrypt);
 
     memcpy(tk, key, KC * 4);
     memcpy(a->round_key[0].u8, key, KC * 4);
@@ -266,6 +310,7 @@ int av_aes_init(AVAES *a, const uint8_t *key, int key_bits, int decrypt)
 #ifdef TEST
 // LCOV_EXCL_START
 #include <string.h>
+#include "cpu.h"
 #include "lfg.h"
 #include "log.h"
 
@@ -306,6 +351,92 @@ int main(int argc, char **argv)
         }
     }
 
+    /* the optimized versions against the C one, for all the key sizes and
+     * modes, with a number of blocks around their block counts, in place */
+    {
+        AVAES ref, opt;
+        AVLFG prng;
+        uint8_t key[32], iv[2][16], buf[2][16 * 9];
+        int bits, count, decrypt, cbc;
+
+        av_lfg_init(&prng, 2);
+        for (i = 0; i < sizeof(key); i++)
+            key[i] = av_lfg_get(&prng);
+        for (bits = 128; bits <= 256; bits += 64)
+            for (decrypt = 0; decrypt < 2; decrypt++)
+                for (cbc = 0; cbc < 2; cbc++)
+                    for (count = 1; count <= 9; count++) {
+                        av_force_cpu_flags(0);
+                        av_aes_init(&ref, key, bits, decrypt);
+                        av_force_cpu_flags(-1);
+                        av_aes_init(&opt, key, bits, decrypt);
+                        for (j = 0; j < sizeof(buf[0]); j++)
+                            buf[0][j] = buf[1][j] = av_lfg_get(&prng);
+                        for (j = 0; j < 16; j++)
+                            iv[0][j] = iv[1][j] = av_lfg_get(&prng);
+                        av_aes_crypt(&ref, buf[0], buf[0], count,
+                                     cbc ? iv[0] : NULL, decrypt);
+                        av_aes_crypt(&opt, buf[1], buf[1], count,
+                                     cbc ? iv[1] : NULL, decrypt);
+                        if (memcmp(buf[0], buf[1], sizeof(buf[0])) ||
+                            memcmp(iv[0], iv[1], sizeof(iv[0]))) {
+                            av_log(NULL, AV_LOG_ERROR,
+                                   "mismatch: %d bits, %d blocks, decrypt %d, cbc %d\n",
+                                   bits, count, decrypt, cbc);
+                            err = 1;
+                        }
+                    }
+    }
+
+    /* CTR, F.5.1 of NIST SP 800-38A, then the optimized version against the
+     * C one with partial blocks and a counter carrying over 64 bits */
+    {
+        static const uint8_t key[16] = {
+            0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+            0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+        };
+        static const uint8_t ctr_pt[16] = {
+            0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+            0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a
+        };
+        static const uint8_t ctr_ct[16] = {
+            0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26,
+            0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce
+        };
+        AVAES ref, opt;
+        AVLFG prng;
+        uint8_t ctr[2][16], buf[2][16 * 9 + 15];
+        int size;
+
+        for (j = 0; j < 16; j++)
+            ctr[0][j] = 0xf0 + j;
+        av_aes_init(&opt, key, 128, 0);
+        av_aes_ctr_crypt(&opt, temp, ctr_pt, 16, ctr[0]);
+        if (memcmp(temp, ctr_ct, 16) || ctr[0][15] != 0x00 || ctr[0][14] != 0xff) {
+            av_log(NULL, AV_LOG_ERROR, "CTR test vector mismatch\n");
+            err = 1;
+        }
+
+        av_lfg_init(&prng, 3);
+        av_force_cpu_flags(0);
+        av_aes_init(&ref, key, 128, 0);
+        av_force_cpu_flags(-1);
+        for (size = 1; size <= sizeof(buf[0]); size++) {
+            for (j = 0; j < sizeof(buf[0]); j++)
+                buf[0][j] = buf[1][j] = av_lfg_get(&prng);
+            for (j = 0; j < 16; j++)
+                ctr[0][j] = ctr[1][j] = j < 8  ? av_lfg_get(&prng) :
+                                         j < 15 ? 0xff : 0xf8 + (size & 7);
+            av_aes_ctr_crypt(&ref, buf[0], buf[0], size, ctr[0]);
+            av_aes_ctr_crypt(&opt, buf[1], buf[1], size, ctr[1]);
+            if (memcmp(buf[0], buf[1], sizeof(buf[0])) ||
+                memcmp(ctr[0], ctr[1], sizeof(ctr[0]))) {
+                av_log(NULL, AV_LOG_ERROR, "CTR mismatch: %d bytes\n", size);
+                err = 1;
+            }
+        }
+    }
+
     if (argc > 1 && !strcmp(argv[1], "-t")) {
         AVAES ae, ad;
         AVLFG prng;
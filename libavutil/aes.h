@@ -58,6 +58,17 @@ int av_aes_init(struct AVAES *a, const uint8_t *key, int key_bits, int decrypt);
  */
 void av_aes_crypt(struct AVAES *a, uint8_t *dst, const uint8_t *src, int count, uint8_t *iv, int decrypt);
 
+/**
+ * Encrypt or decrypt a buffer in CTR mode, using a context initialized for
+ * encryption.
+ * @param size number of bytes, need not be a multiple of 16
+ * @param dst destination array, can be equal to src
+ * @param src source array, can be equal to dst
+ * @param counter 16 byte big-endian counter block, incremented once for
+ *                every block, including a final partial one
+ */
+void av_aes_ctr_crypt(struct AVAES *a, uint8_t *dst, const uint8_t *src, int size, uint8_t *counter);
+
 /**
  * @}
  */
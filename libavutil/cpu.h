@@ -51,6 +51,10 @@
 // #define AV_CPU_FLAG_CMOV         0x1000 ///< supports cmov instruction
 // #endif
 #define AV_CPU_FLAG_AVX2         0x8000 ///< AVX2 functions: requires OS support even if YMM registers aren't used
+#define AV_CPU_FLAG_FMA3        0x10000 ///< Haswell FMA3 functions
+#define AV_CPU_FLAG_AESNI       0x80000 ///< Westmere AES-NI instructions
+#define AV_CPU_FLAG_PCLMUL     0x100000 ///< Westmere carry-less multiplication (PCLMULQDQ)
+#define AV_CPU_FLAG_SHANI      0x200000 ///< Goldmont/Zen SHA-1 and SHA-256 extensions
 
 #define AV_CPU_FLAG_ALTIVEC      0x0001 ///< standard
 
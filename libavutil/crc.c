@@ -22,6 +22,11 @@
 #include "common.h"
 #include "bswap.h"
 #include "crc.h"
+#include "intreadwrite.h"
+
+#if ARCH_X86
+#include "x86/crc.h"
+#endif
 
 #if CONFIG_HARDCODED_TABLES
 static const AVCRC av_crc_table[AV_CRC_MAX][257] = {
@@ -253,7 +258,7 @@ static const AVCRC av_crc_table[AV_CRC_MAX][257] = {
 #if CONFIG_SMALL
 #define CRC_TABLE_SIZE 257
 #else
-#define CRC_TABLE_SIZE 1024
+#define CRC_TABLE_SIZE 2048
 #endif
 static struct {
     uint8_t  le;
@@ -270,16 +275,21 @@ static struct {
 static AVCRC av_crc_table[AV_CRC_MAX][CRC_TABLE_SIZE];
 #endif
 
-int av_crc_init(AVCRC *ctx, int le, int bits, uint32_t poly, int ctx_size)
+#if ARCH_X86 && HAVE_PCLMUL_EXTERNAL && !CONFIG_SMALL && !CONFIG_HARDCODED_TABLES
+#define CRC_FOLD 1
+static CRCFold crc_fold[AV_CRC_MAX];
+#else
+#define CRC_FOLD 0
+#endif
+
+/* The tables after the first one give the CRC of a byte followed by
+ * 1 to 7 zero bytes, for slicing by 4 with the 1024 entries of the tables
+ * initialized by the user and by 8 with the 2048 of the standard ones. */
+static int crc_init(AVCRC *ctx, int le, int bits, uint32_t poly, int nb_tables)
 {
     unsigned i, j;
     uint32_t c;
 
-    if (bits < 8 || bits > 32 || poly >= (1LL << bits))
-        return -1;
-    if (ctx_size != sizeof(AVCRC) * 257 && ctx_size != sizeof(AVCRC) * 1024)
-        return -1;
-
     for (i = 0; i < 256; i++) {
         if (le) {
             for (c = i, j = 0; j < 8; j++)
@@ -293,35 +303,100 @@ int av_crc_init(AVCRC *ctx, int le, int bits, uint32_t poly, int ctx_size)
     }
     ctx[256] = 1;
 #if !CONFIG_SMALL
-    if (ctx_size >= sizeof(AVCRC) * 1024)
-        for (i = 0; i < 256; i++)
-            for (j = 0; j < 3; j++)
-                ctx[256 *(j + 1) + i] =
-                    (ctx[256 * j + i] >> 8) ^ ctx[ctx[256 * j + i] & 0xFF];
+    for (i = 0; i < 256; i++)
+        for (j = 0; j < nb_tables - 1; j++)
+            ctx[256 *(j + 1) + i] =
+                (ctx[256 * j + i] >> 8) ^ ctx[ctx[256 * j + i] & 0xFF];
 #endif
 
     return 0;
 }
 
+int av_crc_init(AVCRC *ctx, int le, int bits, uint32_t poly, int ctx_size)
+{
+    if (bits < 8 || bits > 32 || poly >= (1LL << bits))
+        return -1;
+    if (ctx_size != sizeof(AVCRC) * 257 && ctx_size != sizeof(AVCRC) * 1024)
+        return -1;
+
+    return crc_init(ctx, le, bits, poly, ctx_size / (sizeof(AVCRC) * 256));
+}
+
 const AVCRC *av_crc_get_table(AVCRCId crc_id)
 {
 #if !CONFIG_HARDCODED_TABLES
     if (!av_crc_table[crc_id][FF_ARRAY_ELEMS(av_crc_table[crc_id]) - 1])
-        if (av_crc_init(av_crc_table[crc_id],
-                        av_crc_table_params[crc_id].le,
-                        av_crc_table_params[crc_id].bits,
-                        av_crc_table_params[crc_id].poly,
-                        sizeof(av_crc_table[crc_id])) < 0)
+        if (crc_init(av_crc_table[crc_id],
+                     av_crc_table_params[crc_id].le,
+                     av_crc_table_params[crc_id].bits,
+                     av_crc_table_params[crc_id].poly,
+                     CRC_TABLE_SIZE / 256) < 0)
             return NULL;
+#if CRC_FOLD
+    if (!crc_fold[crc_id].init)
+        ff_crc_fold_init_x86(&crc_fold[crc_id],
+                             av_crc_table_params[crc_id].le,
+                             av_crc_table_params[crc_id].bits,
+                             av_crc_table_params[crc_id].poly);
+#endif
 #endif
     return av_crc_table[crc_id];
 }
 
+#if !CONFIG_SMALL && !CONFIG_HARDCODED_TABLES
+/* The standard tables, sliced by 8 and folded with PCLMULQDQ */
+static uint32_t crc_standard(const AVCRC *ctx, uint32_t crc,
+                             const uint8_t *buffer, size_t length)
+{
+    const uint8_t *end = buffer + length;
+
+#if CRC_FOLD
+    int id = (ctx - av_crc_table[0]) / CRC_TABLE_SIZE;
+    uint8_t rem[16];
+    size_t folded;
+
+    if (length >= 128 &&
+        (folded = ff_crc_fold_x86(&crc_fold[id], crc, buffer, length, rem))) {
+        buffer += folded;
+        crc = 0;
+        for (length = 0; length < 16; length++)
+            crc = ctx[((uint8_t) crc) ^ rem[length]] ^ (crc >> 8);
+    }
+#endif
+
+    while (((intptr_t) buffer & 7) && buffer < end)
+        crc = ctx[((uint8_t) crc) ^ *buffer++] ^ (crc >> 8);
+
+    while (end - buffer >= 8) {
+        uint32_t a = crc ^ AV_RL32(buffer);
+        uint32_t b = AV_RL32(buffer + 4);
+        buffer += 8;
+        crc = ctx[7 * 256 + ( a        & 0xFF)] ^
+              ctx[6 * 256 + ((a >> 8 ) & 0xFF)] ^
+              ctx[5 * 256 + ((a >> 16) & 0xFF)] ^
+              ctx[4 * 256 + ( a >> 24        )] ^
+              ctx[3 * 256 + ( b        & 0xFF)] ^
+              ctx[2 * 256 + ((b >> 8 ) & 0xFF)] ^
+              ctx[1 * 256 + ((b >> 16) & 0xFF)] ^
+              ctx[0 * 256 + ( b >> 24        )];
+    }
+
+    while (buffer < end)
+        crc = ctx[((uint8_t) crc) ^ *buffer++] ^ (crc >> 8);
+
+    return crc;
+}
+#endif
+
 uint32_t av_crc(const AVCRC *ctx, uint32_t crc,
                 const uint8_t *buffer, size_t length)
 {
     const uint8_t *end = buffer + length;
 
+#if !CONFIG_SMALL && !CONFIG_HARDCODED_TABLES
+    if (ctx >= av_crc_table[0] && ctx < av_crc_table[AV_CRC_MAX])
+        return crc_standard(ctx, crc, buffer, length);
+#endif
 #if !CONFIG_SMALL
     if (!ctx[256]) {
         while (((intptr_t) buffer & 3) && buffer < end)
@@ -343,10 +418,20 @@ uint32_t av_crc(const AVCRC *ctx, uint32_t crc,
 }
 
 #ifdef TEST
+#include "cpu.h"
+
+static uint32_t crc_bytewise(const AVCRC *ctx, uint32_t crc,
+                             const uint8_t *buffer, size_t length)
+{
+    while (length--)
+        crc = ctx[((uint8_t) crc) ^ *buffer++] ^ (crc >> 8);
+    return crc;
+}
+
 int main(void)
 {
     uint8_t buf[1999];
-    int i;
+    int i, j, k, ret = 0;
     int p[5][3] = { { AV_CRC_32_IEEE_LE, 0xEDB88320, 0x3D5CDD04 },
                     { AV_CRC_32_IEEE   , 0x04C11DB7, 0xC0F5BAE0 },
                     { AV_CRC_24_IEEE   , 0x864CFB  , 0xB704CE   },
@@ -362,6 +447,25 @@ int main(void)
         ctx = av_crc_get_table(p[i][0]);
         printf("crc %08X = %X\n", p[i][1], av_crc(ctx, 0, buf, sizeof(buf)));
     }
-    return 0;
+
+    /* all the alignments and lengths around the block sizes of the
+     * optimized versions, with and without the SIMD ones */
+    for (k = 0; k < 2; k++) {
+        av_force_cpu_flags(k ? -1 : 0);
+        for (i = 0; i < 5; i++) {
+            ctx = av_crc_get_table(p[i][0]);
+            for (j = 0; j < 600; j++) {
+                int offset = j % 17, len = j * 3 % 400;
+                uint32_t ref = crc_bytewise(ctx, j * 0x9E3779B9, buf + offset, len);
+                uint32_t crc = av_crc(ctx, j * 0x9E3779B9, buf + offset, len);
+                if (crc != ref) {
+                    printf("crc %08X mismatch for length %d offset %d: %X != %X\n",
+                           p[i][1], len, offset, crc, ref);
+                    ret = 1;
+                }
+            }
+        }
+    }
+    return ret;
 }
 #endif
@@ -25,9 +25,21 @@
 #include "internal.h"
 #include "mem.h"
 
+/* Dictionaries with at least this many entries get a hash index of the
+ * keys, so that the lookups of exact keys do not scan all the entries */
+#define HASH_MIN_COUNT 16
+
 struct AVDictionary {
     int count;
     AVDictionaryEntry *elems;
+    int nb_allocated;       ///< allocated elements in elems and hash_next
+
+    /* hash index: the entries with a key hash h are chained from
+     * buckets[h & (nb_buckets - 1)] through hash_next, nb_buckets is 0 when
+     * there is no index */
+    int *buckets;
+    int *hash_next;
+    unsigned nb_buckets;
 };
 
 int av_dict_count(const AVDictionary *m)
@@ -35,10 +47,132 @@ int av_dict_count(const AVDictionary *m)
     return m ? m->count : 0;
 }
 
+/* Case insensitive, so that all the keys matching without
+ * AV_DICT_MATCH_CASE have the same hash */
+static unsigned hash_key(const char *key)
+{
+    unsigned h = 0;
+
+    while (*key)
+        h = h * 31 + av_toupper(*key++);
+    return h;
+}
+
+static void hash_insert(AVDictionary *m, int i)
+{
+    unsigned h = hash_key(m->elems[i].key) & (m->nb_buckets - 1);
+
+    m->hash_next[i] = m->buckets[h];
+    m->buckets[h]   = i;
+}
+
+static void hash_remove(AVDictionary *m, int i)
+{
+    int *p = &m->buckets[hash_key(m->elems[i].key) & (m->nb_buckets - 1)];
+
+    while (*p != i)
+        p = &m->hash_next[*p];
+    *p = m->hash_next[i];
+}
+
+static void hash_free(AVDictionary *m)
+{
+    av_freep(&m->buckets);
+    av_freep(&m->hash_next);
+    m->nb_buckets = 0;
+}
+
+/* (Re)build the index of the entries, a dictionary without index is still
+ * valid so this only drops the index if it fails */
+static void hash_build(AVDictionary *m, unsigned nb_buckets)
+{
+    int i;
+
+    av_freep(&m->buckets);
+    m->buckets   = av_malloc_array(nb_buckets, sizeof(*m->buckets));
+    if (!m->hash_next)
+        m->hash_next = av_malloc_array(m->nb_allocated, sizeof(*m->hash_next));
+    if (!m->buckets || !m->hash_next) {
+        hash_free(m);
+        return;
+    }
+
+    m->nb_buckets = nb_buckets;
+    memset(m->buckets, -1, nb_buckets * sizeof(*m->buckets));
+    for (i = 0; i < m->count; i++)
+        hash_insert(m, i);
+}
+
+/* Make room for one more entry */
+static int grow(AVDictionary *m)
+{
+    AVDictionaryEntry *tmp;
+    int nb_allocated;
+
+    if (m->count < m->nb_allocated)
+        return 0;
+
+    nb_allocated = FFMAX(4, 2 * m->nb_allocated);
+    tmp = av_realloc_array(m->elems, nb_allocated, sizeof(*m->elems));
+    if (!tmp)
+        return AVERROR(ENOMEM);
+    m->elems = tmp;
+    if (m->hash_next) {
+        int *next = av_realloc_array(m->hash_next, nb_allocated, sizeof(*next));
+        if (!next)
+            hash_free(m);
+        else
+            m->hash_next = next;
+    }
+    m->nb_allocated = nb_allocated;
+    return 0;
+}
+
+/* Append the entry set at elems[count] */
+static void append_entry(AVDictionary *m)
+{
+    int i = m->count++;
+
+    if (m->count > m->nb_buckets && m->count >= HASH_MIN_COUNT)
+        hash_build(m, FFMAX(2 * m->nb_buckets, 2 * HASH_MIN_COUNT));
+    else if (m->nb_buckets)
+        hash_insert(m, i);
+}
+
+/* Remove the entry i, moving the last entry in its place */
+static void remove_entry(AVDictionary *m, int i)
+{
+    int last = --m->count;
+
+    if (m->nb_buckets) {
+        hash_remove(m, i);
+        if (i != last)
+            hash_remove(m, last);
+    }
+    if (i != last) {
+        m->elems[i] = m->elems[last];
+        if (m->nb_buckets)
+            hash_insert(m, i);
+    }
+}
+
+static int key_match(const char *s, const char *key, int flags)
+{
+    unsigned int j;
+
+    if(flags & AV_DICT_MATCH_CASE) for(j=0;            s[j]  ==            key[j]  && key[j]; j++);
+    else                           for(j=0; av_toupper(s[j]) == av_toupper(key[j]) && key[j]; j++);
+    if(key[j])
+        return 0;
+    if(s[j] && !(flags & AV_DICT_IGNORE_SUFFIX))
+        return 0;
+    return 1;
+}
+
 AVDictionaryEntry *
 av_dict_get(AVDictionary *m, const char *key, const AVDictionaryEntry *prev, int flags)
 {
-    unsigned int i, j;
+    unsigned int i;
 
     if(!m)
         return NULL;
@@ -46,15 +180,20 @@ av_dict_get(AVDictionary *m, const char *key, const AVDictionaryEntry *prev, int
     if(prev) i= prev - m->elems + 1;
     else     i= 0;
 
+    /* the first matching entry after prev among the ones with the same
+     * hash, the chains are not sorted */
+    if (m->nb_buckets && !(flags & AV_DICT_IGNORE_SUFFIX)) {
+        int j, best = -1;
+
+        for (j = m->buckets[hash_key(key) & (m->nb_buckets - 1)]; j >= 0; j = m->hash_next[j])
+            if (j >= i && (best < 0 || j < best) && key_match(m->elems[j].key, key, flags))
+                best = j;
+        return best < 0 ? NULL : &m->elems[best];
+    }
+
     for(; i<m->count; i++){
-        const char *s= m->elems[i].key;
-        if(flags & AV_DICT_MATCH_CASE) for(j=0;            s[j]  ==            key[j]  && key[j]; j++);
-        else                           for(j=0; av_toupper(s[j]) == av_toupper(key[j]) && key[j]; j++);
-        if(key[j])
-            continue;
-        if(s[j] && !(flags & AV_DICT_IGNORE_SUFFIX))
-            continue;
-        return &m->elems[i];
+        if (key_match(m->elems[i].key, key, flags))
+            return &m->elems[i];
     }
     return NULL;
 }
@@ -67,28 +206,31 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value, int flags
 
     if(!m)
         m = *pm = av_mallocz(sizeof(*m));
+    if (!m)
+        return AVERROR(ENOMEM);
 
     if(tag) {
+        char *oldkey = tag->key;
         if (flags & AV_DICT_DONT_OVERWRITE)
             return 0;
         if (flags & AV_DICT_APPEND)
             oldval = tag->value;
         else
             av_free(tag->value);
-        av_free(tag->key);
-        *tag = m->elems[--m->count];
+        remove_entry(m, tag - m->elems);
+        av_free(oldkey);
     } else {
-        AVDictionaryEntry *tmp = av_realloc(m->elems, (m->count+1) * sizeof(*m->elems));
-        if(tmp) {
-            m->elems = tmp;
-        } else
-            return AVERROR(ENOMEM);
+        int ret = grow(m);
+        if (ret < 0)
+            return ret;
     }
     if (value) {
         if (flags & AV_DICT_DONT_STRDUP_KEY) {
             m->elems[m->count].key = (char*)(intptr_t)key;
         } else
             m->elems[m->count].key = av_strdup(key);
+        if (!m->elems[m->count].key)
+            return AVERROR(ENOMEM);
         if (flags & AV_DICT_DONT_STRDUP_VAL) {
             m->elems[m->count].value = (char*)(intptr_t)value;
         } else if (oldval && flags & AV_DICT_APPEND) {
@@ -102,10 +244,11 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value, int flags
             m->elems[m->count].value = newval;
         } else
             m->elems[m->count].value = av_strdup(value);
-        m->count++;
+        append_entry(m);
     }
     if (!m->count) {
         av_free(m->elems);
+        hash_free(m);
         av_freep(pm);
     }
 
@@ -169,6 +312,7 @@ void av_dict_free(AVDictionary **pm)
             av_free(m->elems[m->count].value);
         }
         av_free(m->elems);
+        hash_free(m);
     }
     av_freep(pm);
 }
@@ -180,3 +324,90 @@ void av_dict_copy(AVDictionary **dst, AVDictionary *src, int flags)
     while ((t = av_dict_get(src, "", t, AV_DICT_IGNORE_SUFFIX)))
         av_dict_set(dst, t->key, t->value, flags);
 }
+
+#ifdef TEST
+#include <stdio.h>
+
+#include "lfg.h"
+
+#define NB_KEYS 200
+
+/* The entries as kept by a plain array: a replaced or deleted entry is
+ * replaced by the last one, the new entries are appended */
+static char *model_keys[2 * NB_KEYS], *model_values[2 * NB_KEYS];
+static int model_count;
+
+static int check(AVDictionary *m, const char *op, int n)
+{
+    AVDictionaryEntry *t = NULL;
+    int i;
+
+    if (av_dict_count(m) != model_count) {
+        printf("%s %d: %d entries instead of %d\n", op, n, av_dict_count(m), model_count);
+        return 1;
+    }
+    for (i = 0; i < model_count; i++) {
+        t = av_dict_get(m, "", t, AV_DICT_IGNORE_SUFFIX);
+        if (!t || strcmp(t->key, model_keys[i]) || strcmp(t->value, model_values[i])) {
+            printf("%s %d: wrong entry %d\n", op, n, i);
+            return 1;
+        }
+        /* the lookup of each key must find its first entry */
+        if (av_dict_get(m, model_keys[i], NULL, AV_DICT_MATCH_CASE) != t) {
+            int j;
+            for (j = 0; j < i && strcmp(model_keys[j], model_keys[i]); j++)
+                ;
+            if (j == i) {
+                printf("%s %d: lookup of %s failed\n", op, n, model_keys[i]);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    AVDictionary *m = NULL;
+    AVLFG lfg;
+    char key[16], value[16];
+    int i, j, ret = 0;
+
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    for (i = 0; i < 10000 && !ret; i++) {
+        int k = av_lfg_get(&lfg) % NB_KEYS, del = !(av_lfg_get(&lfg) % 4);
+        int match_case = av_lfg_get(&lfg) & 1;
+
+        /* keys differing only by case, to match with and without case */
+        snprintf(key,   sizeof(key),   "%s%d", av_lfg_get(&lfg) & 1 ? "key" : "KEY", k);
+        snprintf(value, sizeof(value), "%d", i);
+
+        for (j = 0; j < model_count; j++)
+            if (match_case ? !strcmp(model_keys[j], key) : !av_strcasecmp(model_keys[j], key))
+                break;
+        if (j < model_count) {
+            av_free(model_keys[j]);
+            av_free(model_values[j]);
+            model_count--;
+            model_keys[j]   = model_keys[model_count];
+            model_values[j] = model_values[model_count];
+        }
+        if (!del) {
+            model_keys[model_count]   = av_strdup(key);
+            model_values[model_count] = av_strdup(value);
+            model_count++;
+        }
+
+        av_dict_set(&m, key, del ? NULL : value, match_case ? AV_DICT_MATCH_CASE : 0);
+        ret = check(m, del ? "delete" : "set", i);
+    }
+
+    av_dict_free(&m);
+    for (i = 0; i < model_count; i++) {
+        av_free(model_keys[i]);
+        av_free(model_values[i]);
+    }
+    return ret;
+}
+#endif
@@ -27,6 +27,7 @@
  */
 
 #include <float.h>
+#include <string.h>
 #include "attributes.h"
 #include "avutil.h"
 #include "common.h"
@@ -149,14 +150,22 @@ struct AVExpr {
         e_if, e_ifnot, e_print, e_bitand, e_bitor, e_between,
     } type;
     double value; // is sign in other types
+    int const_index; // index of the constant, or of the function in funcs1/funcs2
     union {
-        int const_index;
         double (*func0)(double);
         double (*func1)(void *, double);
         double (*func2)(void *, double, double);
     } a;
     struct AVExpr *param[3];
     double *var;
+
+    /* bytecode for av_expr_eval_batch(), only set in the root */
+    struct ExprInsn *insns;
+    int nb_insns;
+    int nb_regs;
+    double *regs;   ///< nb_regs batches of EXPR_BATCH values
+    int nb_consts;
+    double *consts; ///< the constant values of one evaluation
 };
 
 static double etime(double v)
@@ -168,7 +177,7 @@ static double eval_expr(Parser *p, AVExpr *e)
 {
     switch (e->type) {
         case e_value:  return e->value;
-        case e_const:  return e->value * p->const_values[e->a.const_index];
+        case e_const:  return e->value * p->const_values[e->const_index];
         case e_func0:  return e->value * e->a.func0(eval_expr(p, e->param[0]));
         case e_func1:  return e->value * e->a.func1(p->opaque, eval_expr(p, e->param[0]));
         case e_func2:  return e->value * e->a.func2(p->opaque, eval_expr(p, e->param[0]), eval_expr(p, e->param[1]));
@@ -307,6 +316,9 @@ void av_expr_free(AVExpr *e)
     av_expr_free(e->param[1]);
     av_expr_free(e->param[2]);
     av_freep(&e->var);
+    av_freep(&e->insns);
+    av_freep(&e->regs);
+    av_freep(&e->consts);
     av_freep(&e);
 }
 
@@ -334,7 +346,7 @@ static int parse_primary(AVExpr **e, Parser *p)
         if (strmatch(p->s, p->const_names[i])) {
             p->s+= strlen(p->const_names[i]);
             d->type = e_const;
-            d->a.const_index = i;
+            d->const_index = i;
             *e = d;
             return 0;
         }
@@ -440,6 +452,7 @@ static int parse_primary(AVExpr **e, Parser *p)
             if (strmatch(next, p->func1_names[i])) {
                 d->a.func1 = p->funcs1[i];
                 d->type = e_func1;
+                d->const_index = i;
                 *e = d;
                 return 0;
             }
@@ -449,6 +462,7 @@ static int parse_primary(AVExpr **e, Parser *p)
             if (strmatch(next, p->func2_names[i])) {
                 d->a.func2 = p->funcs2[i];
                 d->type = e_func2;
+                d->const_index = i;
                 *e = d;
                 return 0;
             }
@@ -638,6 +652,198 @@ static int verify_expr(AVExpr *e)
     }
 }
 
+/* Number of evaluations av_expr_eval_batch() runs each instruction on */
+#define EXPR_BATCH 64
+
+typedef struct ExprInsn {
+    int type;       ///< type of the AVExpr the instruction evaluates
+    int dst;        ///< register of the result
+    int src[3];     ///< registers of the parameters
+    double value;
+    int const_index;
+    union {
+        double (*func0)(double);
+        double (*func1)(void *, double);
+        double (*func2)(void *, double, double);
+    } a;
+} ExprInsn;
+
+/**
+ * Append the instructions evaluating e into register reg to the root
+ * expression. The parameters of e are evaluated into reg, reg + 1 and
+ * reg + 2, so the number of registers is bound by the depth of the tree.
+ *
+ * @return 0 on success, AVERROR(ENOSYS) if the expression cannot be
+ * evaluated in batches, AVERROR(ENOMEM) on allocation failure
+ */
+static int compile_expr(AVExpr *root, AVExpr *e, int reg)
+{
+    ExprInsn *insn;
+    int i, ret, nb_params = 0;
+
+    switch (e->type) {
+    /* the variables are shared by the successive evaluations and print()
+     * must log in order, these are only evaluated one at a time */
+    case e_ld: case e_st: case e_while: case e_taylor: case e_root:
+    case e_random: case e_print:
+        return AVERROR(ENOSYS);
+    case e_value: case e_const:
+        break;
+    case e_if: case e_ifnot: case e_between:
+        nb_params = 3;
+        break;
+    default:
+        nb_params = e->param[1] ? 2 : 1;
+        break;
+    }
+
+    for (i = 0; i < nb_params; i++) {
+        if (e->param[i]) {
+            if ((ret = compile_expr(root, e->param[i], reg + i)) < 0)
+                return ret;
+        } else {
+            /* the missing else branch of if() and ifnot() */
+            AVExpr zero = { .type = e_value };
+            if ((ret = compile_expr(root, &zero, reg + i)) < 0)
+                return ret;
+        }
+    }
+
+    insn = av_dynarray2_add((void **)&root->insns, &root->nb_insns,
+                            sizeof(*insn), NULL);
+    if (!insn)
+        return AVERROR(ENOMEM);
+    insn->type        = e->type;
+    insn->dst         = reg;
+    insn->value       = e->value;
+    insn->const_index = e->const_index;
+    for (i = 0; i < 3; i++)
+        insn->src[i] = reg + i;
+    switch (e->type) {
+    case e_func0: insn->a.func0 = e->a.func0; break;
+    case e_func1: insn->a.func1 = e->a.func1; break;
+    case e_func2: insn->a.func2 = e->a.func2; break;
+    }
+    root->nb_regs = FFMAX(root->nb_regs, reg + FFMAX(nb_params, 1));
+    return 0;
+}
+
+static int compile(AVExpr *e, int nb_consts)
+{
+    int ret;
+
+    e->nb_consts = nb_consts;
+    e->consts    = av_malloc_array(FFMAX(nb_consts, 1), sizeof(*e->consts));
+    if (!e->consts)
+        return AVERROR(ENOMEM);
+
+    if ((ret = compile_expr(e, e, 0)) < 0 ||
+        !(e->regs = av_malloc_array(e->nb_regs, EXPR_BATCH * sizeof(*e->regs)))) {
+        av_freep(&e->insns);
+        e->nb_insns = e->nb_regs = 0;
+        return ret == AVERROR(ENOSYS) ? 0 : AVERROR(ENOMEM);
+    }
+    return 0;
+}
+
+/* Evaluate the bytecode of e for n <= EXPR_BATCH evaluations, the varying
+ * constants start at offset in const_arrays */
+static void eval_insns(AVExpr *e, double *res, int n, int offset,
+                       const double *const_values,
+                       const double * const *const_arrays, void *opaque)
+{
+    int i, j;
+
+    for (i = 0; i < e->nb_insns; i++) {
+        const ExprInsn *insn = &e->insns[i];
+        double *dst = e->regs + insn->dst * EXPR_BATCH;
+        const double *s0 = e->regs + insn->src[0] * EXPR_BATCH;
+        const double *s1 = e->regs + insn->src[1] * EXPR_BATCH;
+        const double *s2 = e->regs + insn->src[2] * EXPR_BATCH;
+        double v = insn->value;
+
+#define UNARY(expr)                 \
+        for (j = 0; j < n; j++) {   \
+            double d = s0[j];       \
+            dst[j] = expr;          \
+        }                           \
+        break
+#define BINARY(expr)                \
+        for (j = 0; j < n; j++) {   \
+            double d = s0[j];       \
+            double d2 = s1[j];      \
+            dst[j] = expr;          \
+        }                           \
+        break
+
+        switch (insn->type) {
+        case e_value:
+            for (j = 0; j < n; j++)
+                dst[j] = v;
+            break;
+        case e_const:
+            if (const_arrays && const_arrays[insn->const_index]) {
+                const double *src = const_arrays[insn->const_index] + offset;
+                for (j = 0; j < n; j++)
+                    dst[j] = v * src[j];
+            } else {
+                double c = v * const_values[insn->const_index];
+                for (j = 0; j < n; j++)
+                    dst[j] = c;
+            }
+            break;
+        case e_if:
+            for (j = 0; j < n; j++)
+                dst[j] = v * (s0[j] ? s1[j] : s2[j]);
+            break;
+        case e_ifnot:
+            for (j = 0; j < n; j++)
+                dst[j] = v * (!s0[j] ? s1[j] : s2[j]);
+            break;
+        case e_between:
+            for (j = 0; j < n; j++)
+                dst[j] = v * (s0[j] >= s1[j] && s0[j] <= s2[j]);
+            break;
+        case e_last:
+            for (j = 0; j < n; j++)
+                dst[j] = v * s1[j];
+            break;
+        case e_func0:  UNARY(v * insn->a.func0(d));
+        case e_func1:  UNARY(v * insn->a.func1(opaque, d));
+        case e_func2:  BINARY(v * insn->a.func2(opaque, d, d2));
+        case e_squish: UNARY(1/(1+exp(4*d)));
+        case e_gauss:  UNARY(exp(-d*d/2)/sqrt(2*M_PI));
+        case e_isnan:  UNARY(v * !!isnan(d));
+        case e_isinf:  UNARY(v * !!isinf(d));
+        case e_floor:  UNARY(v * floor(d));
+        case e_ceil:   UNARY(v * ceil (d));
+        case e_trunc:  UNARY(v * trunc(d));
+        case e_sqrt:   UNARY(v * sqrt (d));
+        case e_not:    UNARY(v * (d == 0));
+        case e_mod:    BINARY(v * (d - floor((!CONFIG_FTRAPV || d2) ? d / d2 : d * INFINITY) * d2));
+        case e_gcd:    BINARY(v * av_gcd(d,d2));
+        case e_max:    BINARY(v * (d >  d2 ?   d : d2));
+        case e_min:    BINARY(v * (d <  d2 ?   d : d2));
+        case e_eq:     BINARY(v * (d == d2 ? 1.0 : 0.0));
+        case e_gt:     BINARY(v * (d >  d2 ? 1.0 : 0.0));
+        case e_gte:    BINARY(v * (d >= d2 ? 1.0 : 0.0));
+        case e_lt:     BINARY(v * (d <  d2 ? 1.0 : 0.0));
+        case e_lte:    BINARY(v * (d <= d2 ? 1.0 : 0.0));
+        case e_pow:    BINARY(v * pow(d, d2));
+        case e_mul:    BINARY(v * (d * d2));
+        case e_div:    BINARY(v * ((!CONFIG_FTRAPV || d2 ) ? (d / d2) : d * INFINITY));
+        case e_add:    BINARY(v * (d + d2));
+        case e_hypot:  BINARY(v * (sqrt(d*d + d2*d2)));
+        case e_bitand: BINARY(isnan(d) || isnan(d2) ? NAN : v * ((long int)d & (long int)d2));
+        case e_bitor:  BINARY(isnan(d) || isnan(d2) ? NAN : v * ((long int)d | (long int)d2));
+        }
+#undef UNARY
+#undef BINARY
+    }
+
+    memcpy(res, e->regs, n * sizeof(*res));
+}
+
 int av_expr_parse(AVExpr **expr, const char *s,
                   const char * const *const_names,
                   const char * const *func1_names, double (* const *funcs1)(void *, double),
@@ -649,7 +855,7 @@ int av_expr_parse(AVExpr **expr, const char *s,
     char *w = av_malloc(strlen(s) + 1);
     char *wp = w;
     const char *s0 = s;
-    int ret = 0;
+    int ret = 0, nb_consts;
 
     if (!w)
         return AVERROR(ENOMEM);
@@ -683,6 +889,12 @@ int av_expr_parse(AVExpr **expr, const char *s,
         goto end;
     }
     e->var= av_mallocz(sizeof(double) *VARS);
+    for (nb_consts = 0; const_names && const_names[nb_consts]; nb_consts++)
+        ;
+    if ((ret = compile(e, nb_consts)) < 0) {
+        av_expr_free(e);
+        goto end;
+    }
     *expr = e;
 end:
     av_free(w);
@@ -699,6 +911,47 @@ double av_expr_eval(AVExpr *e, const double *const_values, void *opaque)
     return eval_expr(&p, e);
 }
 
+void av_expr_eval_batch(AVExpr *e, double *res, int nb,
+                        const double *const_values,
+                        const double * const *const_arrays, void *opaque)
+{
+    int i, j;
+
+    if (e->nb_insns) {
+        for (i = 0; i < nb; i += EXPR_BATCH)
+            eval_insns(e, res + i, FFMIN(nb - i, EXPR_BATCH), i,
+                       const_values, const_arrays, opaque);
+        return;
+    }
+
+    for (i = 0; i < nb; i++) {
+        for (j = 0; j < e->nb_consts; j++)
+            e->consts[j] = const_arrays && const_arrays[j] ? const_arrays[j][i]
+                                                           : const_values[j];
+        res[i] = av_expr_eval(e, e->consts, opaque);
+    }
+}
+
+static void count_func(AVExpr *e, unsigned *counter, int size, int type)
+{
+    int i;
+
+    if (!e)
+        return;
+    for (i = 0; i < 3; i++)
+        count_func(e->param[i], counter, size, type);
+    if (e->type == type && e->const_index < size)
+        counter[e->const_index]++;
+}
+
+int av_expr_count_func(AVExpr *e, unsigned *counter, int size, int arg)
+{
+    if (!e || !counter || arg < 1 || arg > 2)
+        return AVERROR(EINVAL);
+    count_func(e, counter, size, arg == 1 ? e_func1 : e_func2);
+    return 0;
+}
+
 int av_expr_parse_and_eval(double *d, const char *s,
                            const char * const *const_names, const double *const_values,
                            const char * const *func1_names, double (* const *funcs1)(void *, double),
@@ -844,6 +1097,35 @@ int main(int argc, char **argv)
             printf("'%s' -> %f\n\n", *expr, d);
     }
 
+    /* the batches must give the same results as the single evaluations,
+     * with PI varying and E constant */
+    for (expr = exprs; *expr; expr++) {
+        AVExpr *e0, *e1;
+        double pi[200], res[200];
+        const double *const_arrays[] = { pi, NULL };
+
+        if (av_expr_parse(&e0, *expr, const_names, NULL, NULL, NULL, NULL, 0, NULL) < 0)
+            continue;
+        if (av_expr_parse(&e1, *expr, const_names, NULL, NULL, NULL, NULL, 0, NULL) < 0) {
+            av_expr_free(e0);
+            continue;
+        }
+        for (i = 0; i < FF_ARRAY_ELEMS(pi); i++)
+            pi[i] = i * 0.37 - 10;
+        av_expr_eval_batch(e1, res, FF_ARRAY_ELEMS(res), const_values,
+                           const_arrays, NULL);
+        for (i = 0; i < FF_ARRAY_ELEMS(pi); i++) {
+            double values[] = { pi[i], M_E, 0 };
+            d = av_expr_eval(e0, values, NULL);
+            if (d != res[i] && !(isnan(d) && isnan(res[i]))) {
+                printf("'%s' batch mismatch at %d: %f != %f\n", *expr, i, res[i], d);
+                break;
+            }
+        }
+        av_expr_free(e0);
+        av_expr_free(e1);
+    }
+
     av_expr_parse_and_eval(&d, "1+(5-2)^(3-1)+1/2+sin(PI)-max(-2.2,-3.1)",
                            const_names, const_values,
                            NULL, NULL, NULL, NULL, NULL, 0, NULL);
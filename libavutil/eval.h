@@ -86,6 +86,48 @@ int av_expr_parse(AVExpr **expr, const char *s,
  */
 double av_expr_eval(AVExpr *e, const double *const_values, void *opaque);
 
+/**
+ * Evaluate a previously parsed expression nb times, with varying constant
+ * values.
+ *
+ * This gives the same results as calling av_expr_eval() for each set of
+ * values in turn, but evaluates each operation of the expression on a batch
+ * of values at a time, which is much faster for expressions evaluated per
+ * pixel or per sample.
+ *
+ * Expressions using st(), ld(), while(), taylor(), root(), random() or
+ * print() depend on the order of the evaluations, and are evaluated one at
+ * a time. Otherwise both branches of if() and ifnot() may be evaluated, so
+ * the functions from funcs1 and funcs2 must not have side effects.
+ * The intermediate values are stored in e, which must thus not be
+ * evaluated by several threads at once.
+ *
+ * @param res an array where the nb results are put
+ * @param nb number of evaluations
+ * @param const_values a zero terminated array of values for the identifiers from av_expr_parse() const_names
+ * @param const_arrays NULL, or an array with an entry for each identifier from av_expr_parse() const_names;
+ *                     a non-NULL entry points to nb values of that constant, one per evaluation, which are
+ *                     used instead of the one in const_values
+ * @param opaque a pointer which will be passed to all functions from funcs1 and funcs2
+ */
+void av_expr_eval_batch(AVExpr *e, double *res, int nb,
+                        const double *const_values,
+                        const double * const *const_arrays, void *opaque);
+
+/**
+ * Track the use of the functions from funcs1 or funcs2 in a parsed
+ * expression.
+ *
+ * @param counter a zero-initialized array where the number of uses of each
+ *                function is added, indexed like the funcs1 or funcs2 array
+ *                passed to av_expr_parse()
+ * @param size number of elements in counter
+ * @param arg number of arguments of the counted functions, 1 for funcs1 and
+ *            2 for funcs2
+ * @return 0 on success, a negative AVERROR code otherwise
+ */
+int av_expr_count_func(AVExpr *e, unsigned *counter, int size, int arg);
+
 /**
  * Free a parsed expression previously created with av_expr_parse().
  */
@@ -55,6 +55,30 @@ static void vector_dmul_scalar_c(double *dst, const double *src, double mul,
         dst[i] = src[i] * mul;
 }
 
+static void vector_dmul_c(double *dst, const double *src0, const double *src1,
+                          int len)
+{
+    int i;
+    for (i = 0; i < len; i++)
+        dst[i] = src0[i] * src1[i];
+}
+
+static void vector_dmac_scalar_c(double *dst, const double *src, double mul,
+                                 int len)
+{
+    int i;
+    for (i = 0; i < len; i++)
+        dst[i] += src[i] * mul;
+}
+
+static void vector_fadd_c(float *dst, const float *src0, const float *src1,
+                          int len)
+{
+    int i;
+    for (i = 0; i < len; i++)
+        dst[i] = src0[i] + src1[i];
+}
+
 static void vector_fmul_window_c(float *dst, const float *src0,
                                  const float *src1, const float *win, int len)
 {
@@ -126,13 +150,16 @@ av_cold void avpriv_float_dsp_init(AVFloatDSPContext *fdsp, int bit_exact)
     fdsp->vector_fmul_reverse = vector_fmul_reverse_c;
     fdsp->butterflies_float = butterflies_float_c;
     fdsp->scalarproduct_float = avpriv_scalarproduct_float_c;
+    fdsp->vector_fadd = vector_fadd_c;
+    fdsp->vector_dmul = vector_dmul_c;
+    fdsp->vector_dmac_scalar = vector_dmac_scalar_c;
 
 #if ARCH_ARM
     ff_float_dsp_init_arm(fdsp);
 #elif ARCH_PPC
     ff_float_dsp_init_ppc(fdsp, bit_exact);
 #elif ARCH_X86
-    ff_float_dsp_init_x86(fdsp);
+    ff_float_dsp_init_x86(fdsp, bit_exact);
 #elif ARCH_MIPS
     ff_float_dsp_init_mips(fdsp);
 #endif
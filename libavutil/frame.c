@@ -25,6 +25,7 @@
 #include "frame.h"
 #include "imgutils.h"
 #include "mem.h"
+#include "objpool.h"
 #include "samplefmt.h"
 
 MAKE_ACCESSORS(AVFrame, frame, int64_t, best_effort_timestamp)
@@ -129,6 +130,88 @@ void av_frame_free(AVFrame **frame)
     av_freep(frame);
 }
 
+struct AVFramePool {
+    FFObjectPool pool;
+};
+
+static void *frame_pool_alloc(void)
+{
+    return av_frame_alloc();
+}
+
+static void frame_pool_reset(void *obj)
+{
+    av_frame_unref(obj);
+}
+
+static void frame_pool_free(void *obj)
+{
+    AVFrame *frame = obj;
+    av_frame_free(&frame);
+}
+
+AVFramePool *av_frame_pool_alloc(int max_frames, int max_idle)
+{
+    AVFramePool *pool = av_mallocz(sizeof(*pool));
+
+    if (!pool)
+        return NULL;
+    if (avpriv_object_pool_init(&pool->pool, max_frames, max_idle,
+                                frame_pool_alloc, frame_pool_reset,
+                                frame_pool_free) < 0) {
+        av_free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void av_frame_pool_free(AVFramePool **ppool)
+{
+    AVFramePool *pool = *ppool;
+
+    if (!pool)
+        return;
+    *ppool = NULL;
+
+    if (avpriv_object_pool_close(&pool->pool)) {
+        avpriv_object_pool_uninit(&pool->pool);
+        av_free(pool);
+    }
+}
+
+AVFrame *av_frame_pool_get(AVFramePool *pool)
+{
+    return avpriv_object_pool_get(&pool->pool);
+}
+
+void av_frame_pool_release(AVFramePool *pool, AVFrame **pframe)
+{
+    AVFrame *frame = *pframe;
+
+    if (!frame)
+        return;
+    *pframe = NULL;
+
+    if (avpriv_object_pool_release(&pool->pool, frame)) {
+        avpriv_object_pool_uninit(&pool->pool);
+        av_free(pool);
+    }
+}
+
+void av_frame_pool_get_stats(AVFramePool *pool, AVFramePoolStats *stats)
+{
+    FFObjectPoolStats s;
+
+    avpriv_object_pool_get_stats(&pool->pool, &s);
+    stats->nb_in_use  = s.nb_in_use;
+    stats->max_in_use = s.max_in_use;
+    stats->nb_idle    = s.nb_idle;
+    stats->nb_allocs  = s.nb_allocs;
+    stats->nb_reuses  = s.nb_reuses;
+    stats->nb_refused = s.nb_refused;
+    stats->nb_frees   = s.nb_frees;
+}
+
 static int get_video_buffer(AVFrame *frame, int align)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
@@ -592,3 +675,53 @@ AVFrameSideData *av_frame_get_side_data(const AVFrame *frame,
     }
     return NULL;
 }
+
+#ifdef TEST
+// LCOV_EXCL_START
+#include <stdio.h>
+
+int main(void)
+{
+    AVFramePool *pool = av_frame_pool_alloc(4, 2), *tmp;
+    AVFramePoolStats stats;
+    AVFrame *frames[5];
+    int i, j;
+
+    if (!pool)
+        return 1;
+
+    for (j = 0; j < 3; j++) {
+        for (i = 0; i < 5; i++) {
+            frames[i] = av_frame_pool_get(pool);
+            if (!frames[i] != (i == 4))
+                printf("round %d: get %d returned %p\n", j, i, frames[i]);
+        }
+        if (frames[0]->format != -1 || frames[0]->pts != AV_NOPTS_VALUE)
+            printf("round %d: frame not reset\n", j);
+        frames[0]->format = 1;
+        frames[0]->pts    = 42;
+        if (!av_frame_new_side_data(frames[0], AV_FRAME_DATA_STEREO3D, 16) ||
+            av_dict_set(&frames[0]->metadata, "key", "value", 0) < 0)
+            return 1;
+        for (i = 0; i < 5; i++)
+            av_frame_pool_release(pool, &frames[i]);
+    }
+
+    av_frame_pool_get_stats(pool, &stats);
+    if (stats.nb_in_use != 0 || stats.max_in_use != 4 || stats.nb_idle != 2 ||
+        stats.nb_allocs != 8 || stats.nb_reuses != 4 ||
+        stats.nb_refused != 3 || stats.nb_frees != 6)
+        printf("stats: %d %d %d %"PRId64" %"PRId64" %"PRId64" %"PRId64"\n",
+               stats.nb_in_use, stats.max_in_use, stats.nb_idle,
+               stats.nb_allocs, stats.nb_reuses, stats.nb_refused,
+               stats.nb_frees);
+
+    /* a frame released after the pool is freed */
+    frames[0] = av_frame_pool_get(pool);
+    tmp       = pool;
+    av_frame_pool_free(&pool);
+    av_frame_pool_release(tmp, &frames[0]);
+    return 0;
+}
+// LCOV_EXCL_STOP
+#endif
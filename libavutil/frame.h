@@ -708,6 +708,73 @@ AVFrameSideData *av_frame_new_side_data(AVFrame *frame,
 AVFrameSideData *av_frame_get_side_data(const AVFrame *frame,
                                         enum AVFrameSideDataType type);
 
+/**
+ * A pool of AVFrame structures, for long-running processes which handle
+ * frames at a constant rate and should not allocate one per frame.
+ *
+ * Frames are taken with av_frame_pool_get() and given back with
+ * av_frame_pool_release(), which unreferences them with av_frame_unref()
+ * and keeps them for later av_frame_pool_get() calls. The pool may be used
+ * from several threads at the same time.
+ */
+typedef struct AVFramePool AVFramePool;
+
+/**
+ * Counters of an AVFramePool, filled by av_frame_pool_get_stats().
+ */
+typedef struct AVFramePoolStats {
+    int     nb_in_use;      ///< frames taken and not released yet
+    int     max_in_use;     ///< largest nb_in_use so far
+    int     nb_idle;        ///< frames kept for reuse
+    int64_t nb_allocs;      ///< frames allocated by av_frame_pool_get()
+    int64_t nb_reuses;      ///< av_frame_pool_get() calls served by an idle frame
+    int64_t nb_refused;     ///< av_frame_pool_get() calls failing on max_frames
+    int64_t nb_frees;       ///< released frames freed instead of being kept
+} AVFramePoolStats;
+
+/**
+ * Allocate a frame pool.
+ *
+ * Both limits are numbers of frames, not of bytes. The data of a frame is
+ * held by AVBufferRefs which may be shared with frames outside the pool or
+ * moved to them, so it is not accounted to the pool; the memory of the data
+ * is bounded by the AVBufferPool it comes from.
+ *
+ * @param max_frames maximum number of frames of the pool in use at the same
+ *                   time, 0 for no limit
+ * @param max_idle   maximum number of released frames kept for reuse,
+ *                   0 for no limit; the others are freed
+ * @return the pool or NULL on failure
+ */
+AVFramePool *av_frame_pool_alloc(int max_frames, int max_idle);
+
+/**
+ * Free the idle frames of the pool and set *pool to NULL. The frames still
+ * in use may be released afterwards; the pool is freed with the last one.
+ */
+void av_frame_pool_free(AVFramePool **pool);
+
+/**
+ * Get a frame from the pool, set to default values as by av_frame_alloc().
+ *
+ * @return the frame or NULL if max_frames frames are in use or on
+ *         allocation failure
+ */
+AVFrame *av_frame_pool_get(AVFramePool *pool);
+
+/**
+ * Unreference a frame obtained from av_frame_pool_get() and give it back to
+ * the pool. Nothing is done if *frame is NULL.
+ *
+ * @param frame the frame, set to NULL
+ */
+void av_frame_pool_release(AVFramePool *pool, AVFrame **frame);
+
+/**
+ * Get the counters of the pool.
+ */
+void av_frame_pool_get_stats(AVFramePool *pool, AVFramePoolStats *stats);
+
 /**
  * @}
  */
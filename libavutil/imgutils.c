@@ -21,6 +21,8 @@
  * misc image utilities
  */
 
+#include "config.h"
+
 #include "avassert.h"
 #include "common.h"
 #include "imgutils.h"
@@ -29,6 +31,10 @@
 #include "log.h"
 #include "pixdesc.h"
 
+#if ARCH_X86
+#include "x86/imgutils.h"
+#endif
+
 void av_image_fill_max_pixsteps(int max_pixsteps[4], int max_pixstep_comps[4],
                                 const AVPixFmtDescriptor *pixdesc)
 {
@@ -239,14 +245,21 @@ int av_image_check_size(unsigned int w, unsigned int h, int log_offset, void *lo
     return AVERROR(EINVAL);
 }
 
-void av_image_copy_plane(uint8_t       *dst, int dst_linesize,
-                         const uint8_t *src, int src_linesize,
-                         int bytewidth, int height)
+void av_image_copy_plane2(uint8_t       *dst, int dst_linesize,
+                          const uint8_t *src, int src_linesize,
+                          int bytewidth, int height, int flags)
 {
     if (!dst || !src)
         return;
     av_assert0(abs(src_linesize) >= bytewidth);
     av_assert0(abs(dst_linesize) >= bytewidth);
+
+#if ARCH_X86 && HAVE_SSE2_EXTERNAL
+    if (flags && ff_image_copy_plane2_x86(dst, dst_linesize, src, src_linesize,
+                                          bytewidth, height, flags) >= 0)
+        return;
+#endif
+
     for (;height > 0; height--) {
         memcpy(dst, src, bytewidth);
         dst += dst_linesize;
@@ -254,9 +267,18 @@ void av_image_copy_plane(uint8_t       *dst, int dst_linesize,
     }
 }
 
-void av_image_copy(uint8_t *dst_data[4], int dst_linesizes[4],
-                   const uint8_t *src_data[4], const int src_linesizes[4],
-                   enum AVPixelFormat pix_fmt, int width, int height)
+void av_image_copy_plane(uint8_t       *dst, int dst_linesize,
+                         const uint8_t *src, int src_linesize,
+                         int bytewidth, int height)
+{
+    av_image_copy_plane2(dst, dst_linesize, src, src_linesize,
+                         bytewidth, height, 0);
+}
+
+void av_image_copy2(uint8_t *dst_data[4], int dst_linesizes[4],
+                    const uint8_t *src_data[4], const int src_linesizes[4],
+                    enum AVPixelFormat pix_fmt, int width, int height,
+                    int flags)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_fmt);
 
@@ -265,9 +287,9 @@ void av_image_copy(uint8_t *dst_data[4], int dst_linesizes[4],
 
     if (desc->flags & AV_PIX_FMT_FLAG_PAL ||
         desc->flags & AV_PIX_FMT_FLAG_PSEUDOPAL) {
-        av_image_copy_plane(dst_data[0], dst_linesizes[0],
-                            src_data[0], src_linesizes[0],
-                            width, height);
+        av_image_copy_plane2(dst_data[0], dst_linesizes[0],
+                             src_data[0], src_linesizes[0],
+                             width, height, flags);
         /* copy the palette */
         memcpy(dst_data[1], src_data[1], 4*256);
     } else {
@@ -286,13 +308,21 @@ void av_image_copy(uint8_t *dst_data[4], int dst_linesizes[4],
             if (i == 1 || i == 2) {
                 h = FF_CEIL_RSHIFT(height, desc->log2_chroma_h);
             }
-            av_image_copy_plane(dst_data[i], dst_linesizes[i],
-                                src_data[i], src_linesizes[i],
-                                bwidth, h);
+            av_image_copy_plane2(dst_data[i], dst_linesizes[i],
+                                 src_data[i], src_linesizes[i],
+                                 bwidth, h, flags);
         }
     }
 }
 
+void av_image_copy(uint8_t *dst_data[4], int dst_linesizes[4],
+                   const uint8_t *src_data[4], const int src_linesizes[4],
+                   enum AVPixelFormat pix_fmt, int width, int height)
+{
+    av_image_copy2(dst_data, dst_linesizes, src_data, src_linesizes,
+                   pix_fmt, width, height, 0);
+}
+
 int av_image_fill_arrays(uint8_t *dst_data[4], int dst_linesize[4],
                          const uint8_t *src,
                          enum AVPixelFormat pix_fmt, int width, int height, int align)
@@ -366,3 +396,46 @@ int av_image_copy_to_buffer(uint8_t *dst, int dst_size,
 
     return size;
 }
+
+#ifdef TEST
+// LCOV_EXCL_START
+#include <stdio.h>
+#include "mem.h"
+
+#define W 400
+#define H 3
+
+int main(void)
+{
+    uint8_t *src = av_malloc(W * H + 64), *ref = av_malloc(W * H + 64);
+    uint8_t *dst = av_malloc(W * H + 64);
+    int i, flags, width, offset, ret = 0;
+
+    if (!src || !ref || !dst)
+        return 1;
+    for (i = 0; i < W * H + 64; i++)
+        src[i] = i * 7 + (i >> 8);
+
+    for (flags = 0; flags < 4; flags++)
+        for (width = 100; width <= W - 16; width += 37)
+            for (offset = 0; offset < 16; offset += 3) {
+                memset(ref, 0, W * H + 64);
+                memset(dst, 0, W * H + 64);
+                av_image_copy_plane(ref + 15 - offset, W, src + offset, W,
+                                    width, H);
+                av_image_copy_plane2(dst + 15 - offset, W, src + offset, W,
+                                     width, H, flags);
+                if (memcmp(ref, dst, W * H + 64)) {
+                    printf("flags %d width %d offset %d: mismatch\n",
+                           flags, width, offset);
+                    ret = 1;
+                }
+            }
+
+    av_free(src);
+    av_free(ref);
+    av_free(dst);
+    return ret;
+}
+// LCOV_EXCL_STOP
+#endif
@@ -119,6 +119,49 @@ void av_image_copy(uint8_t *dst_data[4], int dst_linesizes[4],
                    const uint8_t *src_data[4], const int src_linesizes[4],
                    enum AVPixelFormat pix_fmt, int width, int height);
 
+/**
+ * @defgroup lavu_image_copy_flags Image copy flags
+ * Flags for av_image_copy_plane2() and av_image_copy2(). They are hints
+ * which only change how the data is moved, not the result, and are ignored
+ * where no suitable instructions are available.
+ * @{
+ */
+/**
+ * Write dst with non-temporal (streaming) stores, which bypass the cache.
+ * This is faster for images larger than the cache which are not read again
+ * soon, or which are written to uncached memory, such as a mapped hardware
+ * surface, and slower otherwise.
+ */
+#define AV_IMAGE_COPY_FLAG_NT_STORE (1 << 0)
+/**
+ * src is uncacheable speculative write-combining (USWC) memory, such as a
+ * hardware surface mapped for readback, which is read with non-temporal
+ * loads in full cache lines instead of one uncached access at a time.
+ */
+#define AV_IMAGE_COPY_FLAG_UC_SRC   (1 << 1)
+/**
+ * @}
+ */
+
+/**
+ * Copy image plane from src to dst, like av_image_copy_plane().
+ *
+ * @param flags a combination of AV_IMAGE_COPY_FLAG_*
+ */
+void av_image_copy_plane2(uint8_t       *dst, int dst_linesize,
+                          const uint8_t *src, int src_linesize,
+                          int bytewidth, int height, int flags);
+
+/**
+ * Copy image in src_data to dst_data, like av_image_copy().
+ *
+ * @param flags a combination of AV_IMAGE_COPY_FLAG_*
+ */
+void av_image_copy2(uint8_t *dst_data[4], int dst_linesizes[4],
+                    const uint8_t *src_data[4], const int src_linesizes[4],
+                    enum AVPixelFormat pix_fmt, int width, int height,
+                    int flags);
+
 /**
  * Setup the data pointers and linesizes based on the specified image
  * parameters and the provided array.
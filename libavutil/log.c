@@ -34,11 +34,14 @@
 #endif
 #include <stdarg.h>
 #include <stdlib.h>
+#include "atomic.h"
 #include "avutil.h"
 #include "bprint.h"
 #include "common.h"
 #include "internal.h"
 #include "log.h"
+#include "mem.h"
+#include "time.h"
 
 #if HAVE_PTHREADS
 #include <pthread.h>
@@ -226,24 +229,16 @@ void av_log_format_line(void *ptr, int level, const char *fmt, va_list vl,
     av_bprint_finalize(part+2, NULL);
 }
 
-void av_log_default_callback(void* ptr, int level, const char* fmt, va_list vl)
+/* Print the parts of a formatted message, called with mutex locked */
+static void print_message(int level, const int type[2], int print_prefix,
+                          char *part0, char *part1, char *part2)
 {
-    static int print_prefix = 1;
     static int count;
     static char prev[LINE_SZ];
-    AVBPrint part[3];
     char line[LINE_SZ];
     static int is_atty;
-    int type[2];
 
-    if (level > av_log_level)
-        return;
-#if HAVE_PTHREADS
-    pthread_mutex_lock(&mutex);
-#endif
-
-    format_line(ptr, level, fmt, vl, part, &print_prefix, type);
-    snprintf(line, sizeof(line), "%s%s%s", part[0].str, part[1].str, part[2].str);
+    snprintf(line, sizeof(line), "%s%s%s", part0, part1, part2);
 
 #if HAVE_ISATTY
     if (!is_atty)
@@ -255,21 +250,324 @@ void av_log_default_callback(void* ptr, int level, const char* fmt, va_list vl)
         count++;
         if (is_atty == 1)
             fprintf(stderr, "    Last message repeated %d times\r", count);
-        goto end;
+        return;
     }
     if (count > 0) {
         fprintf(stderr, "    Last message repeated %d times\n", count);
         count = 0;
     }
     strcpy(prev, line);
-    sanitize(part[0].str);
-    colored_fputs(type[0], part[0].str);
-    sanitize(part[1].str);
-    colored_fputs(type[1], part[1].str);
-    sanitize(part[2].str);
-    colored_fputs(av_clip(level >> 3, 0, 6), part[2].str);
-end:
+    sanitize(part0);
+    colored_fputs(type[0], part0);
+    sanitize(part1);
+    colored_fputs(type[1], part1);
+    sanitize(part2);
+    colored_fputs(av_clip(level >> 3, 0, 6), part2);
+}
+
+#if HAVE_PTHREADS
+/* With AV_LOG_BUFFERED, each thread formats its messages into its own ring
+ * buffer without taking any lock, and a writer thread prints them. The
+ * messages of a thread are printed in order, but the ones of different
+ * threads may be interleaved differently than they were logged. */
+
+#define RING_SIZE (1 << 16)
+
+typedef struct LogRecord {
+    int level;
+    int type[2];
+    int print_prefix;   ///< the message ends a line
+    int len[3];         ///< sizes of the 3 parts, including the terminating 0
+} LogRecord;
+
+typedef struct LogRing {
+    struct LogRing *next;
+    int head;       ///< bytes written by the thread, only it modifies it
+    int tail;       ///< bytes read by the writer, modified with writer_mutex locked
+    int dead;       ///< the thread has exited, freed by the writer once empty
+    int print_prefix;
+    uint8_t buf[RING_SIZE];
+} LogRing;
+
+static pthread_once_t  ring_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t   ring_key;
+static int             ring_key_ok;
+
+/* rings, the ring tails, writer_started, writer_exit, flush_requests and
+ * flush_done are protected by writer_mutex */
+static pthread_mutex_t writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  writer_cond  = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  flush_cond   = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  space_cond   = PTHREAD_COND_INITIALIZER;
+static pthread_t       writer;
+static LogRing        *rings;
+static int             writer_started, writer_sleeping, writer_exit;
+static unsigned        flush_requests, flush_done;
+
+static void ring_destroy(void *r)
+{
+    avpriv_atomic_int_set(&((LogRing *)r)->dead, 1);
+}
+
+static void ring_key_init(void)
+{
+    ring_key_ok = !pthread_key_create(&ring_key, ring_destroy);
+}
+
+static void ring_read(const LogRing *r, unsigned *pos, void *dst, unsigned len)
+{
+    unsigned off = *pos & (RING_SIZE - 1);
+    unsigned n   = FFMIN(len, RING_SIZE - off);
+
+    memcpy(dst, r->buf + off, n);
+    memcpy((uint8_t *)dst + n, r->buf, len - n);
+    *pos += len;
+}
+
+/**
+ * Print the messages of a ring, called with writer_mutex locked.
+ * Unless all is set, the messages after the last complete line are left
+ * in the ring, so that the lines of different threads are not mixed.
+ */
+static void drain_ring(LogRing *r, int all)
+{
+    unsigned tail = r->tail, head = avpriv_atomic_int_get(&r->head);
+    unsigned end = all ? head : tail;
+    char part[3][LINE_SZ];
+    LogRecord rec;
+    int i;
+
+    if (!all) {
+        unsigned pos = tail;
+        while (pos != head) {
+            ring_read(r, &pos, &rec, sizeof(rec));
+            pos += rec.len[0] + rec.len[1] + rec.len[2];
+            if (rec.print_prefix)
+                end = pos;
+        }
+    }
+    if (tail == end)
+        return;
+
+    pthread_mutex_lock(&mutex);
+    while (tail != end) {
+        ring_read(r, &tail, &rec, sizeof(rec));
+        for (i = 0; i < 3; i++)
+            ring_read(r, &tail, part[i], rec.len[i]);
+        print_message(rec.level, rec.type, rec.print_prefix,
+                      part[0], part[1], part[2]);
+    }
+    pthread_mutex_unlock(&mutex);
+
+    avpriv_atomic_int_set(&r->tail, tail);
+}
+
+/* Print the messages of all the rings and free the ones of exited threads,
+ * called with writer_mutex locked */
+static void drain_rings(int all)
+{
+    LogRing **p = &rings;
+
+    while (*p) {
+        LogRing *r = *p;
+        /* read before draining, so that nothing is left when dead */
+        int dead = avpriv_atomic_int_get(&r->dead);
+
+        drain_ring(r, all || dead);
+        /* an unfinished line is printed before it can block its thread */
+        if (avpriv_atomic_int_get(&r->head) - r->tail > RING_SIZE / 2)
+            drain_ring(r, 1);
+        if (dead) {
+            *p = r->next;
+            av_free(r);
+        } else
+            p = &r->next;
+    }
+    pthread_cond_broadcast(&space_cond);
+}
+
+static void *writer_thread(void *arg)
+{
+    pthread_mutex_lock(&writer_mutex);
+    for (;;) {
+        unsigned requests = flush_requests;
+        int64_t t;
+        struct timespec ts;
+
+        drain_rings(flush_done != requests || writer_exit);
+
+        if (flush_done != requests) {
+            flush_done = requests;
+            pthread_cond_broadcast(&flush_cond);
+        }
+        if (writer_exit)
+            break;
+
+        /* the threads only signal a sleeping writer, the timeout bounds
+         * the delay of the messages logged while it was going to sleep */
+        avpriv_atomic_int_set(&writer_sleeping, 1);
+        t = av_gettime() + 50000;
+        ts.tv_sec  = t / 1000000;
+        ts.tv_nsec = t % 1000000 * 1000;
+        if (flush_requests == requests)
+            pthread_cond_timedwait(&writer_cond, &writer_mutex, &ts);
+        avpriv_atomic_int_set(&writer_sleeping, 0);
+    }
+    pthread_mutex_unlock(&writer_mutex);
+    return NULL;
+}
+
+/* Print everything left and stop the writer thread, called when
+ * AV_LOG_BUFFERED is cleared. The rings are kept for a later restart. */
+static void writer_uninit(void)
+{
+    pthread_mutex_lock(&writer_mutex);
+    if (!writer_started) {
+        pthread_mutex_unlock(&writer_mutex);
+        return;
+    }
+    avpriv_atomic_int_set(&writer_exit, 1);
+    pthread_cond_signal(&writer_cond);
+    pthread_mutex_unlock(&writer_mutex);
+
+    pthread_join(writer, NULL);
+
+    pthread_mutex_lock(&writer_mutex);
+    drain_rings(1);
+    writer_started = 0;
+    avpriv_atomic_int_set(&writer_exit, 0);
+    pthread_mutex_unlock(&writer_mutex);
+}
+
+/* Get the ring of the calling thread, creating it and the writer thread
+ * if needed */
+static LogRing *get_ring(void)
+{
+    LogRing *r;
+
+    pthread_once(&ring_key_once, ring_key_init);
+    if (!ring_key_ok || avpriv_atomic_int_get(&writer_exit))
+        return NULL;
+    if ((r = pthread_getspecific(ring_key)))
+        return r;
+
+    if (!(r = av_mallocz(sizeof(*r))))
+        return NULL;
+    r->print_prefix = 1;
+
+    pthread_mutex_lock(&writer_mutex);
+    if (!writer_started && !writer_exit) {
+        writer_started = !pthread_create(&writer, NULL, writer_thread, NULL);
+    }
+    if (writer_started && !writer_exit && !pthread_setspecific(ring_key, r)) {
+        r->next = rings;
+        rings   = r;
+    } else {
+        av_freep(&r);
+    }
+    pthread_mutex_unlock(&writer_mutex);
+    return r;
+}
+
+static int log_buffered(void *ptr, int level, const char *fmt, va_list vl)
+{
+    LogRing *r = get_ring();
+    AVBPrint part[3];
+    LogRecord rec;
+    unsigned head, size;
+    int i, print_prefix;
+
+    if (!r)
+        return AVERROR(ENOMEM);
+
+    print_prefix = r->print_prefix;
+    format_line(ptr, level, fmt, vl, part, &print_prefix, rec.type);
+    rec.level        = level;
+    rec.print_prefix = print_prefix;
+    size = sizeof(rec);
+    for (i = 0; i < 3; i++) {
+        rec.len[i] = FFMIN(strlen(part[i].str), LINE_SZ - 1) + 1;
+        size      += rec.len[i];
+    }
+
+    /* wait for the writer if the ring is full */
+    head = r->head;
+    if (RING_SIZE - (head - avpriv_atomic_int_get(&r->tail)) < size) {
+        pthread_mutex_lock(&writer_mutex);
+        while (RING_SIZE - (head - r->tail) < size && !writer_exit) {
+            pthread_cond_signal(&writer_cond);
+            pthread_cond_wait(&space_cond, &writer_mutex);
+        }
+        pthread_mutex_unlock(&writer_mutex);
+        if (RING_SIZE - (head - avpriv_atomic_int_get(&r->tail)) < size) {
+            av_bprint_finalize(part+2, NULL);
+            return AVERROR_EXIT;
+        }
+    }
+    r->print_prefix = print_prefix;
+
+#define RING_WRITE(src, len) do {                                       \
+        unsigned pos = head & (RING_SIZE - 1);                          \
+        unsigned n   = FFMIN(len, RING_SIZE - pos);                     \
+        memcpy(r->buf + pos, src, n);                                   \
+        memcpy(r->buf, (const uint8_t *)(src) + n, (len) - n);          \
+        head += len;                                                    \
+    } while (0)
+
+    RING_WRITE(&rec, sizeof(rec));
+    for (i = 0; i < 3; i++) {
+        RING_WRITE(part[i].str, rec.len[i] - 1);
+        RING_WRITE("", 1);
+    }
+#undef RING_WRITE
+    av_bprint_finalize(part+2, NULL);
+
+    avpriv_atomic_int_set(&r->head, head);
+
+    /* errors are printed before returning */
+    if (level <= AV_LOG_ERROR)
+        av_log_flush();
+    else if (avpriv_atomic_int_get(&writer_sleeping))
+        pthread_cond_signal(&writer_cond);
+    return 0;
+}
+#endif
+
+void av_log_flush(void)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&writer_mutex);
+    if (writer_started && !writer_exit) {
+        unsigned request = ++flush_requests;
+
+        pthread_cond_signal(&writer_cond);
+        while ((int)(flush_done - request) < 0)
+            pthread_cond_wait(&flush_cond, &writer_mutex);
+    }
+    pthread_mutex_unlock(&writer_mutex);
+#endif
+}
+
+void av_log_default_callback(void* ptr, int level, const char* fmt, va_list vl)
+{
+    static int print_prefix = 1;
+    AVBPrint part[3];
+    int type[2];
+
+    if (level > av_log_level)
+        return;
+
+#if HAVE_PTHREADS
+    if ((flags & AV_LOG_BUFFERED) && log_buffered(ptr, level, fmt, vl) >= 0)
+        return;
+
+    pthread_mutex_lock(&mutex);
+#endif
+
+    format_line(ptr, level, fmt, vl, part, &print_prefix, type);
+    print_message(level, type, print_prefix, part[0].str, part[1].str, part[2].str);
     av_bprint_finalize(part+2, NULL);
+
 #if HAVE_PTHREADS
     pthread_mutex_unlock(&mutex);
 #endif
@@ -309,7 +607,15 @@ void av_log_set_level(int level)
 
 void av_log_set_flags(int arg)
 {
+#if HAVE_PTHREADS
+    int buffered = flags & AV_LOG_BUFFERED;
+
     flags = arg;
+    if (buffered && !(arg & AV_LOG_BUFFERED))
+        writer_uninit();
+#else
+    flags = arg;
+#endif
 }
 
 void av_log_set_callback(void (*callback)(void*, int, const char*, va_list))
@@ -348,3 +654,85 @@ void avpriv_report_missing_feature(void *avc, const char *msg, ...)
     missing_feature_sample(0, avc, msg, argument_list);
     va_end(argument_list);
 }
+
+#ifdef TEST
+#include <stdio.h>
+
+#if HAVE_PTHREADS
+#define NB_THREADS  4
+#define NB_MESSAGES 20000
+
+static int first_message;
+
+static void *log_thread(void *arg)
+{
+    int t = (intptr_t)arg;
+    int i;
+
+    for (i = first_message; i < first_message + NB_MESSAGES; i++) {
+        /* a line logged in 2 parts must not be split by other threads */
+        if (i & 1) {
+            av_log(NULL, AV_LOG_INFO, "thread %d ", t);
+            av_log(NULL, AV_LOG_INFO, "message %d\n", i);
+        } else
+            av_log(NULL, AV_LOG_INFO, "thread %d message %d\n", t, i);
+    }
+    return NULL;
+}
+#endif
+
+int main(void)
+{
+#if HAVE_PTHREADS
+    pthread_t threads[NB_THREADS];
+    int next[NB_THREADS] = { 0 };
+    char line[64];
+    FILE *f = tmpfile();
+    int i, t, n, fd, round;
+
+    /* log from several threads into a temporary file, then check that every
+     * message was printed once and in order, both when flushing and when
+     * stopping the writer thread, which is then restarted */
+    fflush(stderr);
+    if (!f || (fd = dup(2)) < 0 || dup2(fileno(f), 2) < 0)
+        return 1;
+
+    for (round = 0; round < 2; round++) {
+        first_message = round * NB_MESSAGES;
+        av_log_set_flags(AV_LOG_BUFFERED);
+        for (i = 0; i < NB_THREADS; i++)
+            if (pthread_create(&threads[i], NULL, log_thread, (void *)(intptr_t)i))
+                return 1;
+        for (i = 0; i < NB_THREADS; i++)
+            pthread_join(threads[i], NULL);
+        if (round)
+            av_log_set_flags(0);
+        else
+            av_log_flush();
+    }
+
+    fflush(stderr);
+    dup2(fd, 2);
+    close(fd);
+
+    rewind(f);
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "thread %d message %d", &t, &n) != 2 ||
+            t < 0 || t >= NB_THREADS || n != next[t]) {
+            fprintf(stderr, "unexpected line: %s", line);
+            return 1;
+        }
+        next[t]++;
+    }
+    fclose(f);
+    for (t = 0; t < NB_THREADS; t++) {
+        if (next[t] != 2 * NB_MESSAGES) {
+            fprintf(stderr, "thread %d: %d messages printed, expected %d\n",
+                    t, next[t], 2 * NB_MESSAGES);
+            return 1;
+        }
+    }
+#endif
+    return 0;
+}
+#endif
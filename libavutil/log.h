@@ -304,8 +304,26 @@ void av_log_format_line(void *ptr, int level, const char *fmt, va_list vl,
  * call av_log(NULL, AV_LOG_QUIET, "%s", ""); at the end
  */
 #define AV_LOG_SKIP_REPEATED 1
+
+/**
+ * Make av_log_default_callback() format the messages into a buffer of the
+ * calling thread, without taking any lock, and print them from a separate
+ * thread. The messages of each thread are printed in order, but the
+ * messages of different threads may be interleaved differently than they
+ * were logged. Errors are printed before av_log() returns, the other
+ * messages when av_log_flush() is called or when the flag is cleared, which
+ * also stops the thread. The application must do either before it exits.
+ * This flag is ignored without pthreads.
+ */
+#define AV_LOG_BUFFERED 2
+
 void av_log_set_flags(int arg);
 
+/**
+ * Wait until all the messages buffered with AV_LOG_BUFFERED are printed.
+ */
+void av_log_flush(void);
+
 /**
  * @}
  */
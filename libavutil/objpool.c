@@ -0,0 +1,148 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "common.h"
+#include "error.h"
+#include "mem.h"
+#include "objpool.h"
+
+static void object_pool_lock(FFObjectPool *pool)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&pool->lock);
+#endif
+}
+
+static void object_pool_unlock(FFObjectPool *pool)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_unlock(&pool->lock);
+#endif
+}
+
+int avpriv_object_pool_init(FFObjectPool *pool, int max_in_use, int max_idle,
+                            void *(*alloc)(void), void (*reset)(void *obj),
+                            void (*free)(void *obj))
+{
+    if (max_in_use < 0 || max_idle < 0)
+        return AVERROR(EINVAL);
+
+    pool->max_in_use = max_in_use;
+    pool->max_idle   = max_idle;
+    pool->alloc      = alloc;
+    pool->reset      = reset;
+    pool->free       = free;
+#if HAVE_PTHREADS
+    if (pthread_mutex_init(&pool->lock, NULL))
+        return AVERROR(ENOMEM);
+#endif
+    return 0;
+}
+
+void *avpriv_object_pool_get(FFObjectPool *pool)
+{
+    void *obj = NULL;
+
+    object_pool_lock(pool);
+    if (pool->max_in_use && pool->stats.nb_in_use >= pool->max_in_use) {
+        pool->stats.nb_refused++;
+        goto end;
+    }
+    if (pool->stats.nb_idle) {
+        obj = pool->idle[--pool->stats.nb_idle];
+        pool->stats.nb_reuses++;
+    } else {
+        obj = pool->alloc();
+        if (!obj)
+            goto end;
+        pool->stats.nb_allocs++;
+    }
+    pool->stats.nb_in_use++;
+    pool->stats.max_in_use = FFMAX(pool->stats.max_in_use,
+                                   pool->stats.nb_in_use);
+end:
+    object_pool_unlock(pool);
+    return obj;
+}
+
+int avpriv_object_pool_release(FFObjectPool *pool, void *obj)
+{
+    int last;
+
+    pool->reset(obj);
+
+    object_pool_lock(pool);
+    if (!pool->closed &&
+        (!pool->max_idle || pool->stats.nb_idle < pool->max_idle)) {
+        if (pool->stats.nb_idle == pool->idle_size) {
+            int size = FFMAX(2 * pool->idle_size, 8);
+            void **idle;
+
+            if (pool->max_idle)
+                size = FFMIN(size, pool->max_idle);
+            idle = av_realloc_array(pool->idle, size, sizeof(*idle));
+            if (idle) {
+                pool->idle      = idle;
+                pool->idle_size = size;
+            }
+        }
+        if (pool->stats.nb_idle < pool->idle_size) {
+            pool->idle[pool->stats.nb_idle++] = obj;
+            obj = NULL;
+        }
+    }
+    if (obj) {
+        pool->free(obj);
+        pool->stats.nb_frees++;
+    }
+    pool->stats.nb_in_use--;
+    last = pool->closed && !pool->stats.nb_in_use;
+    object_pool_unlock(pool);
+
+    return last;
+}
+
+int avpriv_object_pool_close(FFObjectPool *pool)
+{
+    int i, unused;
+
+    object_pool_lock(pool);
+    for (i = 0; i < pool->stats.nb_idle; i++)
+        pool->free(pool->idle[i]);
+    pool->stats.nb_idle = 0;
+    pool->closed = 1;
+    unused = !pool->stats.nb_in_use;
+    object_pool_unlock(pool);
+
+    return unused;
+}
+
+void avpriv_object_pool_uninit(FFObjectPool *pool)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_destroy(&pool->lock);
+#endif
+    av_freep(&pool->idle);
+}
+
+void avpriv_object_pool_get_stats(FFObjectPool *pool, FFObjectPoolStats *stats)
+{
+    object_pool_lock(pool);
+    *stats = pool->stats;
+    object_pool_unlock(pool);
+}
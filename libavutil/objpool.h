@@ -0,0 +1,113 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Free list of heap allocated objects, shared by AVFramePool and
+ * AVPacketPool.
+ */
+
+#ifndef AVUTIL_OBJPOOL_H
+#define AVUTIL_OBJPOOL_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+#if HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+/**
+ * Counters of an FFObjectPool, the fields of AVFramePoolStats and
+ * AVPacketPoolStats.
+ */
+typedef struct FFObjectPoolStats {
+    int     nb_in_use;
+    int     max_in_use;
+    int     nb_idle;
+    int64_t nb_allocs;
+    int64_t nb_reuses;
+    int64_t nb_refused;
+    int64_t nb_frees;
+} FFObjectPoolStats;
+
+typedef struct FFObjectPool {
+    void **idle;
+    int idle_size;
+    int max_in_use;     ///< number of objects, 0 for no limit
+    int max_idle;       ///< number of objects, 0 for no limit
+    int closed;         ///< set by avpriv_object_pool_close()
+    void *(*alloc)(void);
+    void  (*reset)(void *obj);
+    void  (*free)(void *obj);
+    FFObjectPoolStats stats;
+#if HAVE_PTHREADS
+    pthread_mutex_t lock;
+#endif
+} FFObjectPool;
+
+/**
+ * Initialize a pool embedded in a zeroed structure.
+ *
+ * @param alloc allocate an object in its default state
+ * @param reset bring a released object back to its default state, called
+ *              without the pool lock held
+ * @param free  free an object
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int avpriv_object_pool_init(FFObjectPool *pool, int max_in_use, int max_idle,
+                            void *(*alloc)(void), void (*reset)(void *obj),
+                            void (*free)(void *obj));
+
+/**
+ * Take an idle object or allocate a new one.
+ *
+ * @return the object or NULL if max_in_use objects are in use or on
+ *         allocation failure
+ */
+void *avpriv_object_pool_get(FFObjectPool *pool);
+
+/**
+ * Reset an object and keep it for reuse, or free it if the pool holds
+ * max_idle idle objects or is closed.
+ *
+ * @return 1 if the pool is closed and this was its last object in use, the
+ *         caller must then call avpriv_object_pool_uninit() and free the
+ *         structure containing the pool, 0 otherwise
+ */
+int avpriv_object_pool_release(FFObjectPool *pool, void *obj);
+
+/**
+ * Free the idle objects and close the pool, the objects in use are freed
+ * when released.
+ *
+ * @return 1 if no object is in use, the caller must then call
+ *         avpriv_object_pool_uninit() and free the structure containing the
+ *         pool, 0 otherwise
+ */
+int avpriv_object_pool_close(FFObjectPool *pool);
+
+/**
+ * Free the resources of a closed pool with no object in use.
+ */
+void avpriv_object_pool_uninit(FFObjectPool *pool);
+
+void avpriv_object_pool_get_stats(FFObjectPool *pool, FFObjectPoolStats *stats);
+
+#endif /* AVUTIL_OBJPOOL_H */
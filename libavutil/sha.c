@@ -23,6 +23,7 @@
 
 #include <string.h>
 
+#include "config.h"
 #include "attributes.h"
 #include "avutil.h"
 #include "bswap.h"
@@ -30,6 +31,10 @@
 #include "intreadwrite.h"
 #include "mem.h"
 
+#if ARCH_X86
+#include "x86/sha.h"
+#endif
+
 /** hash context */
 typedef struct AVSHA {
     uint8_t  digest_len;  ///< digest length in 32-bit words
@@ -307,6 +312,9 @@ av_cold int av_sha_init(AVSHA *ctx, int bits)
     default:
         return -1;
     }
+#if ARCH_X86 && HAVE_SHANI_EXTERNAL
+    ff_sha_init_x86(&ctx->transform, bits);
+#endif
     ctx->count = 0;
     return 0;
 }
@@ -0,0 +1,326 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "attributes.h"
+#include "common.h"
+#include "cpu.h"
+#include "mem.h"
+#include "threadpool.h"
+
+#if HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+typedef struct ThreadPoolBatch {
+    AVThreadPoolJobFunc *func;
+    void *ctx;
+    void *arg;
+    int *rets;
+    int nb_jobs;
+    int next_job;       ///< first job not taken by a thread yet
+    int nb_done;
+    int nb_slots;       ///< number of threads which took part in the batch
+    int max_slots;
+    int queued;
+#if HAVE_PTHREADS
+    pthread_cond_t done_cond;
+#endif
+    struct ThreadPoolBatch *next;
+} ThreadPoolBatch;
+
+struct AVThreadPool {
+    int nb_threads;
+#if HAVE_PTHREADS
+    pthread_t *workers;
+    pthread_mutex_t lock;
+    pthread_cond_t  work_cond;
+#endif
+    /* batches with jobs not taken yet, oldest first */
+    ThreadPoolBatch *first;
+    ThreadPoolBatch *last;
+    int exit;
+};
+
+#if HAVE_PTHREADS
+
+static void batch_unqueue(AVThreadPool *pool, ThreadPoolBatch *b)
+{
+    ThreadPoolBatch **p = &pool->first, *prev = NULL;
+
+    while (*p != b) {
+        prev = *p;
+        p    = &(*p)->next;
+    }
+    *p = b->next;
+    if (pool->last == b)
+        pool->last = prev;
+    b->queued = 0;
+}
+
+/**
+ * Run jobs of b until none is left, with the lock held on entry and exit.
+ * b must not be accessed after the lock is released once all the jobs are
+ * done: the submitting thread returns and it goes out of scope.
+ */
+static void batch_run(AVThreadPool *pool, ThreadPoolBatch *b, int slot)
+{
+    while (b->next_job < b->nb_jobs) {
+        int job = b->next_job++;
+        int ret;
+
+        if (b->next_job == b->nb_jobs && b->queued)
+            batch_unqueue(pool, b);
+        pthread_mutex_unlock(&pool->lock);
+
+        ret = b->func(b->ctx, b->arg, job, slot);
+
+        pthread_mutex_lock(&pool->lock);
+        if (b->rets)
+            b->rets[job] = ret;
+        if (++b->nb_done == b->nb_jobs)
+            pthread_cond_signal(&b->done_cond);
+    }
+}
+
+static ThreadPoolBatch *batch_find(AVThreadPool *pool)
+{
+    ThreadPoolBatch *b;
+
+    for (b = pool->first; b; b = b->next)
+        if (b->nb_slots < b->max_slots)
+            return b;
+    return NULL;
+}
+
+static void *attribute_align_arg worker(void *arg)
+{
+    AVThreadPool *pool = arg;
+    ThreadPoolBatch *b;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->exit && !(b = batch_find(pool)))
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        if (pool->exit)
+            break;
+        batch_run(pool, b, b->nb_slots++);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+#endif /* HAVE_PTHREADS */
+
+AVThreadPool *av_thread_pool_alloc(int nb_threads)
+{
+    AVThreadPool *pool = av_mallocz(sizeof(*pool));
+
+    if (!pool)
+        return NULL;
+    if (!nb_threads)
+        nb_threads = av_cpu_count();
+
+#if HAVE_PTHREADS
+    pool->workers = av_mallocz_array(nb_threads, sizeof(*pool->workers));
+    if (!pool->workers) {
+        av_free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    for (; pool->nb_threads < nb_threads; pool->nb_threads++)
+        if (pthread_create(&pool->workers[pool->nb_threads], NULL, worker, pool)) {
+            av_thread_pool_free(&pool);
+            return NULL;
+        }
+#endif
+
+    return pool;
+}
+
+void av_thread_pool_free(AVThreadPool **ppool)
+{
+    AVThreadPool *pool = *ppool;
+#if HAVE_PTHREADS
+    int i;
+#endif
+
+    if (!pool)
+        return;
+
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&pool->lock);
+    pool->exit = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->nb_threads; i++)
+        pthread_join(pool->workers[i], NULL);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_cond);
+    av_freep(&pool->workers);
+#endif
+    av_freep(ppool);
+}
+
+static AVThreadPool *default_pool;
+
+#if HAVE_PTHREADS
+static pthread_once_t default_pool_once = PTHREAD_ONCE_INIT;
+#endif
+
+static void default_pool_init(void)
+{
+    default_pool = av_thread_pool_alloc(0);
+}
+
+AVThreadPool *av_thread_pool_get_default(void)
+{
+#if HAVE_PTHREADS
+    pthread_once(&default_pool_once, default_pool_init);
+#else
+    if (!default_pool)
+        default_pool_init();
+#endif
+    return default_pool;
+}
+
+int av_thread_pool_get_nb_threads(const AVThreadPool *pool)
+{
+    return pool->nb_threads;
+}
+
+int av_thread_pool_execute(AVThreadPool *pool, AVThreadPoolJobFunc *func,
+                           void *ctx, void *arg, int *ret, int nb_jobs,
+                           int max_threads)
+{
+    ThreadPoolBatch b = {
+        .func      = func,
+        .ctx       = ctx,
+        .arg       = arg,
+        .rets      = ret,
+        .nb_jobs   = nb_jobs,
+        .nb_slots  = 1,
+        .max_slots = FFMAX(1, FFMIN(max_threads, pool->nb_threads + 1)),
+    };
+
+#if HAVE_PTHREADS
+    if (nb_jobs > 1 && b.max_slots > 1) {
+        pthread_cond_init(&b.done_cond, NULL);
+        pthread_mutex_lock(&pool->lock);
+
+        b.queued = 1;
+        if (pool->last)
+            pool->last->next = &b;
+        else
+            pool->first = &b;
+        pool->last = &b;
+        if (nb_jobs > 2 && b.max_slots > 2)
+            pthread_cond_broadcast(&pool->work_cond);
+        else
+            pthread_cond_signal(&pool->work_cond);
+
+        batch_run(pool, &b, 0);
+        while (b.nb_done < b.nb_jobs)
+            pthread_cond_wait(&b.done_cond, &pool->lock);
+
+        pthread_mutex_unlock(&pool->lock);
+        pthread_cond_destroy(&b.done_cond);
+        return 0;
+    }
+#endif
+
+    for (; b.next_job < nb_jobs; b.next_job++) {
+        int r = func(ctx, arg, b.next_job, 0);
+        if (ret)
+            ret[b.next_job] = r;
+    }
+    return 0;
+}
+
+#ifdef TEST
+// LCOV_EXCL_START
+#include <stdio.h>
+#include "atomic.h"
+
+static volatile int running, max_running;
+
+static int job(void *ctx, void *arg, int jobnr, int threadnr)
+{
+    int *slots = arg;
+    int n = avpriv_atomic_int_add_and_fetch(&running, 1);
+    int max_threads = *(int *)ctx;
+    int i;
+
+    if (n > max_running)
+        max_running = n;
+    if (threadnr < 0 || threadnr >= max_threads)
+        printf("job %d: thread index %d out of range\n", jobnr, threadnr);
+    if (avpriv_atomic_int_add_and_fetch(&slots[threadnr], 1) != 1)
+        printf("job %d: thread index %d in use\n", jobnr, threadnr);
+    for (i = 0; i < 10000; i++)
+        avpriv_atomic_int_get(&running);
+    avpriv_atomic_int_add_and_fetch(&slots[threadnr], -1);
+    avpriv_atomic_int_add_and_fetch(&running, -1);
+    return jobnr * 3;
+}
+
+/* a job running a batch of its own on the same pool */
+static int nested_job(void *ctx, void *arg, int jobnr, int threadnr)
+{
+    int slots[4] = { 0 }, rets[7], max_threads = 4, i;
+
+    av_thread_pool_execute(ctx, job, &max_threads, slots, rets, 7, 4);
+    for (i = 0; i < 7; i++)
+        if (rets[i] != i * 3)
+            return -1;
+    return jobnr;
+}
+
+int main(void)
+{
+    AVThreadPool *pool = av_thread_pool_alloc(3);
+    int slots[8] = { 0 }, rets[100], max_threads, i, j;
+
+    if (!pool)
+        return 1;
+
+    for (j = 1; j <= 8; j *= 2) {
+        max_threads = j;
+        av_thread_pool_execute(pool, job, &max_threads, slots, rets, 100, j);
+        for (i = 0; i < 100; i++)
+            if (rets[i] != i * 3)
+                printf("max %d: job %d returned %d\n", j, i, rets[i]);
+        if (max_running > FFMIN(j, 4))
+            printf("max %d: %d jobs ran at the same time\n", j, max_running);
+        max_running = 0;
+    }
+
+    av_thread_pool_execute(pool, nested_job, pool, NULL, rets, 20, 4);
+    for (i = 0; i < 20; i++)
+        if (rets[i] != i)
+            printf("nested job %d returned %d\n", i, rets[i]);
+
+    av_thread_pool_free(&pool);
+    return 0;
+}
+// LCOV_EXCL_STOP
+#endif
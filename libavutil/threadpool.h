@@ -0,0 +1,114 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_THREADPOOL_H
+#define AVUTIL_THREADPOOL_H
+
+/**
+ * @file
+ * @ingroup lavu_threadpool
+ * Pool of worker threads shared by several contexts.
+ */
+
+/**
+ * @defgroup lavu_threadpool Thread pool
+ * @ingroup lavu_misc
+ *
+ * A fixed set of worker threads running the jobs of any number of
+ * contexts, so that a process with many codec contexts and filter graphs
+ * does not create a set of threads for each of them.
+ *
+ * Each av_thread_pool_execute() call submits a batch of jobs and runs them
+ * itself along with the idle workers, until all of them are done. Batches
+ * submitted concurrently are served in order. A thread running a job may
+ * submit a batch of its own.
+ *
+ * The slice threading of libavcodec and libavfilter runs on a pool when
+ * one is set with av_codec_set_thread_pool() or AVFilterGraph.thread_pool,
+ * or on the default pool when their "shared_threads" option is set.
+ *
+ * @{
+ */
+
+typedef struct AVThreadPool AVThreadPool;
+
+/**
+ * A job of a batch.
+ *
+ * @param ctx      the ctx passed to av_thread_pool_execute()
+ * @param arg      the arg passed to av_thread_pool_execute()
+ * @param jobnr    the index of the job, from 0 to nb_jobs - 1
+ * @param threadnr the index of the thread running the job, from 0 to
+ *                 max_threads - 1; two jobs of a batch running at the same
+ *                 time have different indices
+ * @return the value stored in the ret array of av_thread_pool_execute()
+ */
+typedef int (AVThreadPoolJobFunc)(void *ctx, void *arg, int jobnr, int threadnr);
+
+/**
+ * Create a pool of worker threads.
+ *
+ * @param nb_threads number of workers, 0 for the number of CPUs
+ * @return the pool or NULL on failure; without thread support the pool
+ *         has no workers and runs the jobs in the calling thread
+ */
+AVThreadPool *av_thread_pool_alloc(int nb_threads);
+
+/**
+ * Wait for the workers to exit, free the pool and set *pool to NULL.
+ * No batch may be running on it.
+ */
+void av_thread_pool_free(AVThreadPool **pool);
+
+/**
+ * Get the default pool of the process, created with one worker per CPU on
+ * the first call. It must not be freed.
+ *
+ * @return the pool or NULL on failure
+ */
+AVThreadPool *av_thread_pool_get_default(void);
+
+/**
+ * @return the number of workers of the pool
+ */
+int av_thread_pool_get_nb_threads(const AVThreadPool *pool);
+
+/**
+ * Run a batch of jobs and wait until all of them are done. The calling
+ * thread runs jobs too, so the batch progresses even when all the workers
+ * are busy.
+ *
+ * @param func        the function run for every job
+ * @param ctx         passed to func
+ * @param arg         passed to func
+ * @param ret         if not NULL, an array of nb_jobs elements receiving the
+ *                    values returned by func
+ * @param nb_jobs     number of jobs
+ * @param max_threads maximum number of threads running the jobs of this
+ *                    batch at the same time, including the calling thread
+ * @return 0
+ */
+int av_thread_pool_execute(AVThreadPool *pool, AVThreadPoolJobFunc *func,
+                           void *ctx, void *arg, int *ret, int nb_jobs,
+                           int max_threads);
+
+/**
+ * @}
+ */
+
+#endif /* AVUTIL_THREADPOOL_H */
@@ -0,0 +1,751 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * tracing of spans and counters
+ */
+
+#include "config.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "avassert.h"
+#include "bprint.h"
+#include "common.h"
+#include "error.h"
+#include "intmath.h"
+#include "mem.h"
+#include "opt.h"
+#include "time.h"
+#include "trace.h"
+
+#if HAVE_PTHREADS
+#include <pthread.h>
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* durations of [2^(i-1), 2^i) nanoseconds, the first bucket is below 1 ns
+ * and the last one is open-ended */
+#define HIST_BUCKETS 32
+
+enum TraceFormat {
+    TRACE_FORMAT_JSON,
+    TRACE_FORMAT_HISTOGRAM,
+};
+
+typedef struct TraceEvent {
+    const char *name;
+    int64_t ts;             ///< in nanoseconds
+    int64_t value;          ///< duration of a span, value of a counter
+    int category;
+    int is_counter;
+    int tid;
+} TraceEvent;
+
+typedef struct TraceStat {
+    const char *name;
+    int category;
+    int is_counter;
+    int64_t count;
+    int64_t sum, min, max;
+    int64_t hist[HIST_BUCKETS];
+} TraceStat;
+
+struct AVTraceContext {
+    const AVClass *class;
+    int categories;
+    int format;
+    int max_events;
+
+    int64_t start_time;
+    TraceEvent *events;
+    int nb_events, nb_events_allocated;
+    int64_t nb_dropped;
+    TraceStat *stats;
+    int nb_stats;
+};
+
+/**
+ * Events and stats recorded by one thread, moved into the context they
+ * belong to when it is dumped or stopped, or when the thread exits.
+ * Only the thread itself and these moves touch it, so that recording does
+ * not contend with the other threads.
+ */
+typedef struct TraceBuffer {
+    struct TraceBuffer *next;
+    AVTraceContext *t;      ///< context of the data, the active one or NULL
+    int tid;
+    TraceEvent *events;
+    int nb_events, nb_events_allocated;
+    int64_t nb_dropped;
+    TraceStat *stats;       ///< hash table on the name pointers
+    int nb_stats, stats_size;
+#if HAVE_PTHREADS
+    pthread_mutex_t lock;
+#endif
+} TraceBuffer;
+
+/* The context being recorded into, and its categories. Both are only written
+ * with the mutex held; the categories are read without it so that a span
+ * which is not recorded costs only a test. */
+static AVTraceContext *active;
+static int active_categories;
+
+/* the buffers of all the threads, protected by the mutex */
+#if HAVE_PTHREADS
+static TraceBuffer *buffers;
+static int          nb_tids;
+#else
+static TraceBuffer  main_buffer = { .tid = 1 };
+static TraceBuffer *buffers = &main_buffer;
+#endif
+
+#define OFFSET(x) offsetof(AVTraceContext, x)
+static const AVOption trace_options[] = {
+    { "categories", "set the categories to record", OFFSET(categories), AV_OPT_TYPE_FLAGS, { .i64 = AV_TRACE_CODEC | AV_TRACE_FORMAT | AV_TRACE_FILTER | AV_TRACE_USER }, 0, INT_MAX, 0, "categories" },
+        { "codec",  "decode and encode calls",          0, AV_OPT_TYPE_CONST, { .i64 = AV_TRACE_CODEC  }, 0, 0, 0, "categories" },
+        { "format", "demuxer reads and muxer writes",   0, AV_OPT_TYPE_CONST, { .i64 = AV_TRACE_FORMAT }, 0, 0, 0, "categories" },
+        { "filter", "filter_frame() calls",             0, AV_OPT_TYPE_CONST, { .i64 = AV_TRACE_FILTER }, 0, 0, 0, "categories" },
+        { "user",   "spans and counters of the caller", 0, AV_OPT_TYPE_CONST, { .i64 = AV_TRACE_USER   }, 0, 0, 0, "categories" },
+    { "format", "set the format of the dump", OFFSET(format), AV_OPT_TYPE_INT, { .i64 = TRACE_FORMAT_JSON }, 0, TRACE_FORMAT_HISTOGRAM, 0, "format" },
+        { "json",      "Chrome trace events",           0, AV_OPT_TYPE_CONST, { .i64 = TRACE_FORMAT_JSON      }, 0, 0, 0, "format" },
+        { "histogram", "aggregated durations",          0, AV_OPT_TYPE_CONST, { .i64 = TRACE_FORMAT_HISTOGRAM }, 0, 0, 0, "format" },
+    { "max_events", "set the maximum number of events kept for the json dump", OFFSET(max_events), AV_OPT_TYPE_INT, { .i64 = 1 << 20 }, 0, INT_MAX, 0 },
+    { NULL },
+};
+
+static const AVClass trace_class = {
+    .class_name = "AVTrace",
+    .item_name  = av_default_item_name,
+    .option     = trace_options,
+    .version    = LIBAVUTIL_VERSION_INT,
+};
+
+const AVClass *av_trace_get_class(void)
+{
+    return &trace_class;
+}
+
+AVTraceContext *av_trace_alloc(void)
+{
+    AVTraceContext *t = av_mallocz(sizeof(*t));
+
+    if (!t)
+        return NULL;
+    t->class = &trace_class;
+    av_opt_set_defaults(t);
+    return t;
+}
+
+static void lock(void)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&mutex);
+#endif
+}
+
+static void unlock(void)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_unlock(&mutex);
+#endif
+}
+
+static void buffer_lock(TraceBuffer *b)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&b->lock);
+#endif
+}
+
+static void buffer_unlock(TraceBuffer *b)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_unlock(&b->lock);
+#endif
+}
+
+/* Monotonic time in nanoseconds */
+static int64_t trace_time(void)
+{
+#if HAVE_CLOCK_GETTIME && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    if (!clock_gettime(CLOCK_MONOTONIC, &ts))
+        return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+    return av_gettime() * 1000;
+}
+
+static TraceStat *get_stat(AVTraceContext *t, int category, const char *name,
+                           int is_counter)
+{
+    TraceStat *st;
+    int i;
+
+    for (i = 0; i < t->nb_stats; i++) {
+        st = &t->stats[i];
+        if (st->category == category && st->is_counter == is_counter &&
+            (st->name == name || !strcmp(st->name, name)))
+            return st;
+    }
+
+    st = av_realloc_array(t->stats, t->nb_stats + 1, sizeof(*t->stats));
+    if (!st)
+        return NULL;
+    t->stats = st;
+    st = &t->stats[t->nb_stats++];
+    memset(st, 0, sizeof(*st));
+    st->name       = name;
+    st->category   = category;
+    st->is_counter = is_counter;
+    st->min        = INT64_MAX;
+    st->max        = INT64_MIN;
+    return st;
+}
+
+/**
+ * Move the data of a buffer into its context, called with the mutex and
+ * the buffer locked.
+ */
+static void collect_buffer(TraceBuffer *b)
+{
+    AVTraceContext *t = b->t;
+    int i, j, n;
+
+    if (!t)
+        return;
+
+    for (i = 0; i < b->stats_size; i++) {
+        const TraceStat *src = &b->stats[i];
+        TraceStat *st;
+
+        if (!src->name ||
+            !(st = get_stat(t, src->category, src->name, src->is_counter)))
+            continue;
+        st->count += src->count;
+        st->sum   += src->sum;
+        st->min    = FFMIN(st->min, src->min);
+        st->max    = FFMAX(st->max, src->max);
+        for (j = 0; j < HIST_BUCKETS; j++)
+            st->hist[j] += src->hist[j];
+    }
+    if (b->stats)
+        memset(b->stats, 0, b->stats_size * sizeof(*b->stats));
+    b->nb_stats = 0;
+
+    n = av_clip(t->max_events - t->nb_events, 0, b->nb_events);
+    if (n > t->nb_events_allocated - t->nb_events) {
+        TraceEvent *events = av_realloc_array(t->events, t->nb_events + n,
+                                              sizeof(*events));
+        if (events) {
+            t->events              = events;
+            t->nb_events_allocated = t->nb_events + n;
+        } else
+            n = 0;
+    }
+    if (n) {
+        memcpy(t->events + t->nb_events, b->events, n * sizeof(*b->events));
+        t->nb_events += n;
+    }
+    t->nb_dropped += b->nb_dropped + b->nb_events - n;
+    b->nb_events   = 0;
+    b->nb_dropped  = 0;
+    b->t           = NULL;
+}
+
+/* Move the data of all the threads recording into t, with the mutex held */
+static void collect(AVTraceContext *t)
+{
+    TraceBuffer *b;
+
+    for (b = buffers; b; b = b->next) {
+        buffer_lock(b);
+        if (b->t == t)
+            collect_buffer(b);
+        buffer_unlock(b);
+    }
+}
+
+void av_trace_free(AVTraceContext **t)
+{
+    if (!*t)
+        return;
+    av_trace_stop(*t);
+    av_freep(&(*t)->events);
+    av_freep(&(*t)->stats);
+    av_opt_free(*t);
+    av_freep(t);
+}
+
+int av_trace_start(AVTraceContext *t)
+{
+    int ret = 0;
+
+    lock();
+    if (active && active != t) {
+        ret = AVERROR(EBUSY);
+    } else {
+        if (!t->start_time)
+            t->start_time = trace_time();
+        active            = t;
+        active_categories = t->categories;
+    }
+    unlock();
+    return ret;
+}
+
+void av_trace_stop(AVTraceContext *t)
+{
+    lock();
+    if (active == t) {
+        active            = NULL;
+        active_categories = 0;
+        /* the buffers are locked after active is cleared, so that nothing
+         * is recorded into them for t afterwards */
+        collect(t);
+    }
+    unlock();
+}
+
+#if HAVE_PTHREADS
+static void free_buffer(TraceBuffer *b)
+{
+    av_freep(&b->events);
+    av_freep(&b->stats);
+    pthread_mutex_destroy(&b->lock);
+    av_free(b);
+}
+
+static pthread_once_t buffer_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  buffer_key;
+static int            buffer_key_ok;
+
+/* called when a thread exits, its data is kept in its context */
+static void buffer_destroy(void *arg)
+{
+    TraceBuffer *b = arg, **p;
+
+    lock();
+    for (p = &buffers; *p != b; p = &(*p)->next)
+        ;
+    *p = b->next;
+    buffer_lock(b);
+    collect_buffer(b);
+    buffer_unlock(b);
+    unlock();
+    free_buffer(b);
+}
+
+static void buffer_key_init(void)
+{
+    buffer_key_ok = !pthread_key_create(&buffer_key, buffer_destroy);
+}
+
+/* Get the buffer of the calling thread, creating it if needed */
+static TraceBuffer *get_buffer(void)
+{
+    TraceBuffer *b;
+
+    pthread_once(&buffer_key_once, buffer_key_init);
+    if (!buffer_key_ok)
+        return NULL;
+    if ((b = pthread_getspecific(buffer_key)))
+        return b;
+
+    if (!(b = av_mallocz(sizeof(*b))))
+        return NULL;
+    if (pthread_mutex_init(&b->lock, NULL)) {
+        av_free(b);
+        return NULL;
+    }
+    if (pthread_setspecific(buffer_key, b)) {
+        free_buffer(b);
+        return NULL;
+    }
+    lock();
+    b->tid  = ++nb_tids;
+    b->next = buffers;
+    buffers = b;
+    unlock();
+    return b;
+}
+#else
+static TraceBuffer *get_buffer(void)
+{
+    return &main_buffer;
+}
+#endif
+
+static unsigned stat_hash(const char *name, int category, int is_counter)
+{
+    return ((uintptr_t)name >> 3) * 0x9E3779B1U ^ (category << 1 | is_counter);
+}
+
+static int grow_stats(TraceBuffer *b)
+{
+    int size = FFMAX(2 * b->stats_size, 16), i;
+    TraceStat *stats = av_mallocz_array(size, sizeof(*stats));
+
+    if (!stats)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < b->stats_size; i++) {
+        const TraceStat *st = &b->stats[i];
+        unsigned h;
+
+        if (!st->name)
+            continue;
+        for (h = stat_hash(st->name, st->category, st->is_counter);
+             stats[h & (size - 1)].name; h++)
+            ;
+        stats[h & (size - 1)] = *st;
+    }
+    av_free(b->stats);
+    b->stats      = stats;
+    b->stats_size = size;
+    return 0;
+}
+
+static TraceStat *get_buffer_stat(TraceBuffer *b, int category,
+                                  const char *name, int is_counter)
+{
+    TraceStat *st;
+    unsigned h;
+
+    if (2 * (b->nb_stats + 1) > b->stats_size && grow_stats(b) < 0)
+        return NULL;
+
+    for (h = stat_hash(name, category, is_counter); ; h++) {
+        st = &b->stats[h & (b->stats_size - 1)];
+        if (!st->name)
+            break;
+        if (st->name == name && st->category == category &&
+            st->is_counter == is_counter)
+            return st;
+    }
+    st->name       = name;
+    st->category   = category;
+    st->is_counter = is_counter;
+    st->min        = INT64_MAX;
+    st->max        = INT64_MIN;
+    b->nb_stats++;
+    return st;
+}
+
+static void add_event(int category, const char *name, int64_t ts,
+                      int64_t value, int is_counter)
+{
+    TraceBuffer *b = get_buffer();
+    AVTraceContext *t;
+    TraceStat *st;
+
+    if (!b)
+        return;
+
+    buffer_lock(b);
+    t = active;
+    if (!t || !(t->categories & category))
+        goto end;
+    /* a buffer only holds data of the active context, the others have been
+     * collected when they were stopped */
+    b->t = t;
+
+    if ((st = get_buffer_stat(b, category, name, is_counter))) {
+        st->count++;
+        st->sum += value;
+        st->min  = FFMIN(st->min, value);
+        st->max  = FFMAX(st->max, value);
+        if (!is_counter)
+            st->hist[value > 0 ? FFMIN(av_log2(FFMIN(value, INT_MAX)) + 1,
+                                     HIST_BUCKETS - 1) : 0]++;
+    }
+
+    if (b->nb_events >= b->nb_events_allocated) {
+        int size = FFMIN(FFMAX(2 * FFMIN(b->nb_events_allocated, INT_MAX / 2),
+                               1024), t->max_events);
+        TraceEvent *events;
+
+        if (b->nb_events >= size ||
+            !(events = av_realloc_array(b->events, size, sizeof(*events)))) {
+            b->nb_dropped++;
+            goto end;
+        }
+        b->events              = events;
+        b->nb_events_allocated = size;
+    }
+    b->events[b->nb_events++] = (TraceEvent) {
+        .name       = name,
+        .ts         = ts,
+        .value      = value,
+        .category   = category,
+        .is_counter = is_counter,
+        .tid        = b->tid,
+    };
+
+end:
+    buffer_unlock(b);
+}
+
+int64_t av_trace_begin(int category)
+{
+    if (!(active_categories & category))
+        return 0;
+    return trace_time();
+}
+
+void av_trace_end(int category, const char *name, int64_t start)
+{
+    if (!start)
+        return;
+    add_event(category, name, start, trace_time() - start, 0);
+}
+
+void av_trace_counter(int category, const char *name, int64_t value)
+{
+    if (!(active_categories & category))
+        return;
+    add_event(category, name, trace_time(), value, 1);
+}
+
+static const char *category_name(int category)
+{
+    switch (category) {
+    case AV_TRACE_CODEC:  return "codec";
+    case AV_TRACE_FORMAT: return "format";
+    case AV_TRACE_FILTER: return "filter";
+    default:              return "user";
+    }
+}
+
+static void print_json_string(AVBPrint *bp, const char *s)
+{
+    av_bprint_chars(bp, '"', 1);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            av_bprintf(bp, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            av_bprintf(bp, "\\u%04x", *s);
+        else
+            av_bprint_chars(bp, *s, 1);
+    }
+    av_bprint_chars(bp, '"', 1);
+}
+
+static int event_cmp(const void *a, const void *b)
+{
+    const TraceEvent *ea = a, *eb = b;
+
+    if (ea->ts != eb->ts)
+        return ea->ts > eb->ts ? 1 : -1;
+    return ea->tid - eb->tid;
+}
+
+static void dump_json(AVTraceContext *t, AVBPrint *bp)
+{
+    int i;
+
+    /* the events of the threads are collected one thread after the other */
+    qsort(t->events, t->nb_events, sizeof(*t->events), event_cmp);
+
+    av_bprintf(bp, "{\"traceEvents\":[\n");
+    for (i = 0; i < t->nb_events; i++) {
+        const TraceEvent *ev = &t->events[i];
+
+        av_bprintf(bp, "{\"name\":");
+        print_json_string(bp, ev->name);
+        av_bprintf(bp, ",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f"
+                   ",\"pid\":1,\"tid\":%d,", category_name(ev->category),
+                   ev->is_counter ? 'C' : 'X',
+                   (ev->ts - t->start_time) / 1000.0, ev->tid);
+        if (ev->is_counter)
+            av_bprintf(bp, "\"args\":{\"value\":%"PRId64"}}", ev->value);
+        else
+            av_bprintf(bp, "\"dur\":%.3f}", ev->value / 1000.0);
+        av_bprintf(bp, "%s\n", i < t->nb_events - 1 ? "," : "");
+    }
+    av_bprintf(bp, "],\n\"displayTimeUnit\":\"ms\",\n"
+               "\"otherData\":{\"dropped_events\":%"PRId64"}}\n", t->nb_dropped);
+}
+
+static int stat_cmp(const void *a, const void *b)
+{
+    const TraceStat *sa = a, *sb = b;
+    int ret = strcmp(sa->name, sb->name);
+
+    if (sa->category != sb->category)
+        return sa->category - sb->category;
+    return ret ? ret : sa->is_counter - sb->is_counter;
+}
+
+static void dump_histogram(AVTraceContext *t, AVBPrint *bp)
+{
+    int i, j;
+
+    qsort(t->stats, t->nb_stats, sizeof(*t->stats), stat_cmp);
+
+    for (i = 0; i < t->nb_stats; i++) {
+        const TraceStat *st = &t->stats[i];
+
+        if (st->is_counter) {
+            av_bprintf(bp, "%s counter %s: %"PRId64" values, min %"PRId64
+                       " avg %"PRId64" max %"PRId64"\n",
+                       category_name(st->category), st->name, st->count,
+                       st->min, st->sum / st->count, st->max);
+            continue;
+        }
+
+        av_bprintf(bp, "%s span %s: %"PRId64" calls, total %.3f us, "
+                   "min %.3f avg %.3f max %.3f us\n",
+                   category_name(st->category), st->name, st->count,
+                   st->sum / 1000.0, st->min / 1000.0,
+                   st->sum / 1000.0 / st->count, st->max / 1000.0);
+        for (j = 0; j < HIST_BUCKETS; j++) {
+            if (!st->hist[j])
+                continue;
+            if (j == HIST_BUCKETS - 1)
+                av_bprintf(bp, "    %10"PRId64" ns and more: ", (int64_t)1 << (j - 1));
+            else
+                av_bprintf(bp, "    %10"PRId64" - %10"PRId64" ns: ",
+                           j ? (int64_t)1 << (j - 1) : 0, (int64_t)1 << j);
+            av_bprintf(bp, "%"PRId64" (%.1f%%)\n", st->hist[j],
+                       100.0 * st->hist[j] / st->count);
+        }
+    }
+}
+
+int av_trace_dump(AVTraceContext *t, AVBPrint *bp)
+{
+    lock();
+    collect(t);
+    if (t->format == TRACE_FORMAT_HISTOGRAM)
+        dump_histogram(t, bp);
+    else
+        dump_json(t, bp);
+    unlock();
+    return av_bprint_is_complete(bp) ? 0 : AVERROR(ENOMEM);
+}
+
+#ifdef TEST
+
+#include <stdio.h>
+
+static const char *const span_name    = "span";
+static const char *const counter_name = "counter";
+
+#define NB_THREADS 4
+#define NB_VALUES  1000
+
+static const TraceStat *find_stat(AVTraceContext *t, const char *name)
+{
+    int i;
+
+    for (i = 0; i < t->nb_stats; i++)
+        if (!strcmp(t->stats[i].name, name))
+            return &t->stats[i];
+    return NULL;
+}
+
+#if HAVE_PTHREADS
+static void *record_values(void *arg)
+{
+    int i;
+
+    for (i = 0; i < NB_VALUES; i++)
+        av_trace_counter(AV_TRACE_USER, counter_name, i);
+    return NULL;
+}
+#endif
+
+int main(void)
+{
+    AVTraceContext *t = av_trace_alloc(), *t2 = av_trace_alloc();
+    const TraceStat *st;
+    AVBPrint bp;
+    int64_t start;
+    int i, ret = 0;
+
+    if (!t || !t2)
+        return 1;
+
+    /* nothing is recorded before the context is started */
+    start = av_trace_begin(AV_TRACE_USER);
+    av_assert0(!start);
+
+    av_opt_set(t, "categories", "user+codec", 0);
+    av_assert0(av_trace_start(t)  == 0);
+    av_assert0(av_trace_start(t2) == AVERROR(EBUSY));
+
+    for (i = 0; i < 10; i++) {
+        start = av_trace_begin(AV_TRACE_USER);
+        av_assert0(start);
+        av_usleep(100);
+        av_trace_end(AV_TRACE_USER, span_name, start);
+        av_trace_counter(AV_TRACE_USER, counter_name, i);
+    }
+    av_assert0(!av_trace_begin(AV_TRACE_FILTER));
+    av_trace_stop(t);
+    av_assert0(!av_trace_begin(AV_TRACE_USER));
+
+    av_assert0(t->nb_events == 20 && t->nb_stats == 2);
+    st = find_stat(t, span_name);
+    av_assert0(st->count == 10 && st->min >= 100000);
+    st = find_stat(t, counter_name);
+    av_assert0(st->min == 0 && st->max == 9 && st->sum == 45);
+
+    av_bprint_init(&bp, 0, AV_BPRINT_SIZE_UNLIMITED);
+    ret |= av_trace_dump(t, &bp);
+    av_assert0(strstr(bp.str, "\"ph\":\"X\"") && strstr(bp.str, "\"ph\":\"C\""));
+    av_bprint_clear(&bp);
+    av_opt_set(t, "format", "histogram", 0);
+    ret |= av_trace_dump(t, &bp);
+    av_assert0(strstr(bp.str, "user span span: 10 calls"));
+    av_bprint_finalize(&bp, NULL);
+
+#if HAVE_PTHREADS
+    /* the values of exited threads are kept, the ones of the running threads
+     * are collected when stopping */
+    {
+        pthread_t threads[NB_THREADS];
+
+        av_assert0(av_trace_start(t2) == 0);
+        for (i = 0; i < NB_THREADS; i++)
+            av_assert0(!pthread_create(&threads[i], NULL, record_values, NULL));
+        for (i = 0; i < NB_THREADS / 2; i++)
+            pthread_join(threads[i], NULL);
+        record_values(NULL);
+        av_trace_stop(t2);
+        for (; i < NB_THREADS; i++)
+            pthread_join(threads[i], NULL);
+
+        st = find_stat(t2, counter_name);
+        av_assert0(st && st->count >= (NB_THREADS / 2 + 1) * NB_VALUES &&
+                   st->count <= (NB_THREADS + 1) * NB_VALUES &&
+                   st->count == t2->nb_events && st->max == NB_VALUES - 1);
+    }
+#endif
+
+    av_trace_free(&t);
+    av_trace_free(&t2);
+    return !!ret;
+}
+
+#endif /* TEST */
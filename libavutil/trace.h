@@ -0,0 +1,144 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_TRACE_H
+#define AVUTIL_TRACE_H
+
+/**
+ * @file
+ * @ingroup lavu_trace
+ * Runtime tracing of the hot paths of the libraries.
+ */
+
+#include <stdint.h>
+
+#include "bprint.h"
+#include "log.h"
+
+/**
+ * @defgroup lavu_trace Tracing
+ * @ingroup lavu_misc
+ *
+ * Timed spans and named counters, recorded while a trace context is started
+ * and dumped as Chrome trace JSON (also read by Perfetto) or as aggregated
+ * histograms.
+ *
+ * The libraries record a span around every decode and encode call
+ * (::AV_TRACE_CODEC), every demuxer read and muxer write
+ * (::AV_TRACE_FORMAT) and every filter_frame() call (::AV_TRACE_FILTER).
+ * Spans nest: the span of a filter includes the filters it passes the frame
+ * to.
+ * When no trace context is started, or its "categories" option does not
+ * contain the category of a span, recording it costs a function call and
+ * a test.
+ *
+ * @code
+ * AVTraceContext *t = av_trace_alloc();
+ * av_opt_set(t, "categories", "codec+filter", 0);
+ * av_trace_start(t);
+ * // transcode
+ * av_trace_stop(t);
+ * av_bprint_init(&bp, 0, AV_BPRINT_SIZE_UNLIMITED);
+ * av_trace_dump(t, &bp);
+ * av_trace_free(&t);
+ * @endcode
+ *
+ * @{
+ */
+
+#define AV_TRACE_CODEC   0x0001 ///< decode and encode calls
+#define AV_TRACE_FORMAT  0x0002 ///< demuxer reads and muxer writes
+#define AV_TRACE_FILTER  0x0004 ///< filter_frame() calls
+#define AV_TRACE_USER    0x0008 ///< spans and counters of the application
+
+typedef struct AVTraceContext AVTraceContext;
+
+/**
+ * Get the AVClass of AVTraceContext, for its options.
+ */
+const AVClass *av_trace_get_class(void);
+
+/**
+ * Allocate a trace context with its options set to their defaults.
+ *
+ * @return the context or NULL on failure
+ */
+AVTraceContext *av_trace_alloc(void);
+
+/**
+ * Stop the trace context if needed, free it and set *t to NULL.
+ */
+void av_trace_free(AVTraceContext **t);
+
+/**
+ * Start recording the spans and counters of the categories set in the
+ * "categories" option of t. Only one context can record at a time.
+ *
+ * @return 0 on success, AVERROR(EBUSY) if another context is recording
+ */
+int av_trace_start(AVTraceContext *t);
+
+/**
+ * Stop recording into t. The recorded data is kept until t is freed.
+ */
+void av_trace_stop(AVTraceContext *t);
+
+/**
+ * Start a span.
+ *
+ * @param category one of the AV_TRACE_* categories
+ * @return the start time of the span, to be passed to av_trace_end(), or
+ *         0 if the category is not being recorded
+ */
+int64_t av_trace_begin(int category);
+
+/**
+ * End a span started by av_trace_begin() and record it.
+ *
+ * @param category the category passed to av_trace_begin()
+ * @param name     name of the span; the string must stay valid until the
+ *                 trace context is freed, usually it is the name of a
+ *                 codec, format or filter
+ * @param start    the value returned by av_trace_begin()
+ */
+void av_trace_end(int category, const char *name, int64_t start);
+
+/**
+ * Record the current value of a counter.
+ *
+ * @param category one of the AV_TRACE_* categories
+ * @param name     name of the counter, with the same lifetime as the span
+ *                 names of av_trace_end()
+ * @param value    the new value of the counter
+ */
+void av_trace_counter(int category, const char *name, int64_t value);
+
+/**
+ * Print the data recorded into t in the format selected by its "format"
+ * option: "json" for Chrome trace events, "histogram" for the count, time
+ * and duration distribution of each span and the range of each counter.
+ *
+ * @return 0 on success, AVERROR(ENOMEM) if bp was truncated
+ */
+int av_trace_dump(AVTraceContext *t, AVBPrint *bp);
+
+/**
+ * @}
+ */
+
+#endif /* AVUTIL_TRACE_H */
@@ -0,0 +1,80 @@
+;******************************************************************************
+;* Adler-32 checksum
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "x86util.asm"
+
+SECTION_RODATA
+
+adler32_taps: db 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17
+              db 16, 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1
+pw_1:         times 8 dw 1
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; void ff_adler32_blocks_ssse3(uint32_t sums[2], const uint8_t *buf,
+;                              int blocks)
+; Add the 32-byte blocks of buf to the sums s1 and s2, without reducing them
+; modulo 65521. Within a block, s1 gets the sum of the bytes (psadbw) and s2
+; the sum of the bytes weighted by their distance to the end of the block
+; (pmaddubsw), plus 32 times s1 at the start of the block, accumulated in m6.
+;-----------------------------------------------------------------------------
+INIT_XMM ssse3
+cglobal adler32_blocks, 3, 4, 8, sums, buf, blocks, s1
+    pxor      m0, m0
+    mova      m1, [pw_1]
+    mova      m2, [adler32_taps]
+    mova      m3, [adler32_taps + 16]
+    pxor      m4, m4
+    movd      m5, [sumsq + 4]
+    mov     s1d, [sumsq]
+    imul    s1d, blocksd
+    movd      m6, s1d
+.loop:
+    paddd     m6, m4
+    movu      m7, [bufq]
+    psadbw    m7, m0
+    paddd     m4, m7
+    movu      m7, [bufq + 16]
+    psadbw    m7, m0
+    paddd     m4, m7
+    movu      m7, [bufq]
+    pmaddubsw m7, m2
+    pmaddwd   m7, m1
+    paddd     m5, m7
+    movu      m7, [bufq + 16]
+    pmaddubsw m7, m3
+    pmaddwd   m7, m1
+    paddd     m5, m7
+    add     bufq, 32
+    sub  blocksd, 1
+        jnz .loop
+    pslld     m6, 5
+    paddd     m5, m6
+    pshufd    m7, m4, q1032
+    paddd     m4, m7
+    pshufd    m7, m5, q1032
+    paddd     m5, m7
+    pshufd    m7, m5, q2301
+    paddd     m5, m7
+    movd    s1d, m4
+    add  [sumsq], s1d
+    movd [sumsq + 4], m5
+    RET
@@ -0,0 +1,33 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_X86_ADLER32_H
+#define AVUTIL_X86_ADLER32_H
+
+#include <stdint.h>
+
+/**
+ * Update the Adler-32 checksum with the 32-byte blocks at the start of buf,
+ * if the CPU has the needed extensions.
+ *
+ * @return the number of bytes processed
+ */
+unsigned ff_adler32_update_x86(unsigned long *adler, const uint8_t *buf,
+                               unsigned int len);
+
+#endif /* AVUTIL_X86_ADLER32_H */
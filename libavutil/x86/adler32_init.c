@@ -0,0 +1,51 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "adler32.h"
+#include "cpu.h"
+
+/* the largest number of 32-byte blocks for which s2 fits in 32 bits */
+#define NMAX_BLOCKS (5552 / 32)
+
+void ff_adler32_blocks_ssse3(uint32_t sums[2], const uint8_t *buf, int blocks);
+
+unsigned ff_adler32_update_x86(unsigned long *adler, const uint8_t *buf,
+                               unsigned int len)
+{
+    int cpu_flags = av_get_cpu_flags();
+    unsigned blocks = len / 32, i, n;
+    uint32_t sums[2];
+
+    if (!EXTERNAL_SSSE3(cpu_flags))
+        return 0;
+
+    sums[0] = *adler & 0xffff;
+    sums[1] = *adler >> 16;
+    for (i = 0; i < blocks; i += n) {
+        n = FFMIN(blocks - i, NMAX_BLOCKS);
+        ff_adler32_blocks_ssse3(sums, buf + i * 32, n);
+        sums[0] %= 65521;
+        sums[1] %= 65521;
+    }
+    *adler = (sums[1] << 16) | sums[0];
+    return blocks * 32;
+}
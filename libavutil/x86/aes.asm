@@ -0,0 +1,259 @@
+;******************************************************************************
+;* AES-NI encryption and decryption
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "x86util.asm"
+
+SECTION_RODATA
+; byte swap of the 2 qwords
+bswap64: db 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+
+SECTION .text
+
+; The round keys are the ones of the C code: rk[rounds] is applied first
+; and rk[0] last, both for encryption and for decryption, whose middle
+; keys already went through InvMixColumns as aesdec expects.
+struc AVAES
+    .round_key: resb 15 * 16
+    .state:     resb 2 * 16
+    .rounds:    resd 1
+endstruc
+
+; apply %1 with the round key in m4 to the %2 blocks in m0-m3
+%macro AES_OP 2
+    %1        m0, m4
+%if %2 == 4
+    %1        m1, m4
+    %1        m2, m4
+    %1        m3, m4
+%endif
+%endmacro
+
+; encrypt or decrypt the %3 blocks in m0-m3 with the rounds %1 and %2
+%macro AES_ROUNDS 3
+    mov       kd, [aq + AVAES.rounds]
+    shl       kd, 4
+    add       kq, aq
+    movu      m4, [kq]
+    AES_OP    pxor, %3
+    sub       kq, 16
+%%loop:
+    movu      m4, [kq]
+    AES_OP    %1, %3
+    sub       kq, 16
+    cmp       kq, aq
+        jne %%loop
+    movu      m4, [kq]
+    AES_OP    %2, %3
+%endmacro
+
+%macro LOAD4 0
+    movu      m0, [srcq]
+    movu      m1, [srcq + 16]
+    movu      m2, [srcq + 32]
+    movu      m3, [srcq + 48]
+%endmacro
+
+%macro STORE4 0
+    movu [dstq     ], m0
+    movu [dstq + 16], m1
+    movu [dstq + 32], m2
+    movu [dstq + 48], m3
+%endmacro
+
+%if HAVE_AESNI_EXTERNAL
+INIT_XMM aesni
+;-----------------------------------------------------------------------------
+; void ff_aes_encrypt_aesni(AVAES *a, uint8_t *dst, const uint8_t *src,
+;                           int count, uint8_t *iv, int decrypt)
+; CBC encryption is serial, ECB runs 4 blocks in parallel.
+;-----------------------------------------------------------------------------
+cglobal aes_encrypt, 5, 6, 5, a, dst, src, count, iv, k
+    test     ivq, ivq
+        jnz .cbc
+    sub   countd, 4
+        jl .ecb1
+.ecb4:
+    LOAD4
+    AES_ROUNDS aesenc, aesenclast, 4
+    STORE4
+    add     srcq, 64
+    add     dstq, 64
+    sub   countd, 4
+        jge .ecb4
+.ecb1:
+    add   countd, 4
+        jle .end
+.ecb1_loop:
+    movu      m0, [srcq]
+    AES_ROUNDS aesenc, aesenclast, 1
+    movu  [dstq], m0
+    add     srcq, 16
+    add     dstq, 16
+    sub   countd, 1
+        jg .ecb1_loop
+.end:
+    RET
+.cbc:
+    test  countd, countd
+        jle .end
+    movu      m1, [ivq]
+.cbc_loop:
+    movu      m0, [srcq]
+    pxor      m0, m1
+    AES_ROUNDS aesenc, aesenclast, 1
+    mova      m1, m0
+    movu  [dstq], m0
+    add     srcq, 16
+    add     dstq, 16
+    sub   countd, 1
+        jg .cbc_loop
+    movu   [ivq], m1
+    RET
+
+;-----------------------------------------------------------------------------
+; void ff_aes_decrypt_aesni(AVAES *a, uint8_t *dst, const uint8_t *src,
+;                           int count, uint8_t *iv, int decrypt)
+; ECB and CBC run 4 blocks in parallel. For CBC the ciphertext is read before
+; writing dst, which may be equal to src.
+;-----------------------------------------------------------------------------
+cglobal aes_decrypt, 5, 6, 5, a, dst, src, count, iv, k
+    sub   countd, 4
+        jl .tail
+    test     ivq, ivq
+        jnz .cbc4
+.ecb4:
+    LOAD4
+    AES_ROUNDS aesdec, aesdeclast, 4
+    STORE4
+    add     srcq, 64
+    add     dstq, 64
+    sub   countd, 4
+        jge .ecb4
+    jmp .tail
+.cbc4:
+    LOAD4
+    AES_ROUNDS aesdec, aesdeclast, 4
+    movu      m4, [ivq]
+    pxor      m0, m4
+    movu      m4, [srcq]
+    pxor      m1, m4
+    movu      m4, [srcq + 16]
+    pxor      m2, m4
+    movu      m4, [srcq + 32]
+    pxor      m3, m4
+    movu      m4, [srcq + 48]
+    movu   [ivq], m4
+    STORE4
+    add     srcq, 64
+    add     dstq, 64
+    sub   countd, 4
+        jge .cbc4
+.tail:
+    add   countd, 4
+        jle .end
+.loop:
+    movu      m0, [srcq]
+    AES_ROUNDS aesdec, aesdeclast, 1
+    test     ivq, ivq
+        jz .store
+    movu      m4, [ivq]
+    pxor      m0, m4
+    movu      m4, [srcq]
+    movu   [ivq], m4
+.store:
+    movu  [dstq], m0
+    add     srcq, 16
+    add     dstq, 16
+    sub   countd, 1
+        jg .loop
+.end:
+    RET
+
+%if ARCH_X86_64
+; the next counter block into %1, the counter is kept as 2 native qwords
+%macro COUNTER 1
+    movq      %1, hiq
+    pinsrq    %1, loq, 1
+    pshufb    %1, m5
+    add      loq, 1
+    adc      hiq, 0
+%endmacro
+
+; xor the %1 blocks in m0-m3 with src and store them to dst
+%macro XOR_STORE 1
+    movu      m4, [srcq]
+    pxor      m0, m4
+%if %1 == 4
+    movu      m4, [srcq + 16]
+    pxor      m1, m4
+    movu      m4, [srcq + 32]
+    pxor      m2, m4
+    movu      m4, [srcq + 48]
+    pxor      m3, m4
+    STORE4
+%else
+    movu  [dstq], m0
+%endif
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_aes_ctr_aesni(AVAES *a, uint8_t *dst, const uint8_t *src,
+;                       int count, uint8_t *ctr)
+; CTR mode on count whole blocks, 4 blocks in parallel. ctr is the 16-byte
+; big-endian counter, it is updated.
+;-----------------------------------------------------------------------------
+cglobal aes_ctr, 5, 8, 6, a, dst, src, count, ctr, k, hi, lo
+    mova      m5, [bswap64]
+    mov      hiq, [ctrq]
+    mov      loq, [ctrq + 8]
+    bswap    hiq
+    bswap    loq
+    sub   countd, 4
+        jl .tail
+.loop4:
+    COUNTER   m0
+    COUNTER   m1
+    COUNTER   m2
+    COUNTER   m3
+    AES_ROUNDS aesenc, aesenclast, 4
+    XOR_STORE 4
+    add     srcq, 64
+    add     dstq, 64
+    sub   countd, 4
+        jge .loop4
+.tail:
+    add   countd, 4
+        jle .end
+.loop1:
+    COUNTER   m0
+    AES_ROUNDS aesenc, aesenclast, 1
+    XOR_STORE 1
+    add     srcq, 16
+    add     dstq, 16
+    sub   countd, 1
+        jg .loop1
+.end:
+    bswap    hiq
+    bswap    loq
+    mov  [ctrq], hiq
+    mov  [ctrq + 8], loq
+    RET
+%endif
+%endif
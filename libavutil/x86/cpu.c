@@ -45,7 +45,7 @@
         "cpuid                       \n\t"                      \
         "xchg   %%"REG_b", %%"REG_S                             \
         : "=a" (eax), "=S" (ebx), "=c" (ecx), "=d" (edx)        \
-        : "0" (index))
+        : "0" (index), "2" (0))
 
 #define xgetbv(index, eax, edx)                                 \
     __asm__ (".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c" (index))
@@ -126,13 +126,32 @@ int ff_get_cpu_flags_x86(void)
             rval |= AV_CPU_FLAG_SSE4;
         if (ecx & 0x00100000 )
             rval |= AV_CPU_FLAG_SSE42;
+#if HAVE_AESNI
+        if (ecx & 0x02000000)
+            rval |= AV_CPU_FLAG_AESNI;
+#endif
+#if HAVE_PCLMUL
+        if (ecx & 0x00000002)
+            rval |= AV_CPU_FLAG_PCLMUL;
+#endif
+#if HAVE_SHANI
+        if (max_std_level >= 7) {
+            int eax7, ebx7, ecx7, edx7;
+            cpuid(7, eax7, ebx7, ecx7, edx7);
+            if (ebx7 & 0x20000000)
+                rval |= AV_CPU_FLAG_SHANI;
+        }
+#endif
 #if HAVE_AVX
         /* Check OXSAVE and AVX bits */
         if ((ecx & 0x18000000) == 0x18000000) {
             /* Check for OS support */
             xgetbv(0, eax, edx);
-            if ((eax & 0x6) == 0x6)
+            if ((eax & 0x6) == 0x6) {
                 rval |= AV_CPU_FLAG_AVX;
+                if (ecx & 0x00001000)
+                    rval |= AV_CPU_FLAG_FMA3;
+            }
         }
 #if HAVE_AVX2
     if (max_std_level >= 7) {
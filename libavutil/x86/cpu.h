@@ -39,6 +39,10 @@
 #define X86_AVX(flags)              CPUEXT(flags, AVX)
 #define X86_FMA4(flags)             CPUEXT(flags, FMA4)
 #define X86_AVX2(flags)             CPUEXT(flags, AVX2)
+#define X86_FMA3(flags)             CPUEXT(flags, FMA3)
+#define X86_PCLMUL(flags)           CPUEXT(flags, PCLMUL)
+#define X86_SHANI(flags)            CPUEXT(flags, SHANI)
+#define X86_AESNI(flags)            CPUEXT(flags, AESNI)
 
 #define EXTERNAL_AMD3DNOW(flags)    CPUEXT_SUFFIX(flags, _EXTERNAL, AMD3DNOW)
 #define EXTERNAL_AMD3DNOWEXT(flags) CPUEXT_SUFFIX(flags, _EXTERNAL, AMD3DNOWEXT)
@@ -53,6 +57,10 @@
 #define EXTERNAL_AVX(flags)         CPUEXT_SUFFIX(flags, _EXTERNAL, AVX)
 #define EXTERNAL_FMA4(flags)        CPUEXT_SUFFIX(flags, _EXTERNAL, FMA4)
 #define EXTERNAL_AVX2(flags)        CPUEXT_SUFFIX(flags, _EXTERNAL, AVX2)
+#define EXTERNAL_FMA3(flags)        CPUEXT_SUFFIX(flags, _EXTERNAL, FMA3)
+#define EXTERNAL_PCLMUL(flags)      CPUEXT_SUFFIX(flags, _EXTERNAL, PCLMUL)
+#define EXTERNAL_SHANI(flags)       CPUEXT_SUFFIX(flags, _EXTERNAL, SHANI)
+#define EXTERNAL_AESNI(flags)       CPUEXT_SUFFIX(flags, _EXTERNAL, AESNI)
 
 #define INLINE_AMD3DNOW(flags)      CPUEXT_SUFFIX(flags, _INLINE, AMD3DNOW)
 #define INLINE_AMD3DNOWEXT(flags)   CPUEXT_SUFFIX(flags, _INLINE, AMD3DNOWEXT)
@@ -67,6 +75,25 @@
 #define INLINE_AVX(flags)           CPUEXT_SUFFIX(flags, _INLINE, AVX)
 #define INLINE_FMA4(flags)          CPUEXT_SUFFIX(flags, _INLINE, FMA4)
 #define INLINE_AVX2(flags)          CPUEXT_SUFFIX(flags, _INLINE, AVX2)
+#define INLINE_FMA3(flags)          CPUEXT_SUFFIX(flags, _INLINE, FMA3)
+#define INLINE_PCLMUL(flags)        CPUEXT_SUFFIX(flags, _INLINE, PCLMUL)
+#define INLINE_SHANI(flags)         CPUEXT_SUFFIX(flags, _INLINE, SHANI)
+#define INLINE_AESNI(flags)         CPUEXT_SUFFIX(flags, _INLINE, AESNI)
+
+/**
+ * Split a line of len elements between an assembly function, which only
+ * handles whole vectors of step elements, and the C code: the statement simd
+ * is run for the first x = len & ~(step - 1) elements and the statement c
+ * for the len - x remaining ones, each only if it has any element to process.
+ * Both statements can use x.
+ */
+#define FF_SIMD_WITH_C_TAIL(len, step, simd, c) do {                    \
+        const int x = (len) & ~((step) - 1);                            \
+        if (x)                                                          \
+            simd;                                                       \
+        if ((len) > x)                                                  \
+            c;                                                          \
+    } while (0)
 
 void ff_cpu_cpuid(int index, int *eax, int *ebx, int *ecx, int *edx);
 void ff_cpu_xgetbv(int op, int *eax, int *edx);
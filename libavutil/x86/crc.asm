@@ -0,0 +1,101 @@
+;******************************************************************************
+;* CRC folding with PCLMULQDQ
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "x86util.asm"
+
+SECTION .text
+
+struc CRCFold
+    .fold4: resq 2
+    .fold1: resq 2
+    .shuf:  resb 16
+endstruc
+
+; fold %1 by the distance in m7 and add the 16 bytes at %2
+%macro FOLD_BLOCK 2
+    pclmulqdq m4, %1, m7, 0x11
+    pclmulqdq %1, m7, 0x00
+    movu      m5, %2
+    pshufb    m5, m6
+    pxor      %1, m4
+    pxor      %1, m5
+%endmacro
+
+; fold %1 by the distance in m7 into %2
+%macro FOLD_REG 2
+    pclmulqdq m4, %1, m7, 0x11
+    pclmulqdq %1, m7, 0x00
+    pxor      %2, %1
+    pxor      %2, m4
+%endmacro
+
+%if HAVE_PCLMUL_EXTERNAL
+;-----------------------------------------------------------------------------
+; void ff_crc_fold_pclmul(uint8_t rem[16], const CRCFold *f, uint32_t crc,
+;                         const uint8_t *buf, size_t len)
+; Fold the 16-byte blocks of buf, 4 at a time then one at a time, into rem,
+; which has the same CRC starting from 0 as the blocks starting from crc.
+; len must be at least 64.
+;-----------------------------------------------------------------------------
+INIT_XMM pclmul
+cglobal crc_fold, 5, 5, 8, rem, f, crc, buf, len
+    mova      m6, [fq + CRCFold.shuf]
+    movd      m4, crcd
+    movu      m0, [bufq]
+    movu      m1, [bufq + 16]
+    movu      m2, [bufq + 32]
+    movu      m3, [bufq + 48]
+    pxor      m0, m4
+    pshufb    m0, m6
+    pshufb    m1, m6
+    pshufb    m2, m6
+    pshufb    m3, m6
+    mova      m7, [fq + CRCFold.fold4]
+    add     bufq, 64
+    sub     lenq, 64
+    cmp     lenq, 64
+        jb .fold1
+.fold4:
+    FOLD_BLOCK m0, [bufq]
+    FOLD_BLOCK m1, [bufq + 16]
+    FOLD_BLOCK m2, [bufq + 32]
+    FOLD_BLOCK m3, [bufq + 48]
+    add     bufq, 64
+    sub     lenq, 64
+    cmp     lenq, 64
+        jae .fold4
+.fold1:
+    mova      m7, [fq + CRCFold.fold1]
+    FOLD_REG  m0, m1
+    FOLD_REG  m1, m2
+    FOLD_REG  m2, m3
+    cmp     lenq, 16
+        jb .end
+.loop:
+    FOLD_BLOCK m3, [bufq]
+    add     bufq, 16
+    sub     lenq, 16
+    cmp     lenq, 16
+        jae .loop
+.end:
+    pshufb    m3, m6
+    movu  [remq], m3
+    RET
+%endif
@@ -0,0 +1,59 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_X86_CRC_H
+#define AVUTIL_X86_CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libavutil/mem.h"
+
+/**
+ * Constants to fold the message 128 bits at a time with PCLMULQDQ.
+ *
+ * Every CRC of av_crc() is a 32-bit CRC: the le ones are the reflected CRC
+ * of the poly given to av_crc_init(), the others the CRC of poly << (32-bits)
+ * with a byteswapped state. A block A of 128 bits followed by D bits is
+ * congruent to A_hi * (x^(D+64) mod P) + A_lo * (x^D mod P), which fits in
+ * 96 bits and is added to the block D bits later. Folding the message down
+ * to its last 16 bytes does not change its CRC, which is then computed with
+ * the tables.
+ *
+ * The layout is used by crc.asm.
+ */
+typedef struct CRCFold {
+    DECLARE_ALIGNED(16, uint64_t, fold4)[2];   ///< folding by 512 bits
+    DECLARE_ALIGNED(16, uint64_t, fold1)[2];   ///< folding by 128 bits
+    DECLARE_ALIGNED(16, uint8_t,  shuf)[16];   ///< polynomial order of the bytes
+    int init;
+} CRCFold;
+
+void ff_crc_fold_init_x86(CRCFold *f, int le, int bits, uint32_t poly);
+
+/**
+ * Fold the 16-byte blocks of buf into rem, which has the same CRC starting
+ * from 0 as the blocks starting from crc, if the CPU has the needed
+ * extensions. len must be at least 64.
+ *
+ * @return the number of bytes folded
+ */
+size_t ff_crc_fold_x86(const CRCFold *f, uint32_t crc,
+                       const uint8_t *buf, size_t len, uint8_t rem[16]);
+
+#endif /* AVUTIL_X86_CRC_H */
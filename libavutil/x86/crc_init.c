@@ -0,0 +1,89 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "cpu.h"
+#include "crc.h"
+
+void ff_crc_fold_pclmul(uint8_t rem[16], const CRCFold *f, uint32_t crc,
+                        const uint8_t *buf, size_t len);
+
+/* x^n mod (x^32 + q), most significant bit first */
+static av_cold uint32_t crc_xpow(int n, uint32_t q)
+{
+    uint32_t r = 1;
+
+    while (n--)
+        r = (r << 1) ^ (r & 0x80000000 ? q : 0);
+    return r;
+}
+
+static av_cold uint64_t crc_fold_const(int le, int n, uint32_t q)
+{
+    uint32_t r = crc_xpow(n, q);
+    uint32_t v = 0;
+    int i;
+
+    if (!le)
+        return r;
+    /* in the reflected order bit i of a 64-bit half of a block is x^(63-i),
+     * and the product is shifted by one bit */
+    for (i = 0; i < 32; i++)
+        v |= ((r >> i) & 1) << (31 - i);
+    return (uint64_t)v << 1;
+}
+
+av_cold void ff_crc_fold_init_x86(CRCFold *f, int le, int bits, uint32_t poly)
+{
+    uint32_t q = 0;
+    int i;
+
+    if (le) {
+        for (i = 0; i < 32; i++)
+            q |= ((poly >> i) & 1) << (31 - i);
+        /* the low qword holds the high degree coefficients */
+        f->fold4[0] = crc_fold_const(1, 512 + 32, q);
+        f->fold4[1] = crc_fold_const(1, 512 - 32, q);
+        f->fold1[0] = crc_fold_const(1, 128 + 32, q);
+        f->fold1[1] = crc_fold_const(1, 128 - 32, q);
+    } else {
+        q = poly << (32 - bits);
+        f->fold4[0] = crc_fold_const(0, 512,      q);
+        f->fold4[1] = crc_fold_const(0, 512 + 64, q);
+        f->fold1[0] = crc_fold_const(0, 128,      q);
+        f->fold1[1] = crc_fold_const(0, 128 + 64, q);
+    }
+    for (i = 0; i < 16; i++)
+        f->shuf[i] = le ? i : 15 - i;
+    f->init = 1;
+}
+
+size_t ff_crc_fold_x86(const CRCFold *f, uint32_t crc,
+                       const uint8_t *buf, size_t len, uint8_t rem[16])
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_PCLMUL(cpu_flags)) {
+        ff_crc_fold_pclmul(rem, f, crc, buf, len);
+        return len & ~(size_t)15;
+    }
+    return 0;
+}
@@ -51,6 +51,72 @@ INIT_YMM avx
 VECTOR_FMUL
 %endif
 
+;-----------------------------------------------------------------------------
+; void vector_fadd(float *dst, const float *src0, const float *src1, int len)
+;-----------------------------------------------------------------------------
+%macro VECTOR_FADD 0
+cglobal vector_fadd, 4,4,2, dst, src0, src1, len
+    lea       lenq, [lend*4 - 2*mmsize]
+ALIGN 16
+.loop:
+%if mmsize == 32
+    ; the pointers are only 16-byte aligned
+    movu      m0,   [src0q + lenq]
+    movu      m1,   [src0q + lenq + mmsize]
+%else
+    mova      m0,   [src0q + lenq]
+    mova      m1,   [src0q + lenq + mmsize]
+%endif
+    addps     m0, m0, [src1q + lenq]
+    addps     m1, m1, [src1q + lenq + mmsize]
+%if mmsize == 32
+    movu      [dstq + lenq], m0
+    movu      [dstq + lenq + mmsize], m1
+%else
+    mova      [dstq + lenq], m0
+    mova      [dstq + lenq + mmsize], m1
+%endif
+
+    sub       lenq, 2*mmsize
+    jge       .loop
+    REP_RET
+%endmacro
+
+INIT_XMM sse
+VECTOR_FADD
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+VECTOR_FADD
+%endif
+
+;-----------------------------------------------------------------------------
+; void vector_dmul(double *dst, const double *src0, const double *src1,
+;                  int len)
+;-----------------------------------------------------------------------------
+%macro VECTOR_DMUL 0
+cglobal vector_dmul, 4,4,2, dst, src0, src1, len
+    lea       lenq, [lend*8 - 2*mmsize]
+ALIGN 16
+.loop:
+    mova      m0,   [src0q + lenq]
+    mova      m1,   [src0q + lenq + mmsize]
+    mulpd     m0, m0, [src1q + lenq]
+    mulpd     m1, m1, [src1q + lenq + mmsize]
+    mova      [dstq + lenq], m0
+    mova      [dstq + lenq + mmsize], m1
+
+    sub       lenq, 2*mmsize
+    jge       .loop
+    REP_RET
+%endmacro
+
+INIT_XMM sse2
+VECTOR_DMUL
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+VECTOR_DMUL
+%endif
+
 ;------------------------------------------------------------------------------
 ; void ff_vector_fmac_scalar(float *dst, const float *src, float mul, int len)
 ;------------------------------------------------------------------------------
@@ -74,10 +140,17 @@ cglobal vector_fmac_scalar, 4,4,3, dst, src, mul, len
 %endif
     lea    lenq, [lend*4-2*mmsize]
 .loop:
+%if cpuflag(fma3)
+    mova     m1,     [dstq+lenq       ]
+    mova     m2,     [dstq+lenq+mmsize]
+    fmaddps  m1, m0, [srcq+lenq       ], m1
+    fmaddps  m2, m0, [srcq+lenq+mmsize], m2
+%else
     mulps    m1, m0, [srcq+lenq       ]
     mulps    m2, m0, [srcq+lenq+mmsize]
     addps    m1, m1, [dstq+lenq       ]
     addps    m2, m2, [dstq+lenq+mmsize]
+%endif
     mova  [dstq+lenq       ], m1
     mova  [dstq+lenq+mmsize], m2
     sub    lenq, 2*mmsize
@@ -91,6 +164,10 @@ VECTOR_FMAC_SCALAR
 INIT_YMM avx
 VECTOR_FMAC_SCALAR
 %endif
+%if HAVE_FMA3_EXTERNAL
+INIT_YMM fma3
+VECTOR_FMAC_SCALAR
+%endif
 
 ;------------------------------------------------------------------------------
 ; void ff_vector_fmul_scalar(float *dst, const float *src, float mul, int len)
@@ -103,11 +180,34 @@ cglobal vector_fmul_scalar, 3,3,2, dst, src, len
 cglobal vector_fmul_scalar, 4,4,3, dst, src, mul, len
 %endif
 %if ARCH_X86_32
-    movss    m0, mulm
-%elif WIN64
-    SWAP 0, 2
+    VBROADCASTSS m0, mulm
+%else
+%if WIN64
+    mova       xmm0, xmm2
 %endif
-    shufps   m0, m0, 0
+    shufps     xmm0, xmm0, 0
+%if cpuflag(avx)
+    vinsertf128  m0, m0, xmm0, 1
+%endif
+%endif
+%if mmsize == 32
+    ; len is a multiple of 4 only and the pointers are 16-byte aligned
+    movsxdifnidn lenq, lend
+    shl    lenq, 2
+    sub    lenq, mmsize
+    jl .tail
+.loop:
+    mulps    m1, m0, [srcq+lenq]
+    movu  [dstq+lenq], m1
+    sub    lenq, mmsize
+    jge .loop
+.tail:
+    cmp    lenq, -16
+    jne .end
+    mulps  xmm1, xmm0, [srcq]
+    movu  [dstq], xmm1
+.end:
+%else
     lea    lenq, [lend*4-mmsize]
 .loop:
     mova     m1, [srcq+lenq]
@@ -115,11 +215,16 @@ cglobal vector_fmul_scalar, 4,4,3, dst, src, mul, len
     mova  [dstq+lenq], m1
     sub    lenq, mmsize
     jge .loop
+%endif
     REP_RET
 %endmacro
 
 INIT_XMM sse
 VECTOR_FMUL_SCALAR
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+VECTOR_FMUL_SCALAR
+%endif
 
 ;------------------------------------------------------------------------------
 ; void ff_vector_dmul_scalar(double *dst, const double *src, double mul,
@@ -168,22 +273,89 @@ VECTOR_DMUL_SCALAR
 INIT_YMM avx
 VECTOR_DMUL_SCALAR
 %endif
+;------------------------------------------------------------------------------
+; void ff_vector_dmac_scalar(double *dst, const double *src, double mul,
+;                            int len)
+;------------------------------------------------------------------------------
+
+%macro VECTOR_DMAC_SCALAR 0
+%if ARCH_X86_32
+cglobal vector_dmac_scalar, 3,4,3, dst, src, mul, len, lenaddr
+    mov          lenq, lenaddrm
+%elif UNIX64
+cglobal vector_dmac_scalar, 3,3,3, dst, src, len
+%else
+cglobal vector_dmac_scalar, 4,4,3, dst, src, mul, len
+%endif
+%if ARCH_X86_32
+    VBROADCASTSD   m0, mulm
+%else
+%if WIN64
+    movlhps      xmm2, xmm2
+%if cpuflag(avx)
+    vinsertf128  ymm2, ymm2, xmm2, 1
+%endif
+    SWAP 0, 2
+%else
+    movlhps      xmm0, xmm0
+%if cpuflag(avx)
+    vinsertf128  ymm0, ymm0, xmm0, 1
+%endif
+%endif
+%endif
+    lea          lenq, [lend*8-2*mmsize]
+.loop:
+%if cpuflag(fma3)
+    mova           m1,     [dstq+lenq       ]
+    mova           m2,     [dstq+lenq+mmsize]
+    fmaddpd        m1, m0, [srcq+lenq       ], m1
+    fmaddpd        m2, m0, [srcq+lenq+mmsize], m2
+%else
+    mulpd          m1, m0, [srcq+lenq       ]
+    mulpd          m2, m0, [srcq+lenq+mmsize]
+    addpd          m1, m1, [dstq+lenq       ]
+    addpd          m2, m2, [dstq+lenq+mmsize]
+%endif
+    mova   [dstq+lenq       ], m1
+    mova   [dstq+lenq+mmsize], m2
+    sub          lenq, 2*mmsize
+    jge .loop
+    REP_RET
+%endmacro
+
+INIT_XMM sse2
+VECTOR_DMAC_SCALAR
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+VECTOR_DMAC_SCALAR
+%endif
+%if HAVE_FMA3_EXTERNAL
+INIT_YMM fma3
+VECTOR_DMAC_SCALAR
+%endif
 
 ;-----------------------------------------------------------------------------
 ; vector_fmul_add(float *dst, const float *src0, const float *src1,
 ;                 const float *src2, int len)
 ;-----------------------------------------------------------------------------
 %macro VECTOR_FMUL_ADD 0
-cglobal vector_fmul_add, 5,5,2, dst, src0, src1, src2, len
+cglobal vector_fmul_add, 5,5,4, dst, src0, src1, src2, len
     lea       lenq, [lend*4 - 2*mmsize]
 ALIGN 16
 .loop:
     mova    m0,   [src0q + lenq]
     mova    m1,   [src0q + lenq + mmsize]
+%if cpuflag(fma3)
+    mova    m2,     [src2q + lenq]
+    mova    m3,     [src2q + lenq + mmsize]
+    fmaddps m0, m0, [src1q + lenq], m2
+    fmaddps m1, m1, [src1q + lenq + mmsize], m3
+%else
     mulps   m0, m0, [src1q + lenq]
     mulps   m1, m1, [src1q + lenq + mmsize]
     addps   m0, m0, [src2q + lenq]
     addps   m1, m1, [src2q + lenq + mmsize]
+%endif
     mova    [dstq + lenq], m0
     mova    [dstq + lenq + mmsize], m1
 
@@ -198,6 +370,10 @@ VECTOR_FMUL_ADD
 INIT_YMM avx
 VECTOR_FMUL_ADD
 %endif
+%if HAVE_FMA3_EXTERNAL
+INIT_YMM fma3
+VECTOR_FMUL_ADD
+%endif
 
 ;-----------------------------------------------------------------------------
 ; void vector_fmul_reverse(float *dst, const float *src0, const float *src1,
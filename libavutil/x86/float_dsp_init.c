@@ -29,23 +29,46 @@ void ff_vector_fmul_sse(float *dst, const float *src0, const float *src1,
 void ff_vector_fmul_avx(float *dst, const float *src0, const float *src1,
                         int len);
 
+void ff_vector_fadd_sse(float *dst, const float *src0, const float *src1,
+                        int len);
+void ff_vector_fadd_avx(float *dst, const float *src0, const float *src1,
+                        int len);
+
+void ff_vector_dmul_sse2(double *dst, const double *src0, const double *src1,
+                         int len);
+void ff_vector_dmul_avx(double *dst, const double *src0, const double *src1,
+                        int len);
+
 void ff_vector_fmac_scalar_sse(float *dst, const float *src, float mul,
                                int len);
 void ff_vector_fmac_scalar_avx(float *dst, const float *src, float mul,
                                int len);
+void ff_vector_fmac_scalar_fma3(float *dst, const float *src, float mul,
+                                int len);
 
 void ff_vector_fmul_scalar_sse(float *dst, const float *src, float mul,
                                int len);
+void ff_vector_fmul_scalar_avx(float *dst, const float *src, float mul,
+                               int len);
 
 void ff_vector_dmul_scalar_sse2(double *dst, const double *src,
                                 double mul, int len);
 void ff_vector_dmul_scalar_avx(double *dst, const double *src,
                                double mul, int len);
 
+void ff_vector_dmac_scalar_sse2(double *dst, const double *src,
+                                double mul, int len);
+void ff_vector_dmac_scalar_avx(double *dst, const double *src,
+                               double mul, int len);
+void ff_vector_dmac_scalar_fma3(double *dst, const double *src,
+                                double mul, int len);
+
 void ff_vector_fmul_add_sse(float *dst, const float *src0, const float *src1,
                             const float *src2, int len);
 void ff_vector_fmul_add_avx(float *dst, const float *src0, const float *src1,
                             const float *src2, int len);
+void ff_vector_fmul_add_fma3(float *dst, const float *src0, const float *src1,
+                             const float *src2, int len);
 
 void ff_vector_fmul_reverse_sse(float *dst, const float *src0,
                                 const float *src1, int len);
@@ -122,7 +145,7 @@ static void vector_fmul_window_sse(float *dst, const float *src0,
 }
 #endif /* HAVE_6REGS && HAVE_INLINE_ASM */
 
-av_cold void ff_float_dsp_init_x86(AVFloatDSPContext *fdsp)
+av_cold void ff_float_dsp_init_x86(AVFloatDSPContext *fdsp, int strict)
 {
     int cpu_flags = av_get_cpu_flags();
 
@@ -142,15 +165,29 @@ av_cold void ff_float_dsp_init_x86(AVFloatDSPContext *fdsp)
         fdsp->vector_fmul_reverse = ff_vector_fmul_reverse_sse;
         fdsp->scalarproduct_float = ff_scalarproduct_float_sse;
         fdsp->butterflies_float   = ff_butterflies_float_sse;
+        fdsp->vector_fadd         = ff_vector_fadd_sse;
     }
     if (EXTERNAL_SSE2(cpu_flags)) {
         fdsp->vector_dmul_scalar = ff_vector_dmul_scalar_sse2;
+        fdsp->vector_dmul        = ff_vector_dmul_sse2;
+        fdsp->vector_dmac_scalar = ff_vector_dmac_scalar_sse2;
     }
     if (EXTERNAL_AVX(cpu_flags)) {
         fdsp->vector_fmul = ff_vector_fmul_avx;
         fdsp->vector_fmac_scalar = ff_vector_fmac_scalar_avx;
+        fdsp->vector_fmul_scalar = ff_vector_fmul_scalar_avx;
         fdsp->vector_dmul_scalar = ff_vector_dmul_scalar_avx;
         fdsp->vector_fmul_add    = ff_vector_fmul_add_avx;
         fdsp->vector_fmul_reverse = ff_vector_fmul_reverse_avx;
+        fdsp->vector_fadd        = ff_vector_fadd_avx;
+        fdsp->vector_dmul        = ff_vector_dmul_avx;
+        fdsp->vector_dmac_scalar = ff_vector_dmac_scalar_avx;
+    }
+    /* FMA3 rounds once per multiply-add, so the results differ from the
+     * separate multiply and add of the other versions. */
+    if (EXTERNAL_FMA3(cpu_flags) && !strict) {
+        fdsp->vector_fmac_scalar = ff_vector_fmac_scalar_fma3;
+        fdsp->vector_dmac_scalar = ff_vector_dmac_scalar_fma3;
+        fdsp->vector_fmul_add    = ff_vector_fmul_add_fma3;
     }
 }
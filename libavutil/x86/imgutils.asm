@@ -0,0 +1,65 @@
+;******************************************************************************
+;* Image copy with non-temporal loads and stores
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "x86util.asm"
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; void ff_image_copy_<name>(uint8_t *dst, const uint8_t *src, int n)
+; Copy n bytes, a non-zero multiple of 64, 64 bytes at a time. The loads are
+; unaligned (movu) or non-temporal (movntdqa, src 16-byte aligned), the
+; stores unaligned (movu) or non-temporal (movntdq, dst 16-byte aligned).
+;-----------------------------------------------------------------------------
+; %1 = name, %2 = load instruction, %3 = store instruction
+%macro IMAGE_COPY_64 3
+cglobal image_copy_%1, 3,3,4, dst, src, n
+    movsxdifnidn nq, nd
+    add        dstq, nq
+    add        srcq, nq
+    neg          nq
+.loop:
+    %2           m0, [srcq+nq]
+    %2           m1, [srcq+nq+16]
+    %2           m2, [srcq+nq+32]
+    %2           m3, [srcq+nq+48]
+    %3 [dstq+nq],    m0
+    %3 [dstq+nq+16], m1
+    %3 [dstq+nq+32], m2
+    %3 [dstq+nq+48], m3
+    add          nq, 64
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+IMAGE_COPY_64 nt, movu, movntdq
+
+;-----------------------------------------------------------------------------
+; void ff_image_copy_sfence_sse2(void)
+; Order the non-temporal stores of the copies before the following stores.
+;-----------------------------------------------------------------------------
+cglobal image_copy_sfence, 0,0,0
+    sfence
+    RET
+
+INIT_XMM sse4
+IMAGE_COPY_64 uc,    movntdqa, movu
+IMAGE_COPY_64 uc_nt, movntdqa, movntdq
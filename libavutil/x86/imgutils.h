@@ -0,0 +1,34 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_X86_IMGUTILS_H
+#define AVUTIL_X86_IMGUTILS_H
+
+#include <stdint.h>
+
+/**
+ * Copy a plane for av_image_copy_plane2() with non-temporal loads or
+ * stores, if flags asks for them and the CPU has the needed extensions.
+ *
+ * @return 0 if the plane was copied, a negative AVERROR code otherwise
+ */
+int ff_image_copy_plane2_x86(uint8_t       *dst, int dst_linesize,
+                             const uint8_t *src, int src_linesize,
+                             int bytewidth, int height, int flags);
+
+#endif /* AVUTIL_X86_IMGUTILS_H */
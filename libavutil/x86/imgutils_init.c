@@ -0,0 +1,97 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "libavutil/cpu.h"
+#include "libavutil/error.h"
+#include "libavutil/imgutils.h"
+#include "cpu.h"
+#include "imgutils.h"
+
+void ff_image_copy_nt_sse2(uint8_t *dst, const uint8_t *src, int n);
+void ff_image_copy_uc_sse4(uint8_t *dst, const uint8_t *src, int n);
+void ff_image_copy_uc_nt_sse4(uint8_t *dst, const uint8_t *src, int n);
+void ff_image_copy_sfence_sse2(void);
+
+/* align the loads on src, which is then read in whole cache lines */
+static void copy_plane_uc_sse4(uint8_t       *dst, int dst_linesize,
+                               const uint8_t *src, int src_linesize,
+                               int bytewidth, int height, int nt)
+{
+    for (; height > 0; height--) {
+        int head = -(uintptr_t)src & 15;
+        int body = (bytewidth - head) & ~63;
+
+        memcpy(dst, src, head);
+        if (nt && !((uintptr_t)(dst + head) & 15))
+            ff_image_copy_uc_nt_sse4(dst + head, src + head, body);
+        else
+            ff_image_copy_uc_sse4(dst + head, src + head, body);
+        memcpy(dst + head + body, src + head + body, bytewidth - head - body);
+        dst += dst_linesize;
+        src += src_linesize;
+    }
+    if (nt)
+        ff_image_copy_sfence_sse2();
+}
+
+/* align the stores on dst */
+static void copy_plane_nt_sse2(uint8_t       *dst, int dst_linesize,
+                               const uint8_t *src, int src_linesize,
+                               int bytewidth, int height)
+{
+    for (; height > 0; height--) {
+        int head = -(uintptr_t)dst & 15;
+        int body = (bytewidth - head) & ~63;
+
+        memcpy(dst, src, head);
+        ff_image_copy_nt_sse2(dst + head, src + head, body);
+        memcpy(dst + head + body, src + head + body, bytewidth - head - body);
+        dst += dst_linesize;
+        src += src_linesize;
+    }
+    ff_image_copy_sfence_sse2();
+}
+
+int ff_image_copy_plane2_x86(uint8_t       *dst, int dst_linesize,
+                             const uint8_t *src, int src_linesize,
+                             int bytewidth, int height, int flags)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    /* the kernels copy at least 64 bytes per line after the aligned head */
+    if (bytewidth < 128)
+        return AVERROR(ENOSYS);
+
+    if (flags & AV_IMAGE_COPY_FLAG_UC_SRC && EXTERNAL_SSE4(cpu_flags)) {
+        copy_plane_uc_sse4(dst, dst_linesize, src, src_linesize, bytewidth,
+                           height, flags & AV_IMAGE_COPY_FLAG_NT_STORE);
+        return 0;
+    }
+    if (flags & AV_IMAGE_COPY_FLAG_NT_STORE && EXTERNAL_SSE2(cpu_flags)) {
+        copy_plane_nt_sse2(dst, dst_linesize, src, src_linesize, bytewidth,
+                           height);
+        return 0;
+    }
+
+    return AVERROR(ENOSYS);
+}
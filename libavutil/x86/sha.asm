@@ -0,0 +1,209 @@
+;******************************************************************************
+;* SHA-1 and SHA-256 with the SHA extensions
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "x86util.asm"
+
+SECTION_RODATA
+
+sha1_shuf:    db 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+sha256_shuf:  db 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+k256:         dd 0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5
+              dd 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5
+              dd 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3
+              dd 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174
+              dd 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc
+              dd 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da
+              dd 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7
+              dd 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967
+              dd 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13
+              dd 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85
+              dd 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3
+              dd 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070
+              dd 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5
+              dd 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3
+              dd 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208
+              dd 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+
+SECTION .text
+
+; m0: ABCD, m1/m2: E, m3-m6: message schedule, m7: byte shuffle
+%macro SHA1_LOAD 2
+    movu        %1, [bufq + %2]
+    pshufb      %1, m7
+%endmacro
+
+; 4 rounds with the function %1, E in %2, the next E is saved in %3,
+; %4 holds W[4i..4i+3]
+%macro SHA1_RNDS 4
+    sha1nexte   %2, %4
+    mova        %3, m0
+    sha1rnds4   m0, %2, %1
+%endmacro
+
+; %1 holds W[4i..4i+3], %2 is the next schedule register, %4 the previous
+%macro SHA1_SCHED 4
+    sha1msg2    %2, %1
+    sha1msg1    %4, %1
+    pxor        %3, %1
+%endmacro
+
+%macro SHA1_ROUNDS 7
+    SHA1_RNDS   %1, %2, %3, %4
+    SHA1_SCHED  %4, %5, %6, %7
+%endmacro
+
+%if HAVE_SHANI_EXTERNAL
+;-----------------------------------------------------------------------------
+; void ff_sha1_transform_shani(uint32_t *state, const uint8_t buffer[64])
+;-----------------------------------------------------------------------------
+INIT_XMM shani
+cglobal sha1_transform, 2, 2, 8, state, buf
+    movu        m0, [stateq]
+    pxor        m1, m1
+    pinsrd      m1, [stateq + 16], 3
+    pshufd      m0, m0, q0123
+    mova        m7, [sha1_shuf]
+    SHA1_LOAD   m3, 0
+    paddd       m1, m3
+    mova        m2, m0
+    sha1rnds4   m0, m1, 0
+    SHA1_LOAD   m4, 16
+    SHA1_RNDS   0, m2, m1, m4
+    sha1msg1    m3, m4
+    SHA1_LOAD   m5, 32
+    SHA1_RNDS   0, m1, m2, m5
+    sha1msg1    m4, m5
+    pxor        m3, m5
+    SHA1_LOAD   m6, 48
+    SHA1_ROUNDS 0, m2, m1, m6, m3, m4, m5
+    SHA1_ROUNDS 0, m1, m2, m3, m4, m5, m6
+    SHA1_ROUNDS 1, m2, m1, m4, m5, m6, m3
+    SHA1_ROUNDS 1, m1, m2, m5, m6, m3, m4
+    SHA1_ROUNDS 1, m2, m1, m6, m3, m4, m5
+    SHA1_ROUNDS 1, m1, m2, m3, m4, m5, m6
+    SHA1_ROUNDS 1, m2, m1, m4, m5, m6, m3
+    SHA1_ROUNDS 2, m1, m2, m5, m6, m3, m4
+    SHA1_ROUNDS 2, m2, m1, m6, m3, m4, m5
+    SHA1_ROUNDS 2, m1, m2, m3, m4, m5, m6
+    SHA1_ROUNDS 2, m2, m1, m4, m5, m6, m3
+    SHA1_ROUNDS 2, m1, m2, m5, m6, m3, m4
+    SHA1_ROUNDS 3, m2, m1, m6, m3, m4, m5
+    SHA1_ROUNDS 3, m1, m2, m3, m4, m5, m6
+    SHA1_RNDS   3, m2, m1, m4
+    sha1msg2    m5, m4
+    pxor        m6, m4
+    SHA1_RNDS   3, m1, m2, m5
+    sha1msg2    m6, m5
+    SHA1_RNDS   3, m2, m1, m6
+    ; only the high dword of E is used by sha1nexte
+    movu        m3, [stateq]
+    pinsrd      m4, [stateq + 16], 3
+    pshufd      m3, m3, q0123
+    sha1nexte   m1, m4
+    paddd       m0, m3
+    pshufd      m0, m0, q0123
+    movu  [stateq], m0
+    pextrd [stateq + 16], m1, 3
+    RET
+
+; m0: message plus constants, m1: ABEF, m2: CDGH, m3-m6: message schedule,
+; m7: scratch
+%macro SHA256_LOAD 2
+    movu        %1, [bufq + %2 * 16]
+    pshufb      %1, [sha256_shuf]
+    mova        m0, %1
+%endmacro
+
+; 4 rounds, sha256rnds2 takes the message plus constants in xmm0
+%macro SHA256_RNDS 1
+    paddd       m0, [k256 + %1 * 16]
+    sha256rnds2 m2, m1
+    pshufd      m0, m0, q0032
+    sha256rnds2 m1, m2
+%endmacro
+
+; %1 holds W[4i..4i+3], compute the next schedule register %2
+%macro SHA256_MSG2 3
+    mova        m7, %1
+    palignr     m7, %3, 4
+    paddd       %2, m7
+    sha256msg2  %2, %1
+%endmacro
+
+%macro SHA256_ROUNDS 4
+    mova        m0, %2
+    SHA256_RNDS %1
+    SHA256_MSG2 %2, %3, %4
+    sha256msg1  %4, %2
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_sha256_transform_shani(uint32_t *state, const uint8_t buffer[64])
+;-----------------------------------------------------------------------------
+cglobal sha256_transform, 2, 2, 8, state, buf
+    movu        m1, [stateq]
+    movu        m2, [stateq + 16]
+    pshufd      m1, m1, q2301
+    pshufd      m2, m2, q0123
+    mova        m7, m1
+    palignr     m1, m2, 8
+    pblendw     m2, m7, 0xF0
+    SHA256_LOAD m3, 0
+    SHA256_RNDS 0
+    SHA256_LOAD m4, 1
+    SHA256_RNDS 1
+    sha256msg1  m3, m4
+    SHA256_LOAD m5, 2
+    SHA256_RNDS 2
+    sha256msg1  m4, m5
+    SHA256_LOAD m6, 3
+    SHA256_RNDS 3
+    SHA256_MSG2 m6, m3, m5
+    sha256msg1  m5, m6
+    SHA256_ROUNDS  4, m3, m4, m6
+    SHA256_ROUNDS  5, m4, m5, m3
+    SHA256_ROUNDS  6, m5, m6, m4
+    SHA256_ROUNDS  7, m6, m3, m5
+    SHA256_ROUNDS  8, m3, m4, m6
+    SHA256_ROUNDS  9, m4, m5, m3
+    SHA256_ROUNDS 10, m5, m6, m4
+    SHA256_ROUNDS 11, m6, m3, m5
+    SHA256_ROUNDS 12, m3, m4, m6
+    mova        m0, m4
+    SHA256_RNDS 13
+    SHA256_MSG2 m4, m5, m3
+    mova        m0, m5
+    SHA256_RNDS 14
+    SHA256_MSG2 m5, m6, m4
+    mova        m0, m6
+    SHA256_RNDS 15
+    pshufd      m1, m1, q0123
+    pshufd      m2, m2, q2301
+    mova        m7, m1
+    pblendw     m1, m2, 0xF0
+    palignr     m2, m7, 8
+    movu        m3, [stateq]
+    movu        m4, [stateq + 16]
+    paddd       m1, m3
+    paddd       m2, m4
+    movu  [stateq], m1
+    movu [stateq + 16], m2
+    RET
+%endif
@@ -0,0 +1,32 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_X86_SHA_H
+#define AVUTIL_X86_SHA_H
+
+#include <stdint.h>
+
+/**
+ * Set *transform to the fastest block function for the hash of the given
+ * size supported by the CPU, if any is faster than the C one.
+ */
+void ff_sha_init_x86(void (**transform)(uint32_t *state,
+                                        const uint8_t buffer[64]),
+                     int bits);
+
+#endif /* AVUTIL_X86_SHA_H */
@@ -755,6 +755,9 @@ SECTION .note.GNU-stack noalloc noexec nowrite progbits
 %assign cpuflags_atom     (1<<21)
 %assign cpuflags_bmi1     (1<<22)|cpuflags_lzcnt
 %assign cpuflags_bmi2     (1<<23)|cpuflags_bmi1
+%assign cpuflags_pclmul   (1<<24)|cpuflags_sse42
+%assign cpuflags_shani    (1<<25)|cpuflags_sse42
+%assign cpuflags_aesni    (1<<26)|cpuflags_sse42
 
 %define    cpuflag(x) ((cpuflags & (cpuflags_ %+ x)) == (cpuflags_ %+ x))
 %define notcpuflag(x) ((cpuflags & (cpuflags_ %+ x)) != (cpuflags_ %+ x))
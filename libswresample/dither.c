@@ -23,53 +23,55 @@
 
 #include "noise_shaping_data.c"
 
-void swri_get_dither(SwrContext *s, void *dst, int len, unsigned seed, enum AVSampleFormat noise_fmt) {
+/* number of samples noise shaped at once by DitherContext.noise_shaping_simd */
+#define NS_SIMD_CHUNK 256
+
+int swri_get_dither(SwrContext *s, void *dst, int len, unsigned seed, enum AVSampleFormat noise_fmt) {
     double scale = s->dither.noise_scale;
 #define TMP_EXTRA 2
-    double *tmp = av_malloc((len + TMP_EXTRA) * sizeof(double));
+    double *tmp = av_malloc_array(len + TMP_EXTRA + 3, sizeof(double));
     int i;
 
-    for(i=0; i<len + TMP_EXTRA; i++){
-        double v;
-        seed = seed* 1664525 + 1013904223;
-
-        switch(s->dither.method){
-            case SWR_DITHER_RECTANGULAR: v= ((double)seed) / UINT_MAX - 0.5; break;
-            default:
-                av_assert0(s->dither.method < SWR_DITHER_NB);
-                v = ((double)seed) / UINT_MAX;
-                seed = seed*1664525 + 1013904223;
-                v-= ((double)seed) / UINT_MAX;
-                break;
-        }
-        tmp[i] = v;
-    }
+    if (!tmp)
+        return AVERROR(ENOMEM);
 
-    for(i=0; i<len; i++){
-        double v;
-
-        switch(s->dither.method){
-            default:
-                av_assert0(s->dither.method < SWR_DITHER_NB);
-                v = tmp[i];
-                break;
-            case SWR_DITHER_TRIANGULAR_HIGHPASS :
-                v = (- tmp[i] + 2*tmp[i+1] - tmp[i+2]) / sqrt(6);
-                break;
+    av_assert0(s->dither.method < SWR_DITHER_NB);
+    if (s->dither.get_noise_simd) {
+        DECLARE_ALIGNED(16, uint32_t, seeds)[4];
+        for (i = 0; i < 4; i++)
+            seeds[i] = seed = seed* 1664525 + 1013904223;
+        s->dither.get_noise_simd(tmp, seeds, len + TMP_EXTRA);
+    } else if (s->dither.method == SWR_DITHER_RECTANGULAR) {
+        for(i=0; i<len + TMP_EXTRA; i++){
+            seed = seed* 1664525 + 1013904223;
+            tmp[i] = ((double)seed) / UINT_MAX - 0.5;
+        }
+    } else {
+        for(i=0; i<len + TMP_EXTRA; i++){
+            double v;
+            seed = seed* 1664525 + 1013904223;
+            v = ((double)seed) / UINT_MAX;
+            seed = seed*1664525 + 1013904223;
+            v-= ((double)seed) / UINT_MAX;
+            tmp[i] = v;
         }
+    }
 
-        v*= scale;
+    if (s->dither.method == SWR_DITHER_TRIANGULAR_HIGHPASS) {
+        for(i=0; i<len; i++)
+            tmp[i] = (- tmp[i] + 2*tmp[i+1] - tmp[i+2]) / sqrt(6);
+    }
 
-        switch(noise_fmt){
-            case AV_SAMPLE_FMT_S16P: ((int16_t*)dst)[i] = v; break;
-            case AV_SAMPLE_FMT_S32P: ((int32_t*)dst)[i] = v; break;
-            case AV_SAMPLE_FMT_FLTP: ((float  *)dst)[i] = v; break;
-            case AV_SAMPLE_FMT_DBLP: ((double *)dst)[i] = v; break;
-            default: av_assert0(0);
-        }
+    switch(noise_fmt){
+    case AV_SAMPLE_FMT_S16P: for(i=0; i<len; i++) ((int16_t*)dst)[i] = tmp[i] * scale; break;
+    case AV_SAMPLE_FMT_S32P: for(i=0; i<len; i++) ((int32_t*)dst)[i] = tmp[i] * scale; break;
+    case AV_SAMPLE_FMT_FLTP: for(i=0; i<len; i++) ((float  *)dst)[i] = tmp[i] * scale; break;
+    case AV_SAMPLE_FMT_DBLP: for(i=0; i<len; i++) ((double *)dst)[i] = tmp[i] * scale; break;
+    default: av_assert0(0);
     }
 
     av_free(tmp);
+    return 0;
 }
 
 int swri_dither_init(SwrContext *s, enum AVSampleFormat out_fmt, enum AVSampleFormat in_fmt)
@@ -118,6 +120,9 @@ int swri_dither_init(SwrContext *s, enum AVSampleFormat out_fmt, enum AVSampleFo
         av_log(s, AV_LOG_WARNING, "Requested noise shaping dither not available at this sampling rate, using triangular hp dither\n");
         s->dither.method = SWR_DITHER_TRIANGULAR_HIGHPASS;
     }
+    s->dither.get_noise_simd     = NULL;
+    s->dither.noise_shaping_simd = NULL;
+    if (HAVE_YASM && HAVE_MMX) swri_dither_init_x86(s);
 
     av_assert0(!s->preout.count);
     s->dither.noise = s->preout;
@@ -146,3 +151,107 @@ int swri_dither_init(SwrContext *s, enum AVSampleFormat out_fmt, enum AVSampleFo
 #define TEMPLATE_DITHER_DBL
 #include "dither_template.c"
 #undef TEMPLATE_DITHER_DBL
+
+#ifdef TEST
+#include <stdio.h>
+#include "libavutil/cpu.h"
+#include "libavutil/opt.h"
+
+#define NB_SAMPLES 1500
+
+/**
+ * Convert stereo audio with dithering, in 2 calls so that the noise shaping
+ * state is carried over.
+ */
+static int dither(uint8_t *out, int cpu_flags, int method, int rate,
+                  enum AVSampleFormat in_fmt, enum AVSampleFormat int_fmt,
+                  enum AVSampleFormat out_fmt, const uint8_t *in)
+{
+    const int in_bps  = 2 * av_get_bytes_per_sample(in_fmt);
+    const int out_bps = 2 * av_get_bytes_per_sample(out_fmt);
+    const uint8_t *in2 = in + 700 * in_bps;
+    uint8_t *out2;
+    SwrContext *s;
+    int ret, n;
+
+    av_force_cpu_flags(cpu_flags);
+    s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_STEREO, out_fmt, rate,
+                                 AV_CH_LAYOUT_STEREO, in_fmt,  rate, 0, NULL);
+    if (!s) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    av_opt_set_int(s, "dither_method", method, 0);
+    av_opt_set_sample_fmt(s, "internal_sample_fmt", int_fmt, 0);
+    if ((ret = swr_init(s)) < 0)
+        goto end;
+
+    if ((ret = swr_convert(s, &out, 700, &in, 700)) < 0)
+        goto end;
+    n    = ret;
+    out2 = out + n * out_bps;
+    if ((ret = swr_convert(s, &out2, NB_SAMPLES - n, &in2, NB_SAMPLES - 700)) < 0)
+        goto end;
+    ret += n;
+
+end:
+    av_force_cpu_flags(-1);
+    swr_free(&s);
+    return ret;
+}
+
+int main(void)
+{
+    static const int methods[] = {
+        SWR_DITHER_RECTANGULAR, SWR_DITHER_TRIANGULAR, SWR_DITHER_TRIANGULAR_HIGHPASS,
+        SWR_DITHER_NS_LIPSHITZ, SWR_DITHER_NS_F_WEIGHTED, SWR_DITHER_NS_MODIFIED_E_WEIGHTED,
+        SWR_DITHER_NS_IMPROVED_E_WEIGHTED, SWR_DITHER_NS_SHIBATA, SWR_DITHER_NS_LOW_SHIBATA,
+        SWR_DITHER_NS_HIGH_SHIBATA,
+    };
+    /* input, internal and output sample formats */
+    static const enum AVSampleFormat fmts[][3] = {
+        { AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_S16 },
+        { AV_SAMPLE_FMT_DBL, AV_SAMPLE_FMT_DBLP, AV_SAMPLE_FMT_S16 },
+        { AV_SAMPLE_FMT_S32, AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_S16 },
+        { AV_SAMPLE_FMT_S16, AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_U8  },
+    };
+    static const int rates[] = { 44100, 48000 };
+    double *in  = av_malloc(2 * NB_SAMPLES * sizeof(double));
+    uint8_t *ref = av_malloc(2 * NB_SAMPLES * 2), *out = av_malloc(2 * NB_SAMPLES * 2);
+    int m, f, r, i, n, n_ref, ret = 0;
+
+    if (!in || !ref || !out)
+        return 1;
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    for (m = 0; m < FF_ARRAY_ELEMS(methods); m++)
+    for (f = 0; f < FF_ARRAY_ELEMS(fmts); f++)
+    for (r = 0; r < FF_ARRAY_ELEMS(rates); r++) {
+        const int out_bps = 2 * av_get_bytes_per_sample(fmts[f][2]);
+
+        for (i = 0; i < 2 * NB_SAMPLES; i++) {
+            double v = sin(i * 0.013) * 0.6 + sin(i * 0.77) * 0.3;
+            switch (fmts[f][0]) {
+            case AV_SAMPLE_FMT_FLT: ((float   *)in)[i] = v; break;
+            case AV_SAMPLE_FMT_DBL: ((double  *)in)[i] = v; break;
+            case AV_SAMPLE_FMT_S32: ((int32_t *)in)[i] = lrint(v * INT32_MAX); break;
+            case AV_SAMPLE_FMT_S16: ((int16_t *)in)[i] = lrint(v * INT16_MAX); break;
+            }
+        }
+
+        n_ref = dither(ref, 0,  methods[m], rates[r], fmts[f][0], fmts[f][1], fmts[f][2], (uint8_t *)in);
+        n     = dither(out, -1, methods[m], rates[r], fmts[f][0], fmts[f][1], fmts[f][2], (uint8_t *)in);
+        if (n_ref <= 0 || n != n_ref || memcmp(ref, out, n * out_bps)) {
+            fprintf(stderr, "dither method %d %s %d Hz: SIMD output differs from C\n",
+                    methods[m], av_get_sample_fmt_name(fmts[f][1]), rates[r]);
+            ret = 1;
+        }
+    }
+
+    av_free(in);
+    av_free(ref);
+    av_free(out);
+    return ret;
+}
+#endif
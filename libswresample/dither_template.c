@@ -23,7 +23,7 @@
 ERROR
 #endif
 
-void RENAME(swri_noise_shaping)(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count){
+int RENAME(swri_noise_shaping)(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count, int ch_start, int ch_end){
     int pos = s->dither.ns_pos;
     int i, j, ch;
     int taps  = s->dither.ns_taps;
@@ -33,13 +33,29 @@ void RENAME(swri_noise_shaping)(SwrContext *s, AudioData *dsts, const AudioData
     av_assert2((taps&3) != 2);
     av_assert2((taps&3) != 3 || s->dither.ns_coeffs[taps] == 0);
 
-    for (ch=0; ch<srcs->ch_count; ch++) {
+    for (ch=ch_start; ch<ch_end; ch++) {
         const float *noise = ((const float *)noises->ch[ch]) + s->dither.noise_pos;
         const DELEM *src = (const DELEM*)srcs->ch[ch];
         DELEM *dst = (DELEM*)dsts->ch[ch];
         float *ns_errors = s->dither.ns_errors[ch];
         const float *ns_coeffs = s->dither.ns_coeffs;
         pos  = s->dither.ns_pos;
+        if (s->dither.noise_shaping_simd) {
+            double buf[NS_SIMD_CHUNK];
+            int n;
+            for (i=0; i<count; i+=n) {
+                n = FFMIN(count - i, NS_SIMD_CHUNK);
+                for (j=0; j<n; j++)
+                    buf[j] = src[i + j]*S_1;
+                pos = s->dither.noise_shaping_simd(buf, noise + i, ns_errors, ns_coeffs, taps, pos, n);
+                for (j=0; j<n; j++) {
+                    double d1 = buf[j] * S;
+                    CLIP(d1);
+                    dst[i + j] = d1;
+                }
+            }
+            continue;
+        }
         for (i=0; i<count; i++) {
             double d1, d = src[i]*S_1;
             for(j=0; j<taps-2; j+=4) {
@@ -59,7 +75,7 @@ void RENAME(swri_noise_shaping)(SwrContext *s, AudioData *dsts, const AudioData
         }
     }
 
-    s->dither.ns_pos = pos;
+    return pos;
 }
 
 #undef RENAME
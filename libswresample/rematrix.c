@@ -38,6 +38,16 @@
 #include "rematrix_template.c"
 #undef TEMPLATE_REMATRIX_S32
 
+/* number of samples mixed for all output channels before moving on, so that
+ * the input channels stay in the cache.
+ * mix_n_1_simd() computes a single output channel per call: its terms only
+ * hold the non zero coefficients of that channel, so the sparse rows of the
+ * usual layouts cost no multiplication by 0, and the output is bit-exact
+ * with the C code, even for inputs which are not finite. The inputs shared
+ * by several outputs are instead read again from the cache, at most
+ * nb_in * MIX_N_1_CHUNK samples per chunk. */
+#define MIX_N_1_CHUNK 256
+
 #define FRONT_LEFT             0
 #define FRONT_RIGHT            1
 #define FRONT_CENTER           2
@@ -346,6 +356,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
     int nb_out = av_get_channel_layout_nb_channels(s->out_ch_layout);
 
     s->mix_any_f = NULL;
+    s->mix_n_1_simd = NULL;
 
     if (!s->rematrix_custom) {
         int r = auto_matrix(s);
@@ -406,7 +417,11 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->matrix_ch[i][0]= ch_in;
     }
 
-    if(HAVE_YASM && HAVE_MMX) swri_rematrix_init_x86(s);
+    if(HAVE_YASM && HAVE_MMX) {
+        int ret = swri_rematrix_init_x86(s);
+        if (ret < 0)
+            return ret;
+    }
 
     return 0;
 }
@@ -416,27 +431,24 @@ av_cold void swri_rematrix_free(SwrContext *s){
     av_freep(&s->native_one);
     av_freep(&s->native_simd_matrix);
     av_freep(&s->native_simd_one);
+    av_freep(&s->mix_terms);
 }
 
-int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
-    int out_i, in_i, i, j;
-    int len1 = 0;
-    int off = 0;
-
-    if(s->mix_any_f) {
-        s->mix_any_f(out->ch, (const uint8_t **)in->ch, s->native_matrix, len);
-        return 0;
-    }
-
-    if(s->mix_2_1_simd || s->mix_1_1_simd){
-        len1= len&~15;
-        off = len1 * out->bps;
-    }
-
-    av_assert0(!s->out_ch_layout || out->ch_count == av_get_channel_layout_nb_channels(s->out_ch_layout));
-    av_assert0(!s-> in_ch_layout || in ->ch_count == av_get_channel_layout_nb_channels(s-> in_ch_layout));
-
-    for(out_i=0; out_i<out->ch_count; out_i++){
+typedef struct RematrixThreadArg {
+    AudioData *out, *in;
+    int len, len1, off;
+    int mustcopy;
+} RematrixThreadArg;
+
+static int rematrix_channels(SwrContext *s, void *arg, int jobnr, int nb_jobs){
+    RematrixThreadArg *a = arg;
+    AudioData *out = a->out, *in = a->in;
+    int len = a->len, len1 = a->len1, off = a->off, mustcopy = a->mustcopy;
+    int out_i, in_i, i, j, i0;
+    int simd_len = s->mix_n_1_simd ? len & ~(s->mix_n_1_block - 1) : 0;
+    int simd_ch[SWR_CH_MAX], nb_simd_ch = 0;
+
+    for(out_i=SWRI_JOB_START(out->ch_count, jobnr, nb_jobs); out_i<SWRI_JOB_END(out->ch_count, jobnr, nb_jobs); out_i++){
         switch(s->matrix_ch[out_i][0]){
         case 0:
             if(mustcopy)
@@ -466,8 +478,14 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
                 s->mix_2_1_f   (out->ch[out_i]+off, in->ch[in_i1]+off, in->ch[in_i2]+off, s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len-len1);
             break;}
         default:
+            /* the SIMD part is mixed below, the C code does the rest */
+            i0 = 0;
+            if(simd_len && s->mix_terms_nb[out_i]){
+                simd_ch[nb_simd_ch++] = out_i;
+                i0 = simd_len;
+            }
             if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
-                for(i=0; i<len; i++){
+                for(i=i0; i<len; i++){
                     float v=0;
                     for(j=0; j<s->matrix_ch[out_i][0]; j++){
                         in_i= s->matrix_ch[out_i][1+j];
@@ -476,7 +494,7 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
                     ((float*)out->ch[out_i])[i]= v;
                 }
             }else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP){
-                for(i=0; i<len; i++){
+                for(i=i0; i<len; i++){
                     double v=0;
                     for(j=0; j<s->matrix_ch[out_i][0]; j++){
                         in_i= s->matrix_ch[out_i][1+j];
@@ -485,7 +503,7 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
                     ((double*)out->ch[out_i])[i]= v;
                 }
             }else{
-                for(i=0; i<len; i++){
+                for(i=i0; i<len; i++){
                     int v=0;
                     for(j=0; j<s->matrix_ch[out_i][0]; j++){
                         in_i= s->matrix_ch[out_i][1+j];
@@ -496,5 +514,43 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
             }
         }
     }
+
+    for(i=0; i<simd_len; i+=MIX_N_1_CHUNK){
+        int end = FFMIN(i + MIX_N_1_CHUNK, simd_len);
+        for(j=0; j<nb_simd_ch; j++){
+            out_i = simd_ch[j];
+            s->mix_n_1_simd(out->ch[out_i], (const uint8_t * const *)in->ch,
+                            s->mix_terms + s->mix_terms_off[out_i],
+                            s->mix_terms_nb[out_i], i, end);
+        }
+    }
+    return 0;
+}
+
+int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
+    RematrixThreadArg arg;
+    int len1 = 0;
+    int off = 0;
+
+    if(s->mix_any_f) {
+        s->mix_any_f(out->ch, (const uint8_t **)in->ch, s->native_matrix, len);
+        return 0;
+    }
+
+    if(s->mix_2_1_simd || s->mix_1_1_simd){
+        len1= len&~15;
+        off = len1 * out->bps;
+    }
+
+    av_assert0(!s->out_ch_layout || out->ch_count == av_get_channel_layout_nb_channels(s->out_ch_layout));
+    av_assert0(!s-> in_ch_layout || in ->ch_count == av_get_channel_layout_nb_channels(s-> in_ch_layout));
+
+    arg.out      = out;
+    arg.in       = in;
+    arg.len      = len;
+    arg.len1     = len1;
+    arg.off      = off;
+    arg.mustcopy = mustcopy;
+    swri_execute(s, rematrix_channels, &arg, NULL, FFMIN(s->nb_threads, out->ch_count));
     return 0;
 }
@@ -242,7 +242,7 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
             goto error;
         if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
             goto error;
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
+        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_length-1)*c->felem_size);
         memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
     }
 
@@ -308,15 +308,76 @@ static int set_compensation(ResampleContext *c, int sample_delta, int compensati
 #undef TEMPLATE_RESAMPLE_S16_SSSE3
 #endif
 
+#if HAVE_AVX_INLINE
+#define TEMPLATE_RESAMPLE_FLT_AVX
+#include "resample_template.c"
+#undef TEMPLATE_RESAMPLE_FLT_AVX
+
+#define TEMPLATE_RESAMPLE_DBL_AVX
+#include "resample_template.c"
+#undef TEMPLATE_RESAMPLE_DBL_AVX
+#endif
+
+#if HAVE_FMA3_INLINE
+#define TEMPLATE_RESAMPLE_FLT_FMA3
+#include "resample_template.c"
+#undef TEMPLATE_RESAMPLE_FLT_FMA3
+
+#define TEMPLATE_RESAMPLE_DBL_FMA3
+#include "resample_template.c"
+#undef TEMPLATE_RESAMPLE_DBL_FMA3
+#endif
+
+#if HAVE_AVX2_INLINE
+#define TEMPLATE_RESAMPLE_S16_AVX2
+#include "resample_template.c"
+#undef TEMPLATE_RESAMPLE_S16_AVX2
+
+#define TEMPLATE_RESAMPLE_S32_AVX2
+#include "resample_template.c"
+#undef TEMPLATE_RESAMPLE_S32_AVX2
+#endif
+
 #endif // HAVE_MMXEXT_INLINE
 
-static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
+typedef struct ResampleThreadArg {
+    ResampleContext *c;
+    ResampleContext last;           ///< context updated by the last channel
+    AudioData *dst, *src;
+    int dst_size, src_size;
+    int consumed[SWR_CH_MAX];
+} ResampleThreadArg;
+
+static int resample_channels(SwrContext *s, void *arg, int jobnr, int nb_jobs){
+    ResampleThreadArg *a = arg;
+    AudioData *dst = a->dst, *src = a->src;
+    int dst_size = a->dst_size, src_size = a->src_size;
     int i, ret= -1;
     int av_unused mm_flags = av_get_cpu_flags();
     int need_emms= 0;
 
-    for(i=0; i<dst->ch_count; i++){
+    for(i=SWRI_JOB_START(dst->ch_count, jobnr, nb_jobs); i<SWRI_JOB_END(dst->ch_count, jobnr, nb_jobs); i++){
+        /* The last channel updates a copy of the context, the other channels
+         * may still be running and need the initial state. */
+        ResampleContext *c = i+1 == dst->ch_count ? &a->last : a->c;
+        int *consumed = &a->consumed[i];
+
 #if HAVE_MMXEXT_INLINE
+#if HAVE_AVX2_INLINE
+             if(c->format == AV_SAMPLE_FMT_S16P && (mm_flags&AV_CPU_FLAG_AVX2 )) ret= swri_resample_int16_avx2 (c, (int16_t*)dst->ch[i], (const int16_t*)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
+        else if(c->format == AV_SAMPLE_FMT_S32P && (mm_flags&AV_CPU_FLAG_AVX2 )) ret= swri_resample_int32_avx2 (c, (int32_t*)dst->ch[i], (const int32_t*)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
+        else
+#endif
+#if HAVE_FMA3_INLINE
+             if(c->format == AV_SAMPLE_FMT_FLTP && (mm_flags&AV_CPU_FLAG_FMA3 )) ret= swri_resample_float_fma3 (c, (float  *)dst->ch[i], (const float  *)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
+        else if(c->format == AV_SAMPLE_FMT_DBLP && (mm_flags&AV_CPU_FLAG_FMA3 )) ret= swri_resample_double_fma3(c, (double *)dst->ch[i], (const double *)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
+        else
+#endif
+#if HAVE_AVX_INLINE
+             if(c->format == AV_SAMPLE_FMT_FLTP && (mm_flags&AV_CPU_FLAG_AVX  )) ret= swri_resample_float_avx  (c, (float  *)dst->ch[i], (const float  *)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
+        else if(c->format == AV_SAMPLE_FMT_DBLP && (mm_flags&AV_CPU_FLAG_AVX  )) ret= swri_resample_double_avx (c, (double *)dst->ch[i], (const double *)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
+        else
+#endif
 #if HAVE_SSSE3_INLINE
              if(c->format == AV_SAMPLE_FMT_S16P && (mm_flags&AV_CPU_FLAG_SSSE3)) ret= swri_resample_int16_ssse3(c, (int16_t*)dst->ch[i], (const int16_t*)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
         else
@@ -336,6 +397,27 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
     return ret;
 }
 
+static int multiple_resample(SwrContext *s, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
+    ResampleThreadArg arg;
+    int ret[SWR_CH_MAX];
+    int nb_jobs = FFMIN(s->nb_threads, dst->ch_count);
+
+    if (!nb_jobs)
+        return -1;
+
+    arg.c        = s->resample;
+    arg.last     = *arg.c;
+    arg.dst      = dst;
+    arg.src      = src;
+    arg.dst_size = dst_size;
+    arg.src_size = src_size;
+    swri_execute(s, resample_channels, &arg, ret, nb_jobs);
+
+    *s->resample = arg.last;
+    *consumed    = arg.consumed[dst->ch_count - 1];
+    return ret[nb_jobs - 1];
+}
+
 static int64_t get_delay(struct SwrContext *s, int64_t base){
     ResampleContext *c = s->resample;
     int64_t num = s->in_buffer_count - (c->filter_length-1)/2;
@@ -370,3 +452,116 @@ struct Resampler const swri_resampler={
   set_compensation,
   get_delay,
 };
+
+#ifdef TEST
+#include <math.h>
+#include <stdio.h>
+#include "libavutil/cpu.h"
+#include "libavutil/opt.h"
+
+#define NB_SAMPLES 1000
+#define NB_POISON  16
+#define OUT_SIZE   (2 * NB_SAMPLES)
+
+/**
+ * Resample NB_SAMPLES samples which are followed by NaN, or by large
+ * integers, in the same buffer. Only the given samples may be read.
+ */
+static int resample_poisoned(uint8_t *out, int cpu_flags, enum AVSampleFormat fmt,
+                             int in_rate, int out_rate, int filter_size, int linear)
+{
+    const int bps = av_get_bytes_per_sample(fmt);
+    SwrContext *s;
+    AudioData in = { { 0 } }, dst = { { 0 } };
+    uint8_t *buf;
+    int i, ret, consumed;
+
+    av_force_cpu_flags(cpu_flags);
+    s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_MONO, fmt, out_rate,
+                                 AV_CH_LAYOUT_MONO, fmt, in_rate, 0, NULL);
+    buf = av_malloc((NB_SAMPLES + NB_POISON) * bps);
+    if (!s || !buf) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    av_opt_set_int(s, "filter_size",   filter_size, 0);
+    av_opt_set_int(s, "linear_interp", linear,      0);
+    if ((ret = swr_init(s)) < 0)
+        goto end;
+
+    for (i = 0; i < NB_SAMPLES + NB_POISON; i++) {
+        double v = i < NB_SAMPLES ? sin(i * 0.05) * 0.7 + sin(i * 1.3) * 0.2 : NAN;
+        switch (fmt) {
+        case AV_SAMPLE_FMT_S16P: ((int16_t *)buf)[i] = i < NB_SAMPLES ? lrint(v * 32767) : INT16_MIN; break;
+        case AV_SAMPLE_FMT_S32P: ((int32_t *)buf)[i] = i < NB_SAMPLES ? lrint(v * INT32_MAX) : INT32_MIN; break;
+        case AV_SAMPLE_FMT_FLTP: ((float   *)buf)[i] = v; break;
+        case AV_SAMPLE_FMT_DBLP: ((double  *)buf)[i] = v; break;
+        }
+    }
+
+    in.ch[0]     = buf;
+    in.ch_count  = dst.ch_count = 1;
+    in.bps       = dst.bps      = bps;
+    in.count     = NB_SAMPLES;
+    dst.count    = OUT_SIZE;
+    in.planar    = dst.planar   = 1;
+    in.fmt       = dst.fmt      = fmt;
+    dst.ch[0]    = out;
+    ret = s->resampler->multiple_resample(s, &dst, OUT_SIZE, &in, NB_SAMPLES, &consumed);
+
+end:
+    av_force_cpu_flags(-1);
+    av_free(buf);
+    swr_free(&s);
+    return ret;
+}
+
+int main(void)
+{
+    static const enum AVSampleFormat fmts[] = {
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP,
+    };
+    static const int rates[][2]      = { { 44100, 48000 }, { 48000, 44100 }, { 44100, 8000 } };
+    static const int filter_sizes[]  = { 5, 13, 16, 21, 32 };
+    uint8_t *ref = av_malloc(OUT_SIZE * 8), *out = av_malloc(OUT_SIZE * 8);
+    int f, r, k, linear, i, n_ref, n, ret = 0;
+
+    if (!ref || !out)
+        return 1;
+
+    for (f = 0; f < FF_ARRAY_ELEMS(fmts); f++)
+    for (r = 0; r < FF_ARRAY_ELEMS(rates); r++)
+    for (k = 0; k < FF_ARRAY_ELEMS(filter_sizes); k++)
+    for (linear = 0; linear < 2; linear++) {
+        n_ref = resample_poisoned(ref, 0,  fmts[f], rates[r][0], rates[r][1], filter_sizes[k], linear);
+        n     = resample_poisoned(out, -1, fmts[f], rates[r][0], rates[r][1], filter_sizes[k], linear);
+        if (n_ref <= 0 || n != n_ref) {
+            fprintf(stderr, "%s %d->%d filter_size %d linear %d: %d samples, expected %d\n",
+                    av_get_sample_fmt_name(fmts[f]), rates[r][0], rates[r][1],
+                    filter_sizes[k], linear, n, n_ref);
+            ret = 1;
+            continue;
+        }
+        for (i = 0; i < n; i++) {
+            double a, b, eps;
+            switch (fmts[f]) {
+            case AV_SAMPLE_FMT_S16P: a = ((int16_t *)ref)[i]; b = ((int16_t *)out)[i]; eps = 0;     break;
+            case AV_SAMPLE_FMT_S32P: a = ((int32_t *)ref)[i]; b = ((int32_t *)out)[i]; eps = 0;     break;
+            case AV_SAMPLE_FMT_FLTP: a = ((float   *)ref)[i]; b = ((float   *)out)[i]; eps = 1e-5;  break;
+            default:                 a = ((double  *)ref)[i]; b = ((double  *)out)[i]; eps = 1e-12; break;
+            }
+            if (!(fabs(a - b) <= eps)) {
+                fprintf(stderr, "%s %d->%d filter_size %d linear %d: sample %d is %g, expected %g\n",
+                        av_get_sample_fmt_name(fmts[f]), rates[r][0], rates[r][1],
+                        filter_sizes[k], linear, i, b, a);
+                ret = 1;
+                break;
+            }
+        }
+    }
+
+    av_free(ref);
+    av_free(out);
+    return ret;
+}
+#endif
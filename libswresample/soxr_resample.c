@@ -72,8 +72,9 @@ static int flush(struct SwrContext *s){
 }
 
 static int process(
-        struct ResampleContext * c, AudioData *dst, int dst_size,
+        struct SwrContext *s, AudioData *dst, int dst_size,
         AudioData *src, int src_size, int *consumed){
+    struct ResampleContext *c = s->resample;
     size_t idone, odone;
     soxr_error_t error = soxr_set_error((soxr_t)c, soxr_set_num_channels((soxr_t)c, src->ch_count));
     error = soxr_process((soxr_t)c, src->ch, (size_t)src_size,
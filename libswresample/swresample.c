@@ -129,6 +129,9 @@ static const AVOption options[]={
 { "kaiser_beta"         , "set swr Kaiser Window Beta"  , OFFSET(kaiser_beta)    , AV_OPT_TYPE_INT  , {.i64=9                     }, 2      , 16        , PARAM },
 
 { "output_sample_bits"  , "set swr number of output sample bits", OFFSET(dither.output_sample_bits), AV_OPT_TYPE_INT  , {.i64=0   }, 0      , 64        , PARAM },
+
+{ "threads"             , "set the number of threads, 0 for automatic", OFFSET(thread_count), AV_OPT_TYPE_INT, {.i64=1   }, 0      , INT_MAX   , PARAM },
+{ "shared_threads"      , "run the jobs on the default thread pool", OFFSET(shared_threads), AV_OPT_TYPE_INT, {.i64=0   }, 0      , 1         , PARAM },
 {0}
 };
 
@@ -170,6 +173,13 @@ int swr_set_channel_mapping(struct SwrContext *s, const int *channel_map){
     return 0;
 }
 
+int swr_set_thread_pool(struct SwrContext *s, AVThreadPool *pool){
+    if(!s)
+        return AVERROR(EINVAL);
+    s->user_thread_pool = pool;
+    return 0;
+}
+
 const AVClass *swr_get_class(void)
 {
     return &av_class;
@@ -235,6 +245,7 @@ av_cold void swr_free(SwrContext **ss){
         if (s->resampler)
             s->resampler->free(&s->resample);
         swri_rematrix_free(s);
+        swri_thread_free(s);
     }
 
     av_freep(ss);
@@ -433,6 +444,9 @@ av_assert0(s->out.ch_count);
         set_audiodata_fmt(&s->in_buffer, s->int_sample_fmt);
     }
 
+    if ((ret = swri_thread_init(s)) < 0)
+        return ret;
+
     if ((ret = swri_dither_init(s, s->out_sample_fmt, s->int_sample_fmt)) < 0)
         return ret;
 
@@ -547,7 +561,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
         int ret, size, consumed;
         if(!s->resample_in_constraint && s->in_buffer_count){
             buf_set(&tmp, &s->in_buffer, s->in_buffer_index);
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &tmp, s->in_buffer_count, &consumed);
+            ret= s->resampler->multiple_resample(s, &out, out_count, &tmp, s->in_buffer_count, &consumed);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -567,7 +581,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
 
         if((s->flushed || in_count > padless) && !s->in_buffer_count){
             s->in_buffer_index=0;
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
+            ret= s->resampler->multiple_resample(s, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -612,6 +626,47 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
     return ret_sum;
 }
 
+typedef struct DitherThreadArg {
+    AudioData *dst;
+    AudioData *src;
+    int count;
+} DitherThreadArg;
+
+static int dither_channels(SwrContext *s, void *arg, int jobnr, int nb_jobs){
+    DitherThreadArg *a = arg;
+    AudioData *conv_src = a->dst, *preout = a->src;
+    int out_count = a->count;
+    int start = SWRI_JOB_START(preout->ch_count, jobnr, nb_jobs);
+    int end   = SWRI_JOB_END  (preout->ch_count, jobnr, nb_jobs);
+    int ch;
+
+    if (s->dither.method < SWR_DITHER_NS){
+        if (s->mix_2_1_simd) {
+            int len1= out_count&~15;
+            int off = len1 * preout->bps;
+
+            if(len1)
+                for(ch=start; ch<end; ch++)
+                    s->mix_2_1_simd(conv_src->ch[ch], preout->ch[ch], s->dither.noise.ch[ch] + s->dither.noise.bps * s->dither.noise_pos, s->native_simd_one, 0, 0, len1);
+            if(out_count != len1)
+                for(ch=start; ch<end; ch++)
+                    s->mix_2_1_f(conv_src->ch[ch] + off, preout->ch[ch] + off, s->dither.noise.ch[ch] + s->dither.noise.bps * s->dither.noise_pos + off + len1, s->native_one, 0, 0, out_count - len1);
+        } else {
+            for(ch=start; ch<end; ch++)
+                s->mix_2_1_f(conv_src->ch[ch], preout->ch[ch], s->dither.noise.ch[ch] + s->dither.noise.bps * s->dither.noise_pos, s->native_one, 0, 0, out_count);
+        }
+        return 0;
+    }
+
+    switch(s->int_sample_fmt) {
+    case AV_SAMPLE_FMT_S16P :return swri_noise_shaping_int16(s, conv_src, preout, &s->dither.noise, out_count, start, end);
+    case AV_SAMPLE_FMT_S32P :return swri_noise_shaping_int32(s, conv_src, preout, &s->dither.noise, out_count, start, end);
+    case AV_SAMPLE_FMT_FLTP :return swri_noise_shaping_float(s, conv_src, preout, &s->dither.noise, out_count, start, end);
+    case AV_SAMPLE_FMT_DBLP :return swri_noise_shaping_double(s,conv_src, preout, &s->dither.noise, out_count, start, end);
+    }
+    return s->dither.ns_pos;
+}
+
 static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_count,
                                                       AudioData *in , int  in_count){
     AudioData *postin, *midbuf, *preout;
@@ -689,6 +744,8 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
     if(preout != out && out_count){
         AudioData *conv_src = preout;
         if(s->dither.method){
+            DitherThreadArg arg;
+            int ns_pos[SWR_CH_MAX];
             int ch;
             int dither_count= FFMAX(out_count, 1<<16);
 
@@ -702,35 +759,19 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
                 return ret;
             if(ret)
                 for(ch=0; ch<s->dither.noise.ch_count; ch++)
-                    swri_get_dither(s, s->dither.noise.ch[ch], s->dither.noise.count, 12345678913579<<ch, s->dither.noise.fmt);
+                    if((ret=swri_get_dither(s, s->dither.noise.ch[ch], s->dither.noise.count, 12345678913579<<ch, s->dither.noise.fmt))<0)
+                        return ret;
             av_assert0(s->dither.noise.ch_count == preout->ch_count);
 
             if(s->dither.noise_pos + out_count > s->dither.noise.count)
                 s->dither.noise_pos = 0;
 
-            if (s->dither.method < SWR_DITHER_NS){
-                if (s->mix_2_1_simd) {
-                    int len1= out_count&~15;
-                    int off = len1 * preout->bps;
-
-                    if(len1)
-                        for(ch=0; ch<preout->ch_count; ch++)
-                            s->mix_2_1_simd(conv_src->ch[ch], preout->ch[ch], s->dither.noise.ch[ch] + s->dither.noise.bps * s->dither.noise_pos, s->native_simd_one, 0, 0, len1);
-                    if(out_count != len1)
-                        for(ch=0; ch<preout->ch_count; ch++)
-                            s->mix_2_1_f(conv_src->ch[ch] + off, preout->ch[ch] + off, s->dither.noise.ch[ch] + s->dither.noise.bps * s->dither.noise_pos + off + len1, s->native_one, 0, 0, out_count - len1);
-                } else {
-                    for(ch=0; ch<preout->ch_count; ch++)
-                        s->mix_2_1_f(conv_src->ch[ch], preout->ch[ch], s->dither.noise.ch[ch] + s->dither.noise.bps * s->dither.noise_pos, s->native_one, 0, 0, out_count);
-                }
-            } else {
-                switch(s->int_sample_fmt) {
-                case AV_SAMPLE_FMT_S16P :swri_noise_shaping_int16(s, conv_src, preout, &s->dither.noise, out_count); break;
-                case AV_SAMPLE_FMT_S32P :swri_noise_shaping_int32(s, conv_src, preout, &s->dither.noise, out_count); break;
-                case AV_SAMPLE_FMT_FLTP :swri_noise_shaping_float(s, conv_src, preout, &s->dither.noise, out_count); break;
-                case AV_SAMPLE_FMT_DBLP :swri_noise_shaping_double(s,conv_src, preout, &s->dither.noise, out_count); break;
-                }
-            }
+            arg.dst   = conv_src;
+            arg.src   = preout;
+            arg.count = out_count;
+            swri_execute(s, dither_channels, &arg, ns_pos, FFMIN(s->nb_threads, preout->ch_count));
+            if (s->dither.method >= SWR_DITHER_NS)
+                s->dither.ns_pos = ns_pos[0];
             s->dither.noise_pos += out_count;
         }
 //FIXME packed doesn't need more than 1 chan here!
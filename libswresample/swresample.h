@@ -95,6 +95,7 @@
 
 #include <stdint.h>
 #include "libavutil/samplefmt.h"
+#include "libavutil/threadpool.h"
 
 #include "libswresample/version.h"
 
@@ -257,6 +258,19 @@ int swr_set_channel_mapping(struct SwrContext *s, const int *channel_map);
  */
 int swr_set_matrix(struct SwrContext *s, const double *matrix, int stride);
 
+/**
+ * Run the jobs of the context on a thread pool instead of a pool of its
+ * own. The "threads" option still bounds the number of jobs run at the
+ * same time. The "shared_threads" option selects the default pool of
+ * libavutil when no pool is set.
+ *
+ * @param s     allocated Swr context, the pool is used from the next
+ *              swr_init() on
+ * @param pool  the pool, which must outlive the context, or NULL
+ * @return AVERROR error code in case of failure.
+ */
+int swr_set_thread_pool(struct SwrContext *s, AVThreadPool *pool);
+
 /**
  * Drops the specified number of output samples.
  */
@@ -40,6 +40,15 @@ typedef void (mix_2_1_func_type)(void *out, const void *in1, const void *in2, vo
 
 typedef void (mix_any_func_type)(uint8_t **out, const uint8_t **in1, void *coeffp, integer len);
 
+/**
+ * Mix samples start to end-1 of one output channel from any number of input
+ * channels, start and end are multiples of SwrContext.mix_n_1_block.
+ * @param in     input channels, the terms reference them by their offset
+ * @param terms  non zero coefficients of the output channel, in an
+ *               implementation specific layout
+ */
+typedef void (mix_n_1_func_type)(void *out, const uint8_t * const *in, const void *terms, integer nb_terms, integer start, integer end);
+
 typedef struct AudioData{
     uint8_t *ch[SWR_CH_MAX];    ///< samples buffer per channel
     uint8_t *data;              ///< samples buffer
@@ -61,6 +70,18 @@ struct DitherContext {
     int ns_pos;                                     ///< Noise shaping dither position
     float ns_coeffs[NS_TAPS];                       ///< Noise shaping filter coefficients
     float ns_errors[SWR_CH_MAX][2*NS_TAPS];
+    /**
+     * Generate len values of the uniform or triangular noise of
+     * swri_get_dither() starting from the 4 next seeds, NULL if unavailable.
+     * Up to 3 values past len may be written.
+     */
+    void (*get_noise_simd)(double *dst, const uint32_t *seeds, int len);
+    /**
+     * Noise shape count samples of one channel, buf holds the scaled input
+     * and is replaced by the rounded output, returns the new ns_pos.
+     * NULL if unavailable.
+     */
+    int (*noise_shaping_simd)(double *buf, const float *noise, float *errors, const float *coeffs, int taps, int pos, int count);
     AudioData noise;                                ///< noise used for dithering
     AudioData temp;                                 ///< temporary storage when writing into the input buffer isnt possible
     int output_sample_bits;                         ///< the number of used output bits, needed to scale dither correctly
@@ -147,13 +168,32 @@ struct SwrContext {
 
     mix_any_func_type *mix_any_f;
 
+    mix_n_1_func_type *mix_n_1_simd;
+    int mix_n_1_block;                              ///< number of samples mix_n_1_simd processes at once
+    uint8_t *mix_terms;                             ///< terms of mix_n_1_simd for all output channels
+    int mix_terms_off[SWR_CH_MAX];                  ///< offset in bytes of the terms of each output channel in mix_terms
+    int mix_terms_nb[SWR_CH_MAX];                   ///< number of terms of each output channel, 0 if mix_n_1_simd cannot be used
+
+    int thread_count;                               ///< requested number of threads, 0 for automatic
+    int shared_threads;                             ///< run the jobs on the default thread pool if user_thread_pool is not set
+    int nb_threads;                                 ///< number of threads actually used
+    struct AVThreadPool *user_thread_pool;          ///< pool set with swr_set_thread_pool()
+    struct AVThreadPool *thread_pool;               ///< pool running the jobs, NULL if single threaded
+    struct AVThreadPool *own_thread_pool;           ///< pool allocated by swri_thread_init(), if any
+
     /* TODO: callbacks for ASM optimizations */
 };
 
+/**
+ * Function run by swri_execute() for each job.
+ * @param jobnr  index of the job, between 0 and nb_jobs - 1
+ */
+typedef int (swri_thread_func)(SwrContext *s, void *arg, int jobnr, int nb_jobs);
+
 typedef struct ResampleContext * (* resample_init_func)(struct ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, int kaiser_beta, double precision, int cheby);
 typedef void    (* resample_free_func)(struct ResampleContext **c);
-typedef int     (* multiple_resample_func)(struct ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
+typedef int     (* multiple_resample_func)(struct SwrContext *s, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
 typedef int     (* resample_flush_func)(struct SwrContext *c);
 typedef int     (* set_compensation_func)(struct ResampleContext *c, int sample_delta, int compensation_distance);
 typedef int64_t (* get_delay_func)(struct SwrContext *s, int64_t base);
@@ -170,22 +210,39 @@ struct Resampler {
 extern struct Resampler const swri_resampler;
 
 int swri_realloc_audio(AudioData *a, int count);
+
+int  swri_thread_init(SwrContext *s);
+void swri_thread_free(SwrContext *s);
+/**
+ * Run func nb_jobs times, in parallel if threads are available. The jobs of
+ * a channel range are usually obtained with SWRI_JOB_START/SWRI_JOB_END.
+ * @param ret  array of nb_jobs return values, may be NULL
+ */
+int  swri_execute(SwrContext *s, swri_thread_func *func, void *arg, int *ret, int nb_jobs);
+
+#define SWRI_JOB_START(ch_count, jobnr, nb_jobs) ((ch_count) *  (jobnr)      / (nb_jobs))
+#define SWRI_JOB_END(ch_count, jobnr, nb_jobs)   ((ch_count) * ((jobnr) + 1) / (nb_jobs))
 int swri_resample_int16(struct ResampleContext *c, int16_t *dst, const int16_t *src, int *consumed, int src_size, int dst_size, int update_ctx);
 int swri_resample_int32(struct ResampleContext *c, int32_t *dst, const int32_t *src, int *consumed, int src_size, int dst_size, int update_ctx);
 int swri_resample_float(struct ResampleContext *c, float   *dst, const float   *src, int *consumed, int src_size, int dst_size, int update_ctx);
 int swri_resample_double(struct ResampleContext *c,double  *dst, const double  *src, int *consumed, int src_size, int dst_size, int update_ctx);
 
-void swri_noise_shaping_int16 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
-void swri_noise_shaping_int32 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
-void swri_noise_shaping_float (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
-void swri_noise_shaping_double(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
+/**
+ * Apply noise shaping dither to the channels ch_start to ch_end - 1.
+ * @return the updated noise shaping position
+ */
+int  swri_noise_shaping_int16 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count, int ch_start, int ch_end);
+int  swri_noise_shaping_int32 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count, int ch_start, int ch_end);
+int  swri_noise_shaping_float (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count, int ch_start, int ch_end);
+int  swri_noise_shaping_double(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count, int ch_start, int ch_end);
 
 int swri_rematrix_init(SwrContext *s);
 void swri_rematrix_free(SwrContext *s);
 int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy);
-void swri_rematrix_init_x86(struct SwrContext *s);
+int swri_rematrix_init_x86(struct SwrContext *s);
+void swri_dither_init_x86(struct SwrContext *s);
 
-void swri_get_dither(SwrContext *s, void *dst, int len, unsigned seed, enum AVSampleFormat noise_fmt);
+int swri_get_dither(SwrContext *s, void *dst, int len, unsigned seed, enum AVSampleFormat noise_fmt);
 int swri_dither_init(SwrContext *s, enum AVSampleFormat out_fmt, enum AVSampleFormat in_fmt);
 
 void swri_audio_convert_init_arm(struct AudioConvert *ac,
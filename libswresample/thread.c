@@ -0,0 +1,97 @@
+/*
+ * This file is part of libswresample
+ *
+ * libswresample is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libswresample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libswresample; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * libswresample multithreading support, the channels are split between
+ * the threads of a thread pool
+ */
+
+#include "config.h"
+
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "libavutil/threadpool.h"
+
+#include "swresample_internal.h"
+
+typedef struct SwrThreadJobs {
+    swri_thread_func *func;
+    void *arg;
+    int nb_jobs;
+} SwrThreadJobs;
+
+static int pool_job(void *ctx, void *arg, int jobnr, int threadnr)
+{
+    SwrThreadJobs *jobs = arg;
+    return jobs->func(ctx, jobs->arg, jobnr, jobs->nb_jobs);
+}
+
+int swri_thread_init(SwrContext *s)
+{
+    int nb_threads = s->thread_count;
+
+    swri_thread_free(s);
+
+    if (!nb_threads)
+        nb_threads = av_cpu_count();
+    /* the work is split by channel, more threads would stay idle */
+    nb_threads = FFMIN(nb_threads, FFMAX(s->in.ch_count, s->out.ch_count));
+
+    if (!HAVE_PTHREADS || nb_threads <= 1)
+        return 0;
+
+    s->thread_pool = s->user_thread_pool;
+    if (!s->thread_pool && s->shared_threads)
+        s->thread_pool = av_thread_pool_get_default();
+    if (!s->thread_pool) {
+        /* the thread calling swri_execute() runs jobs too */
+        s->own_thread_pool = av_thread_pool_alloc(nb_threads - 1);
+        s->thread_pool     = s->own_thread_pool;
+    }
+    if (!s->thread_pool)
+        return AVERROR(ENOMEM);
+    s->nb_threads = nb_threads;
+    return 0;
+}
+
+void swri_thread_free(SwrContext *s)
+{
+    av_thread_pool_free(&s->own_thread_pool);
+    s->thread_pool = NULL;
+    s->nb_threads  = 1;
+}
+
+int swri_execute(SwrContext *s, swri_thread_func *func, void *arg, int *ret,
+                 int nb_jobs)
+{
+    int i;
+
+    if (s->thread_pool && nb_jobs > 1) {
+        SwrThreadJobs jobs = { func, arg, nb_jobs };
+        return av_thread_pool_execute(s->thread_pool, pool_job, s, &jobs, ret,
+                                      nb_jobs, s->nb_threads);
+    }
+
+    for (i = 0; i < nb_jobs; i++) {
+        int r = func(s, arg, i, nb_jobs);
+        if (ret)
+            ret[i] = r;
+    }
+    return 0;
+}
@@ -0,0 +1,170 @@
+;******************************************************************************
+;* SIMD dither noise generation and noise shaping
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+; the 4 lanes advance by 4 steps of the LCG of the C code at once,
+; seed * 1664525^4 + 1013904223 * (1664525^3 + 1664525^2 + 1664525 + 1)
+lcg_mul4:   dd 0x0979e791, 0, 0x0979e791, 0
+lcg_add4:   times 4 dd 0xaaf95334
+pd_sign:    times 4 dd 0x80000000
+pd_2p31:    times 2 dq 2147483648.0
+pd_umax:    times 2 dq 4294967295.0
+pd_0_5:     times 2 dq 0.5
+
+SECTION .text
+
+%if ARCH_X86_64
+; seed / UINT_MAX of the 4 lanes of m0 into m2 and m3, the seeds are
+; converted as signed and rebiased, which is exact
+%macro SEEDS_TO_DOUBLE 0
+    pxor      m1, m0, m4
+    cvtdq2pd  m2, m1
+    pshufd    m1, m1, q3232
+    cvtdq2pd  m3, m1
+    addpd     m2, m5
+    addpd     m3, m5
+    divpd     m2, m6
+    divpd     m3, m6
+%endmacro
+
+%macro NEXT_SEEDS 0
+    psrlq     m1, m0, 32
+    pmuludq   m0, m7
+    pmuludq   m1, m7
+    pshufd    m0, m0, q0020
+    pshufd    m1, m1, q0020
+    punpckldq m0, m1
+    paddd     m0, [lcg_add4]
+%endmacro
+
+; void ff_dither_noise_rect_sse2(double *dst, const uint32_t *seeds, int len)
+; void ff_dither_noise_tri_sse2 (double *dst, const uint32_t *seeds, int len)
+; seeds holds the next 4 seeds of the C code, up to 3 values past len are
+; written
+INIT_XMM sse2
+cglobal dither_noise_rect, 3, 3, 8, dst, seeds, len
+    movsxdifnidn lenq, lend
+    lea     lenq, [dstq + lenq*8]
+    mova      m0, [seedsq]
+    mova      m4, [pd_sign]
+    mova      m5, [pd_2p31]
+    mova      m6, [pd_umax]
+    mova      m7, [lcg_mul4]
+.loop:
+    SEEDS_TO_DOUBLE
+    subpd     m2, [pd_0_5]
+    subpd     m3, [pd_0_5]
+    movu [dstq     ], m2
+    movu [dstq + 16], m3
+    NEXT_SEEDS
+    add     dstq, 32
+    cmp     dstq, lenq
+        jb .loop
+    REP_RET
+
+; each value takes 2 seeds
+cglobal dither_noise_tri, 3, 3, 8, dst, seeds, len
+    movsxdifnidn lenq, lend
+    lea     lenq, [dstq + lenq*8]
+    mova      m0, [seedsq]
+    mova      m4, [pd_sign]
+    mova      m5, [pd_2p31]
+    mova      m6, [pd_umax]
+    mova      m7, [lcg_mul4]
+.loop:
+    SEEDS_TO_DOUBLE
+    unpckhpd  m1, m2, m3
+    unpcklpd  m2, m3
+    subpd     m2, m1
+    movu  [dstq], m2
+    NEXT_SEEDS
+    add     dstq, 16
+    cmp     dstq, lenq
+        jb .loop
+    REP_RET
+
+; int ff_dither_noise_shaping_sse4(double *buf, const float *noise,
+;                                  float *errors, const float *coeffs,
+;                                  int taps, int pos, int count)
+; buf holds the scaled input samples and is replaced by the rounded output
+; samples, the new position in errors is returned.
+; The filter sums the products in groups of 4 in the order of the C code, so
+; that the output is identical.
+INIT_XMM sse4
+cglobal dither_noise_shaping, 7, 13, 4, buf, noise, errors, coeffs, taps, pos, count, i, j, g, p, t, taps4
+    movsxdifnidn tapsq, tapsd
+    movsxdifnidn posq, posd
+    movsxdifnidn countq, countd
+    ; 16 * number of groups of 4 taps in the C code
+    lea       gq, [tapsq + 1]
+    shr       gq, 2
+    shl       gq, 4
+    lea   taps4q, [tapsq*4]
+    xor       iq, iq
+.loop:
+    movsd     m0, [bufq + iq*8]
+    lea       pq, [errorsq + posq*4]
+    xor       jq, jq
+    test      gq, gq
+        jz .tail
+.group:
+    movu      m1, [pq + jq]
+    movu      m2, [coeffsq + jq]
+    mulps     m1, m2
+    pshufd    m2, m1, q1111
+    movhlps   m3, m1
+    addss     m2, m1
+    addss     m2, m3
+    shufps    m3, m3, q1111
+    addss     m2, m3
+    cvtss2sd  m2, m2
+    subsd     m0, m2
+    add       jq, 16
+    cmp       jq, gq
+        jl .group
+.tail:
+    ; the single tap after the last group, taps = 4n + 1
+    cmp       gq, taps4q
+        jge .round
+    movss     m1, [pq + gq]
+    mulss     m1, [coeffsq + gq]
+    cvtss2sd  m1, m1
+    subsd     m0, m1
+.round:
+    sub     posq, 1
+    lea       tq, [posq + tapsq]
+    cmovl   posq, tq
+    cvtss2sd  m1, [noiseq + iq*4]
+    addsd     m1, m0
+    roundsd   m1, m1, 4
+    movsd [bufq + iq*8], m1
+    subsd     m1, m0
+    cvtsd2ss  m1, m1
+    lea       tq, [posq + tapsq]
+    movss [errorsq + posq*4], m1
+    movss [errorsq + tq*4], m1
+    add       iq, 1
+    cmp       iq, countq
+        jl .loop
+    mov      eax, posd
+    RET
+%endif
@@ -24,6 +24,7 @@
 SECTION_RODATA 32
 dw1: times 8  dd 1
 w1 : times 16 dw 1
+pd_16384: times 4 dd 16384
 
 SECTION .text
 
@@ -223,6 +224,143 @@ mix_2_1_int16_u_int %+ SUFFIX
 %endmacro
 
 
+; sizeof(SwrMixTerm), the coefficients come first, followed by the offsets
+; of the input channels in the array of input channel pointers
+%define TERM_SIZE 32
+
+; void ff_mix_n_1_float_<opt>(float *out, const uint8_t * const *in,
+;                             const SwrMixTerm *terms, integer nb_terms,
+;                             integer start, integer end)
+; mixes mmsize samples per iteration, for one output channel per call, see
+; MIX_N_1_CHUNK in rematrix.c
+%macro MIX_N_1_FLT 0
+%if ARCH_X86_64
+cglobal mix_n_1_float, 6, 8, 7, out, in, terms, nb, i, end, k, ptr
+%else
+cglobal mix_n_1_float, 5, 7, 7, out, in, terms, nb, i, k, ptr
+%define endq r5m
+%endif
+    shl      nbq, 5
+    add   termsq, nbq
+    neg      nbq
+.next:
+    xorps     m0, m0
+    xorps     m1, m1
+    xorps     m2, m2
+    xorps     m3, m3
+    mov       kq, nbq
+.term:
+    mov     ptrq, [termsq + kq + 16]
+    mov     ptrq, [inq + ptrq]
+%if mmsize == 32
+    VBROADCASTSS m4, [termsq + kq]
+%else
+    mova      m4, [termsq + kq]
+%endif
+    movu      m5, [ptrq + iq*4           ]
+    movu      m6, [ptrq + iq*4 +   mmsize]
+    mulps     m5, m4
+    mulps     m6, m4
+    addps     m0, m5
+    addps     m1, m6
+    movu      m5, [ptrq + iq*4 + 2*mmsize]
+    movu      m6, [ptrq + iq*4 + 3*mmsize]
+    mulps     m5, m4
+    mulps     m6, m4
+    addps     m2, m5
+    addps     m3, m6
+    add       kq, TERM_SIZE
+        js .term
+    movu  [outq + iq*4           ], m0
+    movu  [outq + iq*4 +   mmsize], m1
+    movu  [outq + iq*4 + 2*mmsize], m2
+    movu  [outq + iq*4 + 3*mmsize], m3
+    add       iq, mmsize
+    cmp       iq, endq
+        jl .next
+    REP_RET
+%if ARCH_X86_32
+%undef endq
+%endif
+%endmacro
+
+; void ff_mix_n_1_int16_<opt>(int16_t *out, const uint8_t * const *in,
+;                             const SwrMixTerm *terms, integer nb_terms,
+;                             integer start, integer end)
+; each term holds 2 input channels with their coefficients interleaved for
+; pmaddwd, the result wraps around like the C code
+%macro MIX_N_1_INT16 0
+%if ARCH_X86_64
+cglobal mix_n_1_int16, 6, 8, 8, out, in, terms, nb, i, end, k, ptr
+%else
+cglobal mix_n_1_int16, 5, 7, 8, out, in, terms, nb, i, k, ptr
+%define endq r5m
+%endif
+    shl      nbq, 5
+    add   termsq, nbq
+    neg      nbq
+.next:
+    pxor      m0, m0
+    pxor      m1, m1
+    pxor      m2, m2
+    pxor      m3, m3
+    mov       kq, nbq
+.term:
+    mov     ptrq, [termsq + kq + 16]
+    mov     ptrq, [inq + ptrq]
+    movu      m4, [ptrq + iq*2         ]
+    movu      m6, [ptrq + iq*2 + mmsize]
+    mov     ptrq, [termsq + kq + 16 + gprsize]
+    mov     ptrq, [inq + ptrq]
+    movu      m5, [ptrq + iq*2         ]
+    mova      m7, m4
+    punpcklwd m4, m5
+    punpckhwd m7, m5
+    pmaddwd   m4, [termsq + kq]
+    pmaddwd   m7, [termsq + kq]
+    paddd     m0, m4
+    paddd     m1, m7
+    movu      m5, [ptrq + iq*2 + mmsize]
+    mova      m7, m6
+    punpcklwd m6, m5
+    punpckhwd m7, m5
+    pmaddwd   m6, [termsq + kq]
+    pmaddwd   m7, [termsq + kq]
+    paddd     m2, m6
+    paddd     m3, m7
+    add       kq, TERM_SIZE
+        js .term
+    mova      m4, [pd_16384]
+    paddd     m0, m4
+    paddd     m1, m4
+    paddd     m2, m4
+    paddd     m3, m4
+    psrad     m0, 15
+    psrad     m1, 15
+    psrad     m2, 15
+    psrad     m3, 15
+    pslld     m0, 16
+    pslld     m1, 16
+    pslld     m2, 16
+    pslld     m3, 16
+    psrad     m0, 16
+    psrad     m1, 16
+    psrad     m2, 16
+    psrad     m3, 16
+    packssdw  m0, m1
+    packssdw  m2, m3
+    movu  [outq + iq*2         ], m0
+    movu  [outq + iq*2 + mmsize], m2
+    add       iq, mmsize
+    cmp       iq, endq
+        jl .next
+    REP_RET
+%if ARCH_X86_32
+%undef endq
+%endif
+%endmacro
+
+
 INIT_MMX mmx
 MIX1_INT16 u
 MIX1_INT16 a
@@ -234,12 +372,14 @@ MIX2_FLT u
 MIX2_FLT a
 MIX1_FLT u
 MIX1_FLT a
+MIX_N_1_FLT
 
 INIT_XMM sse2
 MIX1_INT16 u
 MIX1_INT16 a
 MIX2_INT16 u
 MIX2_INT16 a
+MIX_N_1_INT16
 
 %if HAVE_AVX_EXTERNAL
 INIT_YMM avx
@@ -247,4 +387,5 @@ MIX2_FLT u
 MIX2_FLT a
 MIX1_FLT u
 MIX1_FLT a
+MIX_N_1_FLT
 %endif
@@ -24,6 +24,12 @@
 
 int swri_resample_int16_mmx2 (struct ResampleContext *c, int16_t *dst, const int16_t *src, int *consumed, int src_size, int dst_size, int update_ctx);
 int swri_resample_int16_ssse3(struct ResampleContext *c, int16_t *dst, const int16_t *src, int *consumed, int src_size, int dst_size, int update_ctx);
+int swri_resample_int16_avx2 (struct ResampleContext *c, int16_t *dst, const int16_t *src, int *consumed, int src_size, int dst_size, int update_ctx);
+int swri_resample_int32_avx2 (struct ResampleContext *c, int32_t *dst, const int32_t *src, int *consumed, int src_size, int dst_size, int update_ctx);
+int swri_resample_float_avx  (struct ResampleContext *c, float   *dst, const float   *src, int *consumed, int src_size, int dst_size, int update_ctx);
+int swri_resample_float_fma3 (struct ResampleContext *c, float   *dst, const float   *src, int *consumed, int src_size, int dst_size, int update_ctx);
+int swri_resample_double_avx (struct ResampleContext *c, double  *dst, const double  *src, int *consumed, int src_size, int dst_size, int update_ctx);
+int swri_resample_double_fma3(struct ResampleContext *c, double  *dst, const double  *src, int *consumed, int src_size, int dst_size, int update_ctx);
 
 DECLARE_ALIGNED(16, const uint64_t, ff_resample_int16_rounder)[2]    = { 0x0000000000004000ULL, 0x0000000000000000ULL};
 
@@ -68,3 +74,233 @@ __asm__ volatile(\
       "r" (((uint8_t*)filter)-len),\
       "r" (dst+dst_index)\
 );
+
+/* The cores below only read whole vectors within filter_length, the
+ * remaining elements are summed by CORE_TAIL. src is not padded, it may be
+ * the caller's buffer. */
+#define CORE_TAIL(val, filter, start) \
+    for (i = start; i < c->filter_length; i++)\
+        val += src[sample_index + i] * (FELEM2)(filter)[i];
+
+/* The filter is processed in 16 element steps, plus an 8 element step if
+ * the vector part is not a multiple of 16. Rounding and clipping is left
+ * to the C code. */
+#define COMMON_CORE_INT16_AVX2 \
+    int vlen= c->filter_length & ~7;\
+    x86_reg len= -2*vlen;\
+    FELEM2 val;\
+__asm__ volatile(\
+    "vpxor     %%ymm0, %%ymm0, %%ymm0       \n\t"\
+    "1:                                     \n\t"\
+    "cmp        $-32, %0                    \n\t"\
+    " jg 2f                                 \n\t"\
+    "vmovdqu   (%2, %0), %%ymm1             \n\t"\
+    "vpmaddwd  (%3, %0), %%ymm1, %%ymm1     \n\t"\
+    "vpaddd    %%ymm1, %%ymm0, %%ymm0       \n\t"\
+    "add         $32, %0                    \n\t"\
+    " jmp 1b                                \n\t"\
+    "2:                                     \n\t"\
+    "vextracti128 $1, %%ymm0, %%xmm1        \n\t"\
+    "vpaddd    %%xmm1, %%xmm0, %%xmm0       \n\t"\
+    "test         %0, %0                    \n\t"\
+    " jz 3f                                 \n\t"\
+    "vmovdqu   (%2, %0), %%xmm1             \n\t"\
+    "vpmaddwd  (%3, %0), %%xmm1, %%xmm1     \n\t"\
+    "vpaddd    %%xmm1, %%xmm0, %%xmm0       \n\t"\
+    "3:                                     \n\t"\
+    "vphaddd   %%xmm0, %%xmm0, %%xmm0       \n\t"\
+    "vphaddd   %%xmm0, %%xmm0, %%xmm0       \n\t"\
+    "vmovd     %%xmm0, %1                   \n\t"\
+    "vzeroupper                             \n\t"\
+    : "+r" (len), "=m" (val)\
+    : "r" (((uint8_t*)(src+sample_index))-len),\
+      "r" (((uint8_t*)filter)-len)\
+      XMM_CLOBBERS_ONLY("%xmm0", "%xmm1")\
+);\
+    CORE_TAIL(val, filter, vlen)\
+    OUT(dst[dst_index], val);
+
+/* The 64 bit products of the even and odd elements are summed separately,
+ * rounding and clipping is left to the C code. */
+#define COMMON_CORE_INT32_AVX2 \
+    int vlen= c->filter_length & ~7;\
+    x86_reg len= -4*vlen;\
+    FELEM2 val;\
+__asm__ volatile(\
+    "vpxor     %%ymm0, %%ymm0, %%ymm0       \n\t"\
+    "vpxor     %%ymm2, %%ymm2, %%ymm2       \n\t"\
+    "test         %0, %0                    \n\t"\
+    " jz 2f                                 \n\t"\
+    "1:                                     \n\t"\
+    "vmovdqu   (%2, %0), %%ymm1             \n\t"\
+    "vmovdqu   (%3, %0), %%ymm3             \n\t"\
+    "vpmuldq   %%ymm3, %%ymm1, %%ymm4       \n\t"\
+    "vpsrlq       $32, %%ymm1, %%ymm1       \n\t"\
+    "vpsrlq       $32, %%ymm3, %%ymm3       \n\t"\
+    "vpmuldq   %%ymm3, %%ymm1, %%ymm1       \n\t"\
+    "vpaddq    %%ymm4, %%ymm0, %%ymm0       \n\t"\
+    "vpaddq    %%ymm1, %%ymm2, %%ymm2       \n\t"\
+    "add         $32, %0                    \n\t"\
+    " js 1b                                 \n\t"\
+    "2:                                     \n\t"\
+    "vpaddq    %%ymm2, %%ymm0, %%ymm0       \n\t"\
+    "vextracti128 $1, %%ymm0, %%xmm1        \n\t"\
+    "vpaddq    %%xmm1, %%xmm0, %%xmm0       \n\t"\
+    "vpunpckhqdq %%xmm0, %%xmm0, %%xmm1     \n\t"\
+    "vpaddq    %%xmm1, %%xmm0, %%xmm0       \n\t"\
+    "vmovq     %%xmm0, %1                   \n\t"\
+    "vzeroupper                             \n\t"\
+    : "+r" (len), "=m" (val)\
+    : "r" (((uint8_t*)(src+sample_index))-len),\
+      "r" (((uint8_t*)filter)-len)\
+      XMM_CLOBBERS_ONLY("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4")\
+);\
+    CORE_TAIL(val, filter, vlen)\
+    OUT(dst[dst_index], val);
+
+/* MULADD_AVX/MULADD_FMA3(type, acc, mem, tmp): acc += tmp * mem, tmp may be
+ * clobbered */
+#define MULADD_AVX(type, acc, mem, tmp) \
+    "vmul"type"  "mem", %%"tmp", %%"tmp"  \n\t"\
+    "vadd"type"  %%"tmp", %%"acc", %%"acc"\n\t"
+#define MULADD_FMA3(type, acc, mem, tmp) \
+    "vfmadd231"type" "mem", %%"tmp", %%"acc"\n\t"
+
+#define COMMON_CORE_FLT(MULADD) \
+    int vlen= c->filter_length & ~7;\
+    x86_reg len= -4*vlen;\
+    FELEM2 val;\
+__asm__ volatile(\
+    "vxorps    %%ymm0, %%ymm0, %%ymm0       \n\t"\
+    "test         %0, %0                    \n\t"\
+    " jz 2f                                 \n\t"\
+    "1:                                     \n\t"\
+    "vmovups   (%2, %0), %%ymm1             \n\t"\
+    MULADD("ps", "ymm0", "(%3, %0)", "ymm1")\
+    "add         $32, %0                    \n\t"\
+    " js 1b                                 \n\t"\
+    "2:                                     \n\t"\
+    "vextractf128 $1, %%ymm0, %%xmm1        \n\t"\
+    "vaddps    %%xmm1, %%xmm0, %%xmm0       \n\t"\
+    "vmovhlps  %%xmm0, %%xmm0, %%xmm1       \n\t"\
+    "vaddps    %%xmm1, %%xmm0, %%xmm0       \n\t"\
+    "vshufps $1, %%xmm0, %%xmm0, %%xmm1     \n\t"\
+    "vaddss    %%xmm1, %%xmm0, %%xmm0       \n\t"\
+    "vmovss    %%xmm0, %1                   \n\t"\
+    "vzeroupper                             \n\t"\
+    : "+r" (len), "=m" (val)\
+    : "r" (((uint8_t*)(src+sample_index))-len),\
+      "r" (((uint8_t*)filter)-len)\
+      XMM_CLOBBERS_ONLY("%xmm0", "%xmm1")\
+);\
+    CORE_TAIL(val, filter, vlen)\
+    OUT(dst[dst_index], val);
+
+#define LINEAR_CORE_FLT(MULADD) \
+    int vlen= c->filter_length & ~7;\
+    x86_reg len= -4*vlen;\
+__asm__ volatile(\
+    "vxorps    %%ymm0, %%ymm0, %%ymm0       \n\t"\
+    "vxorps    %%ymm2, %%ymm2, %%ymm2       \n\t"\
+    "test         %0, %0                    \n\t"\
+    " jz 2f                                 \n\t"\
+    "1:                                     \n\t"\
+    "vmovups   (%3, %0), %%ymm1             \n\t"\
+    "vmovaps   %%ymm1, %%ymm3               \n\t"\
+    MULADD("ps", "ymm0", "(%4, %0)", "ymm1")\
+    MULADD("ps", "ymm2", "(%5, %0)", "ymm3")\
+    "add         $32, %0                    \n\t"\
+    " js 1b                                 \n\t"\
+    "2:                                     \n\t"\
+    "vextractf128 $1, %%ymm0, %%xmm1        \n\t"\
+    "vextractf128 $1, %%ymm2, %%xmm3        \n\t"\
+    "vaddps    %%xmm1, %%xmm0, %%xmm0       \n\t"\
+    "vaddps    %%xmm3, %%xmm2, %%xmm2       \n\t"\
+    "vhaddps   %%xmm2, %%xmm0, %%xmm0       \n\t"\
+    "vhaddps   %%xmm0, %%xmm0, %%xmm0       \n\t"\
+    "vmovss    %%xmm0, %1                   \n\t"\
+    "vmovshdup %%xmm0, %%xmm1               \n\t"\
+    "vmovss    %%xmm1, %2                   \n\t"\
+    "vzeroupper                             \n\t"\
+    : "+r" (len), "=m" (val), "=m" (v2)\
+    : "r" (((uint8_t*)(src+sample_index))-len),\
+      "r" (((uint8_t*)filter)-len),\
+      "r" (((uint8_t*)(filter+c->filter_alloc))-len)\
+      XMM_CLOBBERS_ONLY("%xmm0", "%xmm1", "%xmm2", "%xmm3")\
+);\
+    CORE_TAIL(val, filter, vlen)\
+    CORE_TAIL(v2, filter + c->filter_alloc, vlen)
+
+#define COMMON_CORE_DBL(MULADD) \
+    int vlen= c->filter_length & ~7;\
+    x86_reg len= -8*vlen;\
+    FELEM2 val;\
+__asm__ volatile(\
+    "vxorpd    %%ymm0, %%ymm0, %%ymm0       \n\t"\
+    "vxorpd    %%ymm2, %%ymm2, %%ymm2       \n\t"\
+    "test         %0, %0                    \n\t"\
+    " jz 2f                                 \n\t"\
+    "1:                                     \n\t"\
+    "vmovupd   (%2, %0), %%ymm1             \n\t"\
+    "vmovupd 32(%2, %0), %%ymm3             \n\t"\
+    MULADD("pd", "ymm0", "(%3, %0)", "ymm1")\
+    MULADD("pd", "ymm2", "32(%3, %0)", "ymm3")\
+    "add         $64, %0                    \n\t"\
+    " js 1b                                 \n\t"\
+    "2:                                     \n\t"\
+    "vaddpd    %%ymm2, %%ymm0, %%ymm0       \n\t"\
+    "vextractf128 $1, %%ymm0, %%xmm1        \n\t"\
+    "vaddpd    %%xmm1, %%xmm0, %%xmm0       \n\t"\
+    "vunpckhpd %%xmm0, %%xmm0, %%xmm1       \n\t"\
+    "vaddsd    %%xmm1, %%xmm0, %%xmm0       \n\t"\
+    "vmovsd    %%xmm0, %1                   \n\t"\
+    "vzeroupper                             \n\t"\
+    : "+r" (len), "=m" (val)\
+    : "r" (((uint8_t*)(src+sample_index))-len),\
+      "r" (((uint8_t*)filter)-len)\
+      XMM_CLOBBERS_ONLY("%xmm0", "%xmm1", "%xmm2", "%xmm3")\
+);\
+    CORE_TAIL(val, filter, vlen)\
+    OUT(dst[dst_index], val);
+
+#define LINEAR_CORE_DBL(MULADD) \
+    int vlen= c->filter_length & ~3;\
+    x86_reg len= -8*vlen;\
+__asm__ volatile(\
+    "vxorpd    %%ymm0, %%ymm0, %%ymm0       \n\t"\
+    "vxorpd    %%ymm2, %%ymm2, %%ymm2       \n\t"\
+    "test         %0, %0                    \n\t"\
+    " jz 2f                                 \n\t"\
+    "1:                                     \n\t"\
+    "vmovupd   (%3, %0), %%ymm1             \n\t"\
+    "vmovapd   %%ymm1, %%ymm3               \n\t"\
+    MULADD("pd", "ymm0", "(%4, %0)", "ymm1")\
+    MULADD("pd", "ymm2", "(%5, %0)", "ymm3")\
+    "add         $32, %0                    \n\t"\
+    " js 1b                                 \n\t"\
+    "2:                                     \n\t"\
+    "vextractf128 $1, %%ymm0, %%xmm1        \n\t"\
+    "vextractf128 $1, %%ymm2, %%xmm3        \n\t"\
+    "vaddpd    %%xmm1, %%xmm0, %%xmm0       \n\t"\
+    "vaddpd    %%xmm3, %%xmm2, %%xmm2       \n\t"\
+    "vhaddpd   %%xmm2, %%xmm0, %%xmm0       \n\t"\
+    "vmovlpd   %%xmm0, %1                   \n\t"\
+    "vmovhpd   %%xmm0, %2                   \n\t"\
+    "vzeroupper                             \n\t"\
+    : "+r" (len), "=m" (val), "=m" (v2)\
+    : "r" (((uint8_t*)(src+sample_index))-len),\
+      "r" (((uint8_t*)filter)-len),\
+      "r" (((uint8_t*)(filter+c->filter_alloc))-len)\
+      XMM_CLOBBERS_ONLY("%xmm0", "%xmm1", "%xmm2", "%xmm3")\
+);\
+    CORE_TAIL(val, filter, vlen)\
+    CORE_TAIL(v2, filter + c->filter_alloc, vlen)
+
+#define COMMON_CORE_FLT_AVX  COMMON_CORE_FLT(MULADD_AVX)
+#define COMMON_CORE_FLT_FMA3 COMMON_CORE_FLT(MULADD_FMA3)
+#define LINEAR_CORE_FLT_AVX  LINEAR_CORE_FLT(MULADD_AVX)
+#define LINEAR_CORE_FLT_FMA3 LINEAR_CORE_FLT(MULADD_FMA3)
+#define COMMON_CORE_DBL_AVX  COMMON_CORE_DBL(MULADD_AVX)
+#define COMMON_CORE_DBL_FMA3 COMMON_CORE_DBL(MULADD_FMA3)
+#define LINEAR_CORE_DBL_AVX  LINEAR_CORE_DBL(MULADD_AVX)
+#define LINEAR_CORE_DBL_FMA3 LINEAR_CORE_DBL(MULADD_FMA3)
@@ -18,6 +18,9 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/cpu.h"
 #include "libswresample/swresample_internal.h"
 #include "libswresample/audioconvert.h"
 
@@ -148,8 +151,107 @@ D(float, avx)
 D(int16, mmx)
 D(int16, sse2)
 
+mix_n_1_func_type ff_mix_n_1_float_sse;
+mix_n_1_func_type ff_mix_n_1_float_avx;
+mix_n_1_func_type ff_mix_n_1_int16_sse2;
 
-av_cold void swri_rematrix_init_x86(struct SwrContext *s){
+/**
+ * One term of the sum computing an output channel, the non zero
+ * coefficients of the matrix row and the offsets of their input channels
+ * in AudioData.ch. The layout must match TERM_SIZE in rematrix.asm.
+ * For float the coefficient is repeated 4 times and in[1] is unused.
+ * For int16 the coefficients of in[0] and in[1] are interleaved 4 times
+ * for pmaddwd.
+ */
+typedef struct SwrMixTerm {
+    DECLARE_ALIGNED(16, uint8_t, coeff)[16];
+    intptr_t in[2];
+} SwrMixTerm;
+
+static av_cold void set_int16_coeffs(SwrMixTerm *t, int c0, int c1)
+{
+    int n;
+
+    for (n = 0; n < 4; n++) {
+        AV_WN16(t->coeff + 4*n    , c0);
+        AV_WN16(t->coeff + 4*n + 2, c1);
+    }
+}
+
+/**
+ * Build the terms of ff_mix_n_1_*() for every output channel.
+ * Only the non zero coefficients are kept. Int16 coefficients which do not
+ * fit in 16 bits are split in 2 halves applied to the same input channel,
+ * output channels with larger coefficients are left to the C code.
+ */
+static av_cold int rematrix_init_n_1(SwrContext *s, int nb_in, int nb_out)
+{
+    int i, j, nb_terms = 0;
+    SwrMixTerm *t;
+
+    /* an int16 coefficient takes at most a whole term */
+    s->mix_terms = av_malloc_array(nb_in * nb_out, sizeof(SwrMixTerm));
+    if (!s->mix_terms)
+        return AVERROR(ENOMEM);
+    t = (SwrMixTerm*)s->mix_terms;
+
+    for (i = 0; i < nb_out; i++) {
+        s->mix_terms_off[i] = nb_terms * sizeof(SwrMixTerm);
+        s->mix_terms_nb[i]  = 0;
+        if (s->midbuf.fmt == AV_SAMPLE_FMT_FLTP) {
+            for (j = 0; j < nb_in; j++) {
+                float c = ((float*)s->native_matrix)[i * nb_in + j];
+                if (!c)
+                    continue;
+                AV_COPY32(t->coeff     , &c);
+                AV_COPY32(t->coeff +  4, &c);
+                AV_COPY32(t->coeff +  8, &c);
+                AV_COPY32(t->coeff + 12, &c);
+                t->in[0] = t->in[1] = j * sizeof(uint8_t*);
+                t++;
+                s->mix_terms_nb[i]++;
+            }
+        } else {
+            int c[2], n = 0;
+
+            for (j = 0; j < nb_in; j++)
+                if (s->matrix32[i][j] < -65536 || s->matrix32[i][j] > 65534)
+                    break;
+            if (j < nb_in)
+                continue;
+            for (j = 0; j < nb_in; j++) {
+                int v = s->matrix32[i][j];
+                if (v == (int16_t)v)
+                    continue;
+                t->in[0] = t->in[1] = j * sizeof(uint8_t*);
+                set_int16_coeffs(t++, v >> 1, v - (v >> 1));
+                s->mix_terms_nb[i]++;
+            }
+            for (j = 0; j < nb_in; j++) {
+                int v = s->matrix32[i][j];
+                if (!v || v != (int16_t)v)
+                    continue;
+                c[n] = v;
+                t->in[n++] = j * sizeof(uint8_t*);
+                if (n == 2) {
+                    set_int16_coeffs(t++, c[0], c[1]);
+                    s->mix_terms_nb[i]++;
+                    n = 0;
+                }
+            }
+            if (n) {
+                t->in[1] = t->in[0];
+                set_int16_coeffs(t++, c[0], 0);
+                s->mix_terms_nb[i]++;
+            }
+        }
+        nb_terms += s->mix_terms_nb[i];
+    }
+    return 0;
+}
+
+
+av_cold int swri_rematrix_init_x86(struct SwrContext *s){
     int mm_flags = av_get_cpu_flags();
     int nb_in  = av_get_channel_layout_nb_channels(s->in_ch_layout);
     int nb_out = av_get_channel_layout_nb_channels(s->out_ch_layout);
@@ -197,4 +299,39 @@ av_cold void swri_rematrix_init_x86(struct SwrContext *s){
         s->native_simd_one = av_mallocz(sizeof(float));
         memcpy(s->native_simd_one, s->native_one, sizeof(float));
     }
+
+    if (s->midbuf.fmt == AV_SAMPLE_FMT_FLTP && EXTERNAL_SSE(mm_flags)) {
+        s->mix_n_1_simd  = ff_mix_n_1_float_sse;
+        s->mix_n_1_block = 16;
+        if (EXTERNAL_AVX(mm_flags)) {
+            s->mix_n_1_simd  = ff_mix_n_1_float_avx;
+            s->mix_n_1_block = 32;
+        }
+    } else if (s->midbuf.fmt == AV_SAMPLE_FMT_S16P && EXTERNAL_SSE2(mm_flags)) {
+        s->mix_n_1_simd  = ff_mix_n_1_int16_sse2;
+        s->mix_n_1_block = 16;
+    }
+    if (s->mix_n_1_simd)
+        return rematrix_init_n_1(s, nb_in, nb_out);
+
+    return 0;
+}
+
+void ff_dither_noise_rect_sse2(double *dst, const uint32_t *seeds, int len);
+void ff_dither_noise_tri_sse2(double *dst, const uint32_t *seeds, int len);
+int ff_dither_noise_shaping_sse4(double *buf, const float *noise, float *errors,
+                                 const float *coeffs, int taps, int pos, int count);
+
+av_cold void swri_dither_init_x86(struct SwrContext *s){
+#if ARCH_X86_64
+    /* The output is identical to the one of the C code, which on x86-32
+     * computes with the x87 and rounds differently. */
+    int mm_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(mm_flags))
+        s->dither.get_noise_simd = s->dither.method == SWR_DITHER_RECTANGULAR ? ff_dither_noise_rect_sse2
+                                                                              : ff_dither_noise_tri_sse2;
+    if (EXTERNAL_SSE4(mm_flags) && s->dither.method > SWR_DITHER_NS)
+        s->dither.noise_shaping_simd = ff_dither_noise_shaping_sse4;
+#endif
 }
@@ -0,0 +1,142 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/imgutils.h"
+#include "libavutil/mem.h"
+#include "swscale.h"
+
+#define SRC_W 96
+#define SRC_H 64
+#define DST_W 48
+#define DST_H 32
+
+#define GET(w, h) sws_pool_get_context(pool, SRC_W, SRC_H, AV_PIX_FMT_YUV420P, \
+                                       w, h, AV_PIX_FMT_RGB24, SWS_BICUBIC, NULL)
+
+#define CHECK(cond)                                                         \
+    if (!(cond)) {                                                          \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        ret = 1;                                                            \
+        goto end;                                                           \
+    }
+
+static int scale(struct SwsContext *c, uint8_t *src[4], int src_stride[4],
+                 uint8_t *dst)
+{
+    uint8_t *dst_data[4]  = { dst };
+    int dst_stride[4]     = { DST_W * 3 };
+
+    return sws_scale(c, (const uint8_t * const *)src, src_stride, 0, SRC_H,
+                     dst_data, dst_stride);
+}
+
+int main(void)
+{
+    SwsContextPool *pool = NULL;
+    struct SwsContext *c1 = NULL, *c2 = NULL, *c3 = NULL, *c4 = NULL, *tmp;
+    uint8_t *src[4], *dst1 = NULL, *dst2 = NULL;
+    int src_stride[4];
+    int i, ret = 0;
+
+    if (av_image_alloc(src, src_stride, SRC_W, SRC_H, AV_PIX_FMT_YUV420P, 16) < 0)
+        return 1;
+    for (i = 0; i < src_stride[0] * SRC_H; i++)
+        src[0][i] = i * 7 + (i >> 5);
+    for (i = 0; i < src_stride[1] * SRC_H / 2; i++) {
+        src[1][i] = i * 3;
+        src[2][i] = 255 - i * 5;
+    }
+    dst1 = av_malloc(DST_W * DST_H * 3);
+    dst2 = av_malloc(DST_W * DST_H * 3);
+    if (!dst1 || !dst2 || !(pool = sws_pool_alloc(1))) {
+        ret = 1;
+        goto end;
+    }
+
+    /* a context in use is never handed out twice */
+    c1 = GET(DST_W, DST_H);
+    c2 = GET(DST_W, DST_H);
+    CHECK(c1 && c2 && c1 != c2);
+
+    /* contexts with the same parameters scale identically */
+    CHECK(scale(c1, src, src_stride, dst1) == DST_H);
+    CHECK(scale(c2, src, src_stride, dst2) == DST_H);
+    CHECK(!memcmp(dst1, dst2, DST_W * DST_H * 3));
+
+    /* a released context is reused */
+    tmp = c1;
+    sws_pool_release_context(pool, &c1);
+    CHECK(!c1);
+    c1 = GET(DST_W, DST_H);
+    CHECK(c1 == tmp);
+
+    /* the colorspace details do not leak to the next user of a context */
+    {
+        int *inv_table, *table, src_range, dst_range, brightness, contrast, saturation;
+
+        CHECK(sws_setColorspaceDetails(c1, sws_getCoefficients(SWS_CS_ITU709), 1,
+                                       sws_getCoefficients(SWS_CS_ITU709), 0,
+                                       0, 1 << 16, 1 << 16) >= 0);
+        tmp = c1;
+        sws_pool_release_context(pool, &c1);
+        c1 = GET(DST_W, DST_H);
+        CHECK(c1 == tmp);
+        sws_getColorspaceDetails(c1, &inv_table, &src_range, &table, &dst_range,
+                                 &brightness, &contrast, &saturation);
+        CHECK(!src_range && !memcmp(inv_table, sws_getCoefficients(SWS_CS_DEFAULT),
+                                    4 * sizeof(*inv_table)));
+        memset(dst1, 0, DST_W * DST_H * 3);
+        CHECK(scale(c1, src, src_stride, dst1) == DST_H);
+        CHECK(!memcmp(dst1, dst2, DST_W * DST_H * 3));
+    }
+
+    /* different parameters give a different context */
+    c3 = GET(DST_W / 2, DST_H / 2);
+    CHECK(c3 && c3 != c1 && c3 != c2);
+    tmp = c3;
+    sws_pool_release_context(pool, &c3);
+    c4 = GET(DST_W, DST_H);
+    CHECK(c4 && c4 != tmp && c4 != c1 && c4 != c2);
+    c3 = GET(DST_W / 2, DST_H / 2);
+    CHECK(c3 == tmp);
+
+    /* with max_idle 1, only one released context is kept per parameters,
+     * c2 and c4 are freed on release and the reused one still works */
+    sws_pool_release_context(pool, &c1);
+    sws_pool_release_context(pool, &c2);
+    sws_pool_release_context(pool, &c4);
+    c1 = GET(DST_W, DST_H);
+    CHECK(c1);
+    memset(dst1, 0, DST_W * DST_H * 3);
+    CHECK(scale(c1, src, src_stride, dst1) == DST_H);
+    CHECK(!memcmp(dst1, dst2, DST_W * DST_H * 3));
+
+end:
+    sws_pool_release_context(pool, &c1);
+    sws_pool_release_context(pool, &c2);
+    sws_pool_release_context(pool, &c3);
+    sws_pool_release_context(pool, &c4);
+    sws_pool_free(&pool);
+    av_freep(&src[0]);
+    av_free(dst1);
+    av_free(dst2);
+    return ret;
+}
@@ -0,0 +1,307 @@
+/*
+ * Pool of scaling contexts sharing their filter coefficients
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "config.h"
+
+#if HAVE_PTHREADS
+#include <pthread.h>
+#elif HAVE_W32THREADS
+#include "compat/w32pthreads.h"
+#elif HAVE_OS2THREADS
+#include "compat/os2threads.h"
+#endif
+
+#include "libavutil/mem.h"
+#include "swscale.h"
+#include "swscale_internal.h"
+
+#if HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS
+#define POOL_LOCK(pool)   pthread_mutex_lock(&(pool)->mutex)
+#define POOL_UNLOCK(pool) pthread_mutex_unlock(&(pool)->mutex)
+#else
+#define POOL_LOCK(pool)
+#define POOL_UNLOCK(pool)
+#endif
+
+/* the state set by sws_setColorspaceDetails() */
+typedef struct SwsColorspaceDetails {
+    int inv_table[4], table[4];
+    int srcRange, dstRange;
+    int brightness, contrast, saturation;
+} SwsColorspaceDetails;
+
+typedef struct SwsPoolEntry {
+    int srcW, srcH, dstW, dstH, flags;
+    enum AVPixelFormat srcFormat, dstFormat;
+    double param[2];
+    /**
+     * The colorspace details of the contexts when they are handed out, the
+     * ones they were initialized with.
+     */
+    SwsColorspaceDetails cs;
+
+    /**
+     * All the contexts allocated for these parameters. The first one owns
+     * the filter tables the others are using.
+     */
+    SwsContext **contexts;
+    uint8_t *in_use;
+    int nb_contexts;
+} SwsPoolEntry;
+
+struct SwsContextPool {
+    SwsPoolEntry *entries;
+    int nb_entries;
+    int max_idle;
+#if HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS
+    pthread_mutex_t mutex;
+#endif
+};
+
+SwsContextPool *sws_pool_alloc(int max_idle)
+{
+    SwsContextPool *pool = av_mallocz(sizeof(*pool));
+
+    if (!pool)
+        return NULL;
+    pool->max_idle = max_idle;
+#if HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS
+    if (pthread_mutex_init(&pool->mutex, NULL)) {
+        av_free(pool);
+        return NULL;
+    }
+#endif
+    return pool;
+}
+
+static void get_colorspace_details(SwsContext *c, SwsColorspaceDetails *cs)
+{
+    int *inv_table, *table;
+
+    sws_getColorspaceDetails(c, &inv_table, &cs->srcRange, &table, &cs->dstRange,
+                             &cs->brightness, &cs->contrast, &cs->saturation);
+    memcpy(cs->inv_table, inv_table, sizeof(cs->inv_table));
+    memcpy(cs->table,     table,     sizeof(cs->table));
+}
+
+static SwsPoolEntry *find_entry(SwsContextPool *pool,
+                                int srcW, int srcH, enum AVPixelFormat srcFormat,
+                                int dstW, int dstH, enum AVPixelFormat dstFormat,
+                                int flags, const double *param)
+{
+    int i;
+
+    for (i = 0; i < pool->nb_entries; i++) {
+        SwsPoolEntry *e = &pool->entries[i];
+        if (e->srcW      == srcW      && e->srcH      == srcH      &&
+            e->srcFormat == srcFormat && e->dstW      == dstW      &&
+            e->dstH      == dstH      && e->dstFormat == dstFormat &&
+            e->flags     == flags     && e->param[0]  == param[0]  &&
+            e->param[1]  == param[1])
+            return e;
+    }
+    return NULL;
+}
+
+static int add_context(SwsPoolEntry *e, SwsContext *c)
+{
+    SwsContext **contexts;
+    uint8_t *in_use;
+
+    contexts = av_realloc_array(e->contexts, e->nb_contexts + 1,
+                                sizeof(*e->contexts));
+    if (!contexts)
+        return AVERROR(ENOMEM);
+    e->contexts = contexts;
+    in_use = av_realloc(e->in_use, e->nb_contexts + 1);
+    if (!in_use)
+        return AVERROR(ENOMEM);
+    e->in_use = in_use;
+
+    e->contexts[e->nb_contexts] = c;
+    e->in_use[e->nb_contexts++] = 1;
+    return 0;
+}
+
+SwsContext *sws_pool_get_context(SwsContextPool *pool,
+                                 int srcW, int srcH, enum AVPixelFormat srcFormat,
+                                 int dstW, int dstH, enum AVPixelFormat dstFormat,
+                                 int flags, const double *param)
+{
+    static const double default_param[2] = { SWS_PARAM_DEFAULT,
+                                             SWS_PARAM_DEFAULT };
+    SwsPoolEntry *e;
+    SwsContext *c, *filter_src = NULL;
+    int i, new_entry = 0;
+
+    if (!param)
+        param = default_param;
+
+    POOL_LOCK(pool);
+    e = find_entry(pool, srcW, srcH, srcFormat, dstW, dstH, dstFormat,
+                   flags, param);
+    if (e) {
+        for (i = 0; i < e->nb_contexts; i++) {
+            if (!e->in_use[i]) {
+                e->in_use[i] = 1;
+                c = e->contexts[i];
+                POOL_UNLOCK(pool);
+                return c;
+            }
+        }
+        filter_src = e->contexts[0];
+    }
+    POOL_UNLOCK(pool);
+
+    /* Initialize outside of the lock, the filter tables of filter_src are
+     * not modified and it is only freed with the pool. */
+    if (!(c = sws_alloc_context()))
+        return NULL;
+    c->srcW       = srcW;
+    c->srcH       = srcH;
+    c->srcFormat  = srcFormat;
+    c->dstW       = dstW;
+    c->dstH       = dstH;
+    c->dstFormat  = dstFormat;
+    c->flags      = flags;
+    c->param[0]   = param[0];
+    c->param[1]   = param[1];
+    c->filter_src = filter_src;
+    if (sws_init_context(c, NULL, NULL) < 0) {
+        sws_freeContext(c);
+        return NULL;
+    }
+
+    POOL_LOCK(pool);
+    e = find_entry(pool, srcW, srcH, srcFormat, dstW, dstH, dstFormat,
+                   flags, param);
+    if (!e) {
+        SwsPoolEntry *entries = av_realloc_array(pool->entries,
+                                                 pool->nb_entries + 1,
+                                                 sizeof(*pool->entries));
+        if (!entries)
+            goto fail;
+        pool->entries = entries;
+        e = &pool->entries[pool->nb_entries++];
+        memset(e, 0, sizeof(*e));
+        e->srcW      = srcW;
+        e->srcH      = srcH;
+        e->srcFormat = srcFormat;
+        e->dstW      = dstW;
+        e->dstH      = dstH;
+        e->dstFormat = dstFormat;
+        e->flags     = flags;
+        e->param[0]  = param[0];
+        e->param[1]  = param[1];
+        get_colorspace_details(c, &e->cs);
+        new_entry    = 1;
+    }
+    /* If another thread created the entry meanwhile, c owns its own filter
+     * tables and is simply added after the first context. */
+    if (add_context(e, c) < 0) {
+        /* an entry without contexts must not stay in the pool */
+        if (new_entry) {
+            av_freep(&e->contexts);
+            av_freep(&e->in_use);
+            pool->nb_entries--;
+        }
+        goto fail;
+    }
+    POOL_UNLOCK(pool);
+    return c;
+
+fail:
+    POOL_UNLOCK(pool);
+    sws_freeContext(c);
+    return NULL;
+}
+
+void sws_pool_release_context(SwsContextPool *pool, SwsContext **context)
+{
+    SwsContext *c = *context, *to_free = NULL;
+    SwsColorspaceDetails cs;
+    int i, j, k, idle;
+
+    if (!c)
+        return;
+    *context = NULL;
+
+    POOL_LOCK(pool);
+    for (i = 0; i < pool->nb_entries; i++) {
+        SwsPoolEntry *e = &pool->entries[i];
+        for (j = 0; j < e->nb_contexts && e->contexts[j] != c; j++)
+            ;
+        if (j == e->nb_contexts)
+            continue;
+
+        /* a context whose colorspace details were changed with
+         * sws_setColorspaceDetails() gets the ones of its entry back */
+        get_colorspace_details(c, &cs);
+        if (memcmp(&cs, &e->cs, sizeof(cs)))
+            sws_setColorspaceDetails(c, e->cs.inv_table, e->cs.srcRange,
+                                     e->cs.table, e->cs.dstRange,
+                                     e->cs.brightness, e->cs.contrast,
+                                     e->cs.saturation);
+
+        e->in_use[j] = 0;
+        for (idle = 0, k = 0; k < e->nb_contexts; k++)
+            idle += !e->in_use[k];
+        /* the first context is kept, it owns the filter tables */
+        if (pool->max_idle && idle > pool->max_idle && j) {
+            to_free = c;
+            e->nb_contexts--;
+            memmove(e->contexts + j, e->contexts + j + 1,
+                    (e->nb_contexts - j) * sizeof(*e->contexts));
+            memmove(e->in_use + j, e->in_use + j + 1, e->nb_contexts - j);
+        }
+        POOL_UNLOCK(pool);
+        sws_freeContext(to_free);
+        return;
+    }
+    POOL_UNLOCK(pool);
+
+    /* not from this pool */
+    sws_freeContext(c);
+}
+
+void sws_pool_free(SwsContextPool **ppool)
+{
+    SwsContextPool *pool = *ppool;
+    int i, j;
+
+    if (!pool)
+        return;
+
+    for (i = 0; i < pool->nb_entries; i++) {
+        SwsPoolEntry *e = &pool->entries[i];
+        /* free the contexts using the filter tables of the first one first */
+        for (j = e->nb_contexts - 1; j >= 0; j--)
+            sws_freeContext(e->contexts[j]);
+        av_freep(&e->contexts);
+        av_freep(&e->in_use);
+    }
+    av_freep(&pool->entries);
+#if HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS
+    pthread_mutex_destroy(&pool->mutex);
+#endif
+    av_freep(ppool);
+}
@@ -321,6 +321,58 @@ struct SwsContext *sws_getCachedContext(struct SwsContext *context,
                                         int flags, SwsFilter *srcFilter,
                                         SwsFilter *dstFilter, const double *param);
 
+/**
+ * A pool of scaling contexts, which can be shared between threads.
+ *
+ * Contexts obtained from the pool with the same parameters share their
+ * filter coefficients, each of them keeps its own line buffers, so they
+ * can be used concurrently. Released contexts are kept for reuse.
+ */
+typedef struct SwsContextPool SwsContextPool;
+
+/**
+ * Allocate an empty pool of scaling contexts.
+ *
+ * @param max_idle maximum number of released contexts kept for each set of
+ *                 parameters, 0 for no limit
+ * @return the pool, or NULL on allocation failure
+ */
+SwsContextPool *sws_pool_alloc(int max_idle);
+
+/**
+ * Get a scaling context from the pool, allocating it if there is no
+ * released context with the same parameters. The parameters are the same
+ * as for sws_getCachedContext(), without the filters.
+ *
+ * This function is thread-safe. The returned context must only be used by
+ * one thread at a time and must be given back with
+ * sws_pool_release_context().
+ *
+ * @return the context, or NULL in case of error
+ */
+struct SwsContext *sws_pool_get_context(SwsContextPool *pool,
+                                        int srcW, int srcH, enum AVPixelFormat srcFormat,
+                                        int dstW, int dstH, enum AVPixelFormat dstFormat,
+                                        int flags, const double *param);
+
+/**
+ * Give a context obtained with sws_pool_get_context() back to the pool.
+ * The colorspace details changed with sws_setColorspaceDetails() are reset
+ * to the ones the context was initialized with.
+ * This function is thread-safe.
+ *
+ * @param context pointer to the context, set to NULL on return
+ */
+void sws_pool_release_context(SwsContextPool *pool, struct SwsContext **context);
+
+/**
+ * Free the pool and all its contexts. No context obtained from the pool
+ * may be in use anymore.
+ *
+ * @param pool pointer to the pool, set to NULL on return
+ */
+void sws_pool_free(SwsContextPool **pool);
+
 /**
  * Convert an 8-bit paletted frame into a frame with a color depth of 32 bits.
  *
@@ -359,6 +359,13 @@ typedef struct SwsContext {
 
     int canMMXEXTBeUsed;
 
+    /**
+     * Context whose filter coefficients and fast bilinear scaler code are
+     * used instead of computing them, set by the context pool. They are not
+     * freed with this context, which must be freed before filter_src.
+     */
+    struct SwsContext *filter_src;
+
     int dstY;                     ///< Last destination vertical line output from last slice.
     int flags;                    ///< Flags passed by the user to select scaler algorithm, optimizations, subsampling, etc...
     void *yuvTable;             // pointer to the yuv->rgb table start so it can be freed()
@@ -604,6 +611,46 @@ typedef struct SwsContext {
 
     int needs_hcscale; ///< Set if there are chroma planes to be converted.
 
+    /**
+     * Line converters used by the unscaled planar <-> packed RGB wrappers.
+     * The 16-bit ones are only used for native endian input and output.
+     */
+    /** @{ */
+    void (*gbr24pToPacked24Line)(uint8_t *dst, const uint8_t *src0,
+                                 const uint8_t *src1, const uint8_t *src2,
+                                 int width);
+    void (*gbr24pToPacked32Line)(uint8_t *dst, const uint8_t *src0,
+                                 const uint8_t *src1, const uint8_t *src2,
+                                 int width, int alpha_first);
+    void (*packed24ToGbr24pLine)(uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+                                 const uint8_t *src, int width);
+    void (*packed32ToGbr24pLine)(uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+                                 const uint8_t *src, int width, int alpha_first);
+    void (*packed16ToGbra16Line)(uint16_t *dst[4], const uint16_t *src,
+                                 int width, int src_alpha, int shift);
+    void (*gbr16pToPacked16Line)(uint16_t *dst, const uint16_t *src[4],
+                                 int width, int alpha, int bpp);
+    /** @} */
+
+    /**
+     * Line converters used by the unscaled bit depth conversions, for native
+     * endian input and output only. The dither functions compute
+     * dst[i] = (src[i] + dither[i & 7]) * scale >> shift, the shift up ones
+     * dst[i] = src[i] << shift_high | src[i] >> shift_low.
+     */
+    /** @{ */
+    void (*ditherU16ToU8Line)(uint8_t *dst, const uint16_t *src,
+                              const uint8_t *dither, int scale, int shift,
+                              int width);
+    void (*ditherU16ToU16Line)(uint16_t *dst, const uint16_t *src,
+                               const uint8_t *dither, int scale, int shift,
+                               int width);
+    void (*shiftUpU8ToU16Line)(uint16_t *dst, const uint8_t *src, int width,
+                               int shift_high, int shift_low);
+    void (*shiftUpU16Line)(uint16_t *dst, const uint16_t *src, int width,
+                           int shift_high, int shift_low);
+    /** @} */
+
     SwsDither dither;
 } SwsContext;
 //FIXME check init (where 0)
@@ -836,6 +883,31 @@ void ff_get_unscaled_swscale(SwsContext *c);
 void ff_get_unscaled_swscale_bfin(SwsContext *c);
 void ff_get_unscaled_swscale_ppc(SwsContext *c);
 void ff_get_unscaled_swscale_arm(SwsContext *c);
+void ff_get_unscaled_swscale_x86(SwsContext *c);
+
+void ff_gbr24p_to_packed24_c(uint8_t *dst, const uint8_t *src0,
+                             const uint8_t *src1, const uint8_t *src2, int width);
+void ff_gbr24p_to_packed32_c(uint8_t *dst, const uint8_t *src0,
+                             const uint8_t *src1, const uint8_t *src2, int width,
+                             int alpha_first);
+void ff_packed24_to_gbr24p_c(uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+                             const uint8_t *src, int width);
+void ff_packed32_to_gbr24p_c(uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+                             const uint8_t *src, int width, int alpha_first);
+void ff_packed16_to_gbra16_c(uint16_t *dst[4], const uint16_t *src, int width,
+                             int src_alpha, int shift);
+void ff_gbr16p_to_packed16_c(uint16_t *dest, const uint16_t *src[4], int width,
+                             int alpha, int bpp);
+void ff_dither_u16_to_u8_c(uint8_t *dst, const uint16_t *src,
+                           const uint8_t *dither, int scale, int shift,
+                           int width);
+void ff_dither_u16_to_u16_c(uint16_t *dst, const uint16_t *src,
+                            const uint8_t *dither, int scale, int shift,
+                            int width);
+void ff_shift_up_u8_to_u16_c(uint16_t *dst, const uint8_t *src, int width,
+                             int shift_high, int shift_low);
+void ff_shift_up_u16_c(uint16_t *dst, const uint16_t *src, int width,
+                       int shift_high, int shift_low);
 
 /**
  * Return function pointer to fastest main scaler path function depending
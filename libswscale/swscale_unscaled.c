@@ -176,6 +176,46 @@ static int planarToNv12Wrapper(SwsContext *c, const uint8_t *src[],
     return srcSliceH;
 }
 
+static int planarHighToNv12Wrapper(SwsContext *c, const uint8_t *src[],
+                                   int srcStride[], int srcSliceY,
+                                   int srcSliceH, uint8_t *dstParam[],
+                                   int dstStride[])
+{
+    const AVPixFmtDescriptor *desc_src = av_pix_fmt_desc_get(c->srcFormat);
+    const int src_depth = desc_src->comp[0].depth_minus1 + 1;
+    const int scale = dither_scale[7][src_depth - 1];
+    const int shift = src_depth - 8 + dither_scale[src_depth - 2][7];
+    const int chrW  = FF_CEIL_RSHIFT(c->srcW, 1);
+    const int chrH  = FF_CEIL_RSHIFT(srcSliceH, 1);
+    uint8_t *ydst = dstParam[0] + dstStride[0] * srcSliceY;
+    uint8_t *cdst = dstParam[1] + dstStride[1] * srcSliceY / 2;
+    /* the chroma rows are dithered to 8 bits before being interleaved */
+    uint8_t *u = c->formatConvBuffer;
+    uint8_t *v = u + FFALIGN(chrW, 16);
+    int i;
+
+    for (i = 0; i < srcSliceH; i++)
+        c->ditherU16ToU8Line(ydst + i * dstStride[0],
+                             (const uint16_t *)(src[0] + i * srcStride[0]),
+                             dithers[src_depth - 9][i & 7], scale, shift,
+                             c->srcW);
+
+    for (i = 0; i < chrH; i++) {
+        const uint8_t *dither = dithers[src_depth - 9][i & 7];
+        c->ditherU16ToU8Line(u, (const uint16_t *)(src[1] + i * srcStride[1]),
+                             dither, scale, shift, chrW);
+        c->ditherU16ToU8Line(v, (const uint16_t *)(src[2] + i * srcStride[2]),
+                             dither, scale, shift, chrW);
+        if (c->dstFormat == AV_PIX_FMT_NV12)
+            interleaveBytes(u, v, cdst, chrW, 1, 0, 0, 0);
+        else
+            interleaveBytes(v, u, cdst, chrW, 1, 0, 0, 0);
+        cdst += dstStride[1];
+    }
+
+    return srcSliceH;
+}
+
 static int nv12ToPlanarWrapper(SwsContext *c, const uint8_t *src[],
                                int srcStride[], int srcSliceY,
                                int srcSliceH, uint8_t *dstParam[],
@@ -410,7 +450,43 @@ static int palToRgbWrapper(SwsContext *c, const uint8_t *src[], int srcStride[],
     return srcSliceH;
 }
 
-static void packed16togbra16(const uint8_t *src, int srcStride,
+void ff_packed16_to_gbra16_c(uint16_t *dst[4], const uint16_t *src, int width,
+                             int src_alpha, int shift)
+{
+    int x;
+    int dst_alpha = dst[3] != NULL;
+
+    if (src_alpha && dst_alpha) {
+        for (x = 0; x < width; x++) {
+            dst[0][x] = *src++ >> shift;
+            dst[1][x] = *src++ >> shift;
+            dst[2][x] = *src++ >> shift;
+            dst[3][x] = *src++ >> shift;
+        }
+    } else if (dst_alpha) {
+        for (x = 0; x < width; x++) {
+            dst[0][x] = *src++ >> shift;
+            dst[1][x] = *src++ >> shift;
+            dst[2][x] = *src++ >> shift;
+            dst[3][x] = 0xFFFF;
+        }
+    } else if (src_alpha) {
+        for (x = 0; x < width; x++) {
+            dst[0][x] = *src++ >> shift;
+            dst[1][x] = *src++ >> shift;
+            dst[2][x] = *src++ >> shift;
+            src++;
+        }
+    } else {
+        for (x = 0; x < width; x++) {
+            dst[0][x] = *src++ >> shift;
+            dst[1][x] = *src++ >> shift;
+            dst[2][x] = *src++ >> shift;
+        }
+    }
+}
+
+static void packed16togbra16(SwsContext *c, const uint8_t *src, int srcStride,
                              uint16_t *dst[], int dstStride[], int srcSliceH,
                              int src_alpha, int swap, int shift, int width)
 {
@@ -510,34 +586,7 @@ static void packed16togbra16(const uint8_t *src, int srcStride,
             }
             break;
         default:
-            if (src_alpha && dst_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = *src_line++ >> shift;
-                    dst[1][x] = *src_line++ >> shift;
-                    dst[2][x] = *src_line++ >> shift;
-                    dst[3][x] = *src_line++ >> shift;
-                }
-            } else if (dst_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = *src_line++ >> shift;
-                    dst[1][x] = *src_line++ >> shift;
-                    dst[2][x] = *src_line++ >> shift;
-                    dst[3][x] = 0xFFFF;
-                }
-            } else if (src_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = *src_line++ >> shift;
-                    dst[1][x] = *src_line++ >> shift;
-                    dst[2][x] = *src_line++ >> shift;
-                    src_line++;
-                }
-            } else {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = *src_line++ >> shift;
-                    dst[1][x] = *src_line++ >> shift;
-                    dst[2][x] = *src_line++ >> shift;
-                }
-            }
+            c->packed16ToGbra16Line(dst, src_line, width, src_alpha, shift);
         }
         for (i = 0; i < 4; i++)
             dst[i] += dstStride[i] >> 1;
@@ -575,7 +624,7 @@ static int Rgb16ToPlanarRgb16Wrapper(SwsContext *c, const uint8_t *src[],
     case AV_PIX_FMT_RGB48BE:
     case AV_PIX_FMT_RGBA64LE:
     case AV_PIX_FMT_RGBA64BE:
-        packed16togbra16(src[0] + srcSliceY * srcStride[0], srcStride[0],
+        packed16togbra16(c, src[0] + srcSliceY * srcStride[0], srcStride[0],
                          dst2013, stride2013, srcSliceH, alpha, swap,
                          16 - bpc, c->srcW);
         break;
@@ -583,7 +632,7 @@ static int Rgb16ToPlanarRgb16Wrapper(SwsContext *c, const uint8_t *src[],
     case AV_PIX_FMT_BGR48BE:
     case AV_PIX_FMT_BGRA64LE:
     case AV_PIX_FMT_BGRA64BE:
-        packed16togbra16(src[0] + srcSliceY * srcStride[0], srcStride[0],
+        packed16togbra16(c, src[0] + srcSliceY * srcStride[0], srcStride[0],
                          dst1023, stride1023, srcSliceH, alpha, swap,
                          16 - bpc, c->srcW);
         break;
@@ -596,7 +645,37 @@ static int Rgb16ToPlanarRgb16Wrapper(SwsContext *c, const uint8_t *src[],
     return srcSliceH;
 }
 
-static void gbr16ptopacked16(const uint16_t *src[], int srcStride[],
+void ff_gbr16p_to_packed16_c(uint16_t *dest, const uint16_t *src[4], int width,
+                             int alpha, int bpp)
+{
+    int x;
+    int src_alpha = src[3] != NULL;
+    int scale_high = 16 - bpp, scale_low = (bpp - 8) * 2;
+
+    if (alpha && !src_alpha) {
+        for (x = 0; x < width; x++) {
+            *dest++ = src[0][x] << scale_high | src[0][x] >> scale_low;
+            *dest++ = src[1][x] << scale_high | src[1][x] >> scale_low;
+            *dest++ = src[2][x] << scale_high | src[2][x] >> scale_low;
+            *dest++ = 0xffff;
+        }
+    } else if (alpha && src_alpha) {
+        for (x = 0; x < width; x++) {
+            *dest++ = src[0][x] << scale_high | src[0][x] >> scale_low;
+            *dest++ = src[1][x] << scale_high | src[1][x] >> scale_low;
+            *dest++ = src[2][x] << scale_high | src[2][x] >> scale_low;
+            *dest++ = src[3][x] << scale_high | src[3][x] >> scale_low;
+        }
+    } else {
+        for (x = 0; x < width; x++) {
+            *dest++ = src[0][x] << scale_high | src[0][x] >> scale_low;
+            *dest++ = src[1][x] << scale_high | src[1][x] >> scale_low;
+            *dest++ = src[2][x] << scale_high | src[2][x] >> scale_low;
+        }
+    }
+}
+
+static void gbr16ptopacked16(SwsContext *c, const uint16_t *src[], int srcStride[],
                              uint8_t *dst, int dstStride, int srcSliceH,
                              int alpha, int swap, int bpp, int width)
 {
@@ -688,27 +767,7 @@ static void gbr16ptopacked16(const uint16_t *src[], int srcStride[],
             }
             break;
         default:
-            if (alpha && !src_alpha) {
-                for (x = 0; x < width; x++) {
-                    *dest++ = src[0][x] << scale_high | src[0][x] >> scale_low;
-                    *dest++ = src[1][x] << scale_high | src[1][x] >> scale_low;
-                    *dest++ = src[2][x] << scale_high | src[2][x] >> scale_low;
-                    *dest++ = 0xffff;
-                }
-            } else if (alpha && src_alpha) {
-                for (x = 0; x < width; x++) {
-                    *dest++ = src[0][x] << scale_high | src[0][x] >> scale_low;
-                    *dest++ = src[1][x] << scale_high | src[1][x] >> scale_low;
-                    *dest++ = src[2][x] << scale_high | src[2][x] >> scale_low;
-                    *dest++ = src[3][x] << scale_high | src[3][x] >> scale_low;
-                }
-            } else {
-                for (x = 0; x < width; x++) {
-                    *dest++ = src[0][x] << scale_high | src[0][x] >> scale_low;
-                    *dest++ = src[1][x] << scale_high | src[1][x] >> scale_low;
-                    *dest++ = src[2][x] << scale_high | src[2][x] >> scale_low;
-                }
-            }
+            c->gbr16pToPacked16Line(dest, src, width, alpha, bpp);
         }
         for (i = 0; i < 3 + src_alpha; i++)
             src[i] += srcStride[i] >> 1;
@@ -744,25 +803,25 @@ static int planarRgb16ToRgb16Wrapper(SwsContext *c, const uint8_t *src[],
     switch (c->dstFormat) {
     case AV_PIX_FMT_BGR48LE:
     case AV_PIX_FMT_BGR48BE:
-        gbr16ptopacked16(src102, stride102,
+        gbr16ptopacked16(c, src102, stride102,
                          dst[0] + srcSliceY * dstStride[0], dstStride[0],
                          srcSliceH, 0, swap, bits_per_sample, c->srcW);
         break;
     case AV_PIX_FMT_RGB48LE:
     case AV_PIX_FMT_RGB48BE:
-        gbr16ptopacked16(src201, stride201,
+        gbr16ptopacked16(c, src201, stride201,
                          dst[0] + srcSliceY * dstStride[0], dstStride[0],
                          srcSliceH, 0, swap, bits_per_sample, c->srcW);
         break;
     case AV_PIX_FMT_RGBA64LE:
     case AV_PIX_FMT_RGBA64BE:
-         gbr16ptopacked16(src201, stride201,
+         gbr16ptopacked16(c, src201, stride201,
                           dst[0] + srcSliceY * dstStride[0], dstStride[0],
                           srcSliceH, 1, swap, bits_per_sample, c->srcW);
         break;
     case AV_PIX_FMT_BGRA64LE:
     case AV_PIX_FMT_BGRA64BE:
-        gbr16ptopacked16(src102, stride102,
+        gbr16ptopacked16(c, src102, stride102,
                          dst[0] + srcSliceY * dstStride[0], dstStride[0],
                          srcSliceH, 1, swap, bits_per_sample, c->srcW);
         break;
@@ -775,47 +834,60 @@ static int planarRgb16ToRgb16Wrapper(SwsContext *c, const uint8_t *src[],
     return srcSliceH;
 }
 
-static void gbr24ptopacked24(const uint8_t *src[], int srcStride[],
+void ff_gbr24p_to_packed24_c(uint8_t *dst, const uint8_t *src0,
+                             const uint8_t *src1, const uint8_t *src2, int width)
+{
+    int x;
+    for (x = 0; x < width; x++) {
+        *dst++ = src0[x];
+        *dst++ = src1[x];
+        *dst++ = src2[x];
+    }
+}
+
+void ff_gbr24p_to_packed32_c(uint8_t *dst, const uint8_t *src0,
+                             const uint8_t *src1, const uint8_t *src2, int width,
+                             int alpha_first)
+{
+    int x;
+    if (alpha_first) {
+        for (x = 0; x < width; x++) {
+            *dst++ = 0xff;
+            *dst++ = src0[x];
+            *dst++ = src1[x];
+            *dst++ = src2[x];
+        }
+    } else {
+        for (x = 0; x < width; x++) {
+            *dst++ = src0[x];
+            *dst++ = src1[x];
+            *dst++ = src2[x];
+            *dst++ = 0xff;
+        }
+    }
+}
+
+static void gbr24ptopacked24(SwsContext *c, const uint8_t *src[], int srcStride[],
                              uint8_t *dst, int dstStride, int srcSliceH,
                              int width)
 {
-    int x, h, i;
+    int h, i;
     for (h = 0; h < srcSliceH; h++) {
-        uint8_t *dest = dst + dstStride * h;
-        for (x = 0; x < width; x++) {
-            *dest++ = src[0][x];
-            *dest++ = src[1][x];
-            *dest++ = src[2][x];
-        }
+        c->gbr24pToPacked24Line(dst + dstStride * h, src[0], src[1], src[2], width);
 
         for (i = 0; i < 3; i++)
             src[i] += srcStride[i];
     }
 }
 
-static void gbr24ptopacked32(const uint8_t *src[], int srcStride[],
+static void gbr24ptopacked32(SwsContext *c, const uint8_t *src[], int srcStride[],
                              uint8_t *dst, int dstStride, int srcSliceH,
                              int alpha_first, int width)
 {
-    int x, h, i;
+    int h, i;
     for (h = 0; h < srcSliceH; h++) {
-        uint8_t *dest = dst + dstStride * h;
-
-        if (alpha_first) {
-            for (x = 0; x < width; x++) {
-                *dest++ = 0xff;
-                *dest++ = src[0][x];
-                *dest++ = src[1][x];
-                *dest++ = src[2][x];
-            }
-        } else {
-            for (x = 0; x < width; x++) {
-                *dest++ = src[0][x];
-                *dest++ = src[1][x];
-                *dest++ = src[2][x];
-                *dest++ = 0xff;
-            }
-        }
+        c->gbr24pToPacked32Line(dst + dstStride * h, src[0], src[1], src[2],
+                                width, alpha_first);
 
         for (i = 0; i < 3; i++)
             src[i] += srcStride[i];
@@ -841,13 +913,13 @@ static int planarRgbToRgbWrapper(SwsContext *c, const uint8_t *src[],
 
     switch (c->dstFormat) {
     case AV_PIX_FMT_BGR24:
-        gbr24ptopacked24(src102, stride102,
+        gbr24ptopacked24(c, src102, stride102,
                          dst[0] + srcSliceY * dstStride[0], dstStride[0],
                          srcSliceH, c->srcW);
         break;
 
     case AV_PIX_FMT_RGB24:
-        gbr24ptopacked24(src201, stride201,
+        gbr24ptopacked24(c, src201, stride201,
                          dst[0] + srcSliceY * dstStride[0], dstStride[0],
                          srcSliceH, c->srcW);
         break;
@@ -855,7 +927,7 @@ static int planarRgbToRgbWrapper(SwsContext *c, const uint8_t *src[],
     case AV_PIX_FMT_ARGB:
         alpha_first = 1;
     case AV_PIX_FMT_RGBA:
-        gbr24ptopacked32(src201, stride201,
+        gbr24ptopacked32(c, src201, stride201,
                          dst[0] + srcSliceY * dstStride[0], dstStride[0],
                          srcSliceH, alpha_first, c->srcW);
         break;
@@ -863,7 +935,7 @@ static int planarRgbToRgbWrapper(SwsContext *c, const uint8_t *src[],
     case AV_PIX_FMT_ABGR:
         alpha_first = 1;
     case AV_PIX_FMT_BGRA:
-        gbr24ptopacked32(src102, stride102,
+        gbr24ptopacked32(c, src102, stride102,
                          dst[0] + srcSliceY * dstStride[0], dstStride[0],
                          srcSliceH, alpha_first, c->srcW);
         break;
@@ -894,29 +966,54 @@ static int planarRgbToplanarRgbWrapper(SwsContext *c, const uint8_t *src[],
     return srcSliceH;
 }
 
-static void packedtogbr24p(const uint8_t *src, int srcStride,
+void ff_packed24_to_gbr24p_c(uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+                             const uint8_t *src, int width)
+{
+    int x;
+    for (x = 0; x < width; x++) {
+        dst0[x] = src[0];
+        dst1[x] = src[1];
+        dst2[x] = src[2];
+
+        src += 3;
+    }
+}
+
+void ff_packed32_to_gbr24p_c(uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+                             const uint8_t *src, int width, int alpha_first)
+{
+    int x;
+
+    if (alpha_first)
+        src++;
+
+    for (x = 0; x < width; x++) {
+        dst0[x] = src[0];
+        dst1[x] = src[1];
+        dst2[x] = src[2];
+
+        src += 4;
+    }
+}
+
+static void packedtogbr24p(SwsContext *c, const uint8_t *src, int srcStride,
                            uint8_t *dst[], int dstStride[], int srcSliceH,
                            int alpha_first, int inc_size, int width)
 {
     uint8_t *dest[3];
-    int x, h;
+    int h;
 
     dest[0] = dst[0];
     dest[1] = dst[1];
     dest[2] = dst[2];
 
-    if (alpha_first)
-        src++;
-
     for (h = 0; h < srcSliceH; h++) {
-        for (x = 0; x < width; x++) {
-            dest[0][x] = src[0];
-            dest[1][x] = src[1];
-            dest[2][x] = src[2];
-
-            src += inc_size;
-        }
-        src     += srcStride - width * inc_size;
+        if (inc_size == 3)
+            c->packed24ToGbr24pLine(dest[0], dest[1], dest[2], src, width);
+        else
+            c->packed32ToGbr24pLine(dest[0], dest[1], dest[2], src, width,
+                                    alpha_first);
+        src     += srcStride;
         dest[0] += dstStride[0];
         dest[1] += dstStride[1];
         dest[2] += dstStride[2];
@@ -939,23 +1036,23 @@ static int rgbToPlanarRgbWrapper(SwsContext *c, const uint8_t *src[],
 
     switch (c->srcFormat) {
     case AV_PIX_FMT_RGB24:
-        packedtogbr24p((const uint8_t *) src[0], srcStride[0], dst201,
+        packedtogbr24p(c, (const uint8_t *) src[0], srcStride[0], dst201,
                        stride201, srcSliceH, alpha_first, 3, c->srcW);
         break;
     case AV_PIX_FMT_BGR24:
-        packedtogbr24p((const uint8_t *) src[0], srcStride[0], dst102,
+        packedtogbr24p(c, (const uint8_t *) src[0], srcStride[0], dst102,
                        stride102, srcSliceH, alpha_first, 3, c->srcW);
         break;
     case AV_PIX_FMT_ARGB:
         alpha_first = 1;
     case AV_PIX_FMT_RGBA:
-        packedtogbr24p((const uint8_t *) src[0], srcStride[0], dst201,
+        packedtogbr24p(c, (const uint8_t *) src[0], srcStride[0], dst201,
                        stride201, srcSliceH, alpha_first, 4, c->srcW);
         break;
     case AV_PIX_FMT_ABGR:
         alpha_first = 1;
     case AV_PIX_FMT_BGRA:
-        packedtogbr24p((const uint8_t *) src[0], srcStride[0], dst102,
+        packedtogbr24p(c, (const uint8_t *) src[0], srcStride[0], dst102,
                        stride102, srcSliceH, alpha_first, 4, c->srcW);
         break;
     default:
@@ -1214,6 +1311,62 @@ static int packedCopyWrapper(SwsContext *c, const uint8_t *src[],
     return srcSliceH;
 }
 
+void ff_dither_u16_to_u8_c(uint8_t *dst, const uint16_t *src,
+                           const uint8_t *dither, int scale, int shift,
+                           int width)
+{
+    int j;
+    for (j = 0; j < width; j++)
+        dst[j] = (unsigned)(src[j] + dither[j & 7]) * scale >> shift;
+}
+
+void ff_dither_u16_to_u16_c(uint16_t *dst, const uint16_t *src,
+                            const uint8_t *dither, int scale, int shift,
+                            int width)
+{
+    int j;
+    for (j = 0; j < width; j++)
+        dst[j] = (unsigned)(src[j] + dither[j & 7]) * scale >> shift;
+}
+
+void ff_shift_up_u8_to_u16_c(uint16_t *dst, const uint8_t *src, int width,
+                             int shift_high, int shift_low)
+{
+    int j;
+    for (j = 0; j < width; j++)
+        dst[j] = src[j] << shift_high | src[j] >> shift_low;
+}
+
+void ff_shift_up_u16_c(uint16_t *dst, const uint16_t *src, int width,
+                       int shift_high, int shift_low)
+{
+    int j = 0;
+
+    if (shift_low >= 16) {
+#if HAVE_FAST_64BIT
+#define FAST_COPY_UP(shift) \
+    for (; j < width - 3; j += 4) { \
+        uint64_t v = AV_RN64A(src + j); \
+        AV_WN64A(dst + j, v << shift); \
+    }
+#else
+#define FAST_COPY_UP(shift) \
+    for (; j < width - 1; j += 2) { \
+        uint32_t v = AV_RN32A(src + j); \
+        AV_WN32A(dst + j, v << shift); \
+    }
+#endif
+        switch (shift_high) {
+        case 6: FAST_COPY_UP(6); break;
+        case 7: FAST_COPY_UP(7); break;
+        }
+    }
+    for (; j < width; j++) {
+        unsigned int v = src[j];
+        dst[j] = v << shift_high | v >> shift_low;
+    }
+}
+
 #define DITHER_COPY(dst, dstStride, src, srcStride, bswap, dbswap)\
     uint16_t scale= dither_scale[dst_depth-1][src_depth-1];\
     int shift= src_depth-dst_depth + dither_scale[src_depth-2][dst_depth-1];\
@@ -1274,55 +1427,59 @@ static int planarCopyWrapper(SwsContext *c, const uint8_t *src[],
 
                 if (dst_depth == 8) {
                     if(isBE(c->srcFormat) == HAVE_BIGENDIAN){
-                        DITHER_COPY(dstPtr, dstStride[plane], srcPtr2, srcStride[plane]/2, , )
+                        uint16_t scale= dither_scale[dst_depth-1][src_depth-1];
+                        int shift= src_depth-dst_depth + dither_scale[src_depth-2][dst_depth-1];
+                        for (i = 0; i < height; i++) {
+                            c->ditherU16ToU8Line(dstPtr, srcPtr2, dithers[src_depth-9][i&7],
+                                                 scale, shift, length);
+                            dstPtr  += dstStride[plane];
+                            srcPtr2 += srcStride[plane]/2;
+                        }
                     } else {
                         DITHER_COPY(dstPtr, dstStride[plane], srcPtr2, srcStride[plane]/2, av_bswap16, )
                     }
                 } else if (src_depth == 8) {
-                    for (i = 0; i < height; i++) {
-                        #define COPY816(w)\
-                        if(shiftonly){\
-                            for (j = 0; j < length; j++)\
-                                w(&dstPtr2[j], srcPtr[j]<<(dst_depth-8));\
-                        }else{\
-                            for (j = 0; j < length; j++)\
-                                w(&dstPtr2[j], (srcPtr[j]<<(dst_depth-8)) |\
-                                               (srcPtr[j]>>(2*8-dst_depth)));\
+                    if (isBE(c->dstFormat) == HAVE_BIGENDIAN) {
+                        int shift_low = shiftonly ? 16 : 2*8-dst_depth;
+                        for (i = 0; i < height; i++) {
+                            c->shiftUpU8ToU16Line(dstPtr2, srcPtr, length,
+                                                  dst_depth-8, shift_low);
+                            dstPtr2 += dstStride[plane]/2;
+                            srcPtr  += srcStride[plane];
                         }
-                        if(isBE(c->dstFormat)){
-                            COPY816(AV_WB16)
-                        } else {
-                            COPY816(AV_WL16)
+                    } else {
+                        for (i = 0; i < height; i++) {
+                            #define COPY816(w)\
+                            if(shiftonly){\
+                                for (j = 0; j < length; j++)\
+                                    w(&dstPtr2[j], srcPtr[j]<<(dst_depth-8));\
+                            }else{\
+                                for (j = 0; j < length; j++)\
+                                    w(&dstPtr2[j], (srcPtr[j]<<(dst_depth-8)) |\
+                                                   (srcPtr[j]>>(2*8-dst_depth)));\
+                            }
+                            if(isBE(c->dstFormat)){
+                                COPY816(AV_WB16)
+                            } else {
+                                COPY816(AV_WL16)
+                            }
+                            dstPtr2 += dstStride[plane]/2;
+                            srcPtr  += srcStride[plane];
                         }
+                    }
+                } else if (src_depth <= dst_depth &&
+                           isBE(c->srcFormat) == HAVE_BIGENDIAN &&
+                           isBE(c->dstFormat) == HAVE_BIGENDIAN) {
+                    int shift_low = shiftonly ? 16 : 2*src_depth-dst_depth;
+                    for (i = 0; i < height; i++) {
+                        c->shiftUpU16Line(dstPtr2, srcPtr2, length,
+                                          dst_depth-src_depth, shift_low);
                         dstPtr2 += dstStride[plane]/2;
-                        srcPtr  += srcStride[plane];
+                        srcPtr2 += srcStride[plane]/2;
                     }
                 } else if (src_depth <= dst_depth) {
                     for (i = 0; i < height; i++) {
                         j = 0;
-                        if(isBE(c->srcFormat) == HAVE_BIGENDIAN &&
-                           isBE(c->dstFormat) == HAVE_BIGENDIAN &&
-                           shiftonly) {
-                             unsigned shift = dst_depth - src_depth;
-#if HAVE_FAST_64BIT
-#define FAST_COPY_UP(shift) \
-    for (; j < length - 3; j += 4) { \
-        uint64_t v = AV_RN64A(srcPtr2 + j); \
-        AV_WN64A(dstPtr2 + j, v << shift); \
-    }
-#else
-#define FAST_COPY_UP(shift) \
-    for (; j < length - 1; j += 2) { \
-        uint32_t v = AV_RN32A(srcPtr2 + j); \
-        AV_WN32A(dstPtr2 + j, v << shift); \
-    }
-#endif
-                             switch (shift)
-                             {
-                             case 6: FAST_COPY_UP(6); break;
-                             case 7: FAST_COPY_UP(7); break;
-                             }
-                        }
 #define COPY_UP(r,w) \
     if(shiftonly){\
         for (; j < length; j++){ \
@@ -1355,7 +1512,14 @@ static int planarCopyWrapper(SwsContext *c, const uint8_t *src[],
                 } else {
                     if(isBE(c->srcFormat) == HAVE_BIGENDIAN){
                         if(isBE(c->dstFormat) == HAVE_BIGENDIAN){
-                            DITHER_COPY(dstPtr2, dstStride[plane]/2, srcPtr2, srcStride[plane]/2, , )
+                            uint16_t scale= dither_scale[dst_depth-1][src_depth-1];
+                            int shift= src_depth-dst_depth + dither_scale[src_depth-2][dst_depth-1];
+                            for (i = 0; i < height; i++) {
+                                c->ditherU16ToU16Line(dstPtr2, srcPtr2, dithers[src_depth-9][i&7],
+                                                      scale, shift, length);
+                                dstPtr2 += dstStride[plane]/2;
+                                srcPtr2 += srcStride[plane]/2;
+                            }
                         } else {
                             DITHER_COPY(dstPtr2, dstStride[plane]/2, srcPtr2, srcStride[plane]/2, , av_bswap16)
                         }
@@ -1414,11 +1578,30 @@ void ff_get_unscaled_swscale(SwsContext *c)
             c->dstFormatBpp < 24 &&
            (c->dstFormatBpp < c->srcFormatBpp || (!isAnyRGB(srcFormat)));
 
+    c->gbr24pToPacked24Line = ff_gbr24p_to_packed24_c;
+    c->gbr24pToPacked32Line = ff_gbr24p_to_packed32_c;
+    c->packed24ToGbr24pLine = ff_packed24_to_gbr24p_c;
+    c->packed32ToGbr24pLine = ff_packed32_to_gbr24p_c;
+    c->packed16ToGbra16Line = ff_packed16_to_gbra16_c;
+    c->gbr16pToPacked16Line = ff_gbr16p_to_packed16_c;
+    c->ditherU16ToU8Line    = ff_dither_u16_to_u8_c;
+    c->ditherU16ToU16Line   = ff_dither_u16_to_u16_c;
+    c->shiftUpU8ToU16Line   = ff_shift_up_u8_to_u16_c;
+    c->shiftUpU16Line       = ff_shift_up_u16_c;
+
     /* yv12_to_nv12 */
     if ((srcFormat == AV_PIX_FMT_YUV420P || srcFormat == AV_PIX_FMT_YUVA420P) &&
         (dstFormat == AV_PIX_FMT_NV12 || dstFormat == AV_PIX_FMT_NV21)) {
         c->swscale = planarToNv12Wrapper;
     }
+    /* yuv420p9..16 to nv12, dithered */
+    if ((isNBPS(srcFormat) || is16BPS(srcFormat)) && isPlanarYUV(srcFormat) &&
+        isBE(srcFormat) == HAVE_BIGENDIAN &&
+        av_pix_fmt_desc_get(srcFormat)->log2_chroma_w == 1 &&
+        av_pix_fmt_desc_get(srcFormat)->log2_chroma_h == 1 &&
+        (dstFormat == AV_PIX_FMT_NV12 || dstFormat == AV_PIX_FMT_NV21)) {
+        c->swscale = planarHighToNv12Wrapper;
+    }
     /* nv12_to_yv12 */
     if (dstFormat == AV_PIX_FMT_YUV420P &&
         (srcFormat == AV_PIX_FMT_NV12 || srcFormat == AV_PIX_FMT_NV21)) {
@@ -1582,6 +1765,8 @@ void ff_get_unscaled_swscale(SwsContext *c)
         ff_get_unscaled_swscale_bfin(c);
     if (ARCH_PPC)
         ff_get_unscaled_swscale_ppc(c);
+    if (ARCH_X86)
+        ff_get_unscaled_swscale_x86(c);
 //     if (ARCH_ARM)
 //         ff_get_unscaled_swscale_arm(c);
 
@@ -298,8 +298,8 @@ static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
 
     emms_c(); // FIXME should not be required but IS (even for non-MMX versions)
 
-    // NOTE: the +3 is for the MMX(+1) / SSE(+3) scaler which reads over the end
-    FF_ALLOC_OR_GOTO(NULL, *filterPos, (dstW + 3) * sizeof(**filterPos), fail);
+    // NOTE: the +7 is for the MMX(+1) / SSE(+3) / AVX2(+7) scaler which reads over the end
+    FF_ALLOC_OR_GOTO(NULL, *filterPos, (dstW + 7) * sizeof(**filterPos), fail);
 
     if (FFABS(xInc - 0x10000) < 10 && srcPos == dstPos) { // unscaled
         int i;
@@ -620,7 +620,7 @@ static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
     // Note the +1 is for the MMX scaler which reads over the end
     /* align at 16 for AltiVec (needed by hScale_altivec_real) */
     FF_ALLOCZ_OR_GOTO(NULL, *outFilter,
-                      *outFilterSize * (dstW + 3) * sizeof(int16_t), fail);
+                      *outFilterSize * (dstW + 7) * sizeof(int16_t), fail);
 
     /* normalize & store in outFilter */
     for (i = 0; i < dstW; i++) {
@@ -644,15 +644,13 @@ static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
         }
     }
 
-    (*filterPos)[dstW + 0] =
-    (*filterPos)[dstW + 1] =
-    (*filterPos)[dstW + 2] = (*filterPos)[dstW - 1]; /* the MMX/SSE scaler will
-                                                      * read over the end */
-    for (i = 0; i < *outFilterSize; i++) {
-        int k = (dstW - 1) * (*outFilterSize) + i;
-        (*outFilter)[k + 1 * (*outFilterSize)] =
-        (*outFilter)[k + 2 * (*outFilterSize)] =
-        (*outFilter)[k + 3 * (*outFilterSize)] = (*outFilter)[k];
+    /* the MMX/SSE/AVX2 scalers will read over the end */
+    for (i = dstW; i < dstW + 7; i++) {
+        int j;
+        (*filterPos)[i] = (*filterPos)[dstW - 1];
+        for (j = 0; j < *outFilterSize; j++)
+            (*outFilter)[i * (*outFilterSize) + j] =
+                (*outFilter)[(dstW - 1) * (*outFilterSize) + j];
     }
 
     ret = 0;
@@ -1382,7 +1380,21 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
 #define USE_MMAP (HAVE_MMAP && HAVE_MPROTECT && defined MAP_ANONYMOUS)
 
     /* precalculate horizontal scaler filter coefficients */
-    {
+    if (c->filter_src) {
+        const SwsContext *src = c->filter_src;
+        c->hLumFilter     = src->hLumFilter;
+        c->hChrFilter     = src->hChrFilter;
+        c->hLumFilterPos  = src->hLumFilterPos;
+        c->hChrFilterPos  = src->hChrFilterPos;
+        c->hLumFilterSize = src->hLumFilterSize;
+        c->hChrFilterSize = src->hChrFilterSize;
+#if HAVE_MMXEXT_INLINE
+        c->lumMmxextFilterCode     = src->lumMmxextFilterCode;
+        c->chrMmxextFilterCode     = src->chrMmxextFilterCode;
+        c->lumMmxextFilterCodeSize = src->lumMmxextFilterCodeSize;
+        c->chrMmxextFilterCodeSize = src->chrMmxextFilterCodeSize;
+#endif
+    } else {
 #if HAVE_MMXEXT_INLINE
 // can't downscale !!!
         if (c->canMMXEXTBeUsed && (flags & SWS_FAST_BILINEAR)) {
@@ -1469,7 +1481,19 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     } // initialize horizontal stuff
 
     /* precalculate vertical scaler filter coefficients */
-    {
+    if (c->filter_src) {
+        const SwsContext *src = c->filter_src;
+        c->vLumFilter     = src->vLumFilter;
+        c->vChrFilter     = src->vChrFilter;
+        c->vLumFilterPos  = src->vLumFilterPos;
+        c->vChrFilterPos  = src->vChrFilterPos;
+        c->vLumFilterSize = src->vLumFilterSize;
+        c->vChrFilterSize = src->vChrFilterSize;
+#if HAVE_ALTIVEC
+        c->vYCoeffsBank   = src->vYCoeffsBank;
+        c->vCCoeffsBank   = src->vCCoeffsBank;
+#endif
+    } else {
         const int filterAlign = X86_MMX(cpu_flags)     ? 2 :
                                 PPC_ALTIVEC(cpu_flags) ? 8 : 1;
 
@@ -2005,6 +2029,20 @@ void sws_freeContext(SwsContext *c)
     for (i = 0; i < 4; i++)
         av_freep(&c->dither_error[i]);
 
+    if (c->filter_src) {
+        /* the filter tables belong to filter_src */
+        c->vLumFilter    = c->vChrFilter    = NULL;
+        c->hLumFilter    = c->hChrFilter    = NULL;
+        c->vLumFilterPos = c->vChrFilterPos = NULL;
+        c->hLumFilterPos = c->hChrFilterPos = NULL;
+#if HAVE_ALTIVEC
+        c->vYCoeffsBank  = c->vCCoeffsBank  = NULL;
+#endif
+#if HAVE_MMX_INLINE
+        c->lumMmxextFilterCode = c->chrMmxextFilterCode = NULL;
+#endif
+    }
+
     av_freep(&c->vLumFilter);
     av_freep(&c->vChrFilter);
     av_freep(&c->hLumFilter);
@@ -22,20 +22,20 @@
 
 %include "libavutil/x86/x86util.asm"
 
-SECTION_RODATA
-
-minshort:      times 8 dw 0x8000
-yuv2yuvX_16_start:  times 4 dd 0x4000 - 0x40000000
-yuv2yuvX_10_start:  times 4 dd 0x10000
-yuv2yuvX_9_start:   times 4 dd 0x20000
-yuv2yuvX_10_upper:  times 8 dw 0x3ff
-yuv2yuvX_9_upper:   times 8 dw 0x1ff
-pd_4:          times 4 dd 4
-pd_4min0x40000:times 4 dd 4 - (0x40000)
-pw_16:         times 8 dw 16
-pw_32:         times 8 dw 32
-pw_512:        times 8 dw 512
-pw_1024:       times 8 dw 1024
+SECTION_RODATA 32
+
+minshort:      times 16 dw 0x8000
+yuv2yuvX_16_start:  times 8 dd 0x4000 - 0x40000000
+yuv2yuvX_10_start:  times 8 dd 0x10000
+yuv2yuvX_9_start:   times 8 dd 0x20000
+yuv2yuvX_10_upper:  times 16 dw 0x3ff
+yuv2yuvX_9_upper:   times 16 dw 0x1ff
+pd_4:          times 8 dd 4
+pd_4min0x40000:times 8 dd 4 - (0x40000)
+pw_16:         times 16 dw 16
+pw_32:         times 16 dw 32
+pw_512:        times 16 dw 512
+pw_1024:       times 16 dw 1024
 
 SECTION .text
 
@@ -65,6 +65,12 @@ SECTION .text
 %define movsx movsxd
 %endif
 
+%if mmsize == 32 ; the intermediate buffers are only 16-byte aligned
+%define movx movu
+%else
+%define movx mova
+%endif
+
 cglobal yuv2planeX_%1, %3, 8, %2, filter, fltsize, src, dst, w, dither, offset
 %if %1 == 8 || %1 == 9 || %1 == 10
     pxor            m6,  m6
@@ -154,26 +160,39 @@ cglobal yuv2planeX_%1, %3, 8, %2, filter, fltsize, src, dst, w, dither, offset
     ; input pixels
     mov             r6, [srcq+gprsize*cntr_reg-2*gprsize]
 %if %1 == 16
-    mova            m3, [r6+r5*4]
-    mova            m5, [r6+r5*4+mmsize]
+    movx            m3, [r6+r5*4]
+    movx            m5, [r6+r5*4+mmsize]
 %else ; %1 == 8/9/10
-    mova            m3, [r6+r5*2]
+    movx            m3, [r6+r5*2]
 %endif ; %1 == 8/9/10/16
     mov             r6, [srcq+gprsize*cntr_reg-gprsize]
 %if %1 == 16
-    mova            m4, [r6+r5*4]
-    mova            m6, [r6+r5*4+mmsize]
+    movx            m4, [r6+r5*4]
+    movx            m6, [r6+r5*4+mmsize]
 %else ; %1 == 8/9/10
-    mova            m4, [r6+r5*2]
+    movx            m4, [r6+r5*2]
 %endif ; %1 == 8/9/10/16
 
     ; coefficients
+%if mmsize == 32
+%if %1 == 16
+    vpbroadcastw   xm7, [filterq+2*cntr_reg-4] ; coeff[0]
+    vpbroadcastw   xm0, [filterq+2*cntr_reg-2] ; coeff[1]
+    pmovsxwd        m7, xm7              ; word -> dword
+    pmovsxwd        m0, xm0              ; word -> dword
+%else ; %1 == 9/10
+    vpbroadcastd    m0, [filterq+2*cntr_reg-4] ; coeff[0], coeff[1]
+%endif ; %1 == 9/10/16
+%else ; mmsize == 8/16
     movd            m0, [filterq+2*cntr_reg-4] ; coeff[0], coeff[1]
+%endif ; mmsize == 8/16/32
 %if %1 == 16
+%if mmsize != 32
     pshuflw         m7,  m0,  0          ; coeff[0]
     pshuflw         m0,  m0,  0x55       ; coeff[1]
     pmovsxwd        m7,  m7              ; word -> dword
     pmovsxwd        m0,  m0              ; word -> dword
+%endif ; mmsize != 32
 
     pmulld          m3,  m7
     pmulld          m5,  m7
@@ -187,7 +206,9 @@ cglobal yuv2planeX_%1, %3, 8, %2, filter, fltsize, src, dst, w, dither, offset
 %else ; %1 == 10/9/8
     punpcklwd       m5,  m3,  m4
     punpckhwd       m3,  m4
+%if mmsize != 32
     SPLATD          m0
+%endif ; mmsize != 32
 
     pmaddwd         m5,  m0
     pmaddwd         m3,  m0
@@ -214,6 +235,9 @@ cglobal yuv2planeX_%1, %3, 8, %2, filter, fltsize, src, dst, w, dither, offset
 %else ; %1 == 9/10/16
 %if %1 == 16
     packssdw        m2,  m1
+%if mmsize == 32
+    vpermq          m2,  m2,  q3120
+%endif ; mmsize == 32
     paddw           m2, [minshort]
 %else ; %1 == 9/10
 %if cpuflag(sse4)
@@ -224,7 +248,7 @@ cglobal yuv2planeX_%1, %3, 8, %2, filter, fltsize, src, dst, w, dither, offset
 %endif ; mmxext/sse2/sse4/avx
     pminsw          m2, [yuv2yuvX_%1_upper]
 %endif ; %1 == 9/10/16
-    mova   [dstq+r5*2],  m2
+    movx   [dstq+r5*2],  m2
 %endif ; %1 == 8/9/10/16
 
     add             r5,  mmsize/2
@@ -271,6 +295,13 @@ yuv2planeX_fn  9,  7, 5
 yuv2planeX_fn 10,  7, 5
 %endif
 
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+yuv2planeX_fn  9,  7, 5
+yuv2planeX_fn 10,  7, 5
+yuv2planeX_fn 16,  8, 5
+%endif
+
 ; %1=outout-bpc, %2=alignment (u/a)
 %macro yuv2plane1_mainloop 2
 .loop_%2:
@@ -280,7 +311,25 @@ yuv2planeX_fn 10,  7, 5
     psraw           m0, 7
     psraw           m1, 7
     packuswb        m0, m1
+%if mmsize == 32
+    vpermq          m0, m0, q3120
+%endif ; mmsize == 32
     mov%2    [dstq+wq], m0
+%elif mmsize == 32 ; 9/10/16, one register of output per iteration
+%if %1 == 16
+    paddd           m0, m4, [srcq+wq*4+mmsize*0]
+    paddd           m1, m4, [srcq+wq*4+mmsize*1]
+    psrad           m0, 3
+    psrad           m1, 3
+    packusdw        m0, m1
+    vpermq          m0, m0, q3120
+%else ; %1 == 9/10
+    paddsw          m0, m2, [srcq+wq*2]
+    psraw           m0, 15 - %1
+    pmaxsw          m0, m4
+    pminsw          m0, m3
+%endif ; %1 == 9/10/16
+    mov%2  [dstq+wq*2], m0
 %elif %1 == 16
     paddd           m0, m4, [srcq+wq*4+mmsize*0]
     paddd           m1, m4, [srcq+wq*4+mmsize*1]
@@ -313,15 +362,22 @@ yuv2planeX_fn 10,  7, 5
     mov%2    [dstq+wq*2+mmsize*0], m0
     mov%2    [dstq+wq*2+mmsize*1], m1
 %endif
-    add             wq, mmsize
+    add             wq, pixstep
     jl .loop_%2
 %endmacro
 
 %macro yuv2plane1_fn 3
+; keep the overwrite past the end of the line within 32 bytes
+%if mmsize == 32 && %1 != 8
+%define pixstep mmsize/2
+%else
+%define pixstep mmsize
+%endif
+
 cglobal yuv2plane1_%1, %3, %3, %2, src, dst, w, dither, offset
     movsxdifnidn    wq, wd
-    add             wq, mmsize - 1
-    and             wq, ~(mmsize - 1)
+    add             wq, pixstep - 1
+    and             wq, ~(pixstep - 1)
 %if %1 == 8
     add           dstq, wq
 %else ; %1 != 8
@@ -338,15 +394,19 @@ cglobal yuv2plane1_%1, %3, %3, %2, src, dst, w, dither, offset
     pxor            m4, m4               ; zero
 
     ; create registers holding dither
-    movq            m3, [ditherq]        ; dither
+    movq           xm3, [ditherq]        ; dither
     test       offsetd, offsetd
     jz              .no_rot
-%if mmsize == 16
-    punpcklqdq      m3, m3
-%endif ; mmsize == 16
-    PALIGNR         m3, m3, 3, m2
+%if mmsize >= 16
+    punpcklqdq     xm3, xm3
+%endif ; mmsize >= 16
+    PALIGNR        xm3, xm3, 3, xm2
 .no_rot:
-%if mmsize == 8
+%if mmsize == 32
+    punpcklqdq     xm3, xm3
+    pmovzxbw        m3, xm3
+    mova            m2, m3
+%elif mmsize == 8
     mova            m2, m3
     punpckhbw       m3, m4               ; byte->word
     punpcklbw       m2, m4               ; byte->word
@@ -374,6 +434,8 @@ cglobal yuv2plane1_%1, %3, %3, %2, src, dst, w, dither, offset
     ; actual pixel scaling
 %if mmsize == 8
     yuv2plane1_mainloop %1, a
+%elif mmsize == 32
+    yuv2plane1_mainloop %1, u
 %else ; mmsize == 16
     test          dstq, 15
     jnz .unaligned
@@ -381,7 +443,7 @@ cglobal yuv2plane1_%1, %3, %3, %2, src, dst, w, dither, offset
     REP_RET
 .unaligned:
     yuv2plane1_mainloop %1, u
-%endif ; mmsize == 8/16
+%endif ; mmsize == 8/16/32
     REP_RET
 %endmacro
 
@@ -411,3 +473,11 @@ yuv2plane1_fn  9, 5, 3
 yuv2plane1_fn 10, 5, 3
 yuv2plane1_fn 16, 5, 3
 %endif
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+yuv2plane1_fn  8, 5, 5
+yuv2plane1_fn  9, 5, 3
+yuv2plane1_fn 10, 5, 3
+yuv2plane1_fn 16, 5, 3
+%endif
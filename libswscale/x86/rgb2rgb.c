@@ -141,11 +141,154 @@ DECLARE_ASM_CONST(8, uint64_t, mul16_mid)    = 0x2080208020802080ULL;
 
 #endif /* HAVE_INLINE_ASM */
 
+#if HAVE_YASM
+
+static void interleave_bytes_tail(uint8_t *dest, const uint8_t *src1,
+                                  const uint8_t *src2, int x, int width)
+{
+    for (; x < width; x++) {
+        dest[2 * x + 0] = src1[x];
+        dest[2 * x + 1] = src2[x];
+    }
+}
+
+static void deinterleave_bytes_tail(const uint8_t *src, uint8_t *dst1,
+                                    uint8_t *dst2, int x, int width)
+{
+    for (; x < width; x++) {
+        dst1[x] = src[2 * x + 0];
+        dst2[x] = src[2 * x + 1];
+    }
+}
+
+/* y/u/v are the offsets of the components in a macropixel of the lines src
+ * and src2, whose luma goes to ydst and ydst2 if not NULL. The chroma is the
+ * rounded average of both lines, src2 is src for 4:2:2. */
+static void packed422_tail(uint8_t *ydst, uint8_t *ydst2, uint8_t *udst,
+                           uint8_t *vdst, const uint8_t *src,
+                           const uint8_t *src2, int x, int width,
+                           int y, int u, int v)
+{
+    int i;
+
+    for (i = x; i < width; i++) {
+        ydst[i] = src[2 * i + y];
+        if (ydst2)
+            ydst2[i] = src2[2 * i + y];
+    }
+    for (i = x / 2; i < FF_CEIL_RSHIFT(width, 1); i++) {
+        udst[i] = (src[4 * i + u] + src2[4 * i + u] + 1) >> 1;
+        vdst[i] = (src[4 * i + v] + src2[4 * i + v] + 1) >> 1;
+    }
+}
+
+#define INTERLEAVE_FUNCS(opt, step)                                           \
+void ff_interleave_bytes_ ## opt(uint8_t *dst, const uint8_t *src1,           \
+                                 const uint8_t *src2, int w);                 \
+void ff_deinterleave_bytes_ ## opt(uint8_t *dst1, uint8_t *dst2,              \
+                                   const uint8_t *src, int w);                \
+                                                                              \
+static void interleave_bytes_ ## opt(const uint8_t *src1, const uint8_t *src2, \
+                                     uint8_t *dest, int width, int height,    \
+                                     int src1Stride, int src2Stride,          \
+                                     int dstStride)                           \
+{                                                                             \
+    int h;                                                                    \
+                                                                              \
+    for (h = 0; h < height; h++) {                                            \
+        FF_SIMD_WITH_C_TAIL(width, step,                                      \
+            ff_interleave_bytes_ ## opt(dest, src1, src2, x),                 \
+            interleave_bytes_tail(dest, src1, src2, x, width));               \
+        dest += dstStride;                                                    \
+        src1 += src1Stride;                                                   \
+        src2 += src2Stride;                                                   \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static void deinterleave_bytes_ ## opt(const uint8_t *src, uint8_t *dst1,     \
+                                       uint8_t *dst2, int width, int height,  \
+                                       int srcStride, int dst1Stride,         \
+                                       int dst2Stride)                        \
+{                                                                             \
+    int h;                                                                    \
+                                                                              \
+    for (h = 0; h < height; h++) {                                            \
+        FF_SIMD_WITH_C_TAIL(width, step,                                      \
+            ff_deinterleave_bytes_ ## opt(dst1, dst2, src, x),                \
+            deinterleave_bytes_tail(src, dst1, dst2, x, width));              \
+        src  += srcStride;                                                    \
+        dst1 += dst1Stride;                                                   \
+        dst2 += dst2Stride;                                                   \
+    }                                                                         \
+}
+
+/* fmt is uyvy or yuyv, y/u/v are the offsets of the components in a
+ * macropixel. As in the MMX version, the 4:2:0 chroma is the rounded
+ * average of both lines. */
+#define PACKED422_FUNCS(fmt, opt, step, y, u, v)                              \
+void ff_ ## fmt ## toyuv422_ ## opt(uint8_t *ydst, uint8_t *udst,             \
+                                    uint8_t *vdst, const uint8_t *src, int w); \
+void ff_ ## fmt ## toyuv420_ ## opt(uint8_t *ydst, uint8_t *udst,             \
+                                    uint8_t *vdst, const uint8_t *src,        \
+                                    int lumStride, int srcStride, int w);     \
+                                                                              \
+static void fmt ## toyuv422_ ## opt(uint8_t *ydst, uint8_t *udst,             \
+                                    uint8_t *vdst, const uint8_t *src,        \
+                                    int width, int height, int lumStride,     \
+                                    int chromStride, int srcStride)           \
+{                                                                             \
+    int h;                                                                    \
+                                                                              \
+    for (h = 0; h < height; h++) {                                            \
+        FF_SIMD_WITH_C_TAIL(width, step,                                      \
+            ff_ ## fmt ## toyuv422_ ## opt(ydst, udst, vdst, src, x),         \
+            packed422_tail(ydst, NULL, udst, vdst, src, src, x, width,        \
+                           y, u, v));                                         \
+        src  += srcStride;                                                    \
+        ydst += lumStride;                                                    \
+        udst += chromStride;                                                  \
+        vdst += chromStride;                                                  \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static void fmt ## toyuv420_ ## opt(uint8_t *ydst, uint8_t *udst,             \
+                                    uint8_t *vdst, const uint8_t *src,        \
+                                    int width, int height, int lumStride,     \
+                                    int chromStride, int srcStride)           \
+{                                                                             \
+    int h, x;                                                                 \
+                                                                              \
+    for (h = 0; h < height - 1; h += 2) {                                     \
+        const uint8_t *src2 = src + srcStride;                                \
+        FF_SIMD_WITH_C_TAIL(width, step,                                      \
+            ff_ ## fmt ## toyuv420_ ## opt(ydst, udst, vdst, src,             \
+                                           lumStride, srcStride, x),          \
+            packed422_tail(ydst, ydst + lumStride, udst, vdst, src, src2,     \
+                           x, width, y, u, v));                               \
+        src  += 2 * srcStride;                                                \
+        ydst += 2 * lumStride;                                                \
+        udst += chromStride;                                                  \
+        vdst += chromStride;                                                  \
+    }                                                                         \
+    if (height & 1)                                                           \
+        for (x = 0; x < width; x++)                                           \
+            ydst[x] = src[2 * x + y];                                         \
+}
+
+INTERLEAVE_FUNCS(sse2, 16)
+INTERLEAVE_FUNCS(avx2, 32)
+PACKED422_FUNCS(uyvy, sse2, 16, 1, 0, 2)
+PACKED422_FUNCS(uyvy, avx2, 32, 1, 0, 2)
+PACKED422_FUNCS(yuyv, sse2, 16, 0, 1, 3)
+PACKED422_FUNCS(yuyv, avx2, 32, 0, 1, 3)
+
+#endif /* HAVE_YASM */
+
 av_cold void rgb2rgb_init_x86(void)
 {
-#if HAVE_INLINE_ASM
     int cpu_flags = av_get_cpu_flags();
 
+#if HAVE_INLINE_ASM
     if (INLINE_MMX(cpu_flags))
         rgb2rgb_init_mmx();
     if (INLINE_AMD3DNOW(cpu_flags))
@@ -157,4 +300,23 @@ av_cold void rgb2rgb_init_x86(void)
     if (INLINE_AVX(cpu_flags))
         rgb2rgb_init_avx();
 #endif /* HAVE_INLINE_ASM */
+
+#if HAVE_YASM
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        interleaveBytes   = interleave_bytes_sse2;
+        deinterleaveBytes = deinterleave_bytes_sse2;
+        uyvytoyuv420      = uyvytoyuv420_sse2;
+        uyvytoyuv422      = uyvytoyuv422_sse2;
+        yuyvtoyuv420      = yuyvtoyuv420_sse2;
+        yuyvtoyuv422      = yuyvtoyuv422_sse2;
+    }
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        interleaveBytes   = interleave_bytes_avx2;
+        deinterleaveBytes = deinterleave_bytes_avx2;
+        uyvytoyuv420      = uyvytoyuv420_avx2;
+        uyvytoyuv422      = uyvytoyuv422_avx2;
+        yuyvtoyuv420      = yuyvtoyuv420_avx2;
+        yuyvtoyuv422      = yuyvtoyuv422_avx2;
+    }
+#endif /* HAVE_YASM */
 }
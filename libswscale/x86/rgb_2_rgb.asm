@@ -0,0 +1,778 @@
+;******************************************************************************
+;* x86-optimized line kernels for the unscaled converters
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pw_00ff:       times 16 dw 0x00ff
+pw_8000:       times 16 dw 0x8000
+pd_8000:       times  8 dd 0x8000
+pd_permd:      dd 0, 4, 1, 5, 2, 6, 3, 7
+
+; group the bytes of four 32-bit pixels by component
+shuf_from32:   times 2 db 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15
+shuf_from32a:  times 2 db 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15, 0, 4, 8, 12
+
+; shuf_to24_KC picks component C of packed output register K
+shuf_to24_00:  db  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1,  5
+shuf_to24_01:  db -1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1
+shuf_to24_02:  db -1, -1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1
+shuf_to24_10:  db -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10, -1
+shuf_to24_11:  db  5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10
+shuf_to24_12:  db -1,  5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1
+shuf_to24_20:  db -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1
+shuf_to24_21:  db -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1
+shuf_to24_22:  db 10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15
+
+; shuf_from24_CK picks the bytes of component C from packed input register K
+shuf_from24_00: db  0,  3,  6,  9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+shuf_from24_01: db -1, -1, -1, -1, -1, -1,  2,  5,  8, 11, 14, -1, -1, -1, -1, -1
+shuf_from24_02: db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  1,  4,  7, 10, 13
+shuf_from24_10: db  1,  4,  7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+shuf_from24_11: db -1, -1, -1, -1, -1,  0,  3,  6,  9, 12, 15, -1, -1, -1, -1, -1
+shuf_from24_12: db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  2,  5,  8, 11, 14
+shuf_from24_20: db  2,  5,  8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+shuf_from24_21: db -1, -1, -1, -1, -1,  1,  4,  7, 10, 13, -1, -1, -1, -1, -1, -1
+shuf_from24_22: db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  3,  6,  9, 12, 15
+
+; the same for 16-bit components
+shuf_to48_00:  db  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1,  4,  5, -1, -1
+shuf_to48_01:  db -1, -1,  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1,  4,  5
+shuf_to48_02:  db -1, -1, -1, -1,  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1
+shuf_to48_10:  db -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1, -1, -1, 10, 11
+shuf_to48_11:  db -1, -1, -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1, -1, -1
+shuf_to48_12:  db  4,  5, -1, -1, -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1
+shuf_to48_20:  db -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1, -1, -1
+shuf_to48_21:  db 10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1
+shuf_to48_22:  db -1, -1, 10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15
+
+shuf_from48_00: db  0,  1,  6,  7, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+shuf_from48_01: db -1, -1, -1, -1, -1, -1,  2,  3,  8,  9, 14, 15, -1, -1, -1, -1
+shuf_from48_02: db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  4,  5, 10, 11
+shuf_from48_10: db  2,  3,  8,  9, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+shuf_from48_11: db -1, -1, -1, -1, -1, -1,  4,  5, 10, 11, -1, -1, -1, -1, -1, -1
+shuf_from48_12: db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  1,  6,  7, 12, 13
+shuf_from48_20: db  4,  5, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+shuf_from48_21: db -1, -1, -1, -1,  0,  1,  6,  7, 12, 13, -1, -1, -1, -1, -1, -1
+shuf_from48_22: db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  2,  3,  8,  9, 14, 15
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; void ff_interleave_bytes_<opt>(uint8_t *dst, const uint8_t *src1,
+;                                const uint8_t *src2, int w)
+;
+; All the line kernels in this file handle a multiple of mmsize pixels
+; (16 for the 16-bit ones on xmm), the callers take care of the rest.
+;-----------------------------------------------------------------------------
+
+%macro INTERLEAVE_BYTES 0
+cglobal interleave_bytes, 4, 4, 3, dst, src1, src2, w
+    movsxdifnidn    wq, wd
+    add          src1q, wq
+    add          src2q, wq
+    lea           dstq, [dstq+wq*2]
+    neg             wq
+.loop:
+    movu            m0, [src1q+wq]
+    movu            m1, [src2q+wq]
+    punpckhbw       m2, m0, m1
+    punpcklbw       m0, m1
+%if mmsize == 32
+    vperm2i128      m1, m0, m2, 0x20
+    vperm2i128      m0, m0, m2, 0x31
+    movu [dstq+wq*2       ], m1
+    movu [dstq+wq*2+mmsize], m0
+%else
+    movu [dstq+wq*2       ], m0
+    movu [dstq+wq*2+mmsize], m2
+%endif
+    add             wq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_deinterleave_bytes_<opt>(uint8_t *dst1, uint8_t *dst2,
+;                                  const uint8_t *src, int w)
+;-----------------------------------------------------------------------------
+
+%macro DEINTERLEAVE_BYTES 0
+cglobal deinterleave_bytes, 4, 4, 5, dst1, dst2, src, w
+    movsxdifnidn    wq, wd
+    add          dst1q, wq
+    add          dst2q, wq
+    lea           srcq, [srcq+wq*2]
+    neg             wq
+    mova            m4, [pw_00ff]
+.loop:
+    movu            m0, [srcq+wq*2       ]
+    movu            m1, [srcq+wq*2+mmsize]
+    psrlw           m2, m0, 8
+    psrlw           m3, m1, 8
+    pand            m0, m4
+    pand            m1, m4
+    packuswb        m0, m1
+    packuswb        m2, m3
+%if mmsize == 32
+    vpermq          m0, m0, q3120
+    vpermq          m2, m2, q3120
+%endif
+    movu   [dst1q+wq], m0
+    movu   [dst2q+wq], m2
+    add             wq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_<fmt>toyuv422_<opt>(uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
+;                             const uint8_t *src, int w)
+; void ff_<fmt>toyuv420_<opt>(uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
+;                             const uint8_t *src, int lumStride,
+;                             int srcStride, int w)
+;
+; The 4:2:0 version converts two lines, the chroma being the rounded average
+; of both, as in the MMX version.
+;-----------------------------------------------------------------------------
+
+; EXTRACT_LUMA dst, src0, src1, tmp, luma in the odd bytes
+%macro EXTRACT_LUMA 5
+%if %5
+    psrlw           %1, %2, 8
+    psrlw           %4, %3, 8
+%else
+    pand            %1, %2, m7
+    pand            %4, %3, m7
+%endif
+    packuswb        %1, %4
+%if mmsize == 32
+    vpermq          %1, %1, q3120
+%endif
+%endmacro
+
+; EXTRACT_CHROMA src0, src1, tmp, luma in the odd bytes
+; leaves the U samples in the low and the V samples in the high half of src0
+%macro EXTRACT_CHROMA 4
+%if %4
+    pand            %1, m7
+    pand            %2, m7
+%else
+    psrlw           %1, 8
+    psrlw           %2, 8
+%endif
+    packuswb        %1, %2
+%if mmsize == 32
+    vpermq          %1, %1, q3120
+%endif
+    psrlw           %3, %1, 8
+    pand            %1, m7
+    packuswb        %1, %3
+%if mmsize == 32
+    vpermq          %1, %1, q3120
+%endif
+%endmacro
+
+%macro STORE_CHROMA 0
+%if mmsize == 32
+    movu   [udstq+wq], xm0
+    vextracti128 [vdstq+wq], m0, 1
+%else
+    movq   [udstq+wq], m0
+    movhps [vdstq+wq], m0
+%endif
+%endmacro
+
+; PACKED422_TO_PLANAR fmt, luma in the odd bytes
+%macro PACKED422_TO_PLANAR 2
+cglobal %1toyuv422, 5, 5, 8, ydst, udst, vdst, src, w
+    shr             wd, 1
+    movsxdifnidn    wq, wd
+    add          udstq, wq
+    add          vdstq, wq
+    lea          ydstq, [ydstq+wq*2]
+    lea           srcq, [srcq+wq*4]
+    neg             wq
+    mova            m7, [pw_00ff]
+.loop:
+    movu            m0, [srcq+wq*4       ]
+    movu            m1, [srcq+wq*4+mmsize]
+    EXTRACT_LUMA    m2, m0, m1, m3, %2
+    movu [ydstq+wq*2], m2
+    EXTRACT_CHROMA  m0, m1, m3, %2
+    STORE_CHROMA
+    add             wq, mmsize/2
+    jl .loop
+    RET
+
+cglobal %1toyuv420, 7, 7, 8, ydst, udst, vdst, src, ydst2, src2, w
+    movsxdifnidn ydst2q, ydst2d
+    movsxdifnidn  src2q, src2d
+    add         ydst2q, ydstq
+    add          src2q, srcq
+    shr             wd, 1
+    add          udstq, wq
+    add          vdstq, wq
+    lea          ydstq, [ydstq+wq*2]
+    lea         ydst2q, [ydst2q+wq*2]
+    lea           srcq, [srcq+wq*4]
+    lea          src2q, [src2q+wq*4]
+    neg             wq
+    mova            m7, [pw_00ff]
+.loop:
+    movu            m0, [srcq+wq*4        ]
+    movu            m1, [srcq+wq*4+mmsize ]
+    movu            m2, [src2q+wq*4       ]
+    movu            m3, [src2q+wq*4+mmsize]
+    EXTRACT_LUMA    m4, m0, m1, m5, %2
+    movu  [ydstq+wq*2], m4
+    EXTRACT_LUMA    m4, m2, m3, m5, %2
+    movu [ydst2q+wq*2], m4
+    pavgb           m0, m2
+    pavgb           m1, m3
+    EXTRACT_CHROMA  m0, m1, m3, %2
+    STORE_CHROMA
+    add             wq, mmsize/2
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_gbr24p_to_packed32_<opt>(uint8_t *dst, const uint8_t *src0,
+;                                  const uint8_t *src1, const uint8_t *src2,
+;                                  int w, int alpha_first)
+;
+; Writes src0, src1, src2 and 0xff in this order, or 0xff first if
+; alpha_first is set.
+;-----------------------------------------------------------------------------
+
+; PACK32 byte0, byte1, byte2, byte3
+%macro PACK32 4
+    punpcklbw       m4, %1, %2
+    punpckhbw       m5, %1, %2
+    punpcklbw       m6, %3, %4
+    punpckhbw       m7, %3, %4
+    punpcklwd       m0, m4, m6
+    punpckhwd       m4, m6
+    punpcklwd       m1, m5, m7
+    punpckhwd       m5, m7
+%if mmsize == 32
+    vperm2i128      m2, m0, m4, 0x20
+    vperm2i128      m0, m0, m4, 0x31
+    vperm2i128      m4, m1, m5, 0x20
+    vperm2i128      m1, m1, m5, 0x31
+    movu [dstq+wq*4+mmsize*0], m2
+    movu [dstq+wq*4+mmsize*1], m4
+    movu [dstq+wq*4+mmsize*2], m0
+    movu [dstq+wq*4+mmsize*3], m1
+%else
+    movu [dstq+wq*4+mmsize*0], m0
+    movu [dstq+wq*4+mmsize*1], m4
+    movu [dstq+wq*4+mmsize*2], m1
+    movu [dstq+wq*4+mmsize*3], m5
+%endif
+%endmacro
+
+%macro GBR24P_TO_PACKED32 0
+cglobal gbr24p_to_packed32, 5, 6, 8, dst, src0, src1, src2, w, alpha_first
+    movsxdifnidn    wq, wd
+    add          src0q, wq
+    add          src1q, wq
+    add          src2q, wq
+    lea           dstq, [dstq+wq*4]
+    neg             wq
+    pcmpeqb         m3, m3
+    test  alpha_firstd, alpha_firstd
+    jnz .alpha_first
+.loop:
+    movu            m0, [src0q+wq]
+    movu            m1, [src1q+wq]
+    movu            m2, [src2q+wq]
+    PACK32          m0, m1, m2, m3
+    add             wq, mmsize
+    jl .loop
+    RET
+.alpha_first:
+    movu            m0, [src0q+wq]
+    movu            m1, [src1q+wq]
+    movu            m2, [src2q+wq]
+    PACK32          m3, m0, m1, m2
+    add             wq, mmsize
+    jl .alpha_first
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_packed32_to_gbr24p_<opt>(uint8_t *dst0, uint8_t *dst1,
+;                                  uint8_t *dst2, const uint8_t *src,
+;                                  int w, int alpha_first)
+;-----------------------------------------------------------------------------
+
+%macro PACKED32_TO_GBR24P 0
+cglobal packed32_to_gbr24p, 5, 6, 8, dst0, dst1, dst2, src, w, alpha_first
+    movsxdifnidn    wq, wd
+    add          dst0q, wq
+    add          dst1q, wq
+    add          dst2q, wq
+    lea           srcq, [srcq+wq*4]
+    neg             wq
+    mova            m7, [shuf_from32]
+    test  alpha_firstd, alpha_firstd
+    jz .no_alpha_first
+    mova            m7, [shuf_from32a]
+.no_alpha_first:
+%if mmsize == 32
+    mova            m6, [pd_permd]
+%endif
+.loop:
+    movu            m0, [srcq+wq*4+mmsize*0]
+    movu            m1, [srcq+wq*4+mmsize*1]
+    movu            m2, [srcq+wq*4+mmsize*2]
+    movu            m3, [srcq+wq*4+mmsize*3]
+    pshufb          m0, m7
+    pshufb          m1, m7
+    pshufb          m2, m7
+    pshufb          m3, m7
+    punpckhdq       m4, m0, m1
+    punpckldq       m0, m1
+    punpckhdq       m5, m2, m3
+    punpckldq       m2, m3
+    punpcklqdq      m1, m0, m2
+    punpckhqdq      m0, m2
+    punpcklqdq      m4, m5
+%if mmsize == 32
+    vpermd          m1, m6, m1
+    vpermd          m0, m6, m0
+    vpermd          m4, m6, m4
+%endif
+    movu   [dst0q+wq], m1
+    movu   [dst1q+wq], m0
+    movu   [dst2q+wq], m4
+    add             wq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_gbr24p_to_packed24_<opt>(uint8_t *dst, const uint8_t *src0,
+;                                  const uint8_t *src1, const uint8_t *src2,
+;                                  int w)
+; void ff_packed24_to_gbr24p_<opt>(uint8_t *dst0, uint8_t *dst1,
+;                                  uint8_t *dst2, const uint8_t *src, int w)
+; void ff_gbr16p_to_packed48_<opt>(uint16_t *dst, const uint16_t *src0,
+;                                  const uint16_t *src1, const uint16_t *src2,
+;                                  int w, int shift_high, int shift_low)
+; void ff_packed48_to_gbr16p_<opt>(uint16_t *dst0, uint16_t *dst1,
+;                                  uint16_t *dst2, const uint16_t *src,
+;                                  int w, int shift)
+;
+; The 16-bit versions store (x << shift_high | x >> shift_low), resp.
+; x >> shift, like the C code for native endian formats.
+;-----------------------------------------------------------------------------
+
+; SHUF3 dst, tmp, src0, src1, src2, mask name
+%macro SHUF3 6
+    pshufb          %1, %3, [%6 %+ 0]
+    pshufb          %2, %4, [%6 %+ 1]
+    por             %1, %2
+    pshufb          %2, %5, [%6 %+ 2]
+    por             %1, %2
+%endmacro
+
+; PLANAR_TO_PACKED3 bits
+%macro PLANAR_TO_PACKED3 1
+%if %1 == 24
+cglobal gbr24p_to_packed24, 5, 5, 5, dst, src0, src1, src2, w
+%else
+cglobal gbr16p_to_packed48, 5, 5, 8, dst, src0, src1, src2, w
+    movd            m6, r5m
+    movd            m7, r6m
+%endif
+    movsxdifnidn    wq, wd
+%if %1 == 48
+    add             wq, wq
+%endif
+    add          src0q, wq
+    add          src1q, wq
+    add          src2q, wq
+    neg             wq
+.loop:
+    movu            m0, [src0q+wq]
+    movu            m1, [src1q+wq]
+    movu            m2, [src2q+wq]
+%if %1 == 48
+    psllw           m3, m0, m6
+    psllw           m4, m1, m6
+    psllw           m5, m2, m6
+    psrlw           m0, m7
+    psrlw           m1, m7
+    psrlw           m2, m7
+    por             m0, m3
+    por             m1, m4
+    por             m2, m5
+%endif
+    SHUF3           m3, m4, m0, m1, m2, shuf_to%1_0
+    movu   [dstq+mmsize*0], m3
+    SHUF3           m3, m4, m0, m1, m2, shuf_to%1_1
+    movu   [dstq+mmsize*1], m3
+    SHUF3           m3, m4, m0, m1, m2, shuf_to%1_2
+    movu   [dstq+mmsize*2], m3
+    add           dstq, mmsize*3
+    add             wq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+; PACKED3_TO_PLANAR bits
+%macro PACKED3_TO_PLANAR 1
+%if %1 == 24
+cglobal packed24_to_gbr24p, 5, 5, 5, dst0, dst1, dst2, src, w
+%else
+cglobal packed48_to_gbr16p, 5, 5, 6, dst0, dst1, dst2, src, w
+    movd            m5, r5m
+%endif
+    movsxdifnidn    wq, wd
+%if %1 == 48
+    add             wq, wq
+%endif
+    add          dst0q, wq
+    add          dst1q, wq
+    add          dst2q, wq
+    neg             wq
+.loop:
+    movu            m0, [srcq+mmsize*0]
+    movu            m1, [srcq+mmsize*1]
+    movu            m2, [srcq+mmsize*2]
+    SHUF3           m3, m4, m0, m1, m2, shuf_from%1_0
+%if %1 == 48
+    psrlw           m3, m5
+%endif
+    movu   [dst0q+wq], m3
+    SHUF3           m3, m4, m0, m1, m2, shuf_from%1_1
+%if %1 == 48
+    psrlw           m3, m5
+%endif
+    movu   [dst1q+wq], m3
+    SHUF3           m3, m4, m0, m1, m2, shuf_from%1_2
+%if %1 == 48
+    psrlw           m3, m5
+%endif
+    movu   [dst2q+wq], m3
+    add           srcq, mmsize*3
+    add             wq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_gbr16p_to_packed64_<opt>(uint16_t *dst, const uint16_t *src0,
+;                                  const uint16_t *src1, const uint16_t *src2,
+;                                  int w, int shift_high, int shift_low)
+; void ff_gbra16p_to_packed64_<opt>(uint16_t *dst, const uint16_t *src0,
+;                                   const uint16_t *src1, const uint16_t *src2,
+;                                   const uint16_t *src3, int w,
+;                                   int shift_high, int shift_low)
+;
+; Without src3 the fourth component is 0xffff.
+;-----------------------------------------------------------------------------
+
+; SCALE16 reg, tmp
+%macro SCALE16 2
+    psllw           %2, %1, m6
+    psrlw           %1, m7
+    por             %1, %2
+%endmacro
+
+; PLANAR_TO_PACKED64 number of planes
+%macro PLANAR_TO_PACKED64 1
+%if %1 == 4
+cglobal gbra16p_to_packed64, 6, 6, 8, dst, src0, src1, src2, src3, w
+    movd            m6, r6m
+    movd            m7, r7m
+%else
+cglobal gbr16p_to_packed64, 5, 5, 8, dst, src0, src1, src2, w
+    movd            m6, r5m
+    movd            m7, r6m
+%endif
+    movsxdifnidn    wq, wd
+    lea          src0q, [src0q+wq*2]
+    lea          src1q, [src1q+wq*2]
+    lea          src2q, [src2q+wq*2]
+%if %1 == 4
+    lea          src3q, [src3q+wq*2]
+%else
+    pcmpeqw         m3, m3
+%endif
+    lea           dstq, [dstq+wq*8]
+    neg             wq
+.loop:
+    movu            m0, [src0q+wq*2]
+    movu            m1, [src1q+wq*2]
+    movu            m2, [src2q+wq*2]
+    SCALE16         m0, m4
+    SCALE16         m1, m4
+    SCALE16         m2, m4
+%if %1 == 4
+    movu            m3, [src3q+wq*2]
+    SCALE16         m3, m4
+%endif
+    punpckhwd       m4, m0, m1
+    punpcklwd       m0, m1
+    punpckhwd       m5, m2, m3
+    punpcklwd       m2, m3
+    punpckldq       m1, m0, m2
+    punpckhdq       m0, m2
+    punpckldq       m2, m4, m5
+    punpckhdq       m4, m5
+    movu [dstq+wq*8+mmsize*0], m1
+    movu [dstq+wq*8+mmsize*1], m0
+    movu [dstq+wq*8+mmsize*2], m2
+    movu [dstq+wq*8+mmsize*3], m4
+    add             wq, mmsize/2
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_packed64_to_gbr16p_<opt>(uint16_t *dst0, uint16_t *dst1,
+;                                  uint16_t *dst2, const uint16_t *src,
+;                                  int w, int shift)
+; void ff_packed64_to_gbra16p_<opt>(uint16_t *dst0, uint16_t *dst1,
+;                                   uint16_t *dst2, uint16_t *dst3,
+;                                   const uint16_t *src, int w, int shift)
+;-----------------------------------------------------------------------------
+
+; PACKED64_TO_PLANAR number of planes
+%macro PACKED64_TO_PLANAR 1
+%if %1 == 4
+cglobal packed64_to_gbra16p, 6, 6, 7, dst0, dst1, dst2, dst3, src, w
+    movd            m6, r6m
+%else
+cglobal packed64_to_gbr16p, 5, 5, 7, dst0, dst1, dst2, src, w
+    movd            m6, r5m
+%endif
+    movsxdifnidn    wq, wd
+    lea          dst0q, [dst0q+wq*2]
+    lea          dst1q, [dst1q+wq*2]
+    lea          dst2q, [dst2q+wq*2]
+%if %1 == 4
+    lea          dst3q, [dst3q+wq*2]
+%endif
+    lea           srcq, [srcq+wq*8]
+    neg             wq
+.loop:
+    movu            m0, [srcq+wq*8+mmsize*0]
+    movu            m1, [srcq+wq*8+mmsize*1]
+    movu            m2, [srcq+wq*8+mmsize*2]
+    movu            m3, [srcq+wq*8+mmsize*3]
+    punpckhwd       m4, m0, m1
+    punpcklwd       m0, m1
+    punpckhwd       m5, m2, m3
+    punpcklwd       m2, m3
+    punpckhwd       m1, m0, m4          ; components 2, 3 of pixels 0-3
+    punpcklwd       m0, m4              ; components 0, 1 of pixels 0-3
+    punpckhwd       m3, m2, m5          ; components 2, 3 of pixels 4-7
+    punpcklwd       m2, m5              ; components 0, 1 of pixels 4-7
+    punpckhqdq      m4, m0, m2
+    punpcklqdq      m0, m2
+    punpcklqdq      m5, m1, m3
+    psrlw           m0, m6
+    psrlw           m4, m6
+    psrlw           m5, m6
+    movu [dst0q+wq*2], m0
+    movu [dst1q+wq*2], m4
+    movu [dst2q+wq*2], m5
+%if %1 == 4
+    punpckhqdq      m1, m3
+    psrlw           m1, m6
+    movu [dst3q+wq*2], m1
+%endif
+    add             wq, mmsize/2
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_dither_u16_to_u8_<opt>(uint8_t *dst, const uint16_t *src,
+;                                const uint8_t *dither, int scale, int shift,
+;                                int w)
+; void ff_dither_u16_to_u16_<opt>(uint16_t *dst, const uint16_t *src,
+;                                 const uint8_t *dither, int scale, int shift,
+;                                 int w)
+;
+; dst[i] = (src[i] + dither[i & 7]) * scale >> shift, on 32 bits. The 8-bit
+; results always fit, but 16 -> 15 bits can exceed 0x7fff, so the 16-bit
+; output is packed with a bias to get the same truncation as the C code.
+;-----------------------------------------------------------------------------
+
+; DITHER_WORDS reg, tmp, tmp, output bits
+; m4 = shift, m5 = scale, m6/m7 = dither * scale of words 0-3/4-7 of a lane
+%macro DITHER_WORDS 4
+    pmulhuw         %2, %1, m5
+    pmullw          %1, m5
+    punpckhwd       %3, %1, %2
+    punpcklwd       %1, %2
+    paddd           %1, m6
+    paddd           %3, m7
+    psrld           %1, xm4
+    psrld           %3, xm4
+%if %4 == 8
+    packssdw        %1, %3
+%else
+    psubd           %1, [pd_8000]
+    psubd           %3, [pd_8000]
+    packssdw        %1, %3
+    pxor            %1, [pw_8000]
+%endif
+%endmacro
+
+%macro DITHER_U16 1
+cglobal dither_u16_to_u%1, 6, 6, 8, dst, src, dither, scale, shift, w
+%if cpuflag(avx2)
+    vpbroadcastq    m6, [ditherq]
+    movd           xm5, scaled
+    vpbroadcastw    m5, xm5
+%else
+    movq            m6, [ditherq]
+    movd            m5, scaled
+    SPLATW          m5, m5
+%endif
+    movd           xm4, shiftd
+    pxor            m7, m7
+    punpcklbw       m6, m7
+    pmulhuw         m0, m6, m5
+    pmullw          m6, m5
+    punpckhwd       m7, m6, m0
+    punpcklwd       m6, m0
+    movsxdifnidn    wq, wd
+    lea           srcq, [srcq+wq*2]
+%if %1 == 8
+    add           dstq, wq
+%else
+    lea           dstq, [dstq+wq*2]
+%endif
+    neg             wq
+.loop:
+    movu            m0, [srcq+wq*2]
+    movu            m1, [srcq+wq*2+mmsize]
+    DITHER_WORDS    m0, m2, m3, %1
+    DITHER_WORDS    m1, m2, m3, %1
+%if %1 == 8
+    packuswb        m0, m1
+%if cpuflag(avx2)
+    vpermq          m0, m0, q3120
+%endif
+    movu [dstq+wq], m0
+%else
+    movu [dstq+wq*2], m0
+    movu [dstq+wq*2+mmsize], m1
+%endif
+    add             wq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_shift_up_u8_to_u16_<opt>(uint16_t *dst, const uint8_t *src, int w,
+;                                  int shift_high, int shift_low)
+; void ff_shift_up_u16_<opt>(uint16_t *dst, const uint16_t *src, int w,
+;                            int shift_high, int shift_low)
+;
+; dst[i] = src[i] << shift_high | src[i] >> shift_low
+;-----------------------------------------------------------------------------
+
+%macro SHIFT_UP 1 ; input bits
+%if %1 == 8
+cglobal shift_up_u8_to_u16, 5, 5, 8, dst, src, w, shift_high, shift_low
+%else
+cglobal shift_up_u16, 5, 5, 8, dst, src, w, shift_high, shift_low
+%endif
+    movd           xm6, shift_highd
+    movd           xm7, shift_lowd
+    movsxdifnidn    wq, wd
+%if %1 == 8
+    add           srcq, wq
+    pxor            m5, m5
+%else
+    lea           srcq, [srcq+wq*2]
+%endif
+    lea           dstq, [dstq+wq*2]
+    neg             wq
+.loop:
+%if %1 == 8
+    movu            m0, [srcq+wq]
+%if cpuflag(avx2)
+    vpermq          m0, m0, q3120
+%endif
+    punpckhbw       m1, m0, m5
+    punpcklbw       m0, m5
+%else
+    movu            m0, [srcq+wq*2]
+    movu            m1, [srcq+wq*2+mmsize]
+%endif
+    psllw           m2, m0, xm6
+    psllw           m3, m1, xm6
+    psrlw           m0, xm7
+    psrlw           m1, xm7
+    por             m0, m2
+    por             m1, m3
+    movu [dstq+wq*2], m0
+    movu [dstq+wq*2+mmsize], m1
+    add             wq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+INTERLEAVE_BYTES
+DEINTERLEAVE_BYTES
+PACKED422_TO_PLANAR uyvy, 1
+PACKED422_TO_PLANAR yuyv, 0
+GBR24P_TO_PACKED32
+PLANAR_TO_PACKED64 3
+PLANAR_TO_PACKED64 4
+PACKED64_TO_PLANAR 3
+PACKED64_TO_PLANAR 4
+DITHER_U16 8
+DITHER_U16 16
+SHIFT_UP 8
+SHIFT_UP 16
+
+INIT_XMM ssse3
+PACKED32_TO_GBR24P
+PLANAR_TO_PACKED3 24
+PLANAR_TO_PACKED3 48
+PACKED3_TO_PLANAR 24
+PACKED3_TO_PLANAR 48
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+INTERLEAVE_BYTES
+DEINTERLEAVE_BYTES
+PACKED422_TO_PLANAR uyvy, 1
+PACKED422_TO_PLANAR yuyv, 0
+GBR24P_TO_PACKED32
+PACKED32_TO_GBR24P
+DITHER_U16 8
+DITHER_U16 16
+SHIFT_UP 8
+SHIFT_UP 16
+%endif
@@ -21,12 +21,13 @@
 
 %include "libavutil/x86/x86util.asm"
 
-SECTION_RODATA
+SECTION_RODATA 32
 
-max_19bit_int: times 4 dd 0x7ffff
+max_19bit_int: times 8 dd 0x7ffff
+minshort:      times 16 dw 0x8000
+unicoeff:      times 8 dd 0x20000000
+hscale8_perm:  dd 0, 4, 1, 5, 2, 6, 3, 7
 max_19bit_flt: times 4 dd 524287.0
-minshort:      times 8 dw 0x8000
-unicoeff:      times 4 dd 0x20000000
 
 SECTION .text
 
@@ -429,3 +430,169 @@ INIT_XMM ssse3
 SCALE_FUNCS2 6, 6, 8
 INIT_XMM sse4
 SCALE_FUNCS2 6, 6, 8
+
+;-----------------------------------------------------------------------------
+; AVX2 versions of the 4- and 8-tap scalers, producing 8 output pixels per
+; iteration. Each ymm lane holds the source pixels of two output pixels, so
+; the pmaddwd results can be reduced with in-lane horizontal adds. The filter
+; and filterPos arrays are padded by initFilter() so that dstW can be rounded
+; up to a multiple of 8.
+;-----------------------------------------------------------------------------
+
+; SCALE_FUNC_AVX2 source_width, intermediate_nbits, filtersize
+%macro SCALE_FUNC_AVX2 3
+cglobal hscale%1to%2_%3, 6, 7, 8, pos0, dst, w, src, filter, fltpos, pos1
+%if ARCH_X86_64
+    movsxd        wq, wd
+%define mov32 movsxd
+%else ; x86-32
+%define mov32 mov
+%endif ; x86-64
+%if %2 == 19
+    mova          m2, [max_19bit_int]
+%endif ; %2 == 19
+%if %1 == 16
+    mova          m6, [minshort]
+    mova          m7, [unicoeff]
+%endif ; %1 == 16
+%if %3 == 8
+    mova          m3, [hscale8_perm]
+%endif ; %3 == 8
+
+%if %1 == 8
+%define srcmul 1
+%else ; %1 == 9-16
+%define srcmul 2
+%endif ; %1 == 8/9-16
+
+%if %2 == 15
+    lea         dstq, [dstq+wq*2]
+%else ; %2 == 19
+    lea         dstq, [dstq+wq*4]
+%endif ; %2 == 15/19
+    lea      fltposq, [fltposq+wq*4]
+    neg           wq
+
+.loop:
+%if %3 == 4
+    ; m0 = src[filterPos[0..3] + {0,1,2,3}], m1 = src[filterPos[4..7] + {0,1,2,3}]
+%if %1 == 8
+%assign %%j 0
+%rep 2
+    mov32      pos0q, dword [fltposq+wq*4+%%j*16+ 0]
+    mov32      pos1q, dword [fltposq+wq*4+%%j*16+ 4]
+    movd       xm %+ %%j, [srcq+pos0q]
+    pinsrd     xm %+ %%j, [srcq+pos1q], 1
+    mov32      pos0q, dword [fltposq+wq*4+%%j*16+ 8]
+    mov32      pos1q, dword [fltposq+wq*4+%%j*16+12]
+    pinsrd     xm %+ %%j, [srcq+pos0q], 2
+    pinsrd     xm %+ %%j, [srcq+pos1q], 3
+    pmovzxbw   m %+ %%j, xm %+ %%j
+%assign %%j %%j+1
+%endrep
+%else ; %1 > 8
+    mov32      pos0q, dword [fltposq+wq*4+ 0]
+    mov32      pos1q, dword [fltposq+wq*4+ 4]
+    movq         xm0, [srcq+pos0q*2]
+    movhps       xm0, [srcq+pos1q*2]
+    mov32      pos0q, dword [fltposq+wq*4+ 8]
+    mov32      pos1q, dword [fltposq+wq*4+12]
+    movq         xm4, [srcq+pos0q*2]
+    movhps       xm4, [srcq+pos1q*2]
+    mov32      pos0q, dword [fltposq+wq*4+16]
+    mov32      pos1q, dword [fltposq+wq*4+20]
+    movq         xm1, [srcq+pos0q*2]
+    movhps       xm1, [srcq+pos1q*2]
+    mov32      pos0q, dword [fltposq+wq*4+24]
+    mov32      pos1q, dword [fltposq+wq*4+28]
+    movq         xm5, [srcq+pos0q*2]
+    movhps       xm5, [srcq+pos1q*2]
+    vinserti128   m0, m0, xm4, 1
+    vinserti128   m1, m1, xm5, 1
+%endif ; %1 == 8/9-16
+%if %1 == 16
+    psubw         m0, m6
+    psubw         m1, m6
+%endif ; %1 == 16
+    pmaddwd       m0, [filterq+mmsize*0]
+    pmaddwd       m1, [filterq+mmsize*1]
+    ; lane 0: {0,1,4,5}, lane 1: {2,3,6,7}
+    phaddd        m0, m1
+    vpermq        m0, m0, q3120
+    add      filterq, mmsize*2
+%else ; %3 == 8
+    ; m0/m1/m4/m5 = src[filterPos[{0,1}/{2,3}/{4,5}/{6,7}] + {0,1,...,7}]
+%assign %%j 0
+%rep 4
+%if %%j < 2
+%assign %%reg %%j
+%else
+%assign %%reg %%j+2
+%endif
+    mov32      pos0q, dword [fltposq+wq*4+%%j*8+0]
+    mov32      pos1q, dword [fltposq+wq*4+%%j*8+4]
+%if %1 == 8
+    movq     xm %+ %%reg, [srcq+pos0q]
+    movhps   xm %+ %%reg, [srcq+pos1q]
+    pmovzxbw  m %+ %%reg, xm %+ %%reg
+%else ; %1 > 8
+    movu     xm %+ %%reg, [srcq+pos0q*2]
+    vinserti128 m %+ %%reg, m %+ %%reg, [srcq+pos1q*2], 1
+%endif ; %1 == 8/9-16
+%assign %%j %%j+1
+%endrep
+%if %1 == 16
+    psubw         m0, m6
+    psubw         m1, m6
+    psubw         m4, m6
+    psubw         m5, m6
+%endif ; %1 == 16
+    pmaddwd       m0, [filterq+mmsize*0]
+    pmaddwd       m1, [filterq+mmsize*1]
+    pmaddwd       m4, [filterq+mmsize*2]
+    pmaddwd       m5, [filterq+mmsize*3]
+    phaddd        m0, m1
+    phaddd        m4, m5
+    phaddd        m0, m4                        ; {0,2,4,6,1,3,5,7}
+    vpermd        m0, m3, m0
+    add      filterq, mmsize*4
+%endif ; %3 == 4/8
+
+%if %1 == 16 ; add 0x8000 * sum(coeffs), i.e. back from signed -> unsigned
+    paddd         m0, m7
+%endif ; %1 == 16
+
+    psrad         m0, 14 + %1 - %2
+%if %2 == 15
+    packssdw      m0, m0
+    vpermq        m0, m0, q0020
+    movu [dstq+wq*2], xm0
+%else ; %2 == 19
+    pminsd        m0, m2
+    movu [dstq+wq*4], m0
+%endif ; %2 == 15/19
+    add           wq, 8
+    jl .loop
+    RET
+%endmacro
+
+%macro SCALE_FUNCS_AVX2 2
+SCALE_FUNC_AVX2 %1, %2, 4
+SCALE_FUNC_AVX2 %1, %2, 8
+%endmacro
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+SCALE_FUNCS_AVX2  8, 15
+SCALE_FUNCS_AVX2  9, 15
+SCALE_FUNCS_AVX2 10, 15
+SCALE_FUNCS_AVX2 12, 15
+SCALE_FUNCS_AVX2 14, 15
+SCALE_FUNCS_AVX2 16, 15
+SCALE_FUNCS_AVX2  8, 19
+SCALE_FUNCS_AVX2  9, 19
+SCALE_FUNCS_AVX2 10, 19
+SCALE_FUNCS_AVX2 12, 19
+SCALE_FUNCS_AVX2 14, 19
+SCALE_FUNCS_AVX2 16, 19
+%endif
@@ -311,6 +311,8 @@ SCALE_FUNCS_MMX(mmx);
 SCALE_FUNCS_SSE(sse2);
 SCALE_FUNCS_SSE(ssse3);
 SCALE_FUNCS_SSE(sse4);
+SCALE_FUNCS(4, avx2);
+SCALE_FUNCS(8, avx2);
 
 #define VSCALEX_FUNC(size, opt) \
 void ff_yuv2planeX_ ## size ## _ ## opt(const int16_t *filter, int filterSize, \
@@ -328,6 +330,9 @@ VSCALEX_FUNCS(sse2);
 VSCALEX_FUNCS(sse4);
 VSCALEX_FUNC(16, sse4);
 VSCALEX_FUNCS(avx);
+VSCALEX_FUNC(9,  avx2);
+VSCALEX_FUNC(10, avx2);
+VSCALEX_FUNC(16, avx2);
 
 #define VSCALE_FUNC(size, opt) \
 void ff_yuv2plane1_ ## size ## _ ## opt(const int16_t *src, uint8_t *dst, int dstW, \
@@ -344,6 +349,7 @@ VSCALE_FUNCS(mmx, mmxext);
 VSCALE_FUNCS(sse2, sse2);
 VSCALE_FUNC(16, sse4);
 VSCALE_FUNCS(avx, avx);
+VSCALE_FUNCS(avx2, avx2);
 
 #define INPUT_Y_FUNC(fmt, opt) \
 void ff_ ## fmt ## ToY_  ## opt(uint8_t *dst, const uint8_t *src, \
@@ -577,4 +583,19 @@ switch(c->dstBpc){ \
             break;
         }
     }
+
+#define ASSIGN_AVX2_SCALE_FUNC(hscalefn, filtersize) \
+    switch (filtersize) { \
+    case 4:  ASSIGN_SCALE_FUNC2(hscalefn, 4, avx2, avx2); break; \
+    case 8:  ASSIGN_SCALE_FUNC2(hscalefn, 8, avx2, avx2); break; \
+    default: /* keep the SSE versions */                  break; \
+    }
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        ASSIGN_AVX2_SCALE_FUNC(c->hyScale, c->hLumFilterSize);
+        ASSIGN_AVX2_SCALE_FUNC(c->hcScale, c->hChrFilterSize);
+        ASSIGN_VSCALEX_FUNC(c->yuv2planeX, avx2,
+                            if (!isBE(c->dstFormat)) c->yuv2planeX = ff_yuv2planeX_16_avx2,
+                            HAVE_ALIGNED_STACK || ARCH_X86_64);
+        ASSIGN_VSCALE_FUNC(c->yuv2plane1, avx2, avx2, 1);
+    }
 }
@@ -0,0 +1,254 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdint.h>
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#if HAVE_YASM
+
+#define GBR24P_TO_PACKED24_FUNC(opt, step)                                    \
+void ff_gbr24p_to_packed24_ ## opt(uint8_t *dst, const uint8_t *src0,         \
+                                   const uint8_t *src1, const uint8_t *src2,  \
+                                   int w);                                    \
+void ff_packed24_to_gbr24p_ ## opt(uint8_t *dst0, uint8_t *dst1,              \
+                                   uint8_t *dst2, const uint8_t *src, int w); \
+                                                                              \
+static void gbr24p_to_packed24_ ## opt(uint8_t *dst, const uint8_t *src0,     \
+                                       const uint8_t *src1,                   \
+                                       const uint8_t *src2, int width)        \
+{                                                                             \
+    FF_SIMD_WITH_C_TAIL(width, step,                                          \
+        ff_gbr24p_to_packed24_ ## opt(dst, src0, src1, src2, x),              \
+        ff_gbr24p_to_packed24_c(dst + 3 * x, src0 + x, src1 + x, src2 + x,    \
+                                width - x));                                  \
+}                                                                             \
+                                                                              \
+static void packed24_to_gbr24p_ ## opt(uint8_t *dst0, uint8_t *dst1,          \
+                                       uint8_t *dst2, const uint8_t *src,     \
+                                       int width)                             \
+{                                                                             \
+    FF_SIMD_WITH_C_TAIL(width, step,                                          \
+        ff_packed24_to_gbr24p_ ## opt(dst0, dst1, dst2, src, x),              \
+        ff_packed24_to_gbr24p_c(dst0 + x, dst1 + x, dst2 + x, src + 3 * x,    \
+                                width - x));                                  \
+}
+
+#define GBR24P_TO_PACKED32_FUNC(opt, step)                                    \
+void ff_gbr24p_to_packed32_ ## opt(uint8_t *dst, const uint8_t *src0,         \
+                                   const uint8_t *src1, const uint8_t *src2,  \
+                                   int w, int alpha_first);                   \
+                                                                              \
+static void gbr24p_to_packed32_ ## opt(uint8_t *dst, const uint8_t *src0,     \
+                                       const uint8_t *src1,                   \
+                                       const uint8_t *src2, int width,        \
+                                       int alpha_first)                       \
+{                                                                             \
+    FF_SIMD_WITH_C_TAIL(width, step,                                          \
+        ff_gbr24p_to_packed32_ ## opt(dst, src0, src1, src2, x,               \
+                                      alpha_first),                           \
+        ff_gbr24p_to_packed32_c(dst + 4 * x, src0 + x, src1 + x, src2 + x,    \
+                                width - x, alpha_first));                     \
+}
+
+#define PACKED32_TO_GBR24P_FUNC(opt, step)                                    \
+void ff_packed32_to_gbr24p_ ## opt(uint8_t *dst0, uint8_t *dst1,              \
+                                   uint8_t *dst2, const uint8_t *src,         \
+                                   int w, int alpha_first);                   \
+                                                                              \
+static void packed32_to_gbr24p_ ## opt(uint8_t *dst0, uint8_t *dst1,          \
+                                       uint8_t *dst2, const uint8_t *src,     \
+                                       int width, int alpha_first)            \
+{                                                                             \
+    FF_SIMD_WITH_C_TAIL(width, step,                                          \
+        ff_packed32_to_gbr24p_ ## opt(dst0, dst1, dst2, src, x,               \
+                                      alpha_first),                           \
+        ff_packed32_to_gbr24p_c(dst0 + x, dst1 + x, dst2 + x, src + 4 * x,    \
+                                width - x, alpha_first));                     \
+}
+
+GBR24P_TO_PACKED24_FUNC(ssse3, 16)
+GBR24P_TO_PACKED32_FUNC(sse2,  16)
+GBR24P_TO_PACKED32_FUNC(avx2,  32)
+PACKED32_TO_GBR24P_FUNC(ssse3, 16)
+PACKED32_TO_GBR24P_FUNC(avx2,  32)
+
+#define DEPTH_FUNCS(opt, step)                                                \
+void ff_dither_u16_to_u8_ ## opt(uint8_t *dst, const uint16_t *src,           \
+                                 const uint8_t *dither, int scale, int shift, \
+                                 int w);                                      \
+void ff_dither_u16_to_u16_ ## opt(uint16_t *dst, const uint16_t *src,         \
+                                  const uint8_t *dither, int scale,           \
+                                  int shift, int w);                          \
+void ff_shift_up_u8_to_u16_ ## opt(uint16_t *dst, const uint8_t *src, int w,  \
+                                   int shift_high, int shift_low);            \
+void ff_shift_up_u16_ ## opt(uint16_t *dst, const uint16_t *src, int w,       \
+                             int shift_high, int shift_low);                  \
+                                                                              \
+static void dither_u16_to_u8_ ## opt(uint8_t *dst, const uint16_t *src,       \
+                                     const uint8_t *dither, int scale,        \
+                                     int shift, int width)                    \
+{                                                                             \
+    FF_SIMD_WITH_C_TAIL(width, step,                                          \
+        ff_dither_u16_to_u8_ ## opt(dst, src, dither, scale, shift, x),       \
+        ff_dither_u16_to_u8_c(dst + x, src + x, dither, scale, shift,         \
+                              width - x));                                    \
+}                                                                             \
+                                                                              \
+static void dither_u16_to_u16_ ## opt(uint16_t *dst, const uint16_t *src,     \
+                                      const uint8_t *dither, int scale,       \
+                                      int shift, int width)                   \
+{                                                                             \
+    FF_SIMD_WITH_C_TAIL(width, step,                                          \
+        ff_dither_u16_to_u16_ ## opt(dst, src, dither, scale, shift, x),      \
+        ff_dither_u16_to_u16_c(dst + x, src + x, dither, scale, shift,        \
+                               width - x));                                   \
+}                                                                             \
+                                                                              \
+static void shift_up_u8_to_u16_ ## opt(uint16_t *dst, const uint8_t *src,     \
+                                       int width, int shift_high,             \
+                                       int shift_low)                         \
+{                                                                             \
+    FF_SIMD_WITH_C_TAIL(width, step,                                          \
+        ff_shift_up_u8_to_u16_ ## opt(dst, src, x, shift_high, shift_low),    \
+        ff_shift_up_u8_to_u16_c(dst + x, src + x, width - x, shift_high,      \
+                                shift_low));                                  \
+}                                                                             \
+                                                                              \
+static void shift_up_u16_ ## opt(uint16_t *dst, const uint16_t *src,          \
+                                 int width, int shift_high, int shift_low)    \
+{                                                                             \
+    FF_SIMD_WITH_C_TAIL(width, step,                                          \
+        ff_shift_up_u16_ ## opt(dst, src, x, shift_high, shift_low),          \
+        ff_shift_up_u16_c(dst + x, src + x, width - x, shift_high,            \
+                          shift_low));                                        \
+}
+
+DEPTH_FUNCS(sse2, 16)
+DEPTH_FUNCS(avx2, 32)
+
+void ff_gbr16p_to_packed48_ssse3(uint16_t *dst, const uint16_t *src0,
+                                 const uint16_t *src1, const uint16_t *src2,
+                                 int w, int shift_high, int shift_low);
+void ff_gbr16p_to_packed64_sse2(uint16_t *dst, const uint16_t *src0,
+                                const uint16_t *src1, const uint16_t *src2,
+                                int w, int shift_high, int shift_low);
+void ff_gbra16p_to_packed64_sse2(uint16_t *dst, const uint16_t *src0,
+                                 const uint16_t *src1, const uint16_t *src2,
+                                 const uint16_t *src3, int w,
+                                 int shift_high, int shift_low);
+void ff_packed48_to_gbr16p_ssse3(uint16_t *dst0, uint16_t *dst1,
+                                 uint16_t *dst2, const uint16_t *src,
+                                 int w, int shift);
+void ff_packed64_to_gbr16p_sse2(uint16_t *dst0, uint16_t *dst1,
+                                uint16_t *dst2, const uint16_t *src,
+                                int w, int shift);
+void ff_packed64_to_gbra16p_sse2(uint16_t *dst0, uint16_t *dst1,
+                                 uint16_t *dst2, uint16_t *dst3,
+                                 const uint16_t *src, int w, int shift);
+
+static void packed16_to_gbra16_ssse3(uint16_t *dst[4], const uint16_t *src,
+                                     int width, int src_alpha, int shift)
+{
+    int w = width & ~7, x;
+    uint16_t *tail[4];
+
+    if (w) {
+        if (src_alpha && dst[3])
+            ff_packed64_to_gbra16p_sse2(dst[0], dst[1], dst[2], dst[3],
+                                        src, w, shift);
+        else if (src_alpha)
+            ff_packed64_to_gbr16p_sse2(dst[0], dst[1], dst[2], src, w, shift);
+        else
+            ff_packed48_to_gbr16p_ssse3(dst[0], dst[1], dst[2], src, w, shift);
+        if (dst[3] && !src_alpha)
+            for (x = 0; x < w; x++)
+                dst[3][x] = 0xFFFF;
+    }
+
+    tail[0] = dst[0] + w;
+    tail[1] = dst[1] + w;
+    tail[2] = dst[2] + w;
+    tail[3] = dst[3] ? dst[3] + w : NULL;
+    ff_packed16_to_gbra16_c(tail, src + w * (src_alpha ? 4 : 3), width - w,
+                            src_alpha, shift);
+}
+
+static void gbr16p_to_packed16_ssse3(uint16_t *dst, const uint16_t *src[4],
+                                     int width, int alpha, int bpp)
+{
+    int w = width & ~7;
+    int shift_high = 16 - bpp, shift_low = (bpp - 8) * 2;
+    const uint16_t *tail[4];
+
+    if (w) {
+        if (alpha && src[3])
+            ff_gbra16p_to_packed64_sse2(dst, src[0], src[1], src[2], src[3],
+                                        w, shift_high, shift_low);
+        else if (alpha)
+            ff_gbr16p_to_packed64_sse2(dst, src[0], src[1], src[2],
+                                       w, shift_high, shift_low);
+        else
+            ff_gbr16p_to_packed48_ssse3(dst, src[0], src[1], src[2],
+                                        w, shift_high, shift_low);
+    }
+
+    tail[0] = src[0] + w;
+    tail[1] = src[1] + w;
+    tail[2] = src[2] + w;
+    tail[3] = src[3] ? src[3] + w : NULL;
+    ff_gbr16p_to_packed16_c(dst + w * (alpha ? 4 : 3), tail, width - w,
+                            alpha, bpp);
+}
+
+#endif /* HAVE_YASM */
+
+av_cold void ff_get_unscaled_swscale_x86(SwsContext *c)
+{
+#if HAVE_YASM
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        c->gbr24pToPacked32Line = gbr24p_to_packed32_sse2;
+        c->ditherU16ToU8Line    = dither_u16_to_u8_sse2;
+        c->ditherU16ToU16Line   = dither_u16_to_u16_sse2;
+        c->shiftUpU8ToU16Line   = shift_up_u8_to_u16_sse2;
+        c->shiftUpU16Line       = shift_up_u16_sse2;
+    }
+    if (EXTERNAL_SSSE3(cpu_flags)) {
+        c->gbr24pToPacked24Line = gbr24p_to_packed24_ssse3;
+        c->packed24ToGbr24pLine = packed24_to_gbr24p_ssse3;
+        c->packed32ToGbr24pLine = packed32_to_gbr24p_ssse3;
+        c->packed16ToGbra16Line = packed16_to_gbra16_ssse3;
+        c->gbr16pToPacked16Line = gbr16p_to_packed16_ssse3;
+    }
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        c->gbr24pToPacked32Line = gbr24p_to_packed32_avx2;
+        c->packed32ToGbr24pLine = packed32_to_gbr24p_avx2;
+        c->ditherU16ToU8Line    = dither_u16_to_u8_avx2;
+        c->ditherU16ToU16Line   = dither_u16_to_u16_avx2;
+        c->shiftUpU8ToU16Line   = shift_up_u8_to_u16_avx2;
+        c->shiftUpU16Line       = shift_up_u16_avx2;
+    }
+#endif /* HAVE_YASM */
+}
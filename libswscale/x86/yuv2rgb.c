@@ -26,6 +26,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
 
 #include "config.h"
@@ -69,11 +70,85 @@ DECLARE_ASM_CONST(8, uint64_t, pb_07) = 0x0707070707070707ULL;
 
 #endif /* HAVE_INLINE_ASM */
 
+#if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+typedef void (*yuv420_32_fn)(uint8_t *dst, const uint8_t *py,
+                             const uint8_t *pu, const uint8_t *pv,
+                             const uint64_t *coeffs, int w);
+
+void ff_yuv420_rgb32_avx2(uint8_t *dst, const uint8_t *py,
+                          const uint8_t *pu, const uint8_t *pv,
+                          const uint64_t *coeffs, int w);
+void ff_yuv420_bgr32_avx2(uint8_t *dst, const uint8_t *py,
+                          const uint8_t *pu, const uint8_t *pv,
+                          const uint64_t *coeffs, int w);
+
+static av_always_inline int yuv420_32_avx2(SwsContext *c, const uint8_t *src[],
+                                           int srcStride[],
+                                           int srcSliceY, int srcSliceH,
+                                           uint8_t *dst[], int dstStride[],
+                                           yuv420_32_fn fn)
+{
+    const int w      = c->dstW & ~31;
+    const int tail   = c->dstW - w;
+    const int vshift = c->srcFormat != AV_PIX_FMT_YUV422P;
+    uint8_t ybuf[32] = { 0 }, ubuf[16] = { 0 }, vbuf[16] = { 0 };
+    uint8_t rgbbuf[32 * 4];
+    int y;
+
+    for (y = 0; y < srcSliceH; y++) {
+        uint8_t *image    = dst[0] + (y + srcSliceY) * dstStride[0];
+        const uint8_t *py = src[0] +               y * srcStride[0];
+        const uint8_t *pu = src[1] +   (y >> vshift) * srcStride[1];
+        const uint8_t *pv = src[2] +   (y >> vshift) * srcStride[2];
+
+        if (w)
+            fn(image, py, pu, pv, &c->redDither, w);
+        if (tail) {
+            /* go through a bounce buffer for the last pixels, so that
+             * nothing past the end of the lines is touched */
+            memcpy(ybuf, py + w,     tail);
+            memcpy(ubuf, pu + w / 2, (tail + 1) >> 1);
+            memcpy(vbuf, pv + w / 2, (tail + 1) >> 1);
+            fn(rgbbuf, ybuf, ubuf, vbuf, &c->redDither, 32);
+            memcpy(image + 4 * w, rgbbuf, 4 * tail);
+        }
+    }
+    return srcSliceH;
+}
+
+static int yuv420_rgb32_avx2(SwsContext *c, const uint8_t *src[],
+                             int srcStride[], int srcSliceY, int srcSliceH,
+                             uint8_t *dst[], int dstStride[])
+{
+    return yuv420_32_avx2(c, src, srcStride, srcSliceY, srcSliceH,
+                          dst, dstStride, ff_yuv420_rgb32_avx2);
+}
+
+static int yuv420_bgr32_avx2(SwsContext *c, const uint8_t *src[],
+                             int srcStride[], int srcSliceY, int srcSliceH,
+                             uint8_t *dst[], int dstStride[])
+{
+    return yuv420_32_avx2(c, src, srcStride, srcSliceY, srcSliceH,
+                          dst, dstStride, ff_yuv420_bgr32_avx2);
+}
+#endif /* HAVE_AVX2_EXTERNAL && ARCH_X86_64 */
+
 av_cold SwsFunc ff_yuv2rgb_init_x86(SwsContext *c)
 {
-#if HAVE_MMX_INLINE
     int cpu_flags = av_get_cpu_flags();
 
+#if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+    if (EXTERNAL_AVX2(cpu_flags) && c->srcFormat != AV_PIX_FMT_YUVA420P) {
+        switch (c->dstFormat) {
+        case AV_PIX_FMT_RGB32:
+            return yuv420_rgb32_avx2;
+        case AV_PIX_FMT_BGR32:
+            return yuv420_bgr32_avx2;
+        }
+    }
+#endif
+
+#if HAVE_MMX_INLINE
 #if HAVE_MMXEXT_INLINE
     if (INLINE_MMXEXT(cpu_flags)) {
         switch (c->dstFormat) {
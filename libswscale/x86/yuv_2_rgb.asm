@@ -0,0 +1,133 @@
+;******************************************************************************
+;* x86-optimized YUV to RGB conversion
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pw_00ff: times 16 dw 0x00ff
+
+SECTION .text
+
+; offsets of the coefficients in SwsContext, relative to redDither
+%define Y_COEFF   3*8
+%define VR_COEFF  4*8
+%define UB_COEFF  5*8
+%define VG_COEFF  6*8
+%define UG_COEFF  7*8
+%define Y_OFFSET  8*8
+%define U_OFFSET  9*8
+%define V_OFFSET 10*8
+
+;-----------------------------------------------------------------------------
+; void ff_yuv420_<fmt>_<opt>(uint8_t *dst, const uint8_t *py,
+;                            const uint8_t *pu, const uint8_t *pv,
+;                            const uint64_t *coeffs, int w)
+;
+; Convert one line of w pixels, w being a multiple of 32. coeffs points to
+; SwsContext.redDither. The arithmetic is the same as in the MMX version in
+; yuv2rgb_template.c, so the output is identical.
+;-----------------------------------------------------------------------------
+
+; YUV2RGB32_FN fmt, first byte, third byte
+%macro YUV2RGB32_FN 3
+cglobal yuv420_%1, 6, 6, 16, dst, py, pu, pv, coeff, w
+    vpbroadcastq    m8, [coeffq+Y_COEFF]
+    vpbroadcastq    m9, [coeffq+VR_COEFF]
+    vpbroadcastq   m10, [coeffq+UB_COEFF]
+    vpbroadcastq   m11, [coeffq+VG_COEFF]
+    vpbroadcastq   m12, [coeffq+UG_COEFF]
+    vpbroadcastq   m13, [coeffq+Y_OFFSET]
+    vpbroadcastq   m14, [coeffq+U_OFFSET]
+    vpbroadcastq   m15, [coeffq+V_OFFSET]
+    shr             wd, 1                   ; number of chroma samples
+    movsxdifnidn    wq, wd
+    add            puq, wq
+    add            pvq, wq
+    lea            pyq, [pyq+wq*2]
+    lea           dstq, [dstq+wq*8]
+    neg             wq
+
+.loop:
+    ; each lane converts 16 pixels on its own
+    movu            m0, [pyq+wq*2]
+    pmovzxbw        m1, [puq+wq]
+    pmovzxbw        m2, [pvq+wq]
+    psrlw           m3, m0, 8               ; Y of the odd pixels
+    pand            m0, [pw_00ff]           ; Y of the even pixels
+    psllw           m0, 3
+    psllw           m3, 3
+    psllw           m1, 3
+    psllw           m2, 3
+    psubw           m0, m13
+    psubw           m3, m13
+    psubsw          m1, m14
+    psubsw          m2, m15
+    pmulhw          m0, m8
+    pmulhw          m3, m8
+    pmulhw          m4, m1, m12
+    pmulhw          m5, m2, m11
+    pmulhw          m1, m10                 ; UB
+    pmulhw          m2, m9                  ; VR
+    paddsw          m4, m5                  ; CG
+
+    paddsw          m5, m3, m1              ; B odd
+    paddsw          m6, m3, m2              ; R odd
+    paddsw          m3, m4                  ; G odd
+    paddsw          m1, m0                  ; B even
+    paddsw          m2, m0                  ; R even
+    paddsw          m4, m0                  ; G even
+
+    ; pack and interleave even/odd pixels
+    packuswb        m1, m2
+    packuswb        m5, m6
+    packuswb        m4, m4
+    packuswb        m3, m3
+    punpcklbw       m4, m3                  ; G
+    punpckhbw       m2, m1, m5              ; R
+    punpcklbw       m1, m5                  ; B
+    pcmpeqb         m7, m7                  ; A
+
+    punpcklbw       m0, %2, m4
+    punpckhbw       %2, m4
+    punpcklbw       m3, %3, m7
+    punpckhbw       %3, m7
+    punpcklwd       m5, m0, m3              ; pixels  0- 3, 16-19
+    punpckhwd       m0, m3                  ; pixels  4- 7, 20-23
+    punpcklwd       m6, %2, %3              ; pixels  8-11, 24-27
+    punpckhwd       %2, %3                  ; pixels 12-15, 28-31
+    vperm2i128      m3, m5, m0, 0x20
+    vperm2i128      m5, m5, m0, 0x31
+    vperm2i128      m0, m6, %2, 0x20
+    vperm2i128      m6, m6, %2, 0x31
+    movu [dstq+wq*8+mmsize*0], m3
+    movu [dstq+wq*8+mmsize*1], m0
+    movu [dstq+wq*8+mmsize*2], m5
+    movu [dstq+wq*8+mmsize*3], m6
+    add             wq, mmsize/2
+    jl .loop
+    RET
+%endmacro
+
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+YUV2RGB32_FN rgb32, m1, m2
+YUV2RGB32_FN bgr32, m2, m1
+%endif
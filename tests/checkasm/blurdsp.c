@@ -0,0 +1,210 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavfilter/blurdsp.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+
+/* not a multiple of any SIMD width, so that the C tails are run as well */
+#define LEN 1023
+
+#define randomize_buffers(buf, len, mask)       \
+    do {                                        \
+        int j;                                  \
+        for (j = 0; j < len; j++)               \
+            buf[j] = rnd() & (mask);            \
+    } while (0)
+
+static void check_sum_pairs(const BlurDSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, uint32_t, src,     [LEN + 1]);
+    LOCAL_ALIGNED(32, uint32_t, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, uint32_t, dst_new, [LEN]);
+
+    declare_func(void, uint32_t *dst, const uint32_t *src, int len);
+
+    if (check_func(dsp->sum_pairs, "blur_sum_pairs")) {
+        randomize_buffers(src, LEN + 1, 0xFFFFFF);
+        call_ref(dst_ref, src, LEN);
+        call_new(dst_new, src, LEN);
+        if (memcmp(dst_ref, dst_new, LEN * sizeof(*dst_ref)))
+            fail();
+        bench_new(dst_new, src, LEN);
+    }
+}
+
+static void check_sum_stages(const BlurDSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, uint32_t, line0,   [LEN]);
+    LOCAL_ALIGNED(32, uint32_t, line1,   [LEN]);
+    LOCAL_ALIGNED(32, uint32_t, state00, [LEN]);
+    LOCAL_ALIGNED(32, uint32_t, state01, [LEN]);
+    LOCAL_ALIGNED(32, uint32_t, state10, [LEN]);
+    LOCAL_ALIGNED(32, uint32_t, state11, [LEN]);
+
+    declare_func(void, uint32_t *line, uint32_t *state0, uint32_t *state1, int len);
+
+    if (check_func(dsp->sum_stages, "blur_sum_stages")) {
+        randomize_buffers(line0,   LEN, 0xFFFFFF);
+        randomize_buffers(state00, LEN, 0xFFFFFF);
+        randomize_buffers(state01, LEN, 0xFFFFFF);
+        memcpy(line1,   line0,   LEN * sizeof(*line0));
+        memcpy(state10, state00, LEN * sizeof(*state00));
+        memcpy(state11, state01, LEN * sizeof(*state01));
+        call_ref(line0, state00, state01, LEN);
+        call_new(line1, state10, state11, LEN);
+        if (memcmp(line0,   line1,   LEN * sizeof(*line0))   ||
+            memcmp(state00, state10, LEN * sizeof(*state00)) ||
+            memcmp(state01, state11, LEN * sizeof(*state01)))
+            fail();
+        bench_new(line1, state10, state11, LEN);
+    }
+}
+
+static void check_unsharp_line(const BlurDSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, uint8_t,  src,     [LEN]);
+    LOCAL_ALIGNED(32, uint32_t, blur,    [LEN]);
+    LOCAL_ALIGNED(32, uint8_t,  dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, uint8_t,  dst_new, [LEN]);
+    int i, j;
+
+    declare_func(void, uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                 int len, int amount, int scalebits);
+
+    if (check_func(dsp->unsharp_line, "blur_unsharp_line")) {
+        for (i = 0; i < 8; i++) {
+            /* the filter sizes go from 3x3 to 13x13, amount from -2 to 5 */
+            int scalebits = 4 + 2 * (rnd() % 11);
+            int amount    = (int)(rnd() % (7 << 16)) - (2 << 16);
+
+            randomize_buffers(src, LEN, 0xFF);
+            /* a blurred version of src, off by up to +-16 */
+            for (j = 0; j < LEN; j++) {
+                int b = av_clip_uint8(src[j] + (int)(rnd() % 33) - 16);
+                blur[j] = (uint32_t)b << scalebits | (rnd() & ((1 << scalebits) - 1));
+            }
+            call_ref(dst_ref, src, blur, LEN, amount, scalebits);
+            call_new(dst_new, src, blur, LEN, amount, scalebits);
+            if (memcmp(dst_ref, dst_new, LEN))
+                fail();
+        }
+        bench_new(dst_new, src, blur, LEN, 1 << 16, 8);
+    }
+}
+
+static void check_box_slide(const BlurDSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, uint8_t,  add,     [LEN]);
+    LOCAL_ALIGNED(32, uint8_t,  sub,     [LEN]);
+    LOCAL_ALIGNED(32, uint16_t, sum_ref, [LEN]);
+    LOCAL_ALIGNED(32, uint16_t, sum_new, [LEN]);
+
+    declare_func(void, uint16_t *sum, const uint8_t *add, const uint8_t *sub, int len);
+
+    if (check_func(dsp->box_slide, "blur_box_slide")) {
+        randomize_buffers(add,     LEN, 0xFF);
+        randomize_buffers(sub,     LEN, 0xFF);
+        randomize_buffers(sum_ref, LEN, 0xFFFF);
+        memcpy(sum_new, sum_ref, LEN * sizeof(*sum_ref));
+        call_ref(sum_ref, add, sub, LEN);
+        call_new(sum_new, add, sub, LEN);
+        if (memcmp(sum_ref, sum_new, LEN * sizeof(*sum_ref)))
+            fail();
+        bench_new(sum_new, add, sub, LEN);
+    }
+}
+
+static void check_box_scale(const BlurDSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, uint16_t, sum,     [LEN]);
+    LOCAL_ALIGNED(32, uint8_t,  dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, uint8_t,  dst_new, [LEN]);
+    int i, j;
+
+    declare_func(void, uint8_t *dst, const uint16_t *sum, int inv, int len);
+
+    if (check_func(dsp->box_scale, "blur_box_scale")) {
+        for (i = 0; i < 8; i++) {
+            /* the vertical boxblur pass handles radii from 1 to 127 */
+            int length = 2 * (1 + rnd() % 127) + 1;
+            int inv    = ((1 << 16) + length / 2) / length;
+
+            for (j = 0; j < LEN; j++)
+                sum[j] = rnd() % (255 * length + 1);
+            call_ref(dst_ref, sum, inv, LEN);
+            call_new(dst_new, sum, inv, LEN);
+            if (memcmp(dst_ref, dst_new, LEN))
+                fail();
+        }
+        bench_new(dst_new, sum, 6554, LEN);
+    }
+}
+
+static void check_threshold_line(const BlurDSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, uint8_t, src,     [LEN]);
+    LOCAL_ALIGNED(32, uint8_t, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, uint8_t, dst_new, [LEN]);
+    int i, j;
+
+    declare_func(void, uint8_t *dst, const uint8_t *src, int threshold, int len);
+
+    if (check_func(dsp->threshold_line, "blur_threshold_line")) {
+        for (i = 0; i < 8; i++) {
+            /* smartblur thresholds are in [-30, 30], 0 skips the call */
+            int threshold = 1 + rnd() % 30;
+
+            if (i & 1)
+                threshold = -threshold;
+            randomize_buffers(src, LEN, 0xFF);
+            for (j = 0; j < LEN; j++)
+                dst_ref[j] = av_clip_uint8(src[j] + (int)(rnd() % 129) - 64);
+            memcpy(dst_new, dst_ref, LEN);
+            call_ref(dst_ref, src, threshold, LEN);
+            call_new(dst_new, src, threshold, LEN);
+            if (memcmp(dst_ref, dst_new, LEN))
+                fail();
+        }
+        bench_new(dst_new, src, 10, LEN);
+    }
+}
+
+void checkasm_check_blurdsp(void)
+{
+    BlurDSPContext dsp;
+
+    ff_blurdsp_init(&dsp);
+
+    check_sum_pairs(&dsp);
+    check_sum_stages(&dsp);
+    report("sum");
+
+    check_unsharp_line(&dsp);
+    report("unsharp_line");
+
+    check_box_slide(&dsp);
+    check_box_scale(&dsp);
+    report("box");
+
+    check_threshold_line(&dsp);
+    report("threshold_line");
+}
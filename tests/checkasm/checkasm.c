@@ -0,0 +1,451 @@
+/*
+ * Assembly testing and benchmarking tool
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * checkasm runs every DSP function available for the running CPU against
+ * its C version, one CPU flag after the other, and reports the functions
+ * giving different results. With --bench, the cycle count of every version
+ * of the functions is printed as well.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
+#include "libavutil/random_seed.h"
+
+/* List of tests to invoke */
+static const struct {
+    const char *name;
+    void (*func)(void);
+} tests[] = {
+#if CONFIG_AVCODEC
+#if CONFIG_H264DSP
+    { "h264dsp", checkasm_check_h264dsp },
+#endif
+#if CONFIG_HEVC_DECODER
+    { "hevcdsp", checkasm_check_hevcdsp },
+#endif
+#if CONFIG_HPELDSP
+    { "hpeldsp", checkasm_check_hpeldsp },
+#endif
+#if CONFIG_VP9_DECODER
+    { "vp9dsp", checkasm_check_vp9dsp },
+#endif
+#endif
+#if CONFIG_AVFILTER
+#if CONFIG_BOXBLUR_FILTER || CONFIG_SMARTBLUR_FILTER || CONFIG_UNSHARP_FILTER
+    { "blurdsp", checkasm_check_blurdsp },
+#endif
+    { "drawutils", checkasm_check_drawutils },
+#if CONFIG_EBUR128_FILTER
+    { "f_ebur128", checkasm_check_f_ebur128 },
+#endif
+#if CONFIG_AMIX_FILTER || CONFIG_PAN_FILTER
+    { "mixdsp", checkasm_check_mixdsp },
+#endif
+#if CONFIG_SSIM_FILTER
+    { "vf_ssim", checkasm_check_vf_ssim },
+#endif
+#endif
+    { "float_dsp", checkasm_check_float_dsp },
+#if CONFIG_SWRESAMPLE
+    { "swresample", checkasm_check_swresample },
+#endif
+#if CONFIG_SWSCALE
+    { "swscale", checkasm_check_swscale },
+#endif
+    { NULL }
+};
+
+/* List of cpu flags to check, each one is tested on top of the previous ones */
+static const struct {
+    const char *name;
+    const char *suffix;
+    int flag;
+} cpus[] = {
+#if   ARCH_AARCH64
+    { "NEON",     "neon",     AV_CPU_FLAG_NEON },
+#elif ARCH_ARM
+    { "ARMV5TE",  "armv5te",  AV_CPU_FLAG_ARMV5TE },
+    { "ARMV6",    "armv6",    AV_CPU_FLAG_ARMV6 },
+    { "ARMV6T2",  "armv6t2",  AV_CPU_FLAG_ARMV6T2 },
+    { "VFP",      "vfp",      AV_CPU_FLAG_VFP },
+    { "VFPV3",    "vfp3",     AV_CPU_FLAG_VFPV3 },
+    { "NEON",     "neon",     AV_CPU_FLAG_NEON },
+#elif ARCH_PPC
+    { "ALTIVEC",  "altivec",  AV_CPU_FLAG_ALTIVEC },
+#elif ARCH_X86
+    { "MMX",      "mmx",      AV_CPU_FLAG_MMX|AV_CPU_FLAG_CMOV },
+    { "MMXEXT",   "mmxext",   AV_CPU_FLAG_MMXEXT },
+    { "3DNOW",    "3dnow",    AV_CPU_FLAG_3DNOW },
+    { "3DNOWEXT", "3dnowext", AV_CPU_FLAG_3DNOWEXT },
+    { "SSE",      "sse",      AV_CPU_FLAG_SSE },
+    { "SSE2",     "sse2",     AV_CPU_FLAG_SSE2|AV_CPU_FLAG_SSE2SLOW },
+    { "SSE3",     "sse3",     AV_CPU_FLAG_SSE3|AV_CPU_FLAG_SSE3SLOW },
+    { "SSSE3",    "ssse3",    AV_CPU_FLAG_SSSE3|AV_CPU_FLAG_ATOM },
+    { "SSE4.1",   "sse4",     AV_CPU_FLAG_SSE4 },
+    { "SSE4.2",   "sse42",    AV_CPU_FLAG_SSE42 },
+    { "AVX",      "avx",      AV_CPU_FLAG_AVX },
+    { "XOP",      "xop",      AV_CPU_FLAG_XOP },
+    { "FMA4",     "fma4",     AV_CPU_FLAG_FMA4 },
+    { "FMA3",     "fma3",     AV_CPU_FLAG_FMA3 },
+    { "AVX2",     "avx2",     AV_CPU_FLAG_AVX2 },
+#endif
+    { NULL }
+};
+
+typedef struct CheckasmFuncVersion {
+    struct CheckasmFuncVersion *next;
+    void *func;
+    int ok;
+    int cpu;
+    int iterations;
+    uint64_t cycles;
+} CheckasmFuncVersion;
+
+/* The functions are kept in a list sorted by name */
+typedef struct CheckasmFunc {
+    struct CheckasmFunc *next;
+    CheckasmFuncVersion versions;
+    char name[1];
+} CheckasmFunc;
+
+/* Internal state */
+static struct {
+    CheckasmFunc *funcs;
+    CheckasmFunc *current_func;
+    CheckasmFuncVersion *current_func_ver;
+    const char *current_test_name;
+    const char *test_name;
+    const char *bench_pattern;
+    int bench_pattern_len;
+    int num_checked;
+    int num_failed;
+    int cpu_flag;
+    const char *cpu_flag_name;
+} state;
+
+/* PRNG state */
+AVLFG checkasm_lfg;
+
+static void *checkasm_malloc(size_t size)
+{
+    void *ptr = av_mallocz(size);
+    if (!ptr) {
+        fprintf(stderr, "checkasm: malloc failed\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+/* Get the suffix of the specified cpu flag */
+static const char *cpu_suffix(int cpu)
+{
+    int i = FF_ARRAY_ELEMS(cpus) - 1;
+
+    while (--i >= 0)
+        if (cpu & cpus[i].flag)
+            return cpus[i].suffix;
+
+    return "c";
+}
+
+/* Print the name of the current CPU flag, but only do it once */
+static void print_cpu_name(void)
+{
+    if (state.cpu_flag_name) {
+        fprintf(stderr, "%s:\n", state.cpu_flag_name);
+        state.cpu_flag_name = NULL;
+    }
+}
+
+int float_near_abs_eps(float a, float b, float eps)
+{
+    float abs_diff = fabsf(a - b);
+
+    return abs_diff < eps;
+}
+
+int float_near_abs_eps_array(const float *a, const float *b, float eps,
+                             unsigned len)
+{
+    unsigned i;
+
+    for (i = 0; i < len; i++)
+        if (!float_near_abs_eps(a[i], b[i], eps))
+            return 0;
+    return 1;
+}
+
+int double_near_abs_eps(double a, double b, double eps)
+{
+    double abs_diff = fabs(a - b);
+
+    return abs_diff < eps;
+}
+
+#ifdef AV_READ_TIME
+/* Print the average cycle count of every version of the functions */
+static void print_benchs(CheckasmFunc *f)
+{
+    for (; f; f = f->next) {
+        CheckasmFuncVersion *v = &f->versions;
+
+        if (strncmp(f->name, state.bench_pattern, state.bench_pattern_len))
+            continue;
+        do {
+            if (v->iterations)
+                printf("%s_%s: %.1f\n", f->name, cpu_suffix(v->cpu),
+                       v->cycles / (4.0 * v->iterations));
+        } while ((v = v->next));
+    }
+}
+#endif
+
+/* Get a pointer to the function with the specified name, create it if
+ * necessary */
+static CheckasmFunc *get_func(const char *name)
+{
+    CheckasmFunc **f = &state.funcs, *new;
+    int cmp = 1;
+
+    while (*f && (cmp = strcmp((*f)->name, name)) < 0)
+        f = &(*f)->next;
+    if (!cmp)
+        return *f;
+
+    new = checkasm_malloc(sizeof(*new) + strlen(name));
+    strcpy(new->name, name);
+    new->next = *f;
+    *f = new;
+    return new;
+}
+
+static void destroy_funcs(CheckasmFunc *f)
+{
+    while (f) {
+        CheckasmFunc *next = f->next;
+        CheckasmFuncVersion *v = f->versions.next;
+
+        while (v) {
+            CheckasmFuncVersion *next_ver = v->next;
+            av_free(v);
+            v = next_ver;
+        }
+        av_free(f);
+        f = next;
+    }
+}
+
+/* Perform tests and benchmarks for the specified cpu flag if supported
+ * by the host */
+static void check_cpu_flag(const char *name, int flag)
+{
+    int old_cpu_flag = state.cpu_flag;
+
+    flag |= old_cpu_flag;
+    av_force_cpu_flags(-1);
+    state.cpu_flag = flag & av_get_cpu_flags();
+    av_force_cpu_flags(state.cpu_flag);
+
+    if (!flag || state.cpu_flag != old_cpu_flag) {
+        int i;
+
+        state.cpu_flag_name = name;
+        for (i = 0; tests[i].func; i++) {
+            if (state.test_name && strcmp(tests[i].name, state.test_name))
+                continue;
+            state.current_test_name = tests[i].name;
+            tests[i].func();
+        }
+    }
+}
+
+static void usage(const char *name)
+{
+    int i;
+
+    fprintf(stderr, "usage: %s [--bench[=<pattern>]] [--test=<name>] [seed]\n"
+            "tests:", name);
+    for (i = 0; tests[i].func; i++)
+        fprintf(stderr, " %s", tests[i].name);
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned seed = av_get_random_seed();
+    int i, ret = 0;
+
+    for (i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (!strncmp(arg, "--bench", 7)) {
+#ifndef AV_READ_TIME
+            fprintf(stderr, "checkasm: --bench is not supported on this platform\n");
+            return 1;
+#endif
+            state.bench_pattern = arg[7] == '=' ? arg + 8 : "";
+            state.bench_pattern_len = strlen(state.bench_pattern);
+        } else if (!strncmp(arg, "--test=", 7)) {
+            state.test_name = arg + 7;
+        } else if (arg[0] >= '0' && arg[0] <= '9') {
+            seed = strtoul(arg, NULL, 10);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    fprintf(stderr, "checkasm: using random seed %u\n", seed);
+    av_lfg_init(&checkasm_lfg, seed);
+
+    check_cpu_flag(NULL, 0);
+    for (i = 0; cpus[i].flag; i++)
+        check_cpu_flag(cpus[i].name, cpus[i].flag);
+
+    if (state.num_failed) {
+        fprintf(stderr, "checkasm: %d of %d tests have failed\n",
+                state.num_failed, state.num_checked);
+        ret = 1;
+    } else {
+        fprintf(stderr, "checkasm: all %d tests passed\n", state.num_checked);
+#ifdef AV_READ_TIME
+        if (state.bench_pattern)
+            print_benchs(state.funcs);
+#endif
+    }
+
+    destroy_funcs(state.funcs);
+    return ret;
+}
+
+/* Decide whether or not the specified function needs to be tested and
+ * allocate/initialize data structures if needed. Returns a pointer to a
+ * reference function if the function should be tested, otherwise NULL */
+void *checkasm_check_func(void *func, const char *name, ...)
+{
+    char name_buf[256];
+    void *ref = func;
+    CheckasmFuncVersion *v;
+    int name_length;
+    va_list arg;
+
+    va_start(arg, name);
+    name_length = vsnprintf(name_buf, sizeof(name_buf), name, arg);
+    va_end(arg);
+
+    if (!func || name_length <= 0 || name_length >= sizeof(name_buf))
+        return NULL;
+
+    state.current_func = get_func(name_buf);
+    v = &state.current_func->versions;
+
+    if (v->func) {
+        CheckasmFuncVersion *prev;
+        do {
+            /* Only test functions that haven't already been tested */
+            if (v->func == func)
+                return NULL;
+
+            if (v->ok)
+                ref = v->func;
+
+            prev = v;
+        } while ((v = v->next));
+
+        v = prev->next = checkasm_malloc(sizeof(CheckasmFuncVersion));
+    }
+
+    v->func = func;
+    v->ok   = 1;
+    v->cpu  = state.cpu_flag;
+    state.current_func_ver = v;
+
+    if (state.cpu_flag)
+        state.num_checked++;
+
+    return ref;
+}
+
+/* Decide whether or not the current function needs to be benchmarked */
+int checkasm_bench_func(void)
+{
+    return !state.num_failed && state.bench_pattern &&
+           !strncmp(state.current_func->name, state.bench_pattern,
+                    state.bench_pattern_len);
+}
+
+/* Indicate that the current test has failed */
+void checkasm_fail_func(const char *msg, ...)
+{
+    if (state.current_func_ver->cpu && state.current_func_ver->ok) {
+        va_list arg;
+
+        print_cpu_name();
+        fprintf(stderr, "   %s_%s (", state.current_func->name,
+                cpu_suffix(state.current_func_ver->cpu));
+        va_start(arg, msg);
+        vfprintf(stderr, msg, arg);
+        va_end(arg);
+        fprintf(stderr, ")\n");
+
+        state.current_func_ver->ok = 0;
+        state.num_failed++;
+    }
+}
+
+/* Update benchmark results of the current function */
+void checkasm_update_bench(int iterations, uint64_t cycles)
+{
+    state.current_func_ver->iterations += iterations;
+    state.current_func_ver->cycles     += cycles;
+}
+
+/* Print the outcome of all tests performed since the last time this
+ * function was called */
+void checkasm_report(const char *name, ...)
+{
+    static int prev_checked, prev_failed;
+
+    if (state.num_checked > prev_checked) {
+        char name_buf[256];
+        va_list arg;
+
+        va_start(arg, name);
+        vsnprintf(name_buf, sizeof(name_buf), name, arg);
+        va_end(arg);
+
+        print_cpu_name();
+        fprintf(stderr, " - %s.%-*s [%s]\n", state.current_test_name,
+                FFMAX(36 - (int)strlen(state.current_test_name), 0), name_buf,
+                state.num_failed == prev_failed ? "OK" : "FAILED");
+
+        prev_checked = state.num_checked;
+        prev_failed  = state.num_failed;
+    }
+}
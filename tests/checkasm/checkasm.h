@@ -0,0 +1,115 @@
+/*
+ * Assembly testing and benchmarking tool
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef TESTS_CHECKASM_CHECKASM_H
+#define TESTS_CHECKASM_CHECKASM_H
+
+#include <stdint.h>
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/avstring.h"
+#include "libavutil/internal.h"
+#include "libavutil/lfg.h"
+#include "libavutil/timer.h"
+
+void checkasm_check_blurdsp(void);
+void checkasm_check_drawutils(void);
+void checkasm_check_f_ebur128(void);
+void checkasm_check_float_dsp(void);
+void checkasm_check_h264dsp(void);
+void checkasm_check_hevcdsp(void);
+void checkasm_check_hpeldsp(void);
+void checkasm_check_mixdsp(void);
+void checkasm_check_swresample(void);
+void checkasm_check_swscale(void);
+void checkasm_check_vf_ssim(void);
+void checkasm_check_vp9dsp(void);
+
+void *checkasm_check_func(void *func, const char *name, ...) av_printf_format(2, 3);
+int checkasm_bench_func(void);
+void checkasm_fail_func(const char *msg, ...) av_printf_format(1, 2);
+void checkasm_update_bench(int iterations, uint64_t cycles);
+void checkasm_report(const char *name, ...) av_printf_format(1, 2);
+
+int float_near_abs_eps(float a, float b, float eps);
+int float_near_abs_eps_array(const float *a, const float *b, float eps,
+                             unsigned len);
+int double_near_abs_eps(double a, double b, double eps);
+
+extern AVLFG checkasm_lfg;
+#define rnd() av_lfg_get(&checkasm_lfg)
+
+static av_unused void *func_ref, *func_new;
+
+#define BENCH_RUNS 1000 /* Trade-off between accuracy and speed */
+
+/* Decide whether or not the specified function needs to be tested, the
+ * remaining arguments form the printf-style name of the function */
+#define check_func(func, ...) (func_ref = checkasm_check_func((func_new = func), __VA_ARGS__))
+
+/* Declare the function prototype. The first argument is the return value,
+ * the remaining arguments are the function parameters. */
+#define declare_func(ret, ...) typedef ret func_type(__VA_ARGS__)
+
+/* Indicate that the current test has failed */
+#define fail() checkasm_fail_func("%s:%d", av_basename(__FILE__), __LINE__)
+
+/* Print the test outcome */
+#define report checkasm_report
+
+/* Call the reference function. MMX functions leave the FPU state to the
+ * caller, so tests of such functions call emms_c() after the calls. */
+#define call_ref(...) ((func_type *)func_ref)(__VA_ARGS__)
+
+/* Call the function */
+#define call_new(...) ((func_type *)func_new)(__VA_ARGS__)
+
+#ifdef AV_READ_TIME
+/* Benchmark the function, the function is called 4 times per measurement
+ * and the measurements far above the running average are discarded, as
+ * they were most likely interrupted. */
+#define bench_new(...)\
+    do {\
+        if (checkasm_bench_func()) {\
+            func_type *tfunc = func_new;\
+            uint64_t tsum = 0;\
+            int ti, tcount = 0;\
+            for (ti = 0; ti < BENCH_RUNS; ti++) {\
+                uint64_t t = AV_READ_TIME();\
+                tfunc(__VA_ARGS__);\
+                tfunc(__VA_ARGS__);\
+                tfunc(__VA_ARGS__);\
+                tfunc(__VA_ARGS__);\
+                t = AV_READ_TIME() - t;\
+                if (!tcount || t * tcount <= tsum * 4) {\
+                    tsum += t;\
+                    tcount++;\
+                }\
+            }\
+            emms_c();\
+            checkasm_update_bench(tcount, tsum);\
+        }\
+    } while (0)
+#else
+#define bench_new(...) while(0)
+#endif
+
+#endif /* TESTS_CHECKASM_CHECKASM_H */
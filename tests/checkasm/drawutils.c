@@ -0,0 +1,68 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavfilter/drawutils.h"
+#include "libavutil/mem.h"
+
+/* not a multiple of any SIMD width, so that the C tails are run as well */
+#define LEN 1023
+
+static void check_blend_row(const FFDrawContext *draw)
+{
+    LOCAL_ALIGNED(32, uint8_t, mask,    [LEN]);
+    LOCAL_ALIGNED(32, uint8_t, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, uint8_t, dst_new, [LEN]);
+    int i, j;
+
+    declare_func(void, uint8_t *dst, const uint8_t *mask,
+                 unsigned src, unsigned alpha, int w);
+
+    if (check_func(draw->blend_row, "blend_row")) {
+        for (i = 0; i < 8; i++) {
+            /* opaque and transparent colors, then random ones */
+            unsigned alpha = i < 2 ? (i ? 0x10203 : 0) : rnd() % 0x10204;
+            unsigned src   = rnd() & 0xFF;
+
+            for (j = 0; j < LEN; j++) {
+                /* fully covered and empty pixels are the most common */
+                mask[j]    = j & 3 ? rnd() : j & 4 ? 0xFF : 0;
+                dst_ref[j] = rnd();
+            }
+            memcpy(dst_new, dst_ref, LEN);
+            call_ref(dst_ref, mask, src, alpha, LEN);
+            call_new(dst_new, mask, src, alpha, LEN);
+            if (memcmp(dst_ref, dst_new, LEN))
+                fail();
+        }
+        bench_new(dst_new, mask, 0x80, 0x8000, LEN);
+    }
+}
+
+void checkasm_check_drawutils(void)
+{
+    FFDrawContext draw;
+
+    if (ff_draw_init(&draw, AV_PIX_FMT_YUV420P, 0) < 0)
+        return;
+
+    check_blend_row(&draw);
+    report("blend_row");
+}
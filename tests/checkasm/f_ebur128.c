@@ -0,0 +1,83 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavfilter/f_ebur128.h"
+#include "libavutil/mem.h"
+
+#define MAX_CHANNELS 8
+#define LEN          479
+#define STATE_SIZE   (6 * EBUR128_STATE_STRIDE)
+
+/* All versions are meant to be bit-exact, the bound only covers x87 excess
+ * precision in the C version. */
+#define EPS 1.0e-9
+
+static double rnd_sample(void)
+{
+    return (int32_t)rnd() / (double)(1U << 31);
+}
+
+static int check_doubles(const double *a, const double *b, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++)
+        if (!double_near_abs_eps(a[i], b[i], EPS))
+            return 0;
+    return 1;
+}
+
+void checkasm_check_f_ebur128(void)
+{
+    LOCAL_ALIGNED(32, double, samples,    [LEN * MAX_CHANNELS]);
+    LOCAL_ALIGNED(32, double, state_ref,  [STATE_SIZE]);
+    LOCAL_ALIGNED(32, double, state_new,  [STATE_SIZE]);
+    LOCAL_ALIGNED(32, double, energy_ref, [EBUR128_STATE_STRIDE]);
+    LOCAL_ALIGNED(32, double, energy_new, [EBUR128_STATE_STRIDE]);
+    EBUR128DSPContext dsp;
+    int ch, i;
+
+    declare_func(void, double *energy, double *state, const double *samples,
+                 int stride, int nb_channels, int nb_samples);
+
+    ff_ebur128_dsp_init(&dsp);
+
+    if (check_func(dsp.filter_channels, "ebur128_filter_channels")) {
+        /* odd and even channel counts, in a wider interleaved buffer */
+        for (ch = 1; ch <= MAX_CHANNELS; ch++) {
+            for (i = 0; i < LEN * MAX_CHANNELS; i++)
+                samples[i] = rnd_sample();
+            for (i = 0; i < STATE_SIZE; i++)
+                state_ref[i] = rnd_sample();
+            for (i = 0; i < EBUR128_STATE_STRIDE; i++)
+                energy_ref[i] = rnd() % 100;
+            memcpy(state_new,  state_ref,  sizeof(*state_ref)  * STATE_SIZE);
+            memcpy(energy_new, energy_ref, sizeof(*energy_ref) * EBUR128_STATE_STRIDE);
+            call_ref(energy_ref, state_ref, samples, MAX_CHANNELS, ch, LEN);
+            call_new(energy_new, state_new, samples, MAX_CHANNELS, ch, LEN);
+            if (!check_doubles(energy_ref, energy_new, EBUR128_STATE_STRIDE) ||
+                !check_doubles(state_ref,  state_new,  STATE_SIZE))
+                fail();
+        }
+        bench_new(energy_new, state_new, samples, 2, 2, LEN);
+    }
+    report("filter_channels");
+}
@@ -0,0 +1,313 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavutil/float_dsp.h"
+#include "libavutil/mem.h"
+
+#define LEN 256
+
+/* The SIMD versions may use fused multiply-adds or sum in a different
+ * order, so the results are only compared within these bounds */
+#define EPS      1.0e-5
+#define EPS_PROD 1.0e-3
+
+static void check_vector_fmul(const AVFloatDSPContext *fdsp,
+                              const float *src0, const float *src1)
+{
+    LOCAL_ALIGNED(32, float, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, float, dst_new, [LEN]);
+
+    declare_func(void, float *dst, const float *src0, const float *src1, int len);
+
+    if (check_func(fdsp->vector_fmul, "vector_fmul")) {
+        call_ref(dst_ref, src0, src1, LEN);
+        call_new(dst_new, src0, src1, LEN);
+        if (!float_near_abs_eps_array(dst_ref, dst_new, EPS, LEN))
+            fail();
+        bench_new(dst_new, src0, src1, LEN);
+    }
+}
+
+/* vector_fadd only needs 16-byte alignment, the inputs are offset by 4 */
+static void check_vector_fadd(const AVFloatDSPContext *fdsp,
+                              const float *src0, const float *src1)
+{
+    LOCAL_ALIGNED(32, float, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, float, dst_new, [LEN]);
+
+    declare_func(void, float *dst, const float *src0, const float *src1, int len);
+
+    if (check_func(fdsp->vector_fadd, "vector_fadd")) {
+        call_ref(dst_ref, src0 + 4, src1 + 4, LEN - 16);
+        call_new(dst_new, src0 + 4, src1 + 4, LEN - 16);
+        if (!float_near_abs_eps_array(dst_ref, dst_new, EPS, LEN - 16))
+            fail();
+        bench_new(dst_new, src0 + 4, src1 + 4, LEN - 16);
+    }
+}
+
+static void check_vector_fmac_scalar(const AVFloatDSPContext *fdsp,
+                                     const float *src, float mul)
+{
+    LOCAL_ALIGNED(32, float, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, float, dst_new, [LEN]);
+
+    declare_func(void, float *dst, const float *src, float mul, int len);
+
+    if (check_func(fdsp->vector_fmac_scalar, "vector_fmac_scalar")) {
+        memset(dst_ref, 0, LEN * sizeof(*dst_ref));
+        memset(dst_new, 0, LEN * sizeof(*dst_new));
+        call_ref(dst_ref, src, mul, LEN);
+        call_new(dst_new, src, mul, LEN);
+        if (!float_near_abs_eps_array(dst_ref, dst_new, EPS, LEN))
+            fail();
+        bench_new(dst_new, src, mul, LEN);
+    }
+}
+
+static void check_vector_fmul_scalar(const AVFloatDSPContext *fdsp,
+                                     const float *src, float mul)
+{
+    LOCAL_ALIGNED(32, float, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, float, dst_new, [LEN]);
+
+    declare_func(void, float *dst, const float *src, float mul, int len);
+
+    if (check_func(fdsp->vector_fmul_scalar, "vector_fmul_scalar")) {
+        call_ref(dst_ref, src, mul, LEN);
+        call_new(dst_new, src, mul, LEN);
+        if (!float_near_abs_eps_array(dst_ref, dst_new, EPS, LEN))
+            fail();
+        bench_new(dst_new, src, mul, LEN);
+    }
+}
+
+static void check_vector_dmul_scalar(const AVFloatDSPContext *fdsp,
+                                     const double *src, double mul)
+{
+    LOCAL_ALIGNED(32, double, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, double, dst_new, [LEN]);
+    int i;
+
+    declare_func(void, double *dst, const double *src, double mul, int len);
+
+    if (check_func(fdsp->vector_dmul_scalar, "vector_dmul_scalar")) {
+        call_ref(dst_ref, src, mul, LEN);
+        call_new(dst_new, src, mul, LEN);
+        for (i = 0; i < LEN; i++) {
+            if (!double_near_abs_eps(dst_ref[i], dst_new[i], EPS)) {
+                fail();
+                break;
+            }
+        }
+        bench_new(dst_new, src, mul, LEN);
+    }
+}
+
+static void check_vector_dmul(const AVFloatDSPContext *fdsp,
+                              const double *src0, const double *src1)
+{
+    LOCAL_ALIGNED(32, double, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, double, dst_new, [LEN]);
+    int i;
+
+    declare_func(void, double *dst, const double *src0, const double *src1, int len);
+
+    if (check_func(fdsp->vector_dmul, "vector_dmul")) {
+        call_ref(dst_ref, src0, src1, LEN);
+        call_new(dst_new, src0, src1, LEN);
+        for (i = 0; i < LEN; i++) {
+            if (!double_near_abs_eps(dst_ref[i], dst_new[i], EPS)) {
+                fail();
+                break;
+            }
+        }
+        bench_new(dst_new, src0, src1, LEN);
+    }
+}
+
+static void check_vector_dmac_scalar(const AVFloatDSPContext *fdsp,
+                                     const double *src, double mul)
+{
+    LOCAL_ALIGNED(32, double, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, double, dst_new, [LEN]);
+    int i;
+
+    declare_func(void, double *dst, const double *src, double mul, int len);
+
+    if (check_func(fdsp->vector_dmac_scalar, "vector_dmac_scalar")) {
+        for (i = 0; i < LEN; i++)
+            dst_ref[i] = dst_new[i] = src[LEN - 1 - i];
+        call_ref(dst_ref, src, mul, LEN);
+        call_new(dst_new, src, mul, LEN);
+        for (i = 0; i < LEN; i++) {
+            if (!double_near_abs_eps(dst_ref[i], dst_new[i], EPS)) {
+                fail();
+                break;
+            }
+        }
+        bench_new(dst_new, src, mul, LEN);
+    }
+}
+
+static void check_vector_fmul_window(const AVFloatDSPContext *fdsp,
+                                     const float *src0, const float *src1,
+                                     const float *win)
+{
+    LOCAL_ALIGNED(32, float, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, float, dst_new, [LEN]);
+
+    declare_func(void, float *dst, const float *src0, const float *src1,
+                 const float *win, int len);
+
+    if (check_func(fdsp->vector_fmul_window, "vector_fmul_window")) {
+        call_ref(dst_ref, src0, src1, win, LEN / 2);
+        call_new(dst_new, src0, src1, win, LEN / 2);
+        if (!float_near_abs_eps_array(dst_ref, dst_new, EPS, LEN))
+            fail();
+        bench_new(dst_new, src0, src1, win, LEN / 2);
+    }
+}
+
+static void check_vector_fmul_add(const AVFloatDSPContext *fdsp,
+                                  const float *src0, const float *src1,
+                                  const float *src2)
+{
+    LOCAL_ALIGNED(32, float, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, float, dst_new, [LEN]);
+
+    declare_func(void, float *dst, const float *src0, const float *src1,
+                 const float *src2, int len);
+
+    if (check_func(fdsp->vector_fmul_add, "vector_fmul_add")) {
+        call_ref(dst_ref, src0, src1, src2, LEN);
+        call_new(dst_new, src0, src1, src2, LEN);
+        if (!float_near_abs_eps_array(dst_ref, dst_new, EPS, LEN))
+            fail();
+        bench_new(dst_new, src0, src1, src2, LEN);
+    }
+}
+
+static void check_vector_fmul_reverse(const AVFloatDSPContext *fdsp,
+                                      const float *src0, const float *src1)
+{
+    LOCAL_ALIGNED(32, float, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, float, dst_new, [LEN]);
+
+    declare_func(void, float *dst, const float *src0, const float *src1, int len);
+
+    if (check_func(fdsp->vector_fmul_reverse, "vector_fmul_reverse")) {
+        call_ref(dst_ref, src0, src1, LEN);
+        call_new(dst_new, src0, src1, LEN);
+        if (!float_near_abs_eps_array(dst_ref, dst_new, EPS, LEN))
+            fail();
+        bench_new(dst_new, src0, src1, LEN);
+    }
+}
+
+static void check_butterflies_float(const AVFloatDSPContext *fdsp,
+                                    const float *src0, const float *src1)
+{
+    LOCAL_ALIGNED(32, float, v1_ref, [LEN]);
+    LOCAL_ALIGNED(32, float, v2_ref, [LEN]);
+    LOCAL_ALIGNED(32, float, v1_new, [LEN]);
+    LOCAL_ALIGNED(32, float, v2_new, [LEN]);
+
+    declare_func(void, float *av_restrict v1, float *av_restrict v2, int len);
+
+    if (check_func(fdsp->butterflies_float, "butterflies_float")) {
+        memcpy(v1_ref, src0, LEN * sizeof(*src0));
+        memcpy(v2_ref, src1, LEN * sizeof(*src1));
+        memcpy(v1_new, src0, LEN * sizeof(*src0));
+        memcpy(v2_new, src1, LEN * sizeof(*src1));
+        call_ref(v1_ref, v2_ref, LEN);
+        call_new(v1_new, v2_new, LEN);
+        if (!float_near_abs_eps_array(v1_ref, v1_new, EPS, LEN) ||
+            !float_near_abs_eps_array(v2_ref, v2_new, EPS, LEN))
+            fail();
+        bench_new(v1_new, v2_new, LEN);
+    }
+}
+
+static void check_scalarproduct_float(const AVFloatDSPContext *fdsp,
+                                      const float *src0, const float *src1)
+{
+    float res_ref, res_new;
+
+    declare_func(float, const float *v1, const float *v2, int len);
+
+    if (check_func(fdsp->scalarproduct_float, "scalarproduct_float")) {
+        res_ref = call_ref(src0, src1, LEN);
+        res_new = call_new(src0, src1, LEN);
+        if (!float_near_abs_eps(res_ref, res_new, EPS_PROD))
+            fail();
+        bench_new(src0, src1, LEN);
+    }
+}
+
+void checkasm_check_float_dsp(void)
+{
+    LOCAL_ALIGNED(32, float,  src0, [LEN]);
+    LOCAL_ALIGNED(32, float,  src1, [LEN]);
+    LOCAL_ALIGNED(32, float,  src2, [LEN]);
+    LOCAL_ALIGNED(32, double, dbl,  [LEN]);
+    LOCAL_ALIGNED(32, double, dbl2, [LEN]);
+    AVFloatDSPContext fdsp;
+    int i, strict;
+
+    for (i = 0; i < LEN; i++) {
+        src0[i] = (double)rnd() / (UINT_MAX >> 1) - 1.0;
+        src1[i] = (double)rnd() / (UINT_MAX >> 1) - 1.0;
+        src2[i] = (double)rnd() / (UINT_MAX >> 1) - 1.0;
+        dbl[i]  = (double)rnd() / (UINT_MAX >> 1) - 1.0;
+        dbl2[i] = (double)rnd() / (UINT_MAX >> 1) - 1.0;
+    }
+
+    /* the FMA3 versions are only used when bit-exactness is not required */
+    for (strict = 1; strict >= 0; strict--) {
+        avpriv_float_dsp_init(&fdsp, strict);
+
+        check_vector_fmul(&fdsp, src0, src1);
+        report("vector_fmul");
+        check_vector_fadd(&fdsp, src0, src1);
+        report("vector_fadd");
+        check_vector_fmac_scalar(&fdsp, src0, src1[0]);
+        report("vector_fmac_scalar");
+        check_vector_fmul_scalar(&fdsp, src0, src1[0]);
+        report("vector_fmul_scalar");
+        check_vector_dmul(&fdsp, dbl, dbl2);
+        report("vector_dmul");
+        check_vector_dmul_scalar(&fdsp, dbl, dbl[1]);
+        report("vector_dmul_scalar");
+        check_vector_dmac_scalar(&fdsp, dbl, dbl2[0]);
+        report("vector_dmac_scalar");
+        check_vector_fmul_window(&fdsp, src0, src1, src2);
+        report("vector_fmul_window");
+        check_vector_fmul_add(&fdsp, src0, src1, src2);
+        report("vector_fmul_add");
+        check_vector_fmul_reverse(&fdsp, src0, src1);
+        report("vector_fmul_reverse");
+        check_butterflies_float(&fdsp, src0, src1);
+        report("butterflies_float");
+        check_scalarproduct_float(&fdsp, src0, src1);
+        report("scalarproduct_float");
+    }
+}
@@ -0,0 +1,672 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavcodec/h264.h"
+#include "libavcodec/h264dsp.h"
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+
+/* 32x32 pixels of up to 2 bytes */
+#define STRIDE    64
+#define BUF_SIZE (STRIDE * 32)
+
+static const int bit_depths[] = { 8, 9, 10 };
+
+#define randomize_pixels(buf, bit_depth)                        \
+    do {                                                        \
+        int i;                                                  \
+        uint32_t mask = (1 << (bit_depth)) - 1;                 \
+        if ((bit_depth) > 8) {                                  \
+            for (i = 0; i < BUF_SIZE; i += 2)                   \
+                AV_WN16A(buf + i, rnd() & mask);                \
+        } else {                                                \
+            for (i = 0; i < BUF_SIZE; i++)                      \
+                buf[i] = rnd();                                 \
+        }                                                       \
+    } while (0)
+
+/* Smooth content around the middle of the range, so that the loop filters
+ * actually modify the edges */
+#define randomize_edges(buf, bit_depth)                         \
+    do {                                                        \
+        int i, shift = (bit_depth) - 8;                         \
+        for (i = 0; i < BUF_SIZE; i += 1 + ((bit_depth) > 8)) { \
+            int v = (128 + (int)(rnd() % 9) - 4) << shift;      \
+            if ((bit_depth) > 8)                                \
+                AV_WN16A(buf + i, v);                           \
+            else                                                \
+                buf[i] = v;                                     \
+        }                                                       \
+    } while (0)
+
+/* Coefficients in [-128, 127], the high bit depth blocks hold 32-bit
+ * coefficients */
+static void randomize_coeffs(uint8_t *block, int nb_coeffs, int bit_depth)
+{
+    int i;
+
+    for (i = 0; i < nb_coeffs; i++) {
+        int v = (int)(rnd() & 0xFF) - 128;
+        if (bit_depth > 8)
+            ((int32_t *)block)[i] = v;
+        else
+            ((int16_t *)block)[i] = v;
+    }
+}
+
+static void check_idct(int bit_depth)
+{
+    LOCAL_ALIGNED_16(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, coef, [64 * 4]);
+    LOCAL_ALIGNED_16(uint8_t, block0, [64 * 4]);
+    LOCAL_ALIGNED_16(uint8_t, block1, [64 * 4]);
+    H264DSPContext h;
+    int sz, dc;
+
+    declare_func(void, uint8_t *dst, int16_t *block, int stride);
+
+    ff_h264dsp_init(&h, bit_depth, 1);
+
+    for (sz = 4; sz <= 8; sz += 4) {
+        for (dc = 0; dc < 2; dc++) {
+            void (*func)(uint8_t *, int16_t *, int) =
+                sz == 4 ? dc ? h.h264_idct_dc_add  : h.h264_idct_add
+                        : dc ? h.h264_idct8_dc_add : h.h264_idct8_add;
+            int block_size = sz * sz * (bit_depth > 8 ? 4 : 2);
+
+            if (!check_func(func, "h264_idct%s%s_add_%dbpp", sz == 8 ? "8" : "",
+                            dc ? "_dc" : "", bit_depth))
+                continue;
+
+            randomize_pixels(dst0, bit_depth);
+            memcpy(dst1, dst0, BUF_SIZE);
+            /* the DC versions are only called for blocks with a single
+             * DC coefficient, some SIMD versions are the full transform */
+            memset(coef, 0, block_size);
+            randomize_coeffs(coef, dc ? 1 : sz * sz, bit_depth);
+            memcpy(block0, coef, block_size);
+            memcpy(block1, coef, block_size);
+
+            call_ref(dst0, (int16_t *)block0, STRIDE);
+            call_new(dst1, (int16_t *)block1, STRIDE);
+            emms_c();
+            if (memcmp(dst0, dst1, BUF_SIZE) ||
+                memcmp(block0, block1, block_size))
+                fail();
+            bench_new(dst1, (int16_t *)block1, STRIDE);
+        }
+    }
+}
+
+/* Fill the 4x4 (or 8x8 for size 8) blocks of a macroblock and their
+ * non-zero counts as the decoder does: a block is either empty, holds a
+ * lone DC or AC coefficient, or is fully coded with a count above 1.
+ * The DC coefficients of the intra 16x16 and chroma blocks are coded
+ * separately, so that they can be set with a count of 0 when uncoded_dc
+ * is set. */
+static void randomize_blocks(uint8_t *coef, uint8_t *nnzc, int size,
+                             int uncoded_dc, int bit_depth)
+{
+    int coef_size = bit_depth > 8 ? 4 : 2, nb_coeffs = size * size;
+    int i, n;
+
+    memset(coef, 0, 48 * 16 * coef_size);
+    memset(nnzc, 0, 15 * 8);
+
+    for (n = 0; n < 48; n += nb_coeffs / 16) {
+        uint8_t *block = coef + n * 16 * coef_size;
+
+        switch (rnd() % 4) {
+        case 1:
+            randomize_coeffs(block, 1, bit_depth);
+            nnzc[scan8[n]] = uncoded_dc ? rnd() & 1 : 1;
+            break;
+        case 2:
+            i = 1 + rnd() % (nb_coeffs - 1);
+            randomize_coeffs(block + i * coef_size, 1, bit_depth);
+            nnzc[scan8[n]] = 1;
+            break;
+        case 3:
+            randomize_coeffs(block, nb_coeffs, bit_depth);
+            nnzc[scan8[n]] = 2 + rnd() % 15;
+            break;
+        }
+    }
+}
+
+static void check_idct_multiple(int bit_depth)
+{
+    LOCAL_ALIGNED_16(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, coef, [48 * 16 * 4]);
+    LOCAL_ALIGNED_16(uint8_t, block0, [48 * 16 * 4]);
+    LOCAL_ALIGNED_16(uint8_t, block1, [48 * 16 * 4]);
+    uint8_t nnzc[15 * 8];
+    int block_offset[64];
+    int coef_bytes = 48 * 16 * (bit_depth > 8 ? 4 : 2);
+    H264DSPContext h;
+    int i, chroma_format_idc;
+
+    for (i = 0; i < 16; i++) {
+        int x = (scan8[i] - scan8[0]) & 7, y = (scan8[i] - scan8[0]) >> 3;
+        block_offset[i] = block_offset[16 + i] = block_offset[32 + i] =
+            4 * x * (1 + (bit_depth > 8)) + 4 * y * STRIDE;
+    }
+
+    for (chroma_format_idc = 1; chroma_format_idc <= 2; chroma_format_idc++) {
+        static const struct {
+            const char *name;
+            size_t func;
+            int size, uncoded_dc;
+        } funcs[] = {
+#define IDCT(name, size, uncoded_dc) \
+            { #name, offsetof(H264DSPContext, h264_ ## name), size, uncoded_dc }
+            IDCT(idct_add16,      4, 0),
+            IDCT(idct_add16intra, 4, 1),
+            IDCT(idct8_add4,      8, 0),
+#undef IDCT
+        };
+        const char *suffix = chroma_format_idc == 2 ? "_422" : "";
+
+        ff_h264dsp_init(&h, bit_depth, chroma_format_idc);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(funcs); i++) {
+            void *func = *(void **)((uint8_t *)&h + funcs[i].func);
+            declare_func(void, uint8_t *dst, const int *block_offset,
+                         int16_t *block, int stride, const uint8_t nnzc[15 * 8]);
+
+            if (!check_func(func, "h264_%s_%dbpp", funcs[i].name, bit_depth))
+                continue;
+
+            randomize_pixels(dst0, bit_depth);
+            memcpy(dst1, dst0, BUF_SIZE);
+            randomize_blocks(coef, nnzc, funcs[i].size, funcs[i].uncoded_dc,
+                             bit_depth);
+            memcpy(block0, coef, coef_bytes);
+            memcpy(block1, coef, coef_bytes);
+
+            call_ref(dst0, block_offset, (int16_t *)block0, STRIDE, nnzc);
+            call_new(dst1, block_offset, (int16_t *)block1, STRIDE, nnzc);
+            emms_c();
+            if (memcmp(dst0, dst1, BUF_SIZE) || memcmp(block0, block1, coef_bytes))
+                fail();
+            bench_new(dst1, block_offset, (int16_t *)block1, STRIDE, nnzc);
+        }
+
+        {
+            /* the two chroma planes side by side */
+            uint8_t *dest0[2] = { dst0, dst0 + STRIDE / 2 };
+            uint8_t *dest1[2] = { dst1, dst1 + STRIDE / 2 };
+            declare_func(void, uint8_t **dst, const int *block_offset,
+                         int16_t *block, int stride, const uint8_t nnzc[15 * 8]);
+
+            if (check_func(h.h264_idct_add8, "h264_idct_add8%s_%dbpp",
+                           suffix, bit_depth)) {
+                randomize_pixels(dst0, bit_depth);
+                memcpy(dst1, dst0, BUF_SIZE);
+                randomize_blocks(coef, nnzc, 4, 1, bit_depth);
+                memcpy(block0, coef, coef_bytes);
+                memcpy(block1, coef, coef_bytes);
+
+                call_ref(dest0, block_offset, (int16_t *)block0, STRIDE, nnzc);
+                call_new(dest1, block_offset, (int16_t *)block1, STRIDE, nnzc);
+                emms_c();
+                if (memcmp(dst0, dst1, BUF_SIZE) || memcmp(block0, block1, coef_bytes))
+                    fail();
+                bench_new(dest1, block_offset, (int16_t *)block1, STRIDE, nnzc);
+            }
+        }
+    }
+}
+
+/* Dequantization factors as set up with the flat scaling matrices */
+static int random_qmul(void)
+{
+    static const uint8_t dequant_init[6] = { 10, 11, 13, 14, 16, 18 };
+
+    return dequant_init[rnd() % 6] * 16 << (rnd() % 9);
+}
+
+static void check_dc_dequant_idct(int bit_depth)
+{
+    LOCAL_ALIGNED_16(uint8_t, input0, [16 * 4]);
+    LOCAL_ALIGNED_16(uint8_t, input1, [16 * 4]);
+    LOCAL_ALIGNED_16(uint8_t, output0, [256 * 4]);
+    LOCAL_ALIGNED_16(uint8_t, output1, [256 * 4]);
+    int coef_size = bit_depth > 8 ? 4 : 2;
+    H264DSPContext h;
+    int i, chroma_format_idc;
+
+    ff_h264dsp_init(&h, bit_depth, 1);
+
+    {
+        declare_func(void, int16_t *output, int16_t *input, int qmul);
+
+        if (check_func(h.h264_luma_dc_dequant_idct,
+                       "h264_luma_dc_dequant_idct_%dbpp", bit_depth)) {
+            int qmul = random_qmul();
+            /* the 16 coefficients are summed before the scaling, keep the
+             * output in the range of the coefficients */
+            int max = FFMIN(1024, (32767 << 8) / (16 * qmul));
+
+            for (i = 0; i < 16; i++) {
+                int v = (int)(rnd() % (2 * max + 1)) - max;
+                if (coef_size == 4)
+                    ((int32_t *)input0)[i] = v;
+                else
+                    ((int16_t *)input0)[i] = v;
+            }
+            memcpy(input1, input0, 16 * coef_size);
+            for (i = 0; i < 256 * 4; i++)
+                output0[i] = rnd();
+            memcpy(output1, output0, 256 * 4);
+
+            call_ref((int16_t *)output0, (int16_t *)input0, qmul);
+            call_new((int16_t *)output1, (int16_t *)input1, qmul);
+            emms_c();
+            if (memcmp(output0, output1, 256 * 4) ||
+                memcmp(input0, input1, 16 * coef_size))
+                fail();
+            bench_new((int16_t *)output1, (int16_t *)input1, qmul);
+        }
+    }
+
+    for (chroma_format_idc = 1; chroma_format_idc <= 2; chroma_format_idc++) {
+        declare_func(void, int16_t *block, int qmul);
+
+        ff_h264dsp_init(&h, bit_depth, chroma_format_idc);
+
+        if (check_func(h.h264_chroma_dc_dequant_idct,
+                       "h264_chroma%s_dc_dequant_idct_%dbpp",
+                       chroma_format_idc == 2 ? "422" : "", bit_depth)) {
+            int qmul = random_qmul();
+            int max = FFMIN(1024, (32767 << 7) / (8 * qmul));
+
+            memset(output0, 0, 256 * 4);
+            /* the DC coefficients of the 4x4 blocks of 8 rows of chroma */
+            for (i = 0; i < 8; i++) {
+                int v = (int)(rnd() % (2 * max + 1)) - max;
+                if (coef_size == 4)
+                    ((int32_t *)output0)[16 * i] = v;
+                else
+                    ((int16_t *)output0)[16 * i] = v;
+            }
+            memcpy(output1, output0, 256 * 4);
+
+            call_ref((int16_t *)output0, qmul);
+            call_new((int16_t *)output1, qmul);
+            emms_c();
+            if (memcmp(output0, output1, 256 * 4))
+                fail();
+            bench_new((int16_t *)output1, qmul);
+        }
+    }
+}
+
+static void check_add_pixels(int bit_depth)
+{
+    LOCAL_ALIGNED_16(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, block0, [64 * 4]);
+    LOCAL_ALIGNED_16(uint8_t, block1, [64 * 4]);
+    H264DSPContext h;
+    int sz;
+
+    declare_func(void, uint8_t *dst, int16_t *block, int stride);
+
+    ff_h264dsp_init(&h, bit_depth, 1);
+
+    for (sz = 4; sz <= 8; sz += 4) {
+        int block_size = sz * sz * (bit_depth > 8 ? 4 : 2);
+
+        /* the same version is used for all bit depths above 8 */
+        if (!check_func(sz == 4 ? h.h264_add_pixels4_clear : h.h264_add_pixels8_clear,
+                        "h264_add_pixels%d_clear_%dbpp", sz, bit_depth > 8 ? 16 : 8))
+            continue;
+
+        randomize_pixels(dst0, bit_depth);
+        memcpy(dst1, dst0, BUF_SIZE);
+        randomize_coeffs(block0, sz * sz, bit_depth);
+        memcpy(block1, block0, block_size);
+
+        call_ref(dst0, (int16_t *)block0, STRIDE);
+        call_new(dst1, (int16_t *)block1, STRIDE);
+        emms_c();
+        if (memcmp(dst0, dst1, BUF_SIZE) || memcmp(block0, block1, block_size))
+            fail();
+        bench_new(dst1, (int16_t *)block1, STRIDE);
+    }
+}
+
+static void check_weight(int bit_depth)
+{
+    LOCAL_ALIGNED_16(uint8_t, src,  [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [BUF_SIZE]);
+    H264DSPContext h;
+    int i;
+
+    ff_h264dsp_init(&h, bit_depth, 1);
+
+    for (i = 0; i < 4; i++) {
+        int width      = 16 >> i;
+        int log2_denom = rnd() % 8;
+        int weight     = (int)(rnd() % 256) - 128;
+        int weights    = (int)(rnd() % 128) - 64;
+        int weightd    = (int)(rnd() % 128) - 64;
+        int offset     = (int)(rnd() % 256) - 128;
+
+        {
+            declare_func(void, uint8_t *block, int stride, int height,
+                         int log2_denom, int weight, int offset);
+
+            if (check_func(h.weight_h264_pixels_tab[i], "h264_weight_%d_%dbpp",
+                           width, bit_depth)) {
+                randomize_pixels(dst0, bit_depth);
+                memcpy(dst1, dst0, BUF_SIZE);
+                call_ref(dst0, STRIDE, width, log2_denom, weight, offset);
+                call_new(dst1, STRIDE, width, log2_denom, weight, offset);
+                emms_c();
+                if (memcmp(dst0, dst1, BUF_SIZE))
+                    fail();
+                bench_new(dst1, STRIDE, width, log2_denom, weight, offset);
+            }
+        }
+        {
+            declare_func(void, uint8_t *dst, uint8_t *src, int stride,
+                         int height, int log2_denom, int weightd,
+                         int weights, int offset);
+
+            if (check_func(h.biweight_h264_pixels_tab[i],
+                           "h264_biweight_%d_%dbpp", width, bit_depth)) {
+                randomize_pixels(src, bit_depth);
+                randomize_pixels(dst0, bit_depth);
+                memcpy(dst1, dst0, BUF_SIZE);
+                call_ref(dst0, src, STRIDE, width, log2_denom, weightd, weights, offset);
+                call_new(dst1, src, STRIDE, width, log2_denom, weightd, weights, offset);
+                emms_c();
+                if (memcmp(dst0, dst1, BUF_SIZE))
+                    fail();
+                bench_new(dst1, src, STRIDE, width, log2_denom, weightd, weights, offset);
+            }
+        }
+    }
+}
+
+static void check_loop_filter(int bit_depth, int chroma_format_idc)
+{
+    LOCAL_ALIGNED_16(uint8_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, buf1, [BUF_SIZE]);
+    H264DSPContext h;
+    int8_t tc0[4];
+    int i, alpha, beta;
+    /* pixel (8, 8), leaving room for the taps on all sides */
+    int offset = 8 * STRIDE + 8 * (1 + (bit_depth > 8));
+
+    /* chroma422 is set for the filters with a 4:2:2 version */
+    static const struct {
+        const char *name;
+        size_t func;
+        int intra;
+        int chroma422;
+    } filters[] = {
+#define FILTER(name, intra, chroma422) \
+        { #name, offsetof(H264DSPContext, h264_ ## name), intra, chroma422 }
+        FILTER(v_loop_filter_luma,               0, 0),
+        FILTER(h_loop_filter_luma,               0, 0),
+        FILTER(h_loop_filter_luma_mbaff,         0, 0),
+        FILTER(v_loop_filter_luma_intra,         1, 0),
+        FILTER(h_loop_filter_luma_intra,         1, 0),
+        FILTER(h_loop_filter_luma_mbaff_intra,   1, 0),
+        FILTER(v_loop_filter_chroma,             0, 0),
+        FILTER(h_loop_filter_chroma,             0, 1),
+        FILTER(h_loop_filter_chroma_mbaff,       0, 1),
+        FILTER(v_loop_filter_chroma_intra,       1, 0),
+        FILTER(h_loop_filter_chroma_intra,       1, 1),
+        FILTER(h_loop_filter_chroma_mbaff_intra, 1, 1),
+#undef FILTER
+    };
+
+    ff_h264dsp_init(&h, bit_depth, chroma_format_idc);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(filters); i++) {
+        void *func = *(void **)((uint8_t *)&h + filters[i].func);
+        const char *suffix = chroma_format_idc == 2 && filters[i].chroma422 ? "_422" : "";
+
+        alpha = 16 + rnd() % 32;
+        beta  =  8 + rnd() % 16;
+        tc0[0] = (int)(rnd() % 5) - 1;
+        tc0[1] =  rnd() % 4;
+        tc0[2] =  rnd() % 4;
+        tc0[3] =  rnd() % 4;
+
+        if (filters[i].intra) {
+            declare_func(void, uint8_t *pix, int stride, int alpha, int beta);
+
+            if (check_func(func, "h264_%s%s_%dbpp", filters[i].name, suffix, bit_depth)) {
+                randomize_edges(buf0, bit_depth);
+                memcpy(buf1, buf0, BUF_SIZE);
+                call_ref(buf0 + offset, STRIDE, alpha, beta);
+                call_new(buf1 + offset, STRIDE, alpha, beta);
+                emms_c();
+                if (memcmp(buf0, buf1, BUF_SIZE))
+                    fail();
+                bench_new(buf1 + offset, STRIDE, alpha, beta);
+            }
+        } else {
+            declare_func(void, uint8_t *pix, int stride, int alpha, int beta,
+                         int8_t *tc0);
+
+            if (check_func(func, "h264_%s%s_%dbpp", filters[i].name, suffix, bit_depth)) {
+                randomize_edges(buf0, bit_depth);
+                memcpy(buf1, buf0, BUF_SIZE);
+                call_ref(buf0 + offset, STRIDE, alpha, beta, tc0);
+                call_new(buf1 + offset, STRIDE, alpha, beta, tc0);
+                emms_c();
+                if (memcmp(buf0, buf1, BUF_SIZE))
+                    fail();
+                bench_new(buf1 + offset, STRIDE, alpha, beta, tc0);
+            }
+        }
+    }
+}
+
+static int mv_differ(const int16_t *a, const int16_t *b, int mvy_limit)
+{
+    return a[0] - b[0] + 3 >= 7U || FFABS(a[1] - b[1]) >= mvy_limit;
+}
+
+/* There is no C version of h264_loop_filter_strength, the decoder computes
+ * the strengths inline instead. This reference follows the semantics of the
+ * SIMD versions: the motion vectors are checked for the edges not masked by
+ * mask_mv, the others keep the result of the previous vertical edge and
+ * are zero for the horizontal ones, and coded coefficients give a strength
+ * of 2. */
+static void loop_filter_strength_ref(int16_t bs[2][4][4], uint8_t nnz[40],
+                                     int8_t ref[2][40], int16_t mv[2][40][2],
+                                     int bidir, int edges, int step,
+                                     int mask_mv0, int mask_mv1, int field)
+{
+    int mvy_limit = field ? 2 : 4;
+    int v[4] = { 0 };
+    int dir, edge, i;
+
+    for (dir = 1; dir >= 0; dir--) {
+        int d_idx     = dir ? -8       : -1;
+        int nb_edges  = dir ? edges    :  4;
+        int edge_step = dir ? step     :  1;
+        int mask_mv   = dir ? mask_mv1 : mask_mv0;
+
+        /* the vertical edges are computed one row of blocks at a time */
+        for (edge = 0; edge < nb_edges; edge += edge_step) {
+            for (i = 0; i < 4; i++) {
+                int b = 12 + 8 * edge + i, bn = b + d_idx;
+
+                if (!(edge & mask_mv)) {
+                    v[i] = ref[0][b] != ref[0][bn] ||
+                           mv_differ(mv[0][b], mv[0][bn], mvy_limit);
+                    if (bidir) {
+                        int cross = ref[0][b] != ref[1][bn] ||
+                                    ref[1][b] != ref[0][bn] ||
+                                    mv_differ(mv[0][b], mv[1][bn], mvy_limit) ||
+                                    mv_differ(mv[1][b], mv[0][bn], mvy_limit);
+                        v[i] = (v[i] || ref[1][b] != ref[1][bn] ||
+                                mv_differ(mv[1][b], mv[1][bn], mvy_limit)) && cross;
+                    }
+                } else if (dir) {
+                    v[i] = 0;
+                }
+
+                if (dir)
+                    bs[1][edge][i] = nnz[b] || nnz[bn] ? 2 : v[i];
+                else
+                    bs[0][i][edge] = nnz[b] || nnz[bn] ? 2 : v[i];
+            }
+        }
+    }
+}
+
+static void check_loop_filter_strength(void)
+{
+    LOCAL_ALIGNED_16(int16_t, bs0, [2], [4][4]);
+    LOCAL_ALIGNED_16(int16_t, bs1, [2], [4][4]);
+    LOCAL_ALIGNED_16(int16_t, mv, [2], [40][2]);
+    LOCAL_ALIGNED_16(int8_t, ref, [2], [40]);
+    LOCAL_ALIGNED_16(uint8_t, nnz, [40]);
+    H264DSPContext h;
+    int bidir, edges, step, mask_mv0, mask_mv1, field;
+    int i, j, n;
+
+    declare_func(void, int16_t bs[2][4][4], uint8_t nnz[40],
+                 int8_t ref[2][40], int16_t mv[2][40][2],
+                 int bidir, int edges, int step,
+                 int mask_mv0, int mask_mv1, int field);
+
+    ff_h264dsp_init(&h, 8, 1);
+
+    if (!check_func(h.h264_loop_filter_strength, "h264_loop_filter_strength"))
+        return;
+
+    for (n = 0; n < 64; n++) {
+        bidir    = rnd() & 1;
+        edges    = rnd() & 1 ? 4 : 1;
+        step     = 1 + (rnd() & 1);
+        mask_mv0 = rnd() & 1 ? 3 : 0;
+        mask_mv1 = rnd() & 1;
+        field    = rnd() & 1;
+
+        /* mostly close motion vectors and few references, so that all the
+         * comparisons have both outcomes */
+        for (i = 0; i < 40; i++) {
+            nnz[i] = rnd() % 3 ? 0 : 1 + rnd() % 16;
+            for (j = 0; j < 2; j++) {
+                int range = rnd() % 8 ? 8 : 2048;
+                ref[j][i]   = (int)(rnd() % 4) - 1;
+                mv[j][i][0] = (int)(rnd() % (2 * range)) - range;
+                mv[j][i][1] = (int)(rnd() % (2 * range)) - range;
+            }
+        }
+        for (i = 0; i < 4; i++)
+            for (j = 0; j < 4; j++)
+                bs0[0][i][j] = bs0[1][i][j] = rnd() % 5;
+        memcpy(bs1, bs0, sizeof(int16_t) * 2 * 4 * 4);
+
+        loop_filter_strength_ref(bs0, nnz, ref, mv, bidir, edges, step,
+                                 mask_mv0, mask_mv1, field);
+        call_new(bs1, nnz, ref, mv, bidir, edges, step,
+                 mask_mv0, mask_mv1, field);
+        emms_c();
+        if (memcmp(bs0, bs1, sizeof(int16_t) * 2 * 4 * 4)) {
+            fail();
+            break;
+        }
+    }
+    bench_new(bs1, nnz, ref, mv, 1, 4, 1, 0, 0, 0);
+}
+
+static void check_find_start_code(void)
+{
+    LOCAL_ALIGNED_16(uint8_t, buf, [BUF_SIZE]);
+    H264DSPContext h;
+    int i, n, size, res0, res1;
+
+    declare_func(int, const uint8_t *buf, int size);
+
+    ff_h264dsp_init(&h, 8, 1);
+
+    if (!check_func(h.h264_find_start_code_candidate, "h264_find_start_code_candidate"))
+        return;
+
+    for (n = 0; n < 16; n++) {
+        /* the buffers are padded, as the bitstream buffers of the decoder */
+        size = rnd() % (BUF_SIZE - 64);
+        for (i = 0; i < BUF_SIZE; i++)
+            buf[i] = rnd() % 64 ? 1 + rnd() % 255 : 0;
+
+        res0 = call_ref(buf, size);
+        res1 = call_new(buf, size);
+        emms_c();
+        /* any index past the end means that there is no zero byte */
+        if (FFMIN(res0, size) != FFMIN(res1, size)) {
+            fail();
+            break;
+        }
+    }
+    bench_new(buf, BUF_SIZE - 64);
+}
+
+void checkasm_check_h264dsp(void)
+{
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++)
+        check_idct(bit_depths[i]);
+    report("idct");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++)
+        check_idct_multiple(bit_depths[i]);
+    report("idct_multiple");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++)
+        check_dc_dequant_idct(bit_depths[i]);
+    report("dc_dequant_idct");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++)
+        check_add_pixels(bit_depths[i]);
+    report("add_pixels");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++)
+        check_weight(bit_depths[i]);
+    report("weight");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        check_loop_filter(bit_depths[i], 1);
+        check_loop_filter(bit_depths[i], 2);
+    }
+    report("loop_filter");
+
+    check_loop_filter_strength();
+    report("loop_filter_strength");
+
+    check_find_start_code();
+    report("find_start_code");
+}
@@ -0,0 +1,263 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavcodec/hevc.h"
+#include "libavcodec/hevcdsp.h"
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+
+/* 64x64 pixels of up to 2 bytes */
+#define PIXEL_STRIDE (2 * MAX_PB_SIZE)
+#define PIXEL_SIZE   (PIXEL_STRIDE * MAX_PB_SIZE)
+
+/* the MC source has 3 pixels before and 4 after the block in both
+ * directions */
+#define SRC_STRIDE   (2 * (MAX_PB_SIZE + 16))
+#define SRC_SIZE     (SRC_STRIDE * (MAX_PB_SIZE + 8))
+#define SRC_OFFSET(bit_depth) (3 * SRC_STRIDE + 3 * ((bit_depth) > 8 ? 2 : 1))
+
+/* the MC and weighted prediction intermediates */
+#define MC_SIZE      (MAX_PB_SIZE * MAX_PB_SIZE)
+
+/* width and height of the MC blocks */
+#define MC_BLOCK 16
+
+static const int bit_depths[] = { 8, 10 };
+
+static void randomize_pixels(uint8_t *buf, int size, int bit_depth)
+{
+    uint32_t mask = (1 << bit_depth) - 1;
+    int i;
+
+    if (bit_depth > 8) {
+        for (i = 0; i < size; i += 2)
+            AV_WN16A(buf + i, rnd() & mask);
+    } else {
+        for (i = 0; i < size; i++)
+            buf[i] = rnd();
+    }
+}
+
+static void randomize_int16(int16_t *buf, int size, int mask, int bias)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        buf[i] = (int)(rnd() & mask) - bias;
+}
+
+static void check_transform(const HEVCDSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_16(uint8_t, dst0, [PIXEL_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [PIXEL_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, coeffs,  [32 * 32]);
+    LOCAL_ALIGNED_16(int16_t, coeffs0, [32 * 32]);
+    LOCAL_ALIGNED_16(int16_t, coeffs1, [32 * 32]);
+    int i, j;
+
+    declare_func(void, uint8_t *dst, int16_t *coeffs, ptrdiff_t stride);
+
+    for (i = 0; i < 10; i++) {
+        void (*func)(uint8_t *, int16_t *, ptrdiff_t);
+        const char *name;
+        int size;
+
+        if (i < 4) {
+            func = h->transform_add[i];
+            name = "transform_add";
+            size = 4 << i;
+        } else if (i < 8) {
+            func = h->transquant_bypass[i - 4];
+            name = "transquant_bypass";
+            size = 4 << (i - 4);
+        } else {
+            func = i == 8 ? h->transform_skip : h->transform_4x4_luma_add;
+            name = i == 8 ? "transform_skip" : "transform_4x4_luma_add";
+            size = 4;
+        }
+
+        if (!check_func(func, "hevc_%s%dx%d_%d", name, size, size, bit_depth))
+            continue;
+
+        randomize_pixels(dst0, PIXEL_SIZE, bit_depth);
+        memcpy(dst1, dst0, PIXEL_SIZE);
+        randomize_int16(coeffs, size * size, 1023, 512);
+        for (j = 0; j < size * size; j++)
+            coeffs0[j] = coeffs1[j] = coeffs[j];
+
+        call_ref(dst0, coeffs0, PIXEL_STRIDE);
+        call_new(dst1, coeffs1, PIXEL_STRIDE);
+        emms_c();
+        if (memcmp(dst0, dst1, PIXEL_SIZE))
+            fail();
+        bench_new(dst1, coeffs1, PIXEL_STRIDE);
+    }
+}
+
+static void check_mc(const HEVCDSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_16(uint8_t, src, [SRC_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, dst0, [MC_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, dst1, [MC_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, mcbuffer, [(MAX_PB_SIZE + 7) * MAX_PB_SIZE]);
+    int i, j;
+
+    randomize_pixels(src, SRC_SIZE, bit_depth);
+
+    {
+        declare_func(void, int16_t *dst, ptrdiff_t dststride, uint8_t *src,
+                     ptrdiff_t srcstride, int width, int height,
+                     int16_t *mcbuffer);
+
+        for (i = 0; i < 4; i++) {
+            for (j = 0; j < 4; j++) {
+                if (!check_func(h->put_hevc_qpel[i][j], "put_hevc_qpel_h%dv%d_%d",
+                                j, i, bit_depth))
+                    continue;
+
+                memset(dst0, 0, MC_SIZE * sizeof(*dst0));
+                memset(dst1, 0, MC_SIZE * sizeof(*dst1));
+                call_ref(dst0, MAX_PB_SIZE, src + SRC_OFFSET(bit_depth),
+                         SRC_STRIDE, MC_BLOCK, MC_BLOCK, mcbuffer);
+                call_new(dst1, MAX_PB_SIZE, src + SRC_OFFSET(bit_depth),
+                         SRC_STRIDE, MC_BLOCK, MC_BLOCK, mcbuffer);
+                emms_c();
+                if (memcmp(dst0, dst1, MC_SIZE * sizeof(*dst0)))
+                    fail();
+                bench_new(dst1, MAX_PB_SIZE, src + SRC_OFFSET(bit_depth),
+                          SRC_STRIDE, MC_BLOCK, MC_BLOCK, mcbuffer);
+            }
+        }
+    }
+    {
+        declare_func(void, int16_t *dst, ptrdiff_t dststride, uint8_t *src,
+                     ptrdiff_t srcstride, int width, int height,
+                     int mx, int my, int16_t *mcbuffer);
+
+        for (i = 0; i < 2; i++) {
+            for (j = 0; j < 2; j++) {
+                int mx = j ? 1 + rnd() % 7 : 0;
+                int my = i ? 1 + rnd() % 7 : 0;
+
+                if (!check_func(h->put_hevc_epel[i][j], "put_hevc_epel_%s_%d",
+                                i ? j ? "hv" : "v" : j ? "h" : "pixels",
+                                bit_depth))
+                    continue;
+
+                memset(dst0, 0, MC_SIZE * sizeof(*dst0));
+                memset(dst1, 0, MC_SIZE * sizeof(*dst1));
+                call_ref(dst0, MAX_PB_SIZE, src + SRC_OFFSET(bit_depth),
+                         SRC_STRIDE, MC_BLOCK, MC_BLOCK, mx, my, mcbuffer);
+                call_new(dst1, MAX_PB_SIZE, src + SRC_OFFSET(bit_depth),
+                         SRC_STRIDE, MC_BLOCK, MC_BLOCK, mx, my, mcbuffer);
+                emms_c();
+                if (memcmp(dst0, dst1, MC_SIZE * sizeof(*dst0)))
+                    fail();
+                bench_new(dst1, MAX_PB_SIZE, src + SRC_OFFSET(bit_depth),
+                          SRC_STRIDE, MC_BLOCK, MC_BLOCK, mx, my, mcbuffer);
+            }
+        }
+    }
+}
+
+static void check_weighted_pred(const HEVCDSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_16(int16_t, src0, [MC_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, src1, [MC_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst0, [PIXEL_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [PIXEL_SIZE]);
+    int denom = rnd() % 8;
+    int w0 = (int)(rnd() % 256) - 128, w1 = (int)(rnd() % 256) - 128;
+    int o0 = (int)(rnd() % 256) - 128, o1 = (int)(rnd() % 256) - 128;
+
+    /* the MC output range */
+    randomize_int16(src0, MC_SIZE, 0x3FFF, 0);
+    randomize_int16(src1, MC_SIZE, 0x3FFF, 0);
+
+#define CHECK_PRED(name, ...)                                               \
+    if (check_func(h->name, #name "_%d", bit_depth)) {                      \
+        randomize_pixels(dst0, PIXEL_SIZE, bit_depth);                      \
+        memcpy(dst1, dst0, PIXEL_SIZE);                                     \
+        call_ref(__VA_ARGS__ dst0, PIXEL_STRIDE, src0, ARGS);               \
+        call_new(__VA_ARGS__ dst1, PIXEL_STRIDE, src0, ARGS);               \
+        emms_c();                                                           \
+        if (memcmp(dst0, dst1, PIXEL_SIZE))                                 \
+            fail();                                                         \
+        bench_new(__VA_ARGS__ dst1, PIXEL_STRIDE, src0, ARGS);              \
+    }
+
+    {
+        declare_func(void, uint8_t *dst, ptrdiff_t dststride, int16_t *src,
+                     ptrdiff_t srcstride, int width, int height);
+#define ARGS MAX_PB_SIZE, MC_BLOCK, MC_BLOCK
+        CHECK_PRED(put_unweighted_pred,)
+#undef ARGS
+    }
+    {
+        declare_func(void, uint8_t *dst, ptrdiff_t dststride, int16_t *src1,
+                     int16_t *src2, ptrdiff_t srcstride, int width, int height);
+#define ARGS src1, MAX_PB_SIZE, MC_BLOCK, MC_BLOCK
+        CHECK_PRED(put_weighted_pred_avg,)
+#undef ARGS
+    }
+    {
+        declare_func(void, uint8_t denom, int16_t wlxFlag, int16_t olxFlag,
+                     uint8_t *dst, ptrdiff_t dststride, int16_t *src,
+                     ptrdiff_t srcstride, int width, int height);
+#define ARGS MAX_PB_SIZE, MC_BLOCK, MC_BLOCK
+        CHECK_PRED(weighted_pred, denom, w0, o0,)
+#undef ARGS
+    }
+    {
+        declare_func(void, uint8_t denom, int16_t wl0Flag, int16_t wl1Flag,
+                     int16_t ol0Flag, int16_t ol1Flag, uint8_t *dst,
+                     ptrdiff_t dststride, int16_t *src1, int16_t *src2,
+                     ptrdiff_t srcstride, int width, int height);
+#define ARGS src1, MAX_PB_SIZE, MC_BLOCK, MC_BLOCK
+        CHECK_PRED(weighted_pred_avg, denom, w0, w1, o0, o1,)
+#undef ARGS
+    }
+#undef CHECK_PRED
+}
+
+void checkasm_check_hevcdsp(void)
+{
+    HEVCDSPContext h;
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        ff_hevc_dsp_init(&h, bit_depths[i]);
+        check_transform(&h, bit_depths[i]);
+    }
+    report("transform");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        ff_hevc_dsp_init(&h, bit_depths[i]);
+        check_mc(&h, bit_depths[i]);
+    }
+    report("mc");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        ff_hevc_dsp_init(&h, bit_depths[i]);
+        check_weighted_pred(&h, bit_depths[i]);
+    }
+    report("weighted_pred");
+}
@@ -0,0 +1,112 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavcodec/avcodec.h"
+#include "libavcodec/hpeldsp.h"
+#include "libavutil/common.h"
+
+#define STRIDE    32
+/* 16x16 block plus one row and column for the half-pel positions */
+#define SRC_SIZE (STRIDE * 17)
+#define DST_SIZE (STRIDE * 16)
+
+#define randomize_buffer(buf, size)     \
+    do {                                \
+        int j;                          \
+        for (j = 0; j < size; j++)      \
+            buf[j] = rnd();             \
+    } while (0)
+
+static int bytes_near(const uint8_t *a, const uint8_t *b, int size, int eps)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        if (FFABS(a[i] - b[i]) > eps)
+            return 0;
+    return 1;
+}
+
+static void check_tab(op_pixels_func (*tab)[4], int nb_sizes, const char *name,
+                      int eps)
+{
+    LOCAL_ALIGNED_16(uint8_t, src,  [SRC_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst0, [DST_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [DST_SIZE]);
+    static const char *const pos[4] = { "", "_x2", "_y2", "_xy2" };
+    int i, j, h;
+
+    declare_func(void, uint8_t *block, const uint8_t *pixels,
+                 ptrdiff_t line_size, int h);
+
+    for (i = 0; i < nb_sizes; i++) {
+        int size = 16 >> i;
+
+        for (j = 0; j < 4; j++) {
+            if (!check_func(tab[i][j], "%s_pixels%d%s", name, size, pos[j]))
+                continue;
+
+            /* the height is either the width or half of it */
+            for (h = size; h >= FFMIN(size, 4) && h >= size / 2; h >>= 1) {
+                randomize_buffer(src,  SRC_SIZE);
+                randomize_buffer(dst0, DST_SIZE);
+                memcpy(dst1, dst0, DST_SIZE);
+                /* an odd source address, as with the real motion vectors */
+                call_ref(dst0, src + 1, STRIDE, h);
+                call_new(dst1, src + 1, STRIDE, h);
+                emms_c();
+                if (!bytes_near(dst0, dst1, DST_SIZE, eps)) {
+                    fail();
+                    break;
+                }
+            }
+            bench_new(dst1, src + 1, STRIDE, size);
+        }
+    }
+}
+
+void checkasm_check_hpeldsp(void)
+{
+    HpelDSPContext h;
+    op_pixels_func avg_no_rnd[1][4];
+
+    /* the approximations of some SIMD versions are disabled when bitexact */
+    ff_hpeldsp_init(&h, CODEC_FLAG_BITEXACT);
+
+    check_tab(h.put_pixels_tab, 4, "put", 0);
+    report("put_pixels");
+    check_tab(h.avg_pixels_tab, 4, "avg", 0);
+    report("avg_pixels");
+    check_tab(h.put_no_rnd_pixels_tab, 2, "put_no_rnd", 0);
+    report("put_no_rnd_pixels");
+
+    memcpy(avg_no_rnd[0], h.avg_no_rnd_pixels_tab, sizeof(avg_no_rnd[0]));
+    check_tab(avg_no_rnd, 1, "avg_no_rnd", 0);
+    report("avg_no_rnd_pixels");
+
+    /* the approximations chain PAVGB, each pixel may be off by one */
+    ff_hpeldsp_init(&h, 0);
+
+    check_tab(h.put_no_rnd_pixels_tab, 2, "put_no_rnd_approx", 1);
+    report("put_no_rnd_pixels_approx");
+    check_tab(h.avg_pixels_tab, 4, "avg_approx", 1);
+    report("avg_pixels_approx");
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavfilter/mixdsp.h"
+#include "libavutil/mem.h"
+
+/* not a multiple of any SIMD width, so that the C tails are run as well */
+#define LEN 1023
+
+static void check_mix_s16(const MixDSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, int16_t, src,     [LEN]);
+    LOCAL_ALIGNED(32, int32_t, acc_ref, [LEN]);
+    LOCAL_ALIGNED(32, int32_t, acc_new, [LEN]);
+    int i, j;
+
+    declare_func(void, int32_t *acc, const int16_t *src, int gain, int len);
+
+    if (check_func(dsp->mix_s16, "mix_s16")) {
+        for (i = 0; i < 8; i++) {
+            /* full scale gains, the first ones being the extremes */
+            int gain = i < 2 ? (i ? -65534 : 65534)
+                             : (int)(rnd() % 131069) - 65534;
+
+            for (j = 0; j < LEN; j++) {
+                src[j]     = rnd();
+                acc_ref[j] = (int)(rnd() & 0xFFFF) - 0x8000;
+            }
+            memcpy(acc_new, acc_ref, LEN * sizeof(*acc_ref));
+            call_ref(acc_ref, src, gain, LEN);
+            call_new(acc_new, src, gain, LEN);
+            if (memcmp(acc_ref, acc_new, LEN * sizeof(*acc_ref)))
+                fail();
+        }
+        bench_new(acc_new, src, 1 << 14, LEN);
+    }
+}
+
+static void check_pack_s16(const MixDSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, int32_t, acc,     [LEN]);
+    LOCAL_ALIGNED(32, int16_t, dst_ref, [LEN]);
+    LOCAL_ALIGNED(32, int16_t, dst_new, [LEN]);
+    int shift, j;
+
+    declare_func(void, int16_t *dst, const int32_t *acc, int shift, int len);
+
+    if (check_func(dsp->pack_s16, "mix_pack_s16")) {
+        for (shift = 0; shift <= 15; shift++) {
+            /* half of the samples in range, the others mostly saturating */
+            for (j = 0; j < LEN; j++)
+                acc[j] = (int32_t)rnd() >> (rnd() & 1 ? 1 : 16 - shift);
+            call_ref(dst_ref, acc, shift, LEN);
+            call_new(dst_new, acc, shift, LEN);
+            if (memcmp(dst_ref, dst_new, LEN * sizeof(*dst_ref)))
+                fail();
+        }
+        bench_new(dst_new, acc, 15, LEN);
+    }
+}
+
+void checkasm_check_mixdsp(void)
+{
+    MixDSPContext dsp;
+
+    ff_mixdsp_init(&dsp);
+
+    check_mix_s16(&dsp);
+    report("mix_s16");
+
+    check_pack_s16(&dsp);
+    report("pack_s16");
+}
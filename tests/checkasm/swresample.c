@@ -0,0 +1,221 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * libswresample selects its SIMD versions internally for every conversion,
+ * so the whole conversions are compared here: each one runs again whenever
+ * one of the cpu flags its dispatch depends on changes, and its output is
+ * compared to the output of the C code.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/samplefmt.h"
+#include "libswresample/swresample.h"
+
+#define IN_SAMPLES  1024
+#define OUT_SAMPLES (2 * IN_SAMPLES + 256)
+#define MAX_CH      6
+
+#define BENCH_CONVERSIONS 100
+
+typedef struct SwrTest {
+    const char *name;
+    enum AVSampleFormat in_fmt, out_fmt;
+    int64_t in_layout, out_layout;
+    int in_rate, out_rate;
+    int dither_method;
+    int cpu_flags;              ///< the cpu flags used by the dispatch
+    /** tolerance on the output samples, for the floating point versions
+     * summing in a different order and the noise shaping error feedback */
+    double eps;
+} SwrTest;
+
+static const SwrTest tests[] = {
+    { "resample_s16p", AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S16P,
+      AV_CH_LAYOUT_STEREO, AV_CH_LAYOUT_STEREO, 44100, 48000, 0,
+      AV_CPU_FLAG_MMXEXT | AV_CPU_FLAG_SSSE3 | AV_CPU_FLAG_AVX2, 0 },
+    { "resample_s32p", AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_S32P,
+      AV_CH_LAYOUT_STEREO, AV_CH_LAYOUT_STEREO, 44100, 48000, 0,
+      AV_CPU_FLAG_MMXEXT | AV_CPU_FLAG_AVX2, 0 },
+    { "resample_fltp", AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_FLTP,
+      AV_CH_LAYOUT_STEREO, AV_CH_LAYOUT_STEREO, 44100, 48000, 0,
+      AV_CPU_FLAG_MMXEXT | AV_CPU_FLAG_AVX | AV_CPU_FLAG_FMA3, 1.0e-5 },
+    { "resample_dblp", AV_SAMPLE_FMT_DBLP, AV_SAMPLE_FMT_DBLP,
+      AV_CH_LAYOUT_STEREO, AV_CH_LAYOUT_STEREO, 44100, 48000, 0,
+      AV_CPU_FLAG_MMXEXT | AV_CPU_FLAG_AVX | AV_CPU_FLAG_FMA3, 1.0e-10 },
+    { "rematrix_s16p", AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S16P,
+      AV_CH_LAYOUT_5POINT1, AV_CH_LAYOUT_STEREO, 48000, 48000, 0,
+      AV_CPU_FLAG_SSE | AV_CPU_FLAG_SSE2 | AV_CPU_FLAG_AVX, 0 },
+    { "rematrix_fltp", AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_FLTP,
+      AV_CH_LAYOUT_5POINT1, AV_CH_LAYOUT_STEREO, 48000, 48000, 0,
+      AV_CPU_FLAG_SSE | AV_CPU_FLAG_SSE2 | AV_CPU_FLAG_AVX, 1.0e-5 },
+    { "dither_rectangular", AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_S16P,
+      AV_CH_LAYOUT_STEREO, AV_CH_LAYOUT_STEREO, 44100, 44100,
+      SWR_DITHER_RECTANGULAR, AV_CPU_FLAG_SSE2, 0 },
+    { "dither_shibata", AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_S16P,
+      AV_CH_LAYOUT_STEREO, AV_CH_LAYOUT_STEREO, 44100, 44100,
+      SWR_DITHER_NS_SHIBATA, AV_CPU_FLAG_SSE | AV_CPU_FLAG_SSE2, 2 },
+};
+
+static SwrContext *alloc_context(const SwrTest *t)
+{
+    SwrContext *s = swr_alloc_set_opts(NULL, t->out_layout, t->out_fmt,
+                                       t->out_rate, t->in_layout, t->in_fmt,
+                                       t->in_rate, 0, NULL);
+    if (!s)
+        return NULL;
+    av_opt_set_int(s, "dither_method", t->dither_method, 0);
+    av_opt_set_int(s, "threads", 1, 0);
+    if (swr_init(s) < 0)
+        swr_free(&s);
+    return s;
+}
+
+/* Convert in with the given cpu flags, the SwrContext reads them during
+ * both the initialization and the conversion */
+static int convert(const SwrTest *t, int cpu_flags, uint8_t **out,
+                   const uint8_t **in)
+{
+    int saved_flags = av_get_cpu_flags();
+    SwrContext *s;
+    int ret = AVERROR(ENOMEM);
+
+    av_force_cpu_flags(cpu_flags);
+    if ((s = alloc_context(t))) {
+        ret = swr_convert(s, out, OUT_SAMPLES, in, IN_SAMPLES);
+        swr_free(&s);
+    }
+    av_force_cpu_flags(saved_flags);
+    return ret;
+}
+
+static int compare(const SwrTest *t, uint8_t **out0, uint8_t **out1,
+                   int nb_samples)
+{
+    int nb_ch = av_get_channel_layout_nb_channels(t->out_layout);
+    int ch, i;
+
+    for (ch = 0; ch < nb_ch; ch++) {
+        for (i = 0; i < nb_samples; i++) {
+            double a, b;
+
+            switch (t->out_fmt) {
+            case AV_SAMPLE_FMT_S16P: a = ((int16_t *)out0[ch])[i]; b = ((int16_t *)out1[ch])[i]; break;
+            case AV_SAMPLE_FMT_S32P: a = ((int32_t *)out0[ch])[i]; b = ((int32_t *)out1[ch])[i]; break;
+            case AV_SAMPLE_FMT_FLTP: a = ((float   *)out0[ch])[i]; b = ((float   *)out1[ch])[i]; break;
+            default:                 a = ((double  *)out0[ch])[i]; b = ((double  *)out1[ch])[i]; break;
+            }
+            if (fabs(a - b) > t->eps)
+                return 0;
+        }
+    }
+    return 1;
+}
+
+static void randomize_input(const SwrTest *t, uint8_t **in)
+{
+    int nb_ch = av_get_channel_layout_nb_channels(t->in_layout);
+    int ch, i;
+
+    for (ch = 0; ch < nb_ch; ch++) {
+        for (i = 0; i < IN_SAMPLES; i++) {
+            /* about -6 dBFS, so that the downmix does not clip */
+            int v = (int)(rnd() & 0xFFFF) - 0x8000;
+
+            switch (t->in_fmt) {
+            case AV_SAMPLE_FMT_S16P: ((int16_t *)in[ch])[i] = v / 2;               break;
+            case AV_SAMPLE_FMT_S32P: ((int32_t *)in[ch])[i] = (v << 15) + (rnd() & 0x7FFF); break;
+            case AV_SAMPLE_FMT_FLTP: ((float   *)in[ch])[i] = v / 65536.0;         break;
+            default:                 ((double  *)in[ch])[i] = v / 65536.0;         break;
+            }
+        }
+    }
+}
+
+static void bench_convert(const SwrTest *t, uint8_t **out, const uint8_t **in)
+{
+#ifdef AV_READ_TIME
+    SwrContext *s = alloc_context(t);
+    uint64_t tsum = 0;
+    int i, j;
+
+    if (!s)
+        return;
+    for (i = 0; i < BENCH_CONVERSIONS; i++) {
+        uint64_t t0 = AV_READ_TIME();
+        for (j = 0; j < 4; j++)
+            swr_convert(s, out, OUT_SAMPLES, in, IN_SAMPLES);
+        tsum += AV_READ_TIME() - t0;
+    }
+    checkasm_update_bench(BENCH_CONVERSIONS, tsum);
+    swr_free(&s);
+#endif
+}
+
+void checkasm_check_swresample(void)
+{
+    uint8_t *in[MAX_CH], *out0[MAX_CH], *out1[MAX_CH];
+    int i, ch;
+
+    for (ch = 0; ch < MAX_CH; ch++) {
+        in[ch]   = av_malloc(IN_SAMPLES  * sizeof(double));
+        out0[ch] = av_malloc(OUT_SAMPLES * sizeof(double));
+        out1[ch] = av_malloc(OUT_SAMPLES * sizeof(double));
+        if (!in[ch] || !out0[ch] || !out1[ch]) {
+            fprintf(stderr, "checkasm: malloc failed\n");
+            goto end;
+        }
+    }
+
+    for (i = 0; i < FF_ARRAY_ELEMS(tests); i++) {
+        const SwrTest *t = &tests[i];
+        /* the dispatch is identified by the cpu flags it can see, offset
+         * so that the C version is not a NULL function */
+        int flags = av_get_cpu_flags() & t->cpu_flags;
+        int ret0, ret1;
+
+        if (!check_func((void *)(intptr_t)(flags + 1), "%s", t->name))
+            continue;
+
+        randomize_input(t, in);
+        ret0 = convert(t, 0, out0, (const uint8_t **)in);
+        ret1 = convert(t, av_get_cpu_flags(), out1, (const uint8_t **)in);
+        if (ret0 < 0 || ret0 != ret1 || !compare(t, out0, out1, ret0))
+            fail();
+        if (checkasm_bench_func())
+            bench_convert(t, out1, (const uint8_t **)in);
+
+        report("%s", t->name);
+    }
+
+end:
+    for (ch = 0; ch < MAX_CH; ch++) {
+        av_free(in[ch]);
+        av_free(out0[ch]);
+        av_free(out1[ch]);
+    }
+}
@@ -0,0 +1,579 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libswscale/rgb2rgb.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#define WIDTH   512
+#define HEIGHT    2
+/* room for the SIMD versions processing whole vectors past the end */
+#define PADDING  64
+#define BUF_SIZE ((WIDTH * 4 + PADDING) * HEIGHT)
+
+#define randomize_buffer(buf, size)     \
+    do {                                \
+        int j;                          \
+        for (j = 0; j < size; j++)      \
+            buf[j] = rnd();             \
+    } while (0)
+
+static void check_rgb2rgb_packed(void)
+{
+    LOCAL_ALIGNED(32, uint8_t, src,  [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst1, [BUF_SIZE]);
+    static const struct {
+        const char *name;
+        void (**func)(const uint8_t *src, uint8_t *dst, int src_size);
+        int src_bpp;
+    } funcs[] = {
+#define PACKED(name, bpp) { #name, &name, bpp }
+        PACKED(rgb24tobgr32, 3), PACKED(rgb24tobgr16, 3), PACKED(rgb24tobgr15, 3),
+        PACKED(rgb32tobgr24, 4), PACKED(rgb32to16,    4), PACKED(rgb32to15,    4),
+        PACKED(rgb15to16,    2), PACKED(rgb15tobgr24, 2), PACKED(rgb15to32,    2),
+        PACKED(rgb16to15,    2), PACKED(rgb16tobgr24, 2), PACKED(rgb16to32,    2),
+        PACKED(rgb24tobgr24, 3), PACKED(rgb24to16,    3), PACKED(rgb24to15,    3),
+        PACKED(rgb32tobgr16, 4), PACKED(rgb32tobgr15, 4),
+        PACKED(shuffle_bytes_2103, 4),
+#undef PACKED
+    };
+    int i;
+
+    declare_func(void, const uint8_t *src, uint8_t *dst, int src_size);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(funcs); i++) {
+        /* an odd number of pixels, to exercise the tails */
+        int src_size = (WIDTH - 3) * funcs[i].src_bpp;
+
+        if (!check_func(*funcs[i].func, "%s", funcs[i].name))
+            continue;
+
+        randomize_buffer(src, BUF_SIZE);
+        memset(dst0, 0, BUF_SIZE);
+        memset(dst1, 0, BUF_SIZE);
+        call_ref(src, dst0, src_size);
+        call_new(src, dst1, src_size);
+        emms_c();
+        if (memcmp(dst0, dst1, BUF_SIZE))
+            fail();
+        bench_new(src, dst1, src_size);
+    }
+}
+
+static int bytes_near(const uint8_t *a, const uint8_t *b, int size, int eps)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        if (FFABS(a[i] - b[i]) > eps)
+            return 0;
+    return 1;
+}
+
+static void check_rgb2rgb_planar(void)
+{
+    LOCAL_ALIGNED(32, uint8_t, src0, [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, src1, [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst0, [3 * BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst1, [3 * BUF_SIZE]);
+    int width = WIDTH - 2, stride = WIDTH + PADDING, i;
+
+    randomize_buffer(src0, BUF_SIZE);
+    randomize_buffer(src1, BUF_SIZE);
+
+    {
+        declare_func(void, const uint8_t *src1, const uint8_t *src2,
+                     uint8_t *dst, int width, int height, int src1Stride,
+                     int src2Stride, int dstStride);
+
+        if (check_func(interleaveBytes, "interleaveBytes")) {
+            memset(dst0, 0, 3 * BUF_SIZE);
+            memset(dst1, 0, 3 * BUF_SIZE);
+            call_ref(src0, src1, dst0, width, HEIGHT, stride, stride, 2 * stride);
+            call_new(src0, src1, dst1, width, HEIGHT, stride, stride, 2 * stride);
+            emms_c();
+            if (memcmp(dst0, dst1, 3 * BUF_SIZE))
+                fail();
+            bench_new(src0, src1, dst1, width, HEIGHT, stride, stride, 2 * stride);
+        }
+    }
+    {
+        declare_func(void, const uint8_t *src, uint8_t *dst1, uint8_t *dst2,
+                     int width, int height, int srcStride,
+                     int dst1Stride, int dst2Stride);
+
+        if (check_func(deinterleaveBytes, "deinterleaveBytes")) {
+            memset(dst0, 0, 3 * BUF_SIZE);
+            memset(dst1, 0, 3 * BUF_SIZE);
+            call_ref(src0, dst0, dst0 + BUF_SIZE, width / 2, HEIGHT,
+                     stride, stride, stride);
+            call_new(src0, dst1, dst1 + BUF_SIZE, width / 2, HEIGHT,
+                     stride, stride, stride);
+            emms_c();
+            if (memcmp(dst0, dst1, 3 * BUF_SIZE))
+                fail();
+            bench_new(src0, dst1, dst1 + BUF_SIZE, width / 2, HEIGHT,
+                      stride, stride, stride);
+        }
+    }
+    {
+        /* the 4:2:0 versions average the chroma of two lines, which the
+         * PAVGB versions round while the C version truncates */
+        static const struct {
+            const char *name;
+            void (**func)(uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
+                          const uint8_t *src, int width, int height,
+                          int lumStride, int chromStride, int srcStride);
+            int chroma_eps;
+        } funcs[] = {
+            { "uyvytoyuv420", &uyvytoyuv420, 1 }, { "uyvytoyuv422", &uyvytoyuv422, 0 },
+            { "yuyvtoyuv420", &yuyvtoyuv420, 1 }, { "yuyvtoyuv422", &yuyvtoyuv422, 0 },
+        };
+
+        declare_func(void, uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
+                     const uint8_t *src, int width, int height,
+                     int lumStride, int chromStride, int srcStride);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(funcs); i++) {
+            if (!check_func(*funcs[i].func, "%s", funcs[i].name))
+                continue;
+
+            memset(dst0, 0, 3 * BUF_SIZE);
+            memset(dst1, 0, 3 * BUF_SIZE);
+            call_ref(dst0, dst0 + BUF_SIZE, dst0 + 2 * BUF_SIZE, src0,
+                     width / 2, HEIGHT, stride, stride / 2, stride);
+            call_new(dst1, dst1 + BUF_SIZE, dst1 + 2 * BUF_SIZE, src0,
+                     width / 2, HEIGHT, stride, stride / 2, stride);
+            emms_c();
+            if (memcmp(dst0, dst1, BUF_SIZE) ||
+                !bytes_near(dst0 + BUF_SIZE, dst1 + BUF_SIZE, 2 * BUF_SIZE,
+                            funcs[i].chroma_eps))
+                fail();
+            bench_new(dst1, dst1 + BUF_SIZE, dst1 + 2 * BUF_SIZE, src0,
+                      width / 2, HEIGHT, stride, stride / 2, stride);
+        }
+    }
+}
+
+static const struct {
+    enum AVPixelFormat src_fmt, dst_fmt;
+    int src_w, dst_w, flags;
+} scale_tests[] = {
+    { AV_PIX_FMT_GRAY8,  AV_PIX_FMT_GRAY8,     WIDTH / 2, WIDTH,     SWS_BILINEAR },
+    { AV_PIX_FMT_GRAY8,  AV_PIX_FMT_GRAY8,     WIDTH / 2, WIDTH,     SWS_BICUBIC  },
+    { AV_PIX_FMT_GRAY8,  AV_PIX_FMT_GRAY8,     WIDTH,     WIDTH / 2, SWS_BICUBIC  },
+    { AV_PIX_FMT_GRAY8,  AV_PIX_FMT_GRAY8,     WIDTH,     WIDTH / 2, SWS_LANCZOS  },
+    { AV_PIX_FMT_GRAY16, AV_PIX_FMT_GRAY16,    WIDTH / 2, WIDTH,     SWS_BICUBIC  },
+    { AV_PIX_FMT_GRAY16, AV_PIX_FMT_GRAY16,    WIDTH,     WIDTH / 2, SWS_LANCZOS  },
+    { AV_PIX_FMT_GRAY8,  AV_PIX_FMT_GRAY16,    WIDTH,     WIDTH / 2, SWS_BICUBIC  },
+    { AV_PIX_FMT_GRAY16, AV_PIX_FMT_GRAY8,     WIDTH,     WIDTH / 2, SWS_BICUBIC  },
+    { AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P9, WIDTH,     WIDTH / 2, SWS_BICUBIC  },
+    { AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P10, WIDTH,    WIDTH / 2, SWS_BICUBIC  },
+};
+
+static void check_hscale(void)
+{
+    LOCAL_ALIGNED(32, uint8_t, src,  [(WIDTH + PADDING) * 2]);
+    LOCAL_ALIGNED(32, int32_t, dst0, [WIDTH + PADDING]);
+    LOCAL_ALIGNED(32, int32_t, dst1, [WIDTH + PADDING]);
+    int i;
+
+    declare_func(void, SwsContext *c, int16_t *dst, int dstW,
+                 const uint8_t *src, const int16_t *filter,
+                 const int32_t *filterPos, int filterSize);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(scale_tests); i++) {
+        SwsContext *c = sws_getContext(scale_tests[i].src_w, HEIGHT,
+                                       scale_tests[i].src_fmt,
+                                       scale_tests[i].dst_w, HEIGHT,
+                                       scale_tests[i].dst_fmt,
+                                       scale_tests[i].flags | SWS_ACCURATE_RND,
+                                       NULL, NULL, NULL);
+        if (!c) {
+            fprintf(stderr, "checkasm: sws_getContext failed\n");
+            continue;
+        }
+
+        if (check_func(c->hyScale, "hscale_%d_to_%d_%d", c->srcBpc,
+                       c->dstBpc > 10 ? 19 : 15, c->hLumFilterSize)) {
+            randomize_buffer(src, (WIDTH + PADDING) * 2);
+            memset(dst0, 0, (WIDTH + PADDING) * sizeof(*dst0));
+            memset(dst1, 0, (WIDTH + PADDING) * sizeof(*dst1));
+            call_ref(c, (int16_t *)dst0, c->dstW, src, c->hLumFilter,
+                     c->hLumFilterPos, c->hLumFilterSize);
+            call_new(c, (int16_t *)dst1, c->dstW, src, c->hLumFilter,
+                     c->hLumFilterPos, c->hLumFilterSize);
+            emms_c();
+            if (memcmp(dst0, dst1, (WIDTH + PADDING) * sizeof(*dst0)))
+                fail();
+            bench_new(c, (int16_t *)dst1, c->dstW, src, c->hLumFilter,
+                      c->hLumFilterPos, c->hLumFilterSize);
+        }
+        sws_freeContext(c);
+    }
+}
+
+static void check_vscale(void)
+{
+    /* 16 lines of up to 19-bit intermediates */
+    LOCAL_ALIGNED(32, int32_t, lines, [16 * (WIDTH + PADDING)]);
+    LOCAL_ALIGNED(32, uint8_t, dst0,  [(WIDTH + PADDING) * 2]);
+    LOCAL_ALIGNED(32, uint8_t, dst1,  [(WIDTH + PADDING) * 2]);
+    LOCAL_ALIGNED_16(int16_t, filter, [16]);
+    const int16_t *src[16];
+    int i, j, sum;
+
+    for (i = 0; i < 16; i++)
+        src[i] = (const int16_t *)(lines + i * (WIDTH + PADDING));
+
+    /* coefficients summing to 4096, as made by initFilter() */
+    for (i = 0, sum = 0; i < 15; i++) {
+        filter[i] = (int)(rnd() % 512) - 128;
+        sum += filter[i];
+    }
+    filter[15] = 4096 - sum;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(scale_tests); i++) {
+        SwsContext *c = sws_getContext(scale_tests[i].src_w, HEIGHT,
+                                       scale_tests[i].src_fmt,
+                                       scale_tests[i].dst_w, HEIGHT,
+                                       scale_tests[i].dst_fmt,
+                                       scale_tests[i].flags | SWS_ACCURATE_RND,
+                                       NULL, NULL, NULL);
+        int dst_size = (WIDTH + PADDING) * (c && c->dstBpc > 8 ? 2 : 1);
+
+        if (!c) {
+            fprintf(stderr, "checkasm: sws_getContext failed\n");
+            continue;
+        }
+
+        /* 15-bit intermediates, or 19-bit ones in 32 bits */
+        for (j = 0; j < 16 * (WIDTH + PADDING); j++) {
+            if (c->dstBpc > 10)
+                lines[j] = rnd() & 0x7FFFF;
+            else
+                ((int16_t *)lines)[j] = rnd() & 0x7FFF;
+        }
+
+        {
+            declare_func(void, const int16_t *src, uint8_t *dest, int dstW,
+                         const uint8_t *dither, int offset);
+
+            if (check_func(c->yuv2plane1, "yuv2plane1_%d", c->dstBpc)) {
+                memset(dst0, 0, dst_size);
+                memset(dst1, 0, dst_size);
+                call_ref(src[0], dst0, c->dstW, ff_dither_8x8_128[3], 0);
+                call_new(src[0], dst1, c->dstW, ff_dither_8x8_128[3], 0);
+                emms_c();
+                if (memcmp(dst0, dst1, dst_size))
+                    fail();
+                bench_new(src[0], dst1, c->dstW, ff_dither_8x8_128[3], 0);
+            }
+        }
+        /* the 8-bit vertical scalers of the MMX inline asm use the filter
+         * stored in the context instead of their arguments */
+        if (c->dstBpc > 8) {
+            declare_func(void, const int16_t *filter, int filterSize,
+                         const int16_t **src, uint8_t *dest, int dstW,
+                         const uint8_t *dither, int offset);
+
+            if (check_func(c->yuv2planeX, "yuv2planeX_%d", c->dstBpc)) {
+                memset(dst0, 0, dst_size);
+                memset(dst1, 0, dst_size);
+                call_ref(filter, 16, src, dst0, c->dstW, ff_dither_8x8_128[3], 0);
+                call_new(filter, 16, src, dst1, c->dstW, ff_dither_8x8_128[3], 0);
+                emms_c();
+                if (memcmp(dst0, dst1, dst_size))
+                    fail();
+                bench_new(filter, 16, src, dst1, c->dstW, ff_dither_8x8_128[3], 0);
+            }
+        }
+        sws_freeContext(c);
+    }
+}
+
+static void check_packed_planar_lines(SwsContext *c)
+{
+    LOCAL_ALIGNED(32, uint8_t, src,  [4], [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst0, [4], [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst1, [4], [BUF_SIZE]);
+    /* an odd number of pixels, to exercise the tails */
+    int width = WIDTH - 3, i, j;
+
+    for (i = 0; i < 4; i++)
+        randomize_buffer(src[i], BUF_SIZE);
+
+#define CLEAR_DST()                     \
+    do {                                \
+        memset(dst0, 0, 4 * BUF_SIZE);  \
+        memset(dst1, 0, 4 * BUF_SIZE);  \
+    } while (0)
+#define CHECK_DST()                                 \
+    do {                                            \
+        emms_c();                                   \
+        if (memcmp(dst0, dst1, 4 * BUF_SIZE))       \
+            fail();                                 \
+    } while (0)
+
+    {
+        declare_func(void, uint8_t *dst, const uint8_t *src0,
+                     const uint8_t *src1, const uint8_t *src2, int width);
+
+        if (check_func(c->gbr24pToPacked24Line, "gbr24p_to_packed24")) {
+            CLEAR_DST();
+            call_ref(dst0[0], src[0], src[1], src[2], width);
+            call_new(dst1[0], src[0], src[1], src[2], width);
+            CHECK_DST();
+            bench_new(dst1[0], src[0], src[1], src[2], width);
+        }
+    }
+    {
+        declare_func(void, uint8_t *dst, const uint8_t *src0,
+                     const uint8_t *src1, const uint8_t *src2, int width,
+                     int alpha_first);
+
+        for (i = 0; i < 2; i++) {
+            if (check_func(c->gbr24pToPacked32Line, "gbr24p_to_packed32%s",
+                           i ? "_alpha_first" : "")) {
+                CLEAR_DST();
+                call_ref(dst0[0], src[0], src[1], src[2], width, i);
+                call_new(dst1[0], src[0], src[1], src[2], width, i);
+                CHECK_DST();
+                bench_new(dst1[0], src[0], src[1], src[2], width, i);
+            }
+        }
+    }
+    {
+        declare_func(void, uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+                     const uint8_t *src, int width);
+
+        if (check_func(c->packed24ToGbr24pLine, "packed24_to_gbr24p")) {
+            CLEAR_DST();
+            call_ref(dst0[0], dst0[1], dst0[2], src[0], width);
+            call_new(dst1[0], dst1[1], dst1[2], src[0], width);
+            CHECK_DST();
+            bench_new(dst1[0], dst1[1], dst1[2], src[0], width);
+        }
+    }
+    {
+        declare_func(void, uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+                     const uint8_t *src, int width, int alpha_first);
+
+        for (i = 0; i < 2; i++) {
+            if (check_func(c->packed32ToGbr24pLine, "packed32_to_gbr24p%s",
+                           i ? "_alpha_first" : "")) {
+                CLEAR_DST();
+                call_ref(dst0[0], dst0[1], dst0[2], src[0], width, i);
+                call_new(dst1[0], dst1[1], dst1[2], src[0], width, i);
+                CHECK_DST();
+                bench_new(dst1[0], dst1[1], dst1[2], src[0], width, i);
+            }
+        }
+    }
+    {
+        declare_func(void, uint16_t *dst[4], const uint16_t *src,
+                     int width, int src_alpha, int shift);
+
+        /* with and without alpha in the source and in the destination */
+        for (i = 0; i < 4; i++) {
+            int src_alpha = i & 1, dst_alpha = i >> 1;
+            int shift = rnd() % 8;
+            uint16_t *d0[4] = { (uint16_t *)dst0[0], (uint16_t *)dst0[1],
+                                (uint16_t *)dst0[2],
+                                dst_alpha ? (uint16_t *)dst0[3] : NULL };
+            uint16_t *d1[4] = { (uint16_t *)dst1[0], (uint16_t *)dst1[1],
+                                (uint16_t *)dst1[2],
+                                dst_alpha ? (uint16_t *)dst1[3] : NULL };
+
+            if (check_func(c->packed16ToGbra16Line, "packed%d_to_gbr%s16p",
+                           src_alpha ? 64 : 48, dst_alpha ? "a" : "")) {
+                CLEAR_DST();
+                call_ref(d0, (const uint16_t *)src[0], width / 2, src_alpha, shift);
+                call_new(d1, (const uint16_t *)src[0], width / 2, src_alpha, shift);
+                CHECK_DST();
+                bench_new(d1, (const uint16_t *)src[0], width / 2, src_alpha, shift);
+            }
+        }
+    }
+    {
+        declare_func(void, uint16_t *dst, const uint16_t *src[4],
+                     int width, int alpha, int bpp);
+
+        for (i = 0; i < 4; i++) {
+            int alpha = i & 1, src_alpha = i >> 1;
+            int bpp = 9 + rnd() % 8;
+            const uint16_t *s[4] = { (const uint16_t *)src[0], (const uint16_t *)src[1],
+                                     (const uint16_t *)src[2],
+                                     src_alpha ? (const uint16_t *)src[3] : NULL };
+
+            /* a source alpha plane without output alpha is ignored */
+            if (src_alpha && !alpha)
+                continue;
+            for (j = 0; j < 4 * BUF_SIZE / 2; j++)
+                ((uint16_t *)src)[j] &= (1 << bpp) - 1;
+
+            if (check_func(c->gbr16pToPacked16Line, "gbr%s16p_to_packed%d",
+                           src_alpha ? "a" : "", alpha ? 64 : 48)) {
+                CLEAR_DST();
+                call_ref((uint16_t *)dst0[0], s, width / 2, alpha, bpp);
+                call_new((uint16_t *)dst1[0], s, width / 2, alpha, bpp);
+                CHECK_DST();
+                bench_new((uint16_t *)dst1[0], s, width / 2, alpha, bpp);
+            }
+        }
+    }
+#undef CLEAR_DST
+#undef CHECK_DST
+}
+
+/* the scale and shift factors of the dithered conversions, from the
+ * dither_scale table of swscale_unscaled.c */
+static const struct {
+    int src_depth, dst_depth, scale, shift;
+} dither_tests[] = {
+    {  9,  8,   511, 10 }, { 10,  8,   511, 11 }, { 12,  8,  2041, 15 },
+    { 16,  8, 32641, 23 }, { 12, 10,  2047, 13 }, { 16, 10, 32737, 21 },
+    { 16, 12, 32761, 19 },
+};
+
+static void randomize_depth(uint16_t *buf, int size, int depth)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        buf[i] = rnd() & ((1 << depth) - 1);
+}
+
+static void check_bit_depth_lines(SwsContext *c)
+{
+    LOCAL_ALIGNED(32, uint16_t, src,  [WIDTH + PADDING]);
+    LOCAL_ALIGNED(32, uint8_t,  src8, [WIDTH + PADDING]);
+    LOCAL_ALIGNED(32, uint16_t, dst0, [WIDTH + PADDING]);
+    LOCAL_ALIGNED(32, uint16_t, dst1, [WIDTH + PADDING]);
+    const int size = (WIDTH + PADDING) * sizeof(*dst0);
+    uint8_t dither[8];
+    int width = WIDTH - 3, i, j;
+
+    for (i = 0; i < 2; i++) {
+        /* the 8-bit and the 16-bit outputs */
+        declare_func(void, uint8_t *dst, const uint16_t *src,
+                     const uint8_t *dither, int scale, int shift, int width);
+
+        if (!check_func(i ? (void *)c->ditherU16ToU16Line : (void *)c->ditherU16ToU8Line,
+                        "dither_u16_to_u%d", i ? 16 : 8))
+            continue;
+
+        for (j = 0; j < FF_ARRAY_ELEMS(dither_tests); j++) {
+            int src_depth = dither_tests[j].src_depth;
+            int dst_depth = dither_tests[j].dst_depth;
+            int scale = dither_tests[j].scale, shift = dither_tests[j].shift;
+            int k;
+
+            if ((dst_depth > 8) != i)
+                continue;
+
+            randomize_depth(src, WIDTH + PADDING, src_depth);
+            for (k = 0; k < 8; k++)
+                dither[k] = rnd() & FFMIN((1 << (src_depth - dst_depth)) - 1, 127);
+            memset(dst0, 0, size);
+            memset(dst1, 0, size);
+            call_ref((uint8_t *)dst0, src, dither, scale, shift, width);
+            call_new((uint8_t *)dst1, src, dither, scale, shift, width);
+            emms_c();
+            if (memcmp(dst0, dst1, size)) {
+                fail();
+                break;
+            }
+        }
+        bench_new((uint8_t *)dst1, src, dither, dither_tests[0].scale,
+                  dither_tests[0].shift, width);
+    }
+
+    /* from 8 bits, then from 9 to 15 bits, to all the higher depths, both
+     * with the low bits replicated and shifted in as zero */
+    for (i = 0; i < 2; i++) {
+        declare_func(void, uint16_t *dst, const void *src, int width,
+                     int shift_high, int shift_low);
+        const void *line = i ? (const void *)src : (const void *)src8;
+        int src_depth, dst_depth, shift_low = 0;
+
+        if (!check_func(i ? (void *)c->shiftUpU16Line : (void *)c->shiftUpU8ToU16Line,
+                        "shift_up_u%d_to_u16", i ? 16 : 8))
+            continue;
+
+        for (src_depth = i ? 9 : 8; src_depth <= (i ? 15 : 8); src_depth++) {
+            for (dst_depth = src_depth + 1; dst_depth <= 16; dst_depth++) {
+                int k;
+
+                shift_low = rnd() & 1 ? 16 : 2 * src_depth - dst_depth;
+                randomize_depth(src, WIDTH + PADDING, src_depth);
+                for (k = 0; k < WIDTH + PADDING; k++)
+                    src8[k] = src[k];
+                memset(dst0, 0, size);
+                memset(dst1, 0, size);
+                call_ref(dst0, line, width, dst_depth - src_depth, shift_low);
+                call_new(dst1, line, width, dst_depth - src_depth, shift_low);
+                emms_c();
+                if (memcmp(dst0, dst1, size)) {
+                    fail();
+                    break;
+                }
+            }
+        }
+        bench_new(dst1, line, width, 2, shift_low);
+    }
+}
+
+void checkasm_check_swscale(void)
+{
+    sws_rgb2rgb_init();
+
+    check_rgb2rgb_packed();
+    report("rgb2rgb_packed");
+    check_rgb2rgb_planar();
+    report("rgb2rgb_planar");
+    check_hscale();
+    report("hscale");
+    check_vscale();
+    report("vscale");
+
+    {
+        /* the line converters of the unscaled wrappers are set for all the
+         * contexts without scaling */
+        SwsContext *c = sws_getContext(WIDTH, HEIGHT, AV_PIX_FMT_YUV420P10,
+                                       WIDTH, HEIGHT, AV_PIX_FMT_NV12,
+                                       SWS_BILINEAR, NULL, NULL, NULL);
+        if (!c) {
+            fprintf(stderr, "checkasm: sws_getContext failed\n");
+            return;
+        }
+
+        check_packed_planar_lines(c);
+        report("packed_planar_lines");
+        check_bit_depth_lines(c);
+        report("bit_depth_lines");
+        sws_freeContext(c);
+    }
+}
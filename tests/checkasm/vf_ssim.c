@@ -0,0 +1,101 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavfilter/vf_ssim.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+
+/* number of 4x4 blocks, not a multiple of any SIMD width */
+#define W      63
+#define STRIDE (4 * W + 13)
+
+static void check_ssim_4x4_line(const SSIMDSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, uint8_t, src, [4 * STRIDE]);
+    LOCAL_ALIGNED(32, uint8_t, ref, [4 * STRIDE]);
+    LOCAL_ALIGNED(32, int, sums_ref, [W], [4]);
+    LOCAL_ALIGNED(32, int, sums_new, [W], [4]);
+    int i;
+
+    declare_func(void, const uint8_t *main, ptrdiff_t main_stride,
+                 const uint8_t *ref, ptrdiff_t ref_stride,
+                 int (*sums)[4], int w);
+
+    if (check_func(dsp->ssim_4x4_line, "ssim_4x4_line")) {
+        for (i = 0; i < 4 * STRIDE; i++) {
+            src[i] = rnd();
+            /* a distorted version of src, extremes included */
+            ref[i] = i & 15 ? av_clip_uint8(src[i] + (int)(rnd() % 65) - 32)
+                            : 255 - src[i];
+        }
+        memset(sums_ref, 0, sizeof(int[W][4]));
+        memset(sums_new, 0, sizeof(int[W][4]));
+        call_ref(src, STRIDE, ref, STRIDE, sums_ref, W);
+        call_new(src, STRIDE, ref, STRIDE, sums_new, W);
+        if (memcmp(sums_ref, sums_new, sizeof(int[W][4])))
+            fail();
+        bench_new(src, STRIDE, ref, STRIDE, sums_new, W);
+    }
+}
+
+static void check_ssim_end_line(const SSIMDSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, uint8_t, src, [8 * STRIDE]);
+    LOCAL_ALIGNED(32, uint8_t, ref, [8 * STRIDE]);
+    LOCAL_ALIGNED(32, int, sum0, [W + 1], [4]);
+    LOCAL_ALIGNED(32, int, sum1, [W + 1], [4]);
+    int i;
+
+    declare_func(float, const int (*sum0)[4], const int (*sum1)[4], int w);
+
+    if (check_func(dsp->ssim_end_line, "ssim_end_line")) {
+        float ssim_ref, ssim_new;
+
+        /* the statistics must be consistent to stay within the int range */
+        for (i = 0; i < 8 * STRIDE; i++) {
+            src[i] = rnd();
+            ref[i] = av_clip_uint8(src[i] + (int)(rnd() % 65) - 32);
+        }
+        ff_ssim_4x4_line_c(src, STRIDE, ref, STRIDE, sum0, W + 1);
+        ff_ssim_4x4_line_c(src + 4 * STRIDE, STRIDE, ref + 4 * STRIDE, STRIDE,
+                           sum1, W + 1);
+        /* all versions are meant to be bit-exact, the bound only covers
+         * x87 excess precision in the C version */
+        ssim_ref = call_ref((const int (*)[4])sum0, (const int (*)[4])sum1, W);
+        ssim_new = call_new((const int (*)[4])sum0, (const int (*)[4])sum1, W);
+        if (!float_near_abs_eps(ssim_ref, ssim_new, 1.0e-4))
+            fail();
+        bench_new((const int (*)[4])sum0, (const int (*)[4])sum1, W);
+    }
+}
+
+void checkasm_check_vf_ssim(void)
+{
+    SSIMDSPContext dsp;
+
+    ff_ssim_init(&dsp);
+
+    check_ssim_4x4_line(&dsp);
+    report("ssim_4x4_line");
+
+    check_ssim_end_line(&dsp);
+    report("ssim_end_line");
+}
@@ -0,0 +1,263 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavcodec/vp9.h"
+#include "libavcodec/vp9dsp.h"
+#include "libavutil/common.h"
+
+#define STRIDE    64
+#define BUF_SIZE (STRIDE * 64)
+
+/* the MC source has 3 pixels before and 4 after the block in both
+ * directions */
+#define SRC_STRIDE  80
+#define SRC_SIZE   (SRC_STRIDE * 72)
+#define SRC_OFFSET (3 * SRC_STRIDE + 3)
+
+#define randomize_buffer(buf, size)     \
+    do {                                \
+        int j;                          \
+        for (j = 0; j < size; j++)      \
+            buf[j] = rnd();             \
+    } while (0)
+
+static void check_intra_pred(const VP9DSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst1, [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, left, [32]);
+    LOCAL_ALIGNED(32, uint8_t, top,  [32 + 64]);
+    static const char *const modes[N_INTRA_PRED_MODES] = {
+        "vert", "hor", "dc", "diag_downleft", "diag_downright", "vert_right",
+        "hor_down", "vert_left", "hor_up", "tm", "dc_left", "dc_top",
+        "dc_128", "dc_127", "dc_129",
+    };
+    int tx, mode;
+
+    declare_func(void, uint8_t *dst, ptrdiff_t stride, const uint8_t *left,
+                 const uint8_t *top);
+
+    for (tx = 0; tx < N_TXFM_SIZES; tx++) {
+        int size = 4 << tx;
+
+        for (mode = 0; mode < N_INTRA_PRED_MODES; mode++) {
+            if (!check_func(dsp->intra_pred[tx][mode], "vp9_%s_%dx%d",
+                            modes[mode], size, size))
+                continue;
+
+            /* top[-1] is the top left pixel, top[size..2*size-1] the top
+             * right ones */
+            randomize_buffer(left, 32);
+            randomize_buffer(top, 32 + 64);
+            randomize_buffer(dst0, BUF_SIZE);
+            memcpy(dst1, dst0, BUF_SIZE);
+            call_ref(dst0, STRIDE, left, top + 32);
+            call_new(dst1, STRIDE, left, top + 32);
+            emms_c();
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+            bench_new(dst1, STRIDE, left, top + 32);
+        }
+    }
+}
+
+static void check_itxfm(const VP9DSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst1, [BUF_SIZE]);
+    LOCAL_ALIGNED(32, int16_t, coef,   [32 * 32]);
+    LOCAL_ALIGNED(32, int16_t, block0, [32 * 32]);
+    LOCAL_ALIGNED(32, int16_t, block1, [32 * 32]);
+    static const char *const txfm_types[N_TXFM_TYPES] = {
+        "dct_dct", "dct_adst", "adst_dct", "adst_adst",
+    };
+    int tx, type, dc, i;
+
+    declare_func(void, uint8_t *dst, ptrdiff_t stride, int16_t *block, int eob);
+
+    for (tx = 0; tx <= N_TXFM_SIZES; tx++) {
+        int size    = tx == N_TXFM_SIZES ? 4 : 4 << tx;
+        int nb_coef = size * size;
+
+        for (type = 0; type < N_TXFM_TYPES; type++) {
+            void *func = dsp->itxfm_add[tx][type];
+
+            /* the lossless and 32x32 transforms only exist as dct_dct, the
+             * other types point to the same function */
+            if (type && func == dsp->itxfm_add[tx][0])
+                continue;
+
+            for (dc = 0; dc < 2; dc++) {
+                int eob = dc ? 1 : nb_coef;
+
+                if (!check_func(func, "vp9_inv_%s_%dx%d%s_add",
+                                tx == N_TXFM_SIZES ? "wht_wht" : txfm_types[type],
+                                size, size, dc ? "_dc" : ""))
+                    continue;
+
+                /* small coefficients, so that the intermediates do not
+                 * overflow 16 bits in the SIMD versions */
+                memset(coef, 0, nb_coef * sizeof(*coef));
+                for (i = 0; i < eob; i++)
+                    coef[i] = ((int)(rnd() & 0x7F) - 64) >> tx;
+                memcpy(block0, coef, nb_coef * sizeof(*coef));
+                memcpy(block1, coef, nb_coef * sizeof(*coef));
+                randomize_buffer(dst0, BUF_SIZE);
+                memcpy(dst1, dst0, BUF_SIZE);
+
+                call_ref(dst0, STRIDE, block0, eob);
+                call_new(dst1, STRIDE, block1, eob);
+                emms_c();
+                if (memcmp(dst0, dst1, BUF_SIZE) ||
+                    memcmp(block0, block1, nb_coef * sizeof(*block0)))
+                    fail();
+                bench_new(dst1, STRIDE, block1, eob);
+            }
+        }
+    }
+}
+
+/* Smooth content, so that the loop filters actually modify the edges */
+static void randomize_edges(uint8_t *buf)
+{
+    int i;
+
+    for (i = 0; i < BUF_SIZE; i++)
+        buf[i] = 128 + (int)(rnd() % 9) - 4;
+}
+
+static void check_loopfilter(const VP9DSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, uint8_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, buf1, [BUF_SIZE]);
+    /* pixel (16, 16), leaving room for the 8 taps on all sides */
+    int offset = 16 * STRIDE + 16;
+    int dir, wd, wd2;
+
+    declare_func(void, uint8_t *dst, ptrdiff_t stride, int mb_lim, int lim,
+                 int hev_thr);
+
+#define CHECK_LPF(func, E, I, H, ...)                       \
+    if (check_func(func, __VA_ARGS__)) {                    \
+        randomize_edges(buf0);                              \
+        memcpy(buf1, buf0, BUF_SIZE);                       \
+        call_ref(buf0 + offset, STRIDE, E, I, H);           \
+        call_new(buf1 + offset, STRIDE, E, I, H);           \
+        emms_c();                                           \
+        if (memcmp(buf0, buf1, BUF_SIZE))                   \
+            fail();                                         \
+        bench_new(buf1 + offset, STRIDE, E, I, H);          \
+    }
+
+    for (dir = 0; dir < 2; dir++) {
+        int E = 20 + rnd() % 40, I = 8 + rnd() % 16, H = rnd() % 8;
+        int E2 = 20 + rnd() % 40, I2 = 8 + rnd() % 16, H2 = rnd() % 8;
+
+        for (wd = 0; wd < 3; wd++)
+            CHECK_LPF(dsp->loop_filter_8[wd][dir], E, I, H,
+                      "vp9_loop_filter_%s_%d_8", dir ? "v" : "h", 4 << wd)
+
+        CHECK_LPF(dsp->loop_filter_16[dir], E, I, H,
+                  "vp9_loop_filter_%s_16_16", dir ? "v" : "h")
+
+        for (wd = 0; wd < 2; wd++)
+            for (wd2 = 0; wd2 < 2; wd2++)
+                CHECK_LPF(dsp->loop_filter_mix2[wd][wd2][dir],
+                          E | (E2 << 8), I | (I2 << 8), H | (H2 << 8),
+                          "vp9_loop_filter_mix2_%s_%d%d_16", dir ? "v" : "h",
+                          4 << wd, 4 << wd2)
+    }
+#undef CHECK_LPF
+}
+
+static void check_mc(const VP9DSPContext *dsp)
+{
+    LOCAL_ALIGNED(32, uint8_t, src,  [SRC_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst1, [BUF_SIZE]);
+    static const char *const filters[4] = {
+        "smooth", "regular", "sharp", "bilin",
+    };
+    static const char *const subpel[2][2] = {
+        { "", "h" }, { "v", "hv" },
+    };
+    int hsize, filter, avg, dx, dy;
+
+    declare_func(void, uint8_t *dst, ptrdiff_t dst_stride,
+                 const uint8_t *ref, ptrdiff_t ref_stride,
+                 int h, int mx, int my);
+
+    randomize_buffer(src, SRC_SIZE);
+
+    for (hsize = 0; hsize < 5; hsize++) {
+        int size = 64 >> hsize;
+
+        for (filter = 0; filter < 4; filter++) {
+            for (avg = 0; avg < 2; avg++) {
+                for (dx = 0; dx < 2; dx++) {
+                    for (dy = 0; dy < 2; dy++) {
+                        int mx = dx ? 1 + rnd() % 15 : 0;
+                        int my = dy ? 1 + rnd() % 15 : 0;
+
+                        /* the full-pel copies are shared by all filters */
+                        if (!dx && !dy && filter)
+                            continue;
+
+                        if (!check_func(dsp->mc[hsize][filter][avg][dx][dy],
+                                        "vp9_%s%d%s%s%s", avg ? "avg" : "put",
+                                        size, dx || dy ? "_" : "",
+                                        dx || dy ? filters[filter] : "",
+                                        subpel[dy][dx]))
+                            continue;
+
+                        randomize_buffer(dst0, BUF_SIZE);
+                        memcpy(dst1, dst0, BUF_SIZE);
+                        call_ref(dst0, STRIDE, src + SRC_OFFSET, SRC_STRIDE,
+                                 size, mx, my);
+                        call_new(dst1, STRIDE, src + SRC_OFFSET, SRC_STRIDE,
+                                 size, mx, my);
+                        emms_c();
+                        if (memcmp(dst0, dst1, BUF_SIZE))
+                            fail();
+                        bench_new(dst1, STRIDE, src + SRC_OFFSET, SRC_STRIDE,
+                                  size, mx, my);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void checkasm_check_vp9dsp(void)
+{
+    VP9DSPContext dsp;
+
+    ff_vp9dsp_init(&dsp);
+
+    check_intra_pred(&dsp);
+    report("ipred");
+    check_itxfm(&dsp);
+    report("itxfm");
+    check_loopfilter(&dsp);
+    report("loopfilter");
+    check_mc(&dsp);
+    report("mc");
+}
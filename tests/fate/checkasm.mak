@@ -0,0 +1,8 @@
+# checkasm needs the internal DSP symbols, which are only available when
+# linking with the static libraries.
+FATE_CHECKASM-$(CONFIG_STATIC) += fate-checkasm
+fate-checkasm: tests/checkasm/checkasm$(EXESUF)
+fate-checkasm: CMD = run tests/checkasm/checkasm
+fate-checkasm: REF = /dev/null
+
+FATE-yes += $(FATE_CHECKASM-yes)
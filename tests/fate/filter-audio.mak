@@ -4,17 +4,17 @@ fate-filter-adelay: SRC = $(TARGET_PATH)/tests/data/asynth-44100-2.wav
 fate-filter-adelay: CMD = framecrc -i $(SRC) -af adelay=42
 
 FATE_AMIX += fate-filter-amix-simple
-fate-filter-amix-simple: CMD = ffmpeg -filter_complex amix -i $(SRC) -ss 3 -i $(SRC1) -f f32le -
+fate-filter-amix-simple: CMD = ffmpeg -filter_complex "aformat=flt[a];aformat=flt[b];[a][b]amix" -i $(SRC) -ss 3 -i $(SRC1) -f f32le -
 fate-filter-amix-simple: REF = $(SAMPLES)/filter/amix_simple.pcm
 
 FATE_AMIX += fate-filter-amix-first
-fate-filter-amix-first: CMD = ffmpeg -filter_complex amix=duration=first -ss 4 -i $(SRC) -i $(SRC1) -f f32le -
+fate-filter-amix-first: CMD = ffmpeg -filter_complex "aformat=flt[a];aformat=flt[b];[a][b]amix=duration=first" -ss 4 -i $(SRC) -i $(SRC1) -f f32le -
 fate-filter-amix-first: REF = $(SAMPLES)/filter/amix_first.pcm
 
 FATE_AMIX += fate-filter-amix-transition
 fate-filter-amix-transition: tests/data/asynth-44100-2-3.wav
 fate-filter-amix-transition: SRC2 = $(TARGET_PATH)/tests/data/asynth-44100-2-3.wav
-fate-filter-amix-transition: CMD = ffmpeg -filter_complex amix=inputs=3:dropout_transition=0.5 -i $(SRC) -ss 2 -i $(SRC1) -ss 4 -i $(SRC2) -f f32le -
+fate-filter-amix-transition: CMD = ffmpeg -filter_complex "aformat=flt[a];aformat=flt[b];aformat=flt[c];[a][b][c]amix=inputs=3:dropout_transition=0.5" -i $(SRC) -ss 2 -i $(SRC1) -ss 4 -i $(SRC2) -f f32le -
 fate-filter-amix-transition: REF = $(SAMPLES)/filter/amix_transition.pcm
 
 FATE_AFILTER-$(call FILTERDEMDECENCMUX, AMIX, WAV, PCM_S16LE, PCM_F32LE, PCM_F32LE) += $(FATE_AMIX)
@@ -75,6 +75,30 @@ fate-filter-join: CMD = md5 -i $(SRC1) -i $(SRC2) -filter_complex join=channel_l
 fate-filter-join: CMP = oneline
 fate-filter-join: REF = 88b0d24a64717ba8635b29e8dac6ecd8
 
+FATE_AFILTER-$(call FILTERDEMDECENCMUX, AMIX, WAV, PCM_S16LE, PCM_S16LE, PCM_S16LE) += fate-filter-amix-s16
+fate-filter-amix-s16: SRC1 = $(TARGET_PATH)/tests/data/asynth-44100-2.wav
+fate-filter-amix-s16: SRC2 = $(TARGET_PATH)/tests/data/asynth-44100-2-2.wav
+fate-filter-amix-s16: SRC3 = $(TARGET_PATH)/tests/data/asynth-44100-2-3.wav
+fate-filter-amix-s16: tests/data/asynth-44100-2.wav tests/data/asynth-44100-2-2.wav tests/data/asynth-44100-2-3.wav
+fate-filter-amix-s16: CMD = md5 -i $(SRC1) -ss 2 -i $(SRC2) -ss 4 -i $(SRC3) -filter_complex amix=inputs=3:dropout_transition=0.5 -f s16le
+fate-filter-amix-s16: CMP = oneline
+fate-filter-amix-s16: REF = 9f20286649ea0e199ae63732867af9c4
+
+FATE_PAN += fate-filter-pan-mono
+fate-filter-pan-mono: SRC = $(TARGET_PATH)/tests/data/asynth-44100-2.wav
+fate-filter-pan-mono: tests/data/asynth-44100-2.wav
+fate-filter-pan-mono: CMD = md5 -i $(SRC) -af "pan=mono|c0=0.7*c0+0.3*c1" -f s16le
+fate-filter-pan-mono: REF = 5a92a7b71b43ac08cbf7421e9b2ef63f
+
+FATE_PAN += fate-filter-pan-stereo-planar
+fate-filter-pan-stereo-planar: SRC = $(TARGET_PATH)/tests/data/asynth-44100-6.wav
+fate-filter-pan-stereo-planar: tests/data/asynth-44100-6.wav
+fate-filter-pan-stereo-planar: CMD = md5 -i $(SRC) -af "aformat=s16p,pan=stereo|c0<c0+0.5*c2+0.6*c4|c1<c1+0.5*c2+0.6*c5" -f s16le
+fate-filter-pan-stereo-planar: REF = 372b3604bcb288b847d65e14a6a4c494
+
+FATE_AFILTER-$(call FILTERDEMDECENCMUX, PAN, WAV, PCM_S16LE, PCM_S16LE, PCM_S16LE) += $(FATE_PAN)
+$(FATE_PAN): CMP = oneline
+
 FATE_AFILTER-$(call ALLYES, WAV_DEMUXER PCM_S16LE_DECODER PCM_S16LE_ENCODER PCM_S16LE_MUXER APERMS_FILTER VOLUME_FILTER) += fate-filter-volume
 fate-filter-volume: SRC = $(TARGET_PATH)/tests/data/asynth-44100-2.wav
 fate-filter-volume: tests/data/asynth-44100-2.wav
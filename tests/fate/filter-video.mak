@@ -335,8 +335,13 @@ FATE_METADATA_FILTER-$(call ALLYES, $(EBUR128_METADATA_DEPS)) += fate-filter-met
 fate-filter-metadata-ebur128: SRC = $(SAMPLES)/filter/seq-3341-7_seq-3342-5-24bit.flac
 fate-filter-metadata-ebur128: CMD = run $(FILTER_METADATA_COMMAND) "amovie='$(SRC)',ebur128=metadata=1"
 
+SSIM_METADATA_DEPS = FFPROBE AVDEVICE LAVFI_INDEV TESTSRC_FILTER FORMAT_FILTER SPLIT_FILTER BOXBLUR_FILTER SSIM_FILTER
+FATE_METADATA_FILTER_LAVFI-$(call ALLYES, $(SSIM_METADATA_DEPS)) += fate-filter-metadata-ssim
+fate-filter-metadata-ssim: CMD = run $(FILTER_METADATA_COMMAND) "testsrc=s=176x144:r=5:d=2,format=yuv420p,split[main][tmp];[tmp]boxblur=2:1[ref];[main][ref]ssim"
+
 FATE_SAMPLES_FFPROBE += $(FATE_METADATA_FILTER-yes)
+FATE_FFPROBE += $(FATE_METADATA_FILTER_LAVFI-yes)
 
 fate-vfilter: $(FATE_FILTER-yes) $(FATE_FILTER_VSYNTH-yes)
 
-fate-filter: fate-afilter fate-vfilter $(FATE_METADATA_FILTER-yes)
+fate-filter: fate-afilter fate-vfilter $(FATE_METADATA_FILTER-yes) $(FATE_METADATA_FILTER_LAVFI-yes)
@@ -1,3 +1,8 @@
+FATE_LIBAVCODEC-yes += fate-avpacket
+fate-avpacket: libavcodec/avpacket-test$(EXESUF)
+fate-avpacket: CMD = run libavcodec/avpacket-test
+fate-avpacket: REF = /dev/null
+
 FATE_LIBAVCODEC-$(CONFIG_GOLOMB) += fate-golomb
 fate-golomb: libavcodec/golomb-test$(EXESUF)
 fate-golomb: CMD = run libavcodec/golomb-test
@@ -38,6 +38,11 @@ fate-des: libavutil/des-test$(EXESUF)
 fate-des: CMD = run libavutil/des-test
 fate-des: REF = /dev/null
 
+FATE_LIBAVUTIL += fate-dict
+fate-dict: libavutil/dict-test$(EXESUF)
+fate-dict: CMD = run libavutil/dict-test
+fate-dict: REF = /dev/null
+
 FATE_LIBAVUTIL += fate-eval
 fate-eval: libavutil/eval-test$(EXESUF)
 fate-eval: CMD = run libavutil/eval-test
@@ -46,10 +51,25 @@ FATE_LIBAVUTIL += fate-fifo
 fate-fifo: libavutil/fifo-test$(EXESUF)
 fate-fifo: CMD = run libavutil/fifo-test
 
+FATE_LIBAVUTIL += fate-frame
+fate-frame: libavutil/frame-test$(EXESUF)
+fate-frame: CMD = run libavutil/frame-test
+fate-frame: REF = /dev/null
+
 FATE_LIBAVUTIL += fate-hmac
 fate-hmac: libavutil/hmac-test$(EXESUF)
 fate-hmac: CMD = run libavutil/hmac-test
 
+FATE_LIBAVUTIL += fate-imgutils
+fate-imgutils: libavutil/imgutils-test$(EXESUF)
+fate-imgutils: CMD = run libavutil/imgutils-test
+fate-imgutils: REF = /dev/null
+
+FATE_LIBAVUTIL += fate-log
+fate-log: libavutil/log-test$(EXESUF)
+fate-log: CMD = run libavutil/log-test
+fate-log: REF = /dev/null
+
 FATE_LIBAVUTIL += fate-md5
 fate-md5: libavutil/md5-test$(EXESUF)
 fate-md5: CMD = run libavutil/md5-test
@@ -78,6 +98,16 @@ FATE_LIBAVUTIL += fate-sha512
 fate-sha512: libavutil/sha512-test$(EXESUF)
 fate-sha512: CMD = run libavutil/sha512-test
 
+FATE_LIBAVUTIL += fate-threadpool
+fate-threadpool: libavutil/threadpool-test$(EXESUF)
+fate-threadpool: CMD = run libavutil/threadpool-test
+fate-threadpool: REF = /dev/null
+
+FATE_LIBAVUTIL += fate-trace
+fate-trace: libavutil/trace-test$(EXESUF)
+fate-trace: CMD = run libavutil/trace-test
+fate-trace: REF = /dev/null
+
 FATE_LIBAVUTIL += fate-tree
 fate-tree: libavutil/tree-test$(EXESUF)
 fate-tree: CMD = run libavutil/tree-test
@@ -272,5 +272,16 @@ FATE_SWR_RESAMPLE-$(call FILTERDEMDECENCMUX, ARESAMPLE, WAV, PCM_S16LE, PCM_S16L
 fate-swr-resample: $(FATE_SWR_RESAMPLE-yes)
 FATE_SWR += $(FATE_SWR_RESAMPLE-yes)
 
+FATE_SWR_LIB += fate-swr-resample-core
+fate-swr-resample-core: libswresample/resample-test$(EXESUF)
+fate-swr-resample-core: CMD = run libswresample/resample-test
+fate-swr-resample-core: REF = /dev/null
+
+FATE_SWR_LIB += fate-swr-dither
+fate-swr-dither: libswresample/dither-test$(EXESUF)
+fate-swr-dither: CMD = run libswresample/dither-test
+fate-swr-dither: REF = /dev/null
+
 FATE_FFMPEG += $(FATE_SWR)
-fate-swr: $(FATE_SWR)
+FATE-$(CONFIG_SWRESAMPLE) += $(FATE_SWR_LIB)
+fate-swr: $(FATE_SWR) $(FATE_SWR_LIB)
@@ -0,0 +1,7 @@
+FATE_LIBSWSCALE += fate-sws-pool
+fate-sws-pool: libswscale/pool-test$(EXESUF)
+fate-sws-pool: CMD = run libswscale/pool-test
+fate-sws-pool: REF = /dev/null
+
+FATE-$(CONFIG_SWSCALE) += $(FATE_LIBSWSCALE)
+fate-libswscale: $(FATE_LIBSWSCALE)
@@ -71,6 +71,7 @@ struct hash_impl {
 #include "libavutil/sha512.h"
 #include "libavutil/ripemd.h"
 #include "libavutil/aes.h"
+#include "libavutil/adler32.h"
 
 #define IMPL_USE_lavu IMPL_USE
 
@@ -97,6 +98,19 @@ DEFINE_LAVU_MD(sha256,    AVSHA,    sha, 256);
 DEFINE_LAVU_MD(sha512,    AVSHA512, sha512, 512);
 DEFINE_LAVU_MD(ripemd160, AVRIPEMD, ripemd, 160);
 
+static void run_lavu_crc32(uint8_t *output,
+                           const uint8_t *input, unsigned size)
+{
+    AV_WB32(output, av_crc(av_crc_get_table(AV_CRC_32_IEEE_LE), UINT32_MAX,
+                           input, size) ^ UINT32_MAX);
+}
+
+static void run_lavu_adler32(uint8_t *output,
+                             const uint8_t *input, unsigned size)
+{
+    AV_WB32(output, av_adler32_update(1, input, size));
+}
+
 static void run_lavu_aes128(uint8_t *output,
                             const uint8_t *input, unsigned size)
 {
@@ -302,6 +316,8 @@ struct hash_impl implementations[] = {
                                       "7c25b9e118c200a189fcd5a01ef106a4e200061f3e97dbf50ba065745fd46bef")
     IMPL_ALL("RIPEMD-160", ripemd160, "62a5321e4fc8784903bb43ab7752c75f8b25af00")
     IMPL_ALL("AES-128",    aes128,    "crc:ff6bc888")
+    IMPL(lavu, "CRC-32",     crc32,     "12554ca6")
+    IMPL(lavu, "Adler-32",   adler32,   "02be3d2d")
 };
 
 int main(int argc, char **argv)